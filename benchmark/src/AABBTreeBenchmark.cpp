@@ -0,0 +1,178 @@
+/*
+ Copyright (C) 2018 Eric Wasylishen
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "AABBTree.h"
+#include "BenchmarkUtils.h"
+
+#include <vecmath/bbox.h>
+#include <vecmath/ray.h>
+#include <vecmath/vec.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace TrenchBroom {
+    using AABB = AABBTree<double, 3, size_t>;
+    using BOX = AABB::Box;
+    using RAY = vm::ray<double, 3>;
+    using VEC = vm::vec<double, 3>;
+
+    static constexpr size_t NumBoxes = 64'000;
+    static constexpr size_t NumQueries = 10'000;
+
+    static AABB::EntryList makeBoxes(std::mt19937& random) {
+        std::uniform_real_distribution<double> position(-4096.0, 4096.0);
+        std::uniform_real_distribution<double> size(8.0, 128.0);
+
+        AABB::EntryList result;
+        result.reserve(NumBoxes);
+        for (size_t i = 0; i < NumBoxes; ++i) {
+            const auto min = VEC(position(random), position(random), position(random));
+            const auto max = min + VEC(size(random), size(random), size(random));
+            result.emplace_back(BOX(min, max), i);
+        }
+        return result;
+    }
+
+    static std::vector<RAY> makeRays(std::mt19937& random) {
+        std::uniform_real_distribution<double> position(-4096.0, 4096.0);
+        std::uniform_real_distribution<double> direction(-1.0, 1.0);
+
+        std::vector<RAY> result;
+        result.reserve(NumQueries);
+        for (size_t i = 0; i < NumQueries; ++i) {
+            const auto origin = VEC(position(random), position(random), position(random));
+            result.emplace_back(origin, normalize(VEC(direction(random), direction(random), direction(random))));
+        }
+        return result;
+    }
+
+    TEST(AABBTreeBenchmark, benchBuildAndQuery) {
+        std::mt19937 random(1234);
+        const auto entries = makeBoxes(random);
+        const auto rays = makeRays(random);
+
+        AABB incremental;
+        timeLambda([&]() {
+            for (const auto& entry : entries) {
+                incremental.insert(entry.first, entry.second);
+            }
+        }, "insert " + std::to_string(entries.size()) + " boxes");
+
+        AABB bulk;
+        timeLambda([&]() { bulk.clearAndBuild(entries); }, "bulk build " + std::to_string(entries.size()) + " boxes");
+
+        AABB::Snapshot snapshot;
+        timeLambda([&]() { snapshot = AABB::Snapshot(bulk); }, "snapshot " + std::to_string(entries.size()) + " boxes");
+
+        std::vector<size_t> result;
+        size_t treeHits = 0;
+        timeLambda([&]() {
+            for (const auto& ray : rays) {
+                result.clear();
+                bulk.findIntersectors(ray, std::back_inserter(result));
+                treeHits += result.size();
+            }
+        }, "find intersectors in tree with " + std::to_string(rays.size()) + " rays");
+
+        size_t snapshotHits = 0;
+        timeLambda([&]() {
+            for (const auto& ray : rays) {
+                result.clear();
+                snapshot.findIntersectors(ray, std::back_inserter(result));
+                snapshotHits += result.size();
+            }
+        }, "find intersectors in snapshot with " + std::to_string(rays.size()) + " rays");
+
+        ASSERT_EQ(treeHits, snapshotHits);
+
+        treeHits = 0;
+        timeLambda([&]() {
+            for (const auto& ray : rays) {
+                result.clear();
+                bulk.findContainers(ray.origin, std::back_inserter(result));
+                treeHits += result.size();
+            }
+        }, "find containers in tree with " + std::to_string(rays.size()) + " points");
+
+        snapshotHits = 0;
+        timeLambda([&]() {
+            for (const auto& ray : rays) {
+                result.clear();
+                snapshot.findContainers(ray.origin, std::back_inserter(result));
+                snapshotHits += result.size();
+            }
+        }, "find containers in snapshot with " + std::to_string(rays.size()) + " points");
+
+        ASSERT_EQ(treeHits, snapshotHits);
+    }
+
+    TEST(AABBTreeBenchmark, benchUpdate) {
+        std::mt19937 random(1234);
+        const auto entries = makeBoxes(random);
+        const auto rays = makeRays(random);
+
+        // move all boxes in a region, like transforming a large selection
+        const auto region = BOX(VEC(-4096.0, -4096.0, -4096.0), VEC(-256.0, 0.0, 0.0));
+        const auto delta = VEC(1024.0, 512.0, 0.0);
+        AABB::UpdateList updates;
+        for (const auto& entry : entries) {
+            if (region.contains(entry.first)) {
+                updates.push_back(AABB::Update{ entry.first, entry.first.translate(delta), entry.second });
+            }
+        }
+
+        AABB single;
+        single.clearAndBuild(entries);
+        timeLambda([&]() {
+            for (const auto& update : updates) {
+                single.update(update.oldBounds, update.newBounds, update.data);
+            }
+        }, "update " + std::to_string(updates.size()) + " boxes one by one");
+
+        AABB batch;
+        batch.clearAndBuild(entries);
+        timeLambda([&]() { batch.update(updates); }, "update " + std::to_string(updates.size()) + " boxes in one batch");
+
+        std::vector<size_t> result;
+        size_t singleHits = 0;
+        timeLambda([&]() {
+            for (const auto& ray : rays) {
+                result.clear();
+                single.findIntersectors(ray, std::back_inserter(result));
+                singleHits += result.size();
+            }
+        }, "find intersectors after single updates with " + std::to_string(rays.size()) + " rays");
+
+        size_t batchHits = 0;
+        timeLambda([&]() {
+            for (const auto& ray : rays) {
+                result.clear();
+                batch.findIntersectors(ray, std::back_inserter(result));
+                batchHits += result.size();
+            }
+        }, "find intersectors after batch update with " + std::to_string(rays.size()) + " rays");
+
+        ASSERT_EQ(singleHits, batchHits);
+    }
+}
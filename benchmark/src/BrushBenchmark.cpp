@@ -0,0 +1,115 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "BenchmarkUtils.h"
+#include "CollectionUtils.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/NodeSnapshot.h"
+#include "Model/World.h"
+
+#include <vecmath/constants.h>
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Model {
+        static constexpr size_t NumBrushes = 10'000;
+
+        // alternating cubes and sixteen sided cylinders
+        static BrushList createBrushes(const BrushBuilder& builder) {
+            std::vector<vm::vec3> cylinderPoints;
+            for (size_t i = 0; i < 16; ++i) {
+                const auto angle = static_cast<FloatType>(i) * vm::constants<FloatType>::twoPi() / 16.0;
+                const auto x = std::round(32.0 * std::cos(angle));
+                const auto y = std::round(32.0 * std::sin(angle));
+                cylinderPoints.push_back(vm::vec3(x, y, -32.0));
+                cylinderPoints.push_back(vm::vec3(x, y, +32.0));
+            }
+
+            BrushList brushes;
+            brushes.reserve(NumBrushes);
+            for (size_t i = 0; i < NumBrushes; ++i) {
+                if (i % 2 == 0) {
+                    brushes.push_back(builder.createCube(64.0, "texture"));
+                } else {
+                    brushes.push_back(builder.createBrush(cylinderPoints, "texture"));
+                }
+            }
+            return brushes;
+        }
+
+        TEST(BrushBenchmark, clone) {
+            const vm::bbox3 worldBounds(8192.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+            const BrushBuilder builder(&world, worldBounds);
+
+            auto brushes = createBrushes(builder);
+
+            BrushList clones;
+            clones.reserve(brushes.size());
+            timeLambda([&]() {
+                for (const auto* brush : brushes) {
+                    clones.push_back(brush->clone(worldBounds));
+                }
+            }, "clone " + std::to_string(brushes.size()) + " brushes");
+
+            VectorUtils::clearAndDelete(clones);
+            VectorUtils::clearAndDelete(brushes);
+        }
+
+        TEST(BrushBenchmark, snapshotAndRestore) {
+            const vm::bbox3 worldBounds(8192.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+            const BrushBuilder builder(&world, worldBounds);
+
+            auto brushes = createBrushes(builder);
+
+            std::vector<std::unique_ptr<NodeSnapshot>> snapshots;
+            snapshots.reserve(brushes.size());
+            timeLambda([&]() {
+                for (auto* brush : brushes) {
+                    snapshots.emplace_back(brush->takeSnapshot());
+                }
+            }, "take snapshots of " + std::to_string(brushes.size()) + " brushes");
+
+            size_t memoryUsage = 0;
+            for (const auto& snapshot : snapshots) {
+                memoryUsage += snapshot->memoryUsage();
+            }
+            std::cout << "snapshot memory: " << memoryUsage << " bytes" << std::endl;
+
+            timeLambda([&]() {
+                for (auto& snapshot : snapshots) {
+                    snapshot->restore(worldBounds);
+                }
+            }, "restore " + std::to_string(brushes.size()) + " snapshots");
+
+            snapshots.clear();
+            VectorUtils::clearAndDelete(brushes);
+        }
+    }
+}
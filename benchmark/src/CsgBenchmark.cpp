@@ -0,0 +1,119 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "BenchmarkUtils.h"
+#include "ParallelFor.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/World.h"
+
+#include <vecmath/constants.h>
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Model {
+        // a floor of 40x40 cuboids, and 64 sixteen-sided cylinders that are carved out of it
+        static constexpr size_t GridSize = 40;
+        static constexpr FloatType CellSize = 64.0;
+        static constexpr size_t NumCylinders = 64;
+        static constexpr size_t CylinderSides = 16;
+
+        static Brush* createCylinder(const BrushBuilder& builder, const vm::vec3& center, const FloatType radius, const FloatType height) {
+            std::vector<vm::vec3> points;
+            for (size_t i = 0; i < CylinderSides; ++i) {
+                const auto angle = static_cast<FloatType>(i) * vm::constants<FloatType>::twoPi() / static_cast<FloatType>(CylinderSides);
+                const auto x = std::round(center.x() + radius * std::cos(angle));
+                const auto y = std::round(center.y() + radius * std::sin(angle));
+                points.push_back(vm::vec3(x, y, center.z() - height / 2.0));
+                points.push_back(vm::vec3(x, y, center.z() + height / 2.0));
+            }
+            return builder.createBrush(points, "subtrahend");
+        }
+
+        static size_t countBrushes(const std::vector<BrushList>& results) {
+            size_t count = 0;
+            for (const auto& brushes : results) {
+                count += brushes.size();
+            }
+            return count;
+        }
+
+        static void deleteBrushes(std::vector<BrushList>& results) {
+            for (auto& brushes : results) {
+                VectorUtils::clearAndDelete(brushes);
+            }
+            results.clear();
+        }
+
+        TEST(CsgBenchmark, subtract) {
+            const vm::bbox3 worldBounds(8192.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+            BrushBuilder builder(&world, worldBounds);
+
+            BrushList minuends;
+            for (size_t x = 0; x < GridSize; ++x) {
+                for (size_t y = 0; y < GridSize; ++y) {
+                    const auto min = vm::vec3(static_cast<FloatType>(x) * CellSize, static_cast<FloatType>(y) * CellSize, 0.0);
+                    minuends.push_back(builder.createCuboid(vm::bbox3(min, min + vm::vec3(CellSize, CellSize, CellSize)), "minuend"));
+                }
+            }
+
+            BrushList subtrahends;
+            for (size_t i = 0; i < NumCylinders; ++i) {
+                // spread the cylinders over the floor in a deterministic pattern
+                const auto x = static_cast<FloatType>((i * 37) % 64) / 64.0 * static_cast<FloatType>(GridSize) * CellSize;
+                const auto y = static_cast<FloatType>((i * 23) % 64) / 64.0 * static_cast<FloatType>(GridSize) * CellSize;
+                subtrahends.push_back(createCylinder(builder, vm::vec3(x, y, CellSize), 100.0, CellSize));
+            }
+
+            std::printf("Subtracting %zu brushes from %zu brushes\n", subtrahends.size(), minuends.size());
+
+            std::vector<BrushList> results;
+            timeLambda([&]() {
+                for (const auto* minuend : minuends) {
+                    results.push_back(minuend->subtract(world, worldBounds, "default", subtrahends));
+                }
+            }, "subtract every subtrahend from each minuend");
+            std::printf("Created %zu brushes\n", countBrushes(results));
+            deleteBrushes(results);
+
+            timeLambda([&]() {
+                results = Brush::subtractAll(world, worldBounds, "default", minuends, subtrahends, 1);
+            }, "subtract culled subtrahends and merge fragments on one thread");
+            std::printf("Created %zu brushes\n", countBrushes(results));
+            deleteBrushes(results);
+
+            timeLambda([&]() {
+                results = Brush::subtractAll(world, worldBounds, "default", minuends, subtrahends);
+            }, "subtract culled subtrahends and merge fragments on " + std::to_string(defaultThreadCount()) + " threads");
+            std::printf("Created %zu brushes\n", countBrushes(results));
+            deleteBrushes(results);
+
+            VectorUtils::clearAndDelete(minuends);
+            VectorUtils::clearAndDelete(subtrahends);
+        }
+    }
+}
@@ -0,0 +1,156 @@
+/*
+ Copyright (C) 2018 Eric Wasylishen
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "BenchmarkUtils.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushFace.h"
+#include "Model/MapFormat.h"
+#include "Model/World.h"
+
+#include <vecmath/forward.h>
+#include <vecmath/vec.h>
+#include <vecmath/vec_ext.h>
+#include <vecmath/ray.h>
+#include <vecmath/intersection_batch.h>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace TrenchBroom {
+    static constexpr size_t NumPackets = 16'384;
+    static constexpr size_t NumRays = 256;
+
+    static std::vector<vm::ray3> makeRays(std::mt19937& random, const FloatType radius) {
+        std::uniform_real_distribution<FloatType> coord(-1.0, 1.0);
+
+        std::vector<vm::ray3> result;
+        result.reserve(NumRays);
+        for (size_t i = 0; i < NumRays; ++i) {
+            const auto origin = normalize(vm::vec3(coord(random), coord(random), coord(random))) * radius;
+            const auto target = vm::vec3(coord(random), coord(random), coord(random)) * radius / 4.0;
+            result.emplace_back(origin, normalize(target - origin));
+        }
+        return result;
+    }
+
+    TEST(IntersectionBenchmark, benchRayBoxes) {
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<float> position(-256.0f, 256.0f);
+        std::uniform_real_distribution<float> size(8.0f, 64.0f);
+
+        std::vector<vm::bbox4f> packets(NumPackets);
+        for (auto& packet : packets) {
+            for (size_t i = 0; i < 4; ++i) {
+                for (size_t a = 0; a < 3; ++a) {
+                    packet.min[a][i] = position(random);
+                    packet.max[a][i] = packet.min[a][i] + size(random);
+                }
+            }
+        }
+
+        std::vector<vm::box_query_ray> rays;
+        for (const auto& ray : makeRays(random, 512.0)) {
+            rays.emplace_back(ray);
+        }
+
+        const auto message = std::to_string(rays.size()) + " rays against " + std::to_string(4u * packets.size()) + " boxes";
+
+        size_t scalarHits = 0;
+        timeLambda([&]() {
+            for (const auto& ray : rays) {
+                for (const auto& packet : packets) {
+                    scalarHits += static_cast<size_t>(__builtin_popcount(vm::intersectMaskScalar(ray, packet)));
+                }
+            }
+        }, "scalar: " + message);
+
+        size_t simdHits = 0;
+        timeLambda([&]() {
+            for (const auto& ray : rays) {
+                for (const auto& packet : packets) {
+                    simdHits += static_cast<size_t>(__builtin_popcount(vm::intersectMask(ray, packet)));
+                }
+            }
+        }, "simd:   " + message);
+
+        ASSERT_EQ(scalarHits, simdHits);
+    }
+
+    TEST(IntersectionBenchmark, benchRayBrush) {
+        const vm::bbox3 worldBounds(4096.0);
+        Model::World world(Model::MapFormat::Standard, nullptr, worldBounds);
+        Model::BrushBuilder builder(&world, worldBounds);
+
+        // a prism with 16 sides
+        std::vector<vm::vec3> points;
+        for (size_t i = 0; i < 16; ++i) {
+            const auto angle = static_cast<FloatType>(i) * vm::Cd::twoPi() / 16.0;
+            points.emplace_back(std::cos(angle) * 64.0, std::sin(angle) * 64.0, -64.0);
+            points.emplace_back(std::cos(angle) * 64.0, std::sin(angle) * 64.0, +64.0);
+        }
+        std::unique_ptr<Model::Brush> brush(builder.createBrush(points, "texture"));
+
+        std::vector<FloatType> nx, ny, nz, d;
+        for (const auto* face : brush->faces()) {
+            nx.push_back(face->boundary().normal.x());
+            ny.push_back(face->boundary().normal.y());
+            nz.push_back(face->boundary().normal.z());
+            d.push_back(face->boundary().distance);
+        }
+
+        std::mt19937 random(1234);
+        const auto rays = makeRays(random, 256.0);
+        const auto repetitions = size_t(256);
+        const auto message = std::to_string(rays.size() * repetitions) + " rays against a brush with " + std::to_string(nx.size()) + " faces";
+
+        size_t polygonHits = 0;
+        timeLambda([&]() {
+            for (size_t i = 0; i < repetitions; ++i) {
+                for (const auto& ray : rays) {
+                    for (const auto* face : brush->faces()) {
+                        if (!vm::isnan(face->intersectWithRay(ray))) {
+                            ++polygonHits;
+                            break;
+                        }
+                    }
+                }
+            }
+        }, "polygons: " + message);
+
+        size_t planeHits = 0;
+        timeLambda([&]() {
+            for (size_t i = 0; i < repetitions; ++i) {
+                for (const auto& ray : rays) {
+                    if (vm::intersectConvex(ray, nx.data(), ny.data(), nz.data(), d.data(), nx.size()).first < nx.size()) {
+                        ++planeHits;
+                    }
+                }
+            }
+        }, "planes:   " + message);
+
+        ASSERT_EQ(polygonHits, planeHits);
+    }
+}
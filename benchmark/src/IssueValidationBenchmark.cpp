@@ -0,0 +1,116 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "BenchmarkUtils.h"
+#include "ParallelFor.h"
+#include "Model/BrushBuilder.h"
+#include "Model/CollectNodesVisitor.h"
+#include "Model/EmptyAttributeValueIssueGenerator.h"
+#include "Model/Entity.h"
+#include "Model/Layer.h"
+#include "Model/LinkSourceIssueGenerator.h"
+#include "Model/LinkTargetIssueGenerator.h"
+#include "Model/LongAttributeValueIssueGenerator.h"
+#include "Model/MissingClassnameIssueGenerator.h"
+#include "Model/MixedBrushContentsIssueGenerator.h"
+#include "Model/NonIntegerPlanePointsIssueGenerator.h"
+#include "Model/NonIntegerVerticesIssueGenerator.h"
+#include "Model/World.h"
+#include "Model/WorldBoundsIssueGenerator.h"
+
+#include <cstdio>
+#include <string>
+
+namespace TrenchBroom {
+    namespace Model {
+        // 20k entities with four brushes each, plus the world and its layer
+        static constexpr size_t NumEntities = 20'000;
+        static constexpr size_t BrushesPerEntity = 4;
+        static constexpr size_t NumChangedEntities = 100;
+
+        static void registerIssueGenerators(World& world) {
+            world.registerIssueGenerator(new MissingClassnameIssueGenerator());
+            world.registerIssueGenerator(new LinkSourceIssueGenerator());
+            world.registerIssueGenerator(new LinkTargetIssueGenerator());
+            world.registerIssueGenerator(new NonIntegerPlanePointsIssueGenerator());
+            world.registerIssueGenerator(new NonIntegerVerticesIssueGenerator());
+            world.registerIssueGenerator(new MixedBrushContentsIssueGenerator());
+            world.registerIssueGenerator(new WorldBoundsIssueGenerator(vm::bbox3(4096.0)));
+            world.registerIssueGenerator(new EmptyAttributeValueIssueGenerator());
+            world.registerIssueGenerator(new LongAttributeValueIssueGenerator(1023));
+        }
+
+        TEST(IssueValidationBenchmark, validateWorld) {
+            const vm::bbox3 worldBounds(8192.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+            BrushBuilder builder(&world, worldBounds);
+
+            for (size_t i = 0; i < NumEntities; ++i) {
+                auto* entity = world.createEntity();
+                entity->addOrUpdateAttribute(AttributeNames::Classname, "func_wall");
+                entity->addOrUpdateAttribute(AttributeNames::Target, "t" + std::to_string(i % 1000));
+                world.defaultLayer()->addChild(entity);
+
+                const auto x = static_cast<FloatType>(i % 256) * 32.0;
+                const auto y = static_cast<FloatType>(i / 256) * 32.0;
+                for (size_t j = 0; j < BrushesPerEntity; ++j) {
+                    const auto min = vm::vec3(x - 4096.0, y - 4096.0, static_cast<FloatType>(j) * 32.0);
+                    entity->addChild(builder.createCuboid(vm::bbox3(min, min + vm::vec3(24.0, 24.0, 24.0)), "texture"));
+                }
+            }
+            registerIssueGenerators(world);
+
+            CollectNodesVisitor visitor;
+            world.acceptAndRecurse(visitor);
+            const auto& nodes = visitor.nodes();
+            std::printf("Validating the issues of %zu nodes with %zu generators\n", nodes.size(), world.registeredIssueGenerators().size());
+
+            const auto invalidateAll = [&]() {
+                for (auto* node : nodes) {
+                    node->invalidateIssues();
+                }
+            };
+
+            invalidateAll();
+            timeLambda([&]() {
+                for (auto* node : nodes) {
+                    node->issues(world.registeredIssueGenerators());
+                }
+            }, "validate all nodes sequentially");
+
+            invalidateAll();
+            timeLambda([&]() { world.validateIssues(1); }, "validate all nodes on one thread");
+
+            invalidateAll();
+            timeLambda([&]() { world.validateIssues(); }, "validate all nodes on " + std::to_string(defaultThreadCount()) + " threads");
+
+            const auto& entities = world.defaultLayer()->children();
+            for (size_t i = 0; i < NumChangedEntities; ++i) {
+                static_cast<Entity*>(entities[i * (entities.size() / NumChangedEntities)])->addOrUpdateAttribute("message", "");
+            }
+            timeLambda([&]() { world.validateIssues(); }, "validate " + std::to_string(NumChangedEntities) + " changed entities");
+
+            for (auto* node : nodes) {
+                ASSERT_EQ(0, node->invalidIssueTypes());
+            }
+        }
+    }
+}
@@ -0,0 +1,81 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "BenchmarkUtils.h"
+#include "ByteBuffer.h"
+#include "Color.h"
+#include "Assets/Palette.h"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace TrenchBroom {
+    // a large texture collection: 2000 textures of 256x256 pixels, with three mip levels each
+    static constexpr size_t NumTextures = 2000;
+    static constexpr size_t TextureSize = 256;
+
+    TEST(PaletteBenchmark, indexedToRgba) {
+        std::mt19937 random(1);
+        std::uniform_int_distribution<int> byte(0, 255);
+
+        std::vector<unsigned char> paletteData(3 * 256);
+        for (auto& c : paletteData) {
+            c = static_cast<unsigned char>(byte(random));
+        }
+        const auto palette = Assets::Palette::fromRaw(paletteData.size(), paletteData.data());
+
+        // one indexed image per mip level, reused for every texture
+        std::vector<Buffer<unsigned char>> indexedImages;
+        std::vector<Buffer<unsigned char>> rgbaImages;
+        size_t pixelsPerTexture = 0;
+        for (size_t mip = 0; mip < 4; ++mip) {
+            const auto size = TextureSize >> mip;
+            Buffer<unsigned char> indexedImage(size * size);
+            for (size_t i = 0; i < size * size; ++i) {
+                indexedImage[i] = static_cast<unsigned char>(byte(random));
+            }
+            indexedImages.push_back(indexedImage);
+            rgbaImages.push_back(Buffer<unsigned char>(4 * size * size));
+            pixelsPerTexture += size * size;
+        }
+
+        Color averageColor;
+        size_t transparentTextures = 0;
+        timeLambda([&]() {
+            for (size_t i = 0; i < NumTextures; ++i) {
+                const auto transparency = i % 2 == 0 ? Assets::PaletteTransparency::Opaque : Assets::PaletteTransparency::Index255Transparent;
+                for (size_t mip = 0; mip < indexedImages.size(); ++mip) {
+                    const auto size = TextureSize >> mip;
+                    if (palette.indexedToRgba(indexedImages[mip], size * size, rgbaImages[mip], transparency, averageColor) && mip == 0) {
+                        ++transparentTextures;
+                    }
+                }
+            }
+        }, "convert indexed images to RGBA");
+
+        std::printf("Converted %zu textures (%.1f MiB of RGBA pixels), %zu with transparency\n",
+                    NumTextures,
+                    static_cast<double>(4 * NumTextures * pixelsPerTexture) / 1024.0 / 1024.0,
+                    transparentTextures);
+        ASSERT_EQ(NumTextures / 2, transparentTextures);
+    }
+}
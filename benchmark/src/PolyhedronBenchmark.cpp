@@ -0,0 +1,237 @@
+/*
+ Copyright (C) 2018 Eric Wasylishen
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "Allocator.h"
+#include "BenchmarkUtils.h"
+#include "Polyhedron.h"
+#include "Polyhedron_DefaultPayload.h"
+
+#include <vecmath/plane.h>
+#include <vecmath/scalar.h>
+#include <vecmath/vec.h>
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace TrenchBroom {
+    using Polyhedron3d = Polyhedron<double, DefaultPolyhedronPayload, DefaultPolyhedronPayload>;
+
+    static constexpr size_t NumCopies = 5'000;
+
+    // a prism with the given number of sides, similar to a cylinder brush
+    static Polyhedron3d makePrism(const size_t sides) {
+        std::vector<vm::vec3d> points;
+        for (size_t i = 0; i < sides; ++i) {
+            const auto angle = vm::Cd::twoPi() * static_cast<double>(i) / static_cast<double>(sides);
+            const auto x = std::round(64.0 * std::cos(angle));
+            const auto y = std::round(64.0 * std::sin(angle));
+            points.emplace_back(x, y, -32.0);
+            points.emplace_back(x, y, +32.0);
+        }
+        return Polyhedron3d(points);
+    }
+
+    static void benchCopyAndClip(const Polyhedron3d& original, const std::string& name) {
+        const vm::plane3d plane(vm::vec3d(0.0, 0.0, 16.0), normalize(vm::vec3d(1.0, 0.0, 1.0)));
+
+        for (const bool useArena : { false, true }) {
+            AllocatorArena::setEnabled(useArena);
+            const std::string suffix = std::string(" ") + name + (useArena ? " (arena)" : " (allocator)");
+
+            std::vector<Polyhedron3d> copies;
+            copies.reserve(NumCopies);
+
+            timeLambda([&]() {
+                for (size_t i = 0; i < NumCopies; ++i) {
+                    copies.emplace_back(original);
+                }
+            }, "copy " + std::to_string(NumCopies) + suffix);
+
+            timeLambda([&]() {
+                for (auto& copy : copies) {
+                    copy.clip(plane);
+                }
+            }, "clip " + std::to_string(NumCopies) + suffix);
+
+            timeLambda([&]() { copies.clear(); }, "destroy " + std::to_string(NumCopies) + suffix);
+
+            timeLambda([&]() {
+                for (size_t i = 0; i < NumCopies; ++i) {
+                    Polyhedron3d copy(original);
+                    copy.clip(plane);
+                }
+            }, "copy, clip and destroy " + std::to_string(NumCopies) + suffix);
+        }
+
+        AllocatorArena::setEnabled(true);
+    }
+
+    TEST(PolyhedronBenchmark, copyAndClipCube) {
+        benchCopyAndClip(Polyhedron3d(vm::bbox3d(-32.0, 32.0)), "cubes");
+    }
+
+    TEST(PolyhedronBenchmark, copyAndClipPrism) {
+        benchCopyAndClip(makePrism(32), "32 sided prisms");
+    }
+
+    static void benchBuildFromPlanes(const Polyhedron3d& original, const std::string& name) {
+        static constexpr size_t NumBuilds = 5'000;
+        const auto worldBounds = vm::bbox3d(8192.0).expand(1.0);
+
+        std::vector<vm::plane3d> planes;
+        for (const auto* face : original.faces()) {
+            planes.emplace_back(face->origin(), face->normal());
+        }
+
+        size_t clipVertexCount = 0u;
+        timeLambda([&]() {
+            for (size_t i = 0; i < NumBuilds; ++i) {
+                Polyhedron3d polyhedron(worldBounds);
+                for (const auto& plane : planes) {
+                    polyhedron.clip(plane);
+                }
+                clipVertexCount += polyhedron.vertexCount();
+            }
+        }, "clip " + std::to_string(NumBuilds) + " " + name);
+
+        size_t planeVertexCount = 0u;
+        timeLambda([&]() {
+            std::vector<Polyhedron3d::Face*> faces;
+            for (size_t i = 0; i < NumBuilds; ++i) {
+                Polyhedron3d polyhedron;
+                polyhedron.setPlanes(planes, faces);
+                planeVertexCount += polyhedron.vertexCount();
+            }
+        }, "set planes of " + std::to_string(NumBuilds) + " " + name);
+
+        ASSERT_EQ(clipVertexCount, planeVertexCount);
+    }
+
+    TEST(PolyhedronBenchmark, buildCubeFromPlanes) {
+        benchBuildFromPlanes(Polyhedron3d(vm::bbox3d(-32.0, 32.0)), "cubes");
+    }
+
+    TEST(PolyhedronBenchmark, buildWedgeFromPlanes) {
+        Polyhedron3d wedge(vm::bbox3d(-32.0, 32.0));
+        wedge.clip(vm::plane3d(vm::vec3d::zero, normalize(vm::vec3d(1.0, 0.0, 1.0))));
+        benchBuildFromPlanes(wedge, "wedges");
+    }
+
+    TEST(PolyhedronBenchmark, buildPrismFromPlanes) {
+        benchBuildFromPlanes(makePrism(16), "16 sided prisms");
+    }
+
+    static void benchConvexHull(const std::vector<vm::vec3d>& points, const std::string& name, const size_t maxIncrementalCount) {
+        // adding the points one by one is too slow for large clouds
+        if (points.size() <= maxIncrementalCount) {
+            timeLambda([&]() {
+                Polyhedron3d polyhedron;
+                for (const auto& point : points) {
+                    polyhedron.addPoint(point);
+                }
+            }, "add " + std::to_string(points.size()) + " " + name + " one by one");
+        }
+
+        timeLambda([&]() {
+            Polyhedron3d polyhedron;
+            polyhedron.addPoints(points);
+        }, "add " + std::to_string(points.size()) + " " + name + " at once");
+    }
+
+    TEST(PolyhedronBenchmark, convexHullOfPointClouds) {
+        std::mt19937 random(42);
+        std::uniform_real_distribution<double> coordinate(-1.0, 1.0);
+
+        for (const size_t count : { 1'000u, 10'000u, 100'000u }) {
+            std::vector<vm::vec3d> ballPoints;
+            std::vector<vm::vec3d> spherePoints;
+            while (ballPoints.size() < count) {
+                const auto point = vm::vec3d(coordinate(random), coordinate(random), coordinate(random));
+                const auto length = vm::length(point);
+                if (length <= 1.0 && length > 0.1) {
+                    ballPoints.push_back(4096.0 * point);
+                    spherePoints.push_back(4096.0 * point / length);
+                }
+            }
+
+            benchConvexHull(ballPoints, "points in a ball", 10'000u);
+            benchConvexHull(spherePoints, "points on a sphere", 1'000u);
+        }
+    }
+
+    TEST(PolyhedronBenchmark, traverseElements) {
+        static constexpr size_t NumTraversals = 2'000;
+        const auto polyhedron = makePrism(32);
+
+        double iteratorSum = 0.0;
+        timeLambda([&]() {
+            for (size_t i = 0; i < NumTraversals; ++i) {
+                for (const auto* vertex : polyhedron.vertices()) {
+                    iteratorSum += vertex->position().x();
+                }
+                for (const auto* edge : polyhedron.edges()) {
+                    iteratorSum += edge->firstVertex()->position().y();
+                }
+                for (const auto* face : polyhedron.faces()) {
+                    for (const auto* halfEdge : face->boundary()) {
+                        iteratorSum += halfEdge->origin()->position().z();
+                    }
+                }
+            }
+        }, "traverse " + std::to_string(NumTraversals) + " prisms with iterators");
+
+        double loopSum = 0.0;
+        timeLambda([&]() {
+            for (size_t i = 0; i < NumTraversals; ++i) {
+                const auto* firstVertex = polyhedron.vertices().front();
+                const auto* vertex = firstVertex;
+                do {
+                    loopSum += vertex->position().x();
+                    vertex = vertex->next();
+                } while (vertex != firstVertex);
+
+                const auto* firstEdge = polyhedron.edges().front();
+                const auto* edge = firstEdge;
+                do {
+                    loopSum += edge->firstVertex()->position().y();
+                    edge = edge->next();
+                } while (edge != firstEdge);
+
+                const auto* firstFace = polyhedron.faces().front();
+                const auto* face = firstFace;
+                do {
+                    const auto* firstHalfEdge = face->boundary().front();
+                    const auto* halfEdge = firstHalfEdge;
+                    do {
+                        loopSum += halfEdge->origin()->position().z();
+                        halfEdge = halfEdge->next();
+                    } while (halfEdge != firstHalfEdge);
+                    face = face->next();
+                } while (face != firstFace);
+            }
+        }, "traverse " + std::to_string(NumTraversals) + " prisms with loops");
+
+        ASSERT_DOUBLE_EQ(loopSum, iteratorSum);
+    }
+}
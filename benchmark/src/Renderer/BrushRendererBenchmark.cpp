@@ -19,6 +19,7 @@
 
 #include <gtest/gtest.h>
 
+#include "BenchmarkUtils.h"
 #include "CollectionUtils.h"
 #include "Assets/Texture.h"
 #include "Model/Brush.h"
@@ -26,9 +27,9 @@
 #include "Model/World.h"
 #include "Model/MapFormat.h"
 #include "Renderer/BrushRenderer.h"
+#include "Renderer/BrushRendererBrushCache.h"
 
 #include <vector>
-#include <chrono>
 #include <string>
 #include <iostream>
 #include <tuple>
@@ -79,21 +80,37 @@ namespace TrenchBroom {
             return {result, textures};
         }
 
-#ifdef __GNUC__
-#define TB_NOINLINE __attribute__((noinline))
-#else
-#define TB_NOINLINE
-#endif
-
-        // the noinline is so you can see the timeLambda when profiling
-        template<class L>
-        TB_NOINLINE static void timeLambda(L&& lambda, const std::string& message) {
-            const auto start = std::chrono::high_resolution_clock::now();
-            lambda();
-            const auto end = std::chrono::high_resolution_clock::now();
-
-            printf("Time elapsed for '%s': %fms\n", message.c_str(),
-                   std::chrono::duration<double>(end - start).count() * 1000.0);
+        TEST(BrushRendererBenchmark, benchBrushCache) {
+            auto brushesTextures = makeBrushes();
+            std::vector<Model::Brush*> brushes = brushesTextures.first;
+            std::vector<Assets::Texture*> textures = brushesTextures.second;
+
+            for (auto* brush : brushes) {
+                brush->brushRendererBrushCache().invalidateVertexCache();
+            }
+
+            timeLambda([&](){
+                for (auto* brush : brushes) {
+                    brush->brushRendererBrushCache().validateVertexCache(brush);
+                }
+            }, "build vertex caches of " + std::to_string(brushes.size()) + " brushes");
+
+            size_t vertexCount = 0;
+            size_t memoryUsage = 0;
+            for (auto* brush : brushes) {
+                const auto& cache = brush->brushRendererBrushCache();
+                vertexCount += cache.cachedVertices().size();
+                memoryUsage += cache.memoryUsage();
+            }
+
+            const auto vertexBytes = vertexCount * sizeof(BrushRendererBrushCache::Vertex);
+            const auto unpackedVertexBytes = vertexCount * sizeof(VertexSpecs::P3NT2::Vertex);
+            std::cout << "Vertex size: " << sizeof(BrushRendererBrushCache::Vertex) << " bytes (unpacked: " << sizeof(VertexSpecs::P3NT2::Vertex) << " bytes)" << std::endl;
+            std::cout << "Vertex bytes per brush: " << vertexBytes / brushes.size() << " (unpacked: " << unpackedVertexBytes / brushes.size() << ")" << std::endl;
+            std::cout << "Cache bytes per brush: " << memoryUsage / brushes.size() << std::endl;
+
+            VectorUtils::clearAndDelete(brushes);
+            VectorUtils::clearAndDelete(textures);
         }
 
         TEST(BrushRendererBenchmark, benchBrushRenderer) {
@@ -142,6 +159,45 @@ namespace TrenchBroom {
             VectorUtils::clearAndDelete(brushes);
             VectorUtils::clearAndDelete(textures);
         }
+
+        TEST(BrushRendererBenchmark, benchSingleBrushEdits) {
+            auto brushesTextures = makeBrushes();
+            std::vector<Model::Brush*> brushes = brushesTextures.first;
+            std::vector<Assets::Texture*> textures = brushesTextures.second;
+
+            BrushRenderer r(false);
+            r.addBrushes(brushes);
+            r.validate();
+
+            // Simulates editing one brush at a time, e.g. dragging a vertex
+            static constexpr size_t NumEdits = 1000;
+
+            timeLambda([&](){
+                for (size_t i = 0; i < NumEdits; ++i) {
+                    r.invalidateBrushes({ brushes[i] });
+                    if (!r.valid()) {
+                        r.validate();
+                    }
+                }
+            }, "invalidate and validate one brush " + std::to_string(NumEdits) + " times");
+
+            Model::BrushList brushesMinusOne = brushes;
+            brushesMinusOne.pop_back();
+
+            timeLambda([&](){
+                r.setBrushes(brushesMinusOne);
+                if (!r.valid()) {
+                    r.validate();
+                }
+                r.setBrushes(brushes);
+                if (!r.valid()) {
+                    r.validate();
+                }
+            }, "setBrushes removing and re-adding one of " + std::to_string(brushes.size()) + " brushes");
+
+            VectorUtils::clearAndDelete(brushes);
+            VectorUtils::clearAndDelete(textures);
+        }
     }
 }
 
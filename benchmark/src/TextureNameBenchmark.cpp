@@ -0,0 +1,144 @@
+/*
+ Copyright (C) 2018 Eric Wasylishen
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "BenchmarkUtils.h"
+#include "StringUtils.h"
+#include "Assets/TextureName.h"
+#include "Model/BrushFaceAttributes.h"
+
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace TrenchBroom {
+    // a large map: 150k brushes with six faces each, using a few hundred distinct textures
+    static constexpr size_t NumFaces = 900'000;
+    static constexpr size_t NumTextureNames = 300;
+
+    static std::vector<String> makeTextureNames() {
+        std::vector<String> result;
+        result.reserve(NumTextureNames);
+        for (size_t i = 0; i < NumTextureNames; ++i) {
+            // mix short names (Quake) with longer ones (Quake 2 / Quake 3 style paths)
+            if (i % 2 == 0) {
+                result.push_back("tex_" + std::to_string(i));
+            } else {
+                result.push_back("textures/base_wall/metal_panel_" + std::to_string(i));
+            }
+        }
+        return result;
+    }
+
+    // the number of heap bytes a string allocates in addition to its own size
+    static size_t heapSize(const String& str) {
+        return str.capacity() > String().capacity() ? str.capacity() + 1 : 0;
+    }
+
+    TEST(TextureNameBenchmark, memoryAndComparisons) {
+        const auto names = makeTextureNames();
+
+        std::mt19937 random(1);
+        std::uniform_int_distribution<size_t> pick(0, NumTextureNames - 1);
+
+        std::vector<String> strings;
+        std::vector<Assets::TextureName> interned;
+        strings.reserve(NumFaces);
+        interned.reserve(NumFaces);
+
+        for (size_t i = 0; i < NumFaces; ++i) {
+            const auto& name = names[pick(random)];
+            strings.push_back(name);
+            interned.push_back(Assets::TextureName(name));
+        }
+
+        size_t stringBytes = 0;
+        for (const auto& str : strings) {
+            stringBytes += sizeof(String) + heapSize(str);
+        }
+
+        // every distinct name is stored once in the table, plus its lower case variant and an index entry
+        size_t tableBytes = 0;
+        for (const auto& name : names) {
+            tableBytes += 2 * (sizeof(String) + heapSize(name) + 4 * sizeof(void*));
+        }
+        const auto internedBytes = NumFaces * sizeof(Assets::TextureName) + tableBytes;
+
+        std::printf("Texture names of %zu faces: %.1f MiB as strings, %.1f MiB interned, %.1f MiB saved\n",
+                    NumFaces,
+                    static_cast<double>(stringBytes) / 1024.0 / 1024.0,
+                    static_cast<double>(internedBytes) / 1024.0 / 1024.0,
+                    static_cast<double>(stringBytes - internedBytes) / 1024.0 / 1024.0);
+        std::printf("sizeof(BrushFaceAttributes) is now %zu bytes (%zu bytes with a string member)\n",
+                    sizeof(Model::BrushFaceAttributes),
+                    sizeof(Model::BrushFaceAttributes) - sizeof(Assets::TextureName) + sizeof(String));
+
+        // find all faces with a given texture
+        const auto& queryName = names[NumTextureNames / 2 + 1];
+        const auto queryInterned = Assets::TextureName(queryName);
+        size_t stringMatches = 0;
+        size_t internedMatches = 0;
+
+        timeLambda([&]() {
+            for (const auto& str : strings) {
+                if (str == queryName) {
+                    ++stringMatches;
+                }
+            }
+        }, "find faces by texture name (strings)");
+        timeLambda([&]() {
+            for (const auto& name : interned) {
+                if (name == queryInterned) {
+                    ++internedMatches;
+                }
+            }
+        }, "find faces by texture name (interned)");
+        ASSERT_EQ(stringMatches, internedMatches);
+
+        // resolve the texture of every face, like TextureManager::texture does
+        std::map<String, size_t> byName;
+        std::vector<size_t> byId;
+        for (size_t i = 0; i < NumTextureNames; ++i) {
+            byName[StringUtils::toLower(names[i])] = i;
+
+            const auto id = Assets::TextureName(names[i]).caseInsensitiveId();
+            if (id >= byId.size()) {
+                byId.resize(id + 1);
+            }
+            byId[id] = i;
+        }
+
+        size_t stringSum = 0;
+        size_t internedSum = 0;
+        timeLambda([&]() {
+            for (const auto& str : strings) {
+                stringSum += byName.find(StringUtils::toLower(str))->second;
+            }
+        }, "resolve textures (strings)");
+        timeLambda([&]() {
+            for (const auto& name : interned) {
+                internedSum += byId[name.caseInsensitiveId()];
+            }
+        }, "resolve textures (interned)");
+        ASSERT_EQ(stringSum, internedSum);
+    }
+}
@@ -25,7 +25,7 @@ IF(common_TYPE STREQUAL "SHARED_LIBRARY")
 		TARGET_LINK_LIBRARIES(common asan)
 	ENDIF()
 
-	TARGET_LINK_LIBRARIES(common glew ${wxWidgets_LIBRARIES} ${FREETYPE_LIBRARIES} ${FREEIMAGE_LIBRARIES} vecmath)
+	TARGET_LINK_LIBRARIES(common glew ${wxWidgets_LIBRARIES} ${FREETYPE_LIBRARIES} ${FREEIMAGE_LIBRARIES} vecmath Threads::Threads)
 ENDIF()
 
 INCLUDE_DIRECTORIES(${COMMON_SOURCE_DIR})
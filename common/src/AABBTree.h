@@ -22,17 +22,24 @@
 
 #include "NodeTree.h"
 #include "Exceptions.h"
+#include "ParallelFor.h"
 #include <vecmath/scalar.h>
 #include <vecmath/bbox.h>
 #include <vecmath/ray.h>
 #include <vecmath/intersection.h>
+#include <vecmath/intersection_batch.h>
 
 #include <algorithm>
+#include <array>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <list>
 #include <memory>
+#include <vector>
 
 template <typename T, size_t S, typename U, typename Cmp = std::less<U>>
 class AABBTree : public NodeTree<T,S,U,Cmp> {
@@ -41,7 +48,52 @@ public:
     using Box = typename NodeTree<T,S,U,Cmp>::Box;
     using DataType = typename NodeTree<T,S,U,Cmp>::DataType;
     using FloatType = typename NodeTree<T,S,U,Cmp>::FloatType;
+    using Array = typename NodeTree<T,S,U,Cmp>::Array;
+    using GetBounds = typename NodeTree<T,S,U,Cmp>::GetBounds;
+
+    using Entry = std::pair<Box, U>;
+    using EntryList = std::vector<Entry>;
+
+    struct Update {
+        Box oldBounds;
+        Box newBounds;
+        U data;
+    };
+    using UpdateList = std::vector<Update>;
 private:
+    /**
+     * The number of bins per axis that are evaluated when searching for a split during a bulk build.
+     */
+    static const size_t BuildBinCount = 16;
+
+    /**
+     * During a bulk build, subtrees at this depth or deeper are split at the median instead of using the SAH. This
+     * bounds the height of the tree for degenerate inputs.
+     */
+    static const size_t MaxSAHBuildDepth = 48;
+
+    /**
+     * During a parallel bulk build, subtrees with fewer entries than this are not split into further tasks.
+     */
+    static const size_t MinParallelBuildCount = 4096;
+
+    /**
+     * During a parallel bulk build, the entries are split into up to this many tasks per thread. The SAH splits are
+     * uneven, so more tasks than threads are needed to keep all threads busy.
+     */
+    static const size_t BuildTasksPerThread = 4;
+
+    /**
+     * Batches with fewer updates than this are applied by removing and reinserting each leaf.
+     */
+    static const size_t MinBatchUpdateCount = 16;
+
+    /**
+     * When applying a batch of updates, an inner node whose surface area has grown by more than this factor due to
+     * refitting is rebuilt from its leafs.
+     */
+    static constexpr T MaxRefitAreaGrowth = static_cast<T>(1.5);
+
     class InnerNode;
     class LeafNode;
 
@@ -141,6 +193,32 @@ private:
          */
         virtual std::pair<Node*, bool> remove(const Box& bounds, const U& data) = 0;
 
+        /**
+         * Finds the leaf with the given old bounds and data in this subtree and sets its bounds to the given new
+         * bounds. The inner nodes on the path to the leaf are marked for refitting, but their bounds are not changed,
+         * so that the remaining leafs of a batch can still be found by their old bounds.
+         *
+         * @param oldBounds the current bounds of the leaf
+         * @param newBounds the new bounds of the leaf
+         * @param data the data of the leaf
+         * @return true if the leaf was found and false otherwise
+         */
+        virtual bool moveLeaf(const Box& oldBounds, const Box& newBounds, const U& data) = 0;
+
+        /**
+         * Recomputes the bounds of the inner nodes in this subtree that were marked for refitting, bottom-up.
+         */
+        virtual void refitBounds() = 0;
+
+        /**
+         * Rebuilds the subtrees of the marked inner nodes whose bounds have grown too much during refitting, top-down,
+         * and clears the marks. Returns the new root of this subtree; if it differs from this node, the caller must
+         * delete this node.
+         *
+         * @return the new root of this subtree
+         */
+        virtual Node* restructure() = 0;
+
         /**
          * Accepts the given visitor.
          *
@@ -195,12 +273,21 @@ private:
         Node* m_left;
         Node* m_right;
         size_t m_height;
+
+        /**
+         * The surface area of this node's bounds when it was created or last changed by an insertion or removal.
+         * Refitting does not change this value.
+         */
+        T m_baseArea;
+        bool m_needsRefit;
     public:
         InnerNode(Node* left, Node* right) :
         Node(merge(left->bounds(), right->bounds())),
         m_left(left),
         m_right(right),
-        m_height(0) {
+        m_height(0),
+        m_baseArea(surfaceArea(this->bounds())),
+        m_needsRefit(false) {
             assert(m_left != nullptr);
             assert(m_right != nullptr);
             updateHeight();
@@ -211,6 +298,24 @@ private:
             delete m_right;
         }
 
+        /**
+         * Returns the left child of this node.
+         *
+         * @return the left child
+         */
+        const Node* left() const {
+            return m_left;
+        }
+
+        /**
+         * Returns the right child of this node.
+         *
+         * @return the right child
+         */
+        const Node* right() const {
+            return m_right;
+        }
+
         bool leaf() const override {
             return false;
         }
@@ -251,6 +356,65 @@ private:
                 return doRemove(bounds, data, m_right, m_left);
             }
         }
+
+        bool moveLeaf(const Box& oldBounds, const Box& newBounds, const U& data) override {
+            if (this->bounds().contains(oldBounds) &&
+                (m_left->moveLeaf(oldBounds, newBounds, data) || m_right->moveLeaf(oldBounds, newBounds, data))) {
+                m_needsRefit = true;
+                return true;
+            }
+            return false;
+        }
+
+        void refitBounds() override {
+            if (m_needsRefit) {
+                m_left->refitBounds();
+                m_right->refitBounds();
+                this->setBounds(merge(m_left->bounds(), m_right->bounds()));
+            }
+        }
+
+        Node* restructure() override {
+            if (!m_needsRefit) {
+                return this;
+            }
+
+            m_needsRefit = false;
+            if (surfaceArea(this->bounds()) > MaxRefitAreaGrowth * m_baseArea) {
+                return rebuild();
+            }
+
+            restructureChild(m_left);
+            restructureChild(m_right);
+            updateHeight();
+            return this;
+        }
+    private:
+        static void restructureChild(Node*& child) {
+            auto* newChild = child->restructure();
+            if (newChild != child) {
+                delete child;
+                child = newChild;
+            }
+        }
+
+        /**
+         * Builds a new subtree from the leafs of this node's subtree.
+         *
+         * @return the root of the new subtree
+         */
+        Node* rebuild() const {
+            std::vector<BuildEntry> entries;
+            LambdaVisitor visitor(
+                    [](const InnerNode*) { return true; },
+                    [&](const LeafNode* leaf) {
+                        entries.push_back(BuildEntry{ leaf->bounds(), leaf->bounds().center(), leaf->data() });
+                    }
+            );
+            accept(visitor);
+
+            return build(std::begin(entries), std::end(entries), 0, 1);
+        }
     private:
         /**
          * Attempt to remove the node with the given bounds and data from the given child.
@@ -334,6 +498,7 @@ private:
 
         void updateBounds() {
             this->setBounds(merge(m_left->bounds(), m_right->bounds()));
+            m_baseArea = surfaceArea(this->bounds());
         }
 
         void updateHeight() {
@@ -432,6 +597,21 @@ private:
             }
         }
 
+        bool moveLeaf(const Box& oldBounds, const Box& newBounds, const U& data) override {
+            if (this->hasBounds(oldBounds) && hasData(data)) {
+                this->setBounds(newBounds);
+                return true;
+            } else {
+                return false;
+            }
+        }
+
+        void refitBounds() override {}
+
+        Node* restructure() override {
+            return this;
+        }
+
         /**
          * Checks whether the given data equals the data of this leaf. The given data is considered
          * equal to this node's data if and only if !(data < m_data) && !(m_data < data) where < is
@@ -458,6 +638,216 @@ private:
             str << ": " << m_data << std::endl;
         }
     };
+public:
+    /**
+     * A read-only, flattened copy of an AABB tree that is optimized for queries.
+     *
+     * The binary tree is collapsed into a tree where every node has up to four children, and the nodes are stored in
+     * a contiguous array. The bounds of the children of a node are stored together as floats in structure of arrays
+     * layout, so that a query can test all of them at once using SIMD instructions, see vm::intersectMask and
+     * vm::containsMask. The tree is traversed with a loop and an explicit stack, without recursion or virtual calls.
+     *
+     * Since the float bounds are only conservative, the exact bounds of the leafs are stored separately and tested
+     * before a leaf is reported. The leafs are reported in the same order as by the tree.
+     *
+     * A snapshot does not observe the tree it was created from and must be recreated whenever the tree changes.
+     */
+    class Snapshot {
+    private:
+        static_assert(S == 3, "snapshots are only supported for three dimensional trees");
+
+        static constexpr uint32_t LeafFlag = 0x80000000u;
+
+        /**
+         * The float bounds are padded by this amount so that the tests in single precision do not miss boxes that
+         * are hit when testing in double precision.
+         */
+        static constexpr float BoundsPadding = 1.0f / 16.0f;
+
+        /**
+         * The traversal stack lives on the call stack if the snapshot is at most this deep, which covers all but
+         * degenerate trees. Every level of a snapshot adds at most three siblings to the stack.
+         */
+        static constexpr size_t MaxLocalStackDepth = 64u;
+        static constexpr size_t LocalStackSize = 3u * MaxLocalStackDepth + 1u;
+
+        struct WideNode {
+            vm::bbox4f bounds;
+            uint32_t children[4]; // the index of a node, or the index of a leaf with LeafFlag set
+            uint32_t childCount;
+        };
+
+        std::vector<WideNode> m_nodes;
+        std::vector<Box> m_leafBounds;
+        std::vector<U> m_leafData;
+        size_t m_maxStackSize; // the largest number of entries on the traversal stack, recorded when adding nodes
+    public:
+        Snapshot() : m_maxStackSize(0) {}
+
+        /**
+         * Creates a snapshot of the given tree.
+         *
+         * @param tree the tree to flatten
+         */
+        explicit Snapshot(const AABBTree& tree) : m_maxStackSize(0) {
+            if (!tree.empty()) {
+                addNode(tree.m_root, 1);
+            }
+        }
+
+        bool empty() const {
+            return m_nodes.empty();
+        }
+
+        /**
+         * Finds every data item in this snapshot whose bounding box intersects with the given ray and appends it to
+         * the given output iterator.
+         *
+         * @tparam O the type of the output iterator
+         * @param ray the ray to test
+         * @param out the output iterator to append to
+         */
+        template <typename O>
+        void findIntersectors(const vm::ray<T,S>& ray, O out) const {
+            const vm::box_query_ray query(ray);
+            traverse(
+                [&](const WideNode& node) { return vm::intersectMask(query, node.bounds); },
+                [&](const Box& bounds) { return bounds.contains(ray.origin) || !vm::isnan(intersect(ray, bounds)); },
+                out);
+        }
+
+        /**
+         * Finds every data item in this snapshot whose bounding box contains the given point and appends it to the
+         * given output iterator.
+         *
+         * @tparam O the type of the output iterator
+         * @param point the point to test
+         * @param out the output iterator to append to
+         */
+        template <typename O>
+        void findContainers(const vm::vec<T,S>& point, O out) const {
+            const auto pointf = vm::vec<float,S>(point);
+            traverse(
+                [&](const WideNode& node) { return vm::containsMask(pointf, node.bounds); },
+                [&](const Box& bounds) { return bounds.contains(point); },
+                out);
+        }
+    private:
+        template <typename TestNode, typename TestLeaf, typename O>
+        void traverse(const TestNode& testNode, const TestLeaf& testLeaf, O out) const {
+            if (empty()) {
+                return;
+            }
+
+            uint32_t localStack[LocalStackSize];
+            std::vector<uint32_t> heapStack;
+
+            auto* stack = localStack;
+            if (m_maxStackSize > LocalStackSize) {
+                heapStack.resize(m_maxStackSize);
+                stack = heapStack.data();
+            }
+
+            size_t stackSize = 0u;
+            stack[stackSize++] = 0u;
+
+            while (stackSize > 0u) {
+                const auto current = stack[--stackSize];
+
+                if ((current & LeafFlag) != 0u) {
+                    const auto leaf = current & ~LeafFlag;
+                    if (testLeaf(m_leafBounds[leaf])) {
+                        out = m_leafData[leaf];
+                        ++out;
+                    }
+                } else {
+                    const auto& node = m_nodes[current];
+                    const auto mask = testNode(node);
+
+                    // push the children in reverse order so that they are visited from left to right
+                    for (uint32_t i = node.childCount; i > 0u; --i) {
+                        if ((mask & (1u << (i - 1u))) != 0u) {
+                            assert(stackSize < m_maxStackSize);
+                            stack[stackSize++] = node.children[i - 1u];
+                        }
+                    }
+                }
+            }
+        }
+
+        uint32_t addNode(const Node* node, const size_t depth) {
+            // Collect up to four children by repeatedly replacing the inner child with the largest surface area by
+            // its own children. The order of the children is preserved.
+            std::vector<const Node*> children;
+            if (node->leaf()) {
+                children.push_back(node);
+            } else {
+                const auto* innerNode = static_cast<const InnerNode*>(node);
+                children = { innerNode->left(), innerNode->right() };
+                while (children.size() < 4u) {
+                    auto largest = std::end(children);
+                    for (auto it = std::begin(children); it != std::end(children); ++it) {
+                        if (!(*it)->leaf() && (largest == std::end(children) || surfaceArea((*it)->bounds()) > surfaceArea((*largest)->bounds()))) {
+                            largest = it;
+                        }
+                    }
+
+                    if (largest == std::end(children)) {
+                        break;
+                    }
+
+                    const auto* open = static_cast<const InnerNode*>(*largest);
+                    *largest = open->left();
+                    children.insert(std::next(largest), open->right());
+                }
+            }
+
+            const auto index = static_cast<uint32_t>(m_nodes.size());
+            m_nodes.push_back(WideNode());
+            m_nodes[index].childCount = static_cast<uint32_t>(children.size());
+            m_maxStackSize = std::max(m_maxStackSize, 3u * depth + 1u);
+
+            for (size_t i = 0; i < 4u; ++i) {
+                for (size_t a = 0; a < S; ++a) {
+                    if (i < children.size()) {
+                        m_nodes[index].bounds.min[a][i] = roundDown(children[i]->bounds().min[a]) - BoundsPadding;
+                        m_nodes[index].bounds.max[a][i] = roundUp(children[i]->bounds().max[a]) + BoundsPadding;
+                    } else {
+                        m_nodes[index].bounds.min[a][i] = 0.0f;
+                        m_nodes[index].bounds.max[a][i] = 0.0f;
+                    }
+                }
+            }
+
+            for (size_t i = 0; i < children.size(); ++i) {
+                uint32_t child;
+                if (children[i]->leaf()) {
+                    const auto* leaf = static_cast<const LeafNode*>(children[i]);
+                    child = static_cast<uint32_t>(m_leafData.size()) | LeafFlag;
+                    m_leafBounds.push_back(leaf->bounds());
+                    m_leafData.push_back(leaf->data());
+                } else {
+                    child = addNode(children[i], depth + 1);
+                }
+                m_nodes[index].children[i] = child;
+            }
+            for (size_t i = children.size(); i < 4u; ++i) {
+                m_nodes[index].children[i] = 0u;
+            }
+
+            return index;
+        }
+
+        static float roundDown(const T v) {
+            const auto result = static_cast<float>(v);
+            return static_cast<T>(result) > v ? std::nextafter(result, -std::numeric_limits<float>::max()) : result;
+        }
+
+        static float roundUp(const T v) {
+            const auto result = static_cast<float>(v);
+            return static_cast<T>(result) < v ? std::nextafter(result, std::numeric_limits<float>::max()) : result;
+        }
+    };
 private:
     Node* m_root;
 public:
@@ -498,6 +888,48 @@ public:
         return false;
     }
 
+    void clearAndBuild(const List& objects, const GetBounds& getBounds) override {
+        clearAndBuild(makeEntries(objects, getBounds));
+    }
+
+    void clearAndBuild(const Array& objects, const GetBounds& getBounds) override {
+        clearAndBuild(makeEntries(objects, getBounds));
+    }
+
+    /**
+     * Clears this tree and builds a new tree containing the given entries.
+     *
+     * The tree is built top-down. Each set of entries is split into two subsets along the axis and at the position
+     * where the surface area heuristic (SAH) is minimal. To find the split, the centers of the entries' bounds are
+     * sorted into a fixed number of bins per axis, and only the bin boundaries are considered as split positions.
+     * This yields trees that are much better suited for queries than trees built by repeated insertion, and the
+     * result does not depend on the order of the given entries.
+     *
+     * If the given thread count is greater than 1, the top levels of the tree are split on the calling thread until
+     * there are enough subtrees to keep the threads busy, and these subtrees are then built using parallelFor. No
+     * threads are started besides parallelFor's shared worker threads.
+     *
+     * @param entries the entries to insert, each consisting of bounds and data
+     * @param threadCount the maximum number of threads to use
+     *
+     * @throws NodeTreeException if the bounds of any entry are invalid
+     */
+    void clearAndBuild(const EntryList& entries, const size_t threadCount = 1) {
+        clear();
+        if (entries.empty()) {
+            return;
+        }
+
+        std::vector<BuildEntry> buildEntries;
+        buildEntries.reserve(entries.size());
+        for (const auto& entry : entries) {
+            check(entry.first, entry.second);
+            buildEntries.push_back(BuildEntry{ entry.first, entry.first.center(), entry.second });
+        }
+
+        m_root = build(std::begin(buildEntries), std::end(buildEntries), 0, threadCount);
+    }
+
     void update(const Box& oldBounds, const Box& newBounds, const U& data) override {
         check(oldBounds, data);
         check(newBounds, data);
@@ -509,7 +941,303 @@ public:
         }
         insert(newBounds, data);
     }
+
+    /**
+     * Updates the bounds of many data items at once.
+     *
+     * Instead of removing and reinserting every leaf, the leafs are found by their old bounds and assigned their new
+     * bounds in place. Then the bounds of their ancestors are refitted bottom-up in a single pass. Refitting keeps
+     * the structure of the tree, so its quality degrades if the leafs move far. Therefore, every refitted subtree
+     * whose surface area has grown by more than a fixed factor is rebuilt from its leafs using the
+     * surface area heuristic. Subtrees that were translated as a whole keep their structure.
+     *
+     * Small batches are applied by calling update for each item.
+     *
+     * Each data item must occur at most once in the given list.
+     *
+     * @param updates the updates to apply, each consisting of the old bounds, the new bounds, and the data
+     *
+     * @throws NodeTreeException if any bounds are invalid or if no leaf with the old bounds and data of an update
+     * exists; the updates preceding the failed one remain applied
+     */
+    void update(const UpdateList& updates) {
+        if (updates.size() < MinBatchUpdateCount) {
+            for (const auto& update : updates) {
+                this->update(update.oldBounds, update.newBounds, update.data);
+            }
+            return;
+        }
+
+        for (const auto& update : updates) {
+            check(update.oldBounds, update.data);
+            check(update.newBounds, update.data);
+        }
+
+        for (const auto& update : updates) {
+            if (empty() || !m_root->moveLeaf(update.oldBounds, update.newBounds, update.data)) {
+                refit();
+
+                NodeTreeException ex;
+                ex << "AABB node not found with oldBounds [ ( " << update.oldBounds.min << " ) ( " << update.oldBounds.max << " ) ]: " << update.data;
+                throw ex;
+            }
+        }
+
+        refit();
+    }
 private:
+    void refit() {
+        if (!empty()) {
+            m_root->refitBounds();
+
+            auto* newRoot = m_root->restructure();
+            if (newRoot != m_root) {
+                delete m_root;
+                m_root = newRoot;
+            }
+        }
+    }
+
+    struct BuildEntry {
+        Box bounds;
+        vm::vec<T,S> center;
+        U data;
+    };
+    using BuildIterator = typename std::vector<BuildEntry>::iterator;
+
+    template <typename C>
+    static EntryList makeEntries(const C& objects, const GetBounds& getBounds) {
+        EntryList entries;
+        entries.reserve(objects.size());
+        for (const auto& object : objects) {
+            entries.emplace_back(getBounds(object), object);
+        }
+        return entries;
+    }
+
+    /**
+     * A subtree that is built by one of the threads during a parallel bulk build.
+     */
+    struct BuildTask {
+        BuildIterator first;
+        BuildIterator last;
+        size_t depth;
+        Node* node;
+    };
+
+    /**
+     * Builds a subtree containing the entries in the given range, using up to the given number of threads.
+     *
+     * @param first the first entry
+     * @param last the end of the range of entries
+     * @param depth the depth of the subtree to build
+     * @param threadCount the maximum number of threads to use
+     * @return the root of the subtree
+     */
+    static Node* build(BuildIterator first, BuildIterator last, const size_t depth, const size_t threadCount) {
+        if (threadCount <= 1 || static_cast<size_t>(std::distance(first, last)) < MinParallelBuildCount) {
+            return build(first, last, depth);
+        }
+
+        // the top levels of the tree, in preorder: true for an inner node, false for the root of a task's subtree
+        // more threads than the hardware provides would only grow parallelFor's shared worker pool
+        const auto usedThreadCount = std::min(threadCount, TrenchBroom::defaultThreadCount());
+
+        std::vector<bool> shape;
+        std::vector<BuildTask> tasks;
+        splitTasks(first, last, depth, usedThreadCount * BuildTasksPerThread, shape, tasks);
+
+        try {
+            TrenchBroom::parallelFor(tasks.size(), [&](const size_t i) {
+                auto& task = tasks[i];
+                task.node = build(task.first, task.last, task.depth);
+            }, usedThreadCount, 1);
+        } catch (...) {
+            for (auto& task : tasks) {
+                delete task.node;
+            }
+            throw;
+        }
+
+        size_t nextShape = 0;
+        size_t nextTask = 0;
+        return assembleTasks(shape, nextShape, tasks, nextTask);
+    }
+
+    /**
+     * Builds a subtree containing the entries in the given range on the calling thread.
+     *
+     * @param first the first entry
+     * @param last the end of the range of entries
+     * @param depth the depth of the subtree to build
+     * @return the root of the subtree
+     */
+    static Node* build(BuildIterator first, BuildIterator last, const size_t depth) {
+        const auto count = static_cast<size_t>(std::distance(first, last));
+        assert(count > 0);
+
+        if (count == 1) {
+            return new LeafNode(first->bounds, first->data);
+        }
+
+        const auto mid = split(first, last, depth);
+
+        auto* left = build(first, mid, depth + 1);
+        Node* right = nullptr;
+        try {
+            right = build(mid, last, depth + 1);
+        } catch (...) {
+            delete left;
+            throw;
+        }
+
+        return new InnerNode(left, right);
+    }
+
+    /**
+     * Splits the entries in the given range the same way as build does until there are the given number of
+     * subranges or until the subranges are too small, and adds a task for each of the subranges.
+     */
+    static void splitTasks(BuildIterator first, BuildIterator last, const size_t depth, const size_t taskCount, std::vector<bool>& shape, std::vector<BuildTask>& tasks) {
+        const auto count = static_cast<size_t>(std::distance(first, last));
+        if (taskCount <= 1 || count < MinParallelBuildCount) {
+            shape.push_back(false);
+            tasks.push_back(BuildTask{ first, last, depth, nullptr });
+        } else {
+            shape.push_back(true);
+            const auto mid = split(first, last, depth);
+            splitTasks(first, mid, depth + 1, taskCount / 2, shape, tasks);
+            splitTasks(mid, last, depth + 1, taskCount - taskCount / 2, shape, tasks);
+        }
+    }
+
+    /**
+     * Creates the inner nodes above the subtrees built by the tasks, as recorded in the given shape.
+     */
+    static Node* assembleTasks(const std::vector<bool>& shape, size_t& nextShape, const std::vector<BuildTask>& tasks, size_t& nextTask) {
+        if (!shape[nextShape++]) {
+            return tasks[nextTask++].node;
+        } else {
+            auto* left = assembleTasks(shape, nextShape, tasks, nextTask);
+            auto* right = assembleTasks(shape, nextShape, tasks, nextTask);
+            return new InnerNode(left, right);
+        }
+    }
+
+    /**
+     * Partitions the entries in the given range into two non-empty subranges and returns the beginning of the second
+     * subrange.
+     *
+     * @param first the first entry
+     * @param last the end of the range of entries
+     * @param depth the depth of the subtree that is being built
+     * @return the beginning of the second subrange
+     */
+    static BuildIterator split(BuildIterator first, BuildIterator last, const size_t depth) {
+        Box centerBounds(first->center, first->center);
+        for (auto it = std::next(first); it != last; ++it) {
+            centerBounds = merge(centerBounds, it->center);
+        }
+
+        const auto centerSize = centerBounds.size();
+        if (depth < MaxSAHBuildDepth) {
+            auto bestCost = std::numeric_limits<T>::max();
+            auto bestAxis = S;
+            auto bestBin = size_t(0);
+
+            for (size_t axis = 0; axis < S; ++axis) {
+                if (centerSize[axis] <= static_cast<T>(0.0)) {
+                    continue;
+                }
+
+                std::array<size_t, BuildBinCount> binCounts;
+                std::array<Box, BuildBinCount> binBounds;
+                binCounts.fill(0u);
+
+                for (auto it = first; it != last; ++it) {
+                    const auto bin = binIndex(*it, centerBounds, axis);
+                    binBounds[bin] = binCounts[bin] == 0u ? it->bounds : merge(binBounds[bin], it->bounds);
+                    ++binCounts[bin];
+                }
+
+                // rightCosts[i] holds the cost of the bins i+1 ... BuildBinCount-1
+                std::array<T, BuildBinCount> rightCosts;
+                auto rightCount = size_t(0);
+                auto rightBounds = Box();
+                for (size_t i = BuildBinCount - 1; i > 0; --i) {
+                    if (binCounts[i] > 0u) {
+                        rightBounds = rightCount == 0u ? binBounds[i] : merge(rightBounds, binBounds[i]);
+                        rightCount += binCounts[i];
+                    }
+                    rightCosts[i - 1] = rightCount == 0u ? static_cast<T>(0.0) : surfaceArea(rightBounds) * static_cast<T>(rightCount);
+                }
+
+                auto leftCount = size_t(0);
+                auto leftBounds = Box();
+                for (size_t i = 0; i < BuildBinCount - 1; ++i) {
+                    if (binCounts[i] > 0u) {
+                        leftBounds = leftCount == 0u ? binBounds[i] : merge(leftBounds, binBounds[i]);
+                        leftCount += binCounts[i];
+                    }
+
+                    if (leftCount > 0u && leftCount < static_cast<size_t>(std::distance(first, last))) {
+                        const auto cost = surfaceArea(leftBounds) * static_cast<T>(leftCount) + rightCosts[i];
+                        if (cost < bestCost) {
+                            bestCost = cost;
+                            bestAxis = axis;
+                            bestBin = i;
+                        }
+                    }
+                }
+            }
+
+            if (bestAxis < S) {
+                return std::partition(first, last, [&](const BuildEntry& entry) {
+                    return binIndex(entry, centerBounds, bestAxis) <= bestBin;
+                });
+            }
+        }
+
+        // All centers coincide or the tree is getting too deep, split at the median of the longest axis.
+        auto axis = size_t(0);
+        for (size_t i = 1; i < S; ++i) {
+            if (centerSize[i] > centerSize[axis]) {
+                axis = i;
+            }
+        }
+
+        const auto mid = std::next(first, std::distance(first, last) / 2);
+        std::nth_element(first, mid, last, [&](const BuildEntry& lhs, const BuildEntry& rhs) {
+            return lhs.center[axis] < rhs.center[axis];
+        });
+        return mid;
+    }
+
+    static size_t binIndex(const BuildEntry& entry, const Box& centerBounds, const size_t axis) {
+        const auto offset = entry.center[axis] - centerBounds.min[axis];
+        const auto extent = centerBounds.max[axis] - centerBounds.min[axis];
+        const auto bin = static_cast<size_t>(offset / extent * static_cast<T>(BuildBinCount));
+        return std::min(bin, BuildBinCount - 1);
+    }
+
+    /**
+     * Computes half of the surface area of the given box, which is sufficient to compare the costs of splits.
+     */
+    static T surfaceArea(const Box& box) {
+        const auto size = box.size();
+        if constexpr (S == 1) {
+            return size[0];
+        } else {
+            auto result = static_cast<T>(0.0);
+            for (size_t i = 0; i < S; ++i) {
+                for (size_t j = i + 1; j < S; ++j) {
+                    result += size[i] * size[j];
+                }
+            }
+            return result;
+        }
+    }
+
     void check(const Box& bounds, const U& data) const {
         if (vm::isNaN(bounds.min) || vm::isNaN(bounds.max)) {
             NodeTreeException ex;
@@ -544,10 +1272,41 @@ public:
         return empty() ? 0 : m_root->height();
     }
 
+    /**
+     * Computes the surface area heuristic (SAH) cost of this tree. The cost estimates the expected number of nodes
+     * that a query with a random ray must visit, so smaller values indicate a better tree.
+     *
+     * @return the SAH cost of this tree, or 0 if this tree is empty
+     */
+    T sahCost() const {
+        if (empty()) {
+            return static_cast<T>(0.0);
+        }
+
+        const auto rootArea = surfaceArea(m_root->bounds());
+        if (rootArea <= static_cast<T>(0.0)) {
+            return static_cast<T>(0.0);
+        }
+
+        auto totalArea = static_cast<T>(0.0);
+        LambdaVisitor visitor(
+                [&](const InnerNode* innerNode) {
+                    totalArea += surfaceArea(innerNode->bounds());
+                    return true;
+                },
+                [&](const LeafNode* leaf) {
+                    totalArea += surfaceArea(leaf->bounds());
+                }
+        );
+        m_root->accept(visitor);
+
+        return totalArea / rootArea;
+    }
+
     List findIntersectors(const vm::ray<T,S>& ray) const override {
         List result;
         findIntersectors(ray, std::back_inserter(result));
-        return std::move(result);
+        return result;
     }
 
     /**
@@ -577,10 +1336,36 @@ public:
         }
     }
 
+    /**
+     * Finds every data item in this tree whose bounding box intersects with the given bounding box and appends it
+     * to the given output iterator. Boxes that only touch the given box are considered intersecting.
+     *
+     * @tparam O the output iterator type
+     * @param bounds the bounding box to test
+     * @param out the output iterator to append to
+     */
+    template <typename O>
+    void findIntersectors(const Box& bounds, O out) const {
+        if (!empty()) {
+            LambdaVisitor visitor(
+                    [&](const InnerNode* innerNode) {
+                        return innerNode->bounds().intersects(bounds);
+                    },
+                    [&](const LeafNode* leaf) {
+                        if (leaf->bounds().intersects(bounds)) {
+                            out = leaf->data();
+                            ++out;
+                        }
+                    }
+            );
+            m_root->accept(visitor);
+        }
+    }
+
      List findContainers(const vm::vec<T,S>& point) const override {
          List result;
          findContainers(point, std::back_inserter(result));
-         return std::move(result);
+         return result;
      }
 
     /**
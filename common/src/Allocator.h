@@ -1,18 +1,18 @@
 /*
  Copyright (C) 2010-2017 Kristian Duske
- 
+
  This file is part of TrenchBroom.
- 
+
  TrenchBroom is free software: you can redistribute it and/or modify
  it under the terms of the GNU General Public License as published by
  the Free Software Foundation, either version 3 of the License, or
  (at your option) any later version.
- 
+
  TrenchBroom is distributed in the hope that it will be useful,
  but WITHOUT ANY WARRANTY; without even the implied warranty of
  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
  GNU General Public License for more details.
- 
+
  You should have received a copy of the GNU General Public License
  along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
  */
@@ -20,183 +20,515 @@
 #ifndef TrenchBroom_Allocator_h
 #define TrenchBroom_Allocator_h
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
 #include <limits>
-#include <stack>
+#include <mutex>
+#include <new>
+#include <thread>
 #include <vector>
 
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
 // Undefine this to prevent false positives when looking for memory leaks.
 #define TB_ENABLE_ALLOCATOR 1
 
-template <class T, size_t PoolSize = 64, size_t BlocksPerChunk = 256>
+class AllocatorArena;
+
+/**
+ * The memory of arenas and of the chunks of Allocator consists of pages that are aligned to their size. Every
+ * page starts with a header that points to the arena it belongs to, or nullptr if it is a chunk. This way,
+ * operator delete finds out where an object came from by rounding its address down to the start of its page,
+ * and nothing needs to be stored with the object itself.
+ */
+class AllocatorPage {
+public:
+    static constexpr size_t Size = 4096;
+    // the offset of the first object in a page, so that objects that follow the header need no padding
+    static constexpr size_t HeaderSize = alignof(std::max_align_t);
+
+    AllocatorArena* const arena;
+
+    explicit AllocatorPage(AllocatorArena* i_arena) :
+    arena(i_arena) {}
+
+    /**
+     * Returns the page that contains the given block, which must have been allocated from an arena or a chunk.
+     */
+    static const AllocatorPage* of(const void* block) {
+        const auto address = reinterpret_cast<uintptr_t>(block);
+        return reinterpret_cast<const AllocatorPage*>(address - address % Size);
+    }
+
+    /**
+     * Allocates the given number of bytes starting at a page boundary. The memory must be freed by calling free.
+     */
+    static void* allocate(const size_t size) {
+#ifdef _WIN32
+        void* memory = _aligned_malloc(size, Size);
+#else
+        void* memory = nullptr;
+        if (posix_memalign(&memory, Size, size) != 0) {
+            memory = nullptr;
+        }
+#endif
+        if (memory == nullptr) {
+            throw std::bad_alloc();
+        }
+        return memory;
+    }
+
+    static void free(void* memory) {
+#ifdef _WIN32
+        _aligned_free(memory);
+#else
+        std::free(memory);
+#endif
+    }
+};
+
+/**
+ * A contiguous block of memory from which objects of classes deriving from Allocator can be allocated. An
+ * arena hands out memory by bumping a pointer and never reuses it. It counts the objects that are currently
+ * allocated from it and frees itself, together with its memory, when the last of these objects is deleted.
+ *
+ * This is useful for structures whose size is known up front and whose elements are usually deleted
+ * together, e.g. a copy of a polyhedron. Only the thread that created an arena may allocate from it, but its
+ * objects may be deleted on any thread, e.g. when a polyhedron that was copied on a worker thread is deleted
+ * on the main thread.
+ */
+class AllocatorArena {
+private:
+    unsigned char* m_memory;
+    unsigned char* m_current;
+    unsigned char* m_end;
+    std::atomic<size_t> m_objectCount;
+    std::thread::id m_owner;
+
+    static bool& enabledFlag() {
+        static bool enabled = true;
+        return enabled;
+    }
+public:
+    /**
+     * Creates an arena that can hold objects with the given total size in bytes, provided that none of them
+     * is larger than maxBlockSize and that they need no alignment padding. The arena and its memory are
+     * allocated with a single allocation.
+     *
+     * Returns nullptr if the capacity is 0 or if arenas are disabled. In that case, callers should fall
+     * back to the regular allocator.
+     *
+     * @param capacity the total size of the objects in bytes
+     * @param maxBlockSize the size of the largest object in bytes
+     * @return the arena or nullptr
+     */
+    static AllocatorArena* create(const size_t capacity, const size_t maxBlockSize) {
+#ifdef TB_ENABLE_ALLOCATOR
+        if (capacity == 0 || !enabled()) {
+            return nullptr;
+        }
+
+        assert(firstHeaderSize() + maxBlockSize <= AllocatorPage::Size);
+
+        // An object that does not fit into the rest of a page is moved to the next page, so every page but the
+        // last one may waste up to maxBlockSize bytes.
+        size_t pageCount = 1;
+        size_t size = firstHeaderSize() + capacity;
+        while (size > pageCount * AllocatorPage::Size) {
+            ++pageCount;
+            size += AllocatorPage::HeaderSize + maxBlockSize;
+        }
+
+        auto* memory = static_cast<unsigned char*>(AllocatorPage::allocate(size));
+        auto* arena = new (memory + AllocatorPage::HeaderSize) AllocatorArena(memory, size);
+        for (size_t i = 0; i < pageCount; ++i) {
+            new (memory + i * AllocatorPage::Size) AllocatorPage(arena);
+        }
+        return arena;
+#else
+        return nullptr;
+#endif
+    }
+
+    /**
+     * Indicates whether create returns arenas. This can be switched off to compare the performance of the
+     * regular allocator with the arenas.
+     */
+    static bool enabled() {
+        return enabledFlag();
+    }
+
+    static void setEnabled(const bool enabled) {
+        enabledFlag() = enabled;
+    }
+private:
+    AllocatorArena(unsigned char* memory, const size_t size) :
+    m_memory(memory),
+    m_current(memory + firstHeaderSize()),
+    m_end(memory + size),
+    m_objectCount(0),
+    m_owner(std::this_thread::get_id()) {}
+
+    // the first page holds the arena itself after the page header
+    static constexpr size_t firstHeaderSize() {
+        return alignUp(AllocatorPage::HeaderSize + sizeof(AllocatorArena), AllocatorPage::HeaderSize);
+    }
+
+    static constexpr uintptr_t alignUp(const uintptr_t address, const size_t alignment) {
+        return (address + alignment - 1) / alignment * alignment;
+    }
+public:
+    /**
+     * Allocates a block of the given size and alignment, or returns nullptr if the arena is exhausted. Every
+     * block returned by this function must be released by calling release. Must be called on the thread that
+     * created this arena.
+     */
+    void* allocate(const size_t size, const size_t alignment) {
+        assert(std::this_thread::get_id() == m_owner);
+        assert(AllocatorPage::HeaderSize + size <= AllocatorPage::Size);
+        assert(alignment <= AllocatorPage::HeaderSize);
+
+        const auto current = reinterpret_cast<uintptr_t>(m_current);
+        auto address = alignUp(current, alignment);
+        const auto pageOffset = address % AllocatorPage::Size;
+        if (pageOffset < AllocatorPage::HeaderSize) {
+            // the previous block ended exactly at a page boundary
+            address += AllocatorPage::HeaderSize - pageOffset;
+        } else if (pageOffset + size > AllocatorPage::Size) {
+            // blocks must not overlap the header of the next page
+            address += AllocatorPage::Size - pageOffset + AllocatorPage::HeaderSize;
+        }
+
+        const auto end = reinterpret_cast<uintptr_t>(m_end);
+        if (address > end || end - address < size) {
+            return nullptr;
+        }
+
+        unsigned char* block = m_current + (address - current);
+        m_current = block + size;
+        ++m_objectCount;
+        return block;
+    }
+
+    /**
+     * Releases a block previously returned by allocate. Destroys this arena if it was the last block. This may
+     * be called on any thread.
+     */
+    void release() {
+        assert(m_objectCount > 0);
+        if (--m_objectCount == 0) {
+            unsigned char* memory = m_memory;
+            this->~AllocatorArena();
+            AllocatorPage::free(memory);
+        }
+    }
+};
+
+/**
+ * Provides class specific operator new and delete that allocate objects of type T from a pool of
+ * preallocated chunks, or from an AllocatorArena using placement syntax, i.e. new (arena) T(...).
+ *
+ * Every chunk occupies one AllocatorPage, so operator delete finds the chunk or arena that an object was
+ * allocated from without storing anything with the object.
+ */
+template <class T, size_t PoolSize = 64>
 class Allocator {
 private:
     class Chunk {
     private:
-        unsigned char m_blocks[BlocksPerChunk * sizeof(T)];
+        // the offset of the first block, which follows the page header and the free list
+        static constexpr size_t BlocksOffset = (AllocatorPage::HeaderSize + 2 + alignof(T) - 1) / alignof(T) * alignof(T);
+        // the free list stores the index of the next free block in the first byte of every free block
+        static constexpr size_t BlocksPerChunk = std::min(size_t(std::numeric_limits<unsigned char>::max()), (AllocatorPage::Size - BlocksOffset) / sizeof(T));
+        static_assert(BlocksPerChunk >= 8, "T is too large for the allocator");
+        static_assert(alignof(T) <= AllocatorPage::HeaderSize, "T needs a larger alignment than the allocator provides");
+
+        AllocatorPage m_page;
         unsigned char m_firstFreeBlock;
         unsigned char m_numFreeBlocks;
+        alignas(T) unsigned char m_blocks[BlocksPerChunk * sizeof(T)];
     public:
         Chunk() :
+        m_page(nullptr),
         m_firstFreeBlock(0),
-        m_numFreeBlocks(BlocksPerChunk - 1) {
-            for (size_t i = 0; i < BlocksPerChunk - 1; i++)
+        m_numFreeBlocks(BlocksPerChunk) {
+            for (size_t i = 0; i < BlocksPerChunk; i++)
                 m_blocks[i * sizeof(T)] = static_cast<unsigned char>(i + 1);
         }
-        
-        bool contains(const T* t) const {
-            const unsigned char* block = reinterpret_cast<const unsigned char*>(t);
-            if (block < m_blocks)
-                return false;
-            size_t offset = static_cast<size_t>(block - m_blocks);
-            return offset < (BlocksPerChunk - 1) * sizeof(T);
+
+        static Chunk* create() {
+            static_assert(sizeof(Chunk) <= AllocatorPage::Size, "A chunk must fit into a page");
+            return new (AllocatorPage::allocate(AllocatorPage::Size)) Chunk();
+        }
+
+        static void destroy(Chunk* chunk) {
+            chunk->~Chunk();
+            AllocatorPage::free(chunk);
         }
-        
-        T* allocate() {
+
+        // the given block must have been allocated from a chunk
+        static Chunk* of(void* block) {
+            return reinterpret_cast<Chunk*>(const_cast<AllocatorPage*>(AllocatorPage::of(block)));
+        }
+
+        void* allocate() {
             if (m_numFreeBlocks == 0)
                 return nullptr;
-            
+
             unsigned char* block = m_blocks + m_firstFreeBlock * sizeof(T);
             m_firstFreeBlock = *block;
             m_numFreeBlocks--;
-            return reinterpret_cast<T*>(block);
-        }
-        
-        void deallocate(T* t) {
-            assert(m_numFreeBlocks < BlocksPerChunk - 1);
-            assert(contains(t));
-            
-            unsigned char* block = reinterpret_cast<unsigned char*>(t);
+            return block;
+        }
+
+        void deallocate(void* t) {
+            assert(m_numFreeBlocks < BlocksPerChunk);
+
+            unsigned char* block = static_cast<unsigned char*>(t);
             assert(block >= m_blocks);
             size_t offset = static_cast<size_t>(block - m_blocks);
             assert(offset % sizeof(T) == 0);
-            
+
             size_t index = offset / sizeof(T);
             assert(index < BlocksPerChunk);
-            
+
             *block = m_firstFreeBlock;
             m_firstFreeBlock = static_cast<unsigned char>(index);
             m_numFreeBlocks++;
         }
-        
+
         bool empty() const {
-            return m_numFreeBlocks == BlocksPerChunk - 1;
+            return m_numFreeBlocks == BlocksPerChunk;
         }
-        
+
         bool full() const {
             return m_numFreeBlocks == 0;
         }
     };
-    
+
     typedef std::vector<Chunk*> ChunkList;
-    typedef std::stack<T*> Pool;
-    
-    static Pool& pool() {
-        static Pool p;
-        return p;
-    }
-    
+
+    // The chunk lists and the mutex are never destroyed because threads that exit during static destruction, e.g.
+    // the worker threads of parallelFor, still return the blocks in their caches to the chunks.
     static ChunkList& fullChunks() {
-        static ChunkList chunks;
-        return chunks;
+        static ChunkList* chunks = new ChunkList();
+        return *chunks;
     }
-    
+
     static ChunkList& mixedChunks() {
-        static ChunkList chunks;
-        return chunks;
+        static ChunkList* chunks = new ChunkList();
+        return *chunks;
     }
-    
-    static ChunkList emptyChunks() {
-        static ChunkList chunks;
-        return chunks;
+
+    static ChunkList& emptyChunks() {
+        static ChunkList* chunks = new ChunkList();
+        return *chunks;
     }
-public:
+
+    // The chunk lists are shared by all threads, but threads only lock this to move a batch of blocks between their
+    // cache and the chunks.
+    static std::mutex& mutex() {
+        static std::mutex* m = new std::mutex();
+        return *m;
+    }
+
 #ifdef TB_ENABLE_ALLOCATOR
+    static constexpr size_t CacheBatchSize = PoolSize / 2 > 0 ? PoolSize / 2 : 1;
+
+    /**
+     * Holds up to PoolSize free blocks for one thread. Most allocations and deallocations only touch the cache of
+     * the calling thread, so threads that allocate in parallel, e.g. when brush geometry is built in parallel,
+     * rarely contend for the mutex. Blocks move between a cache and the chunks in batches of CacheBatchSize. A
+     * block may be freed by another thread than the one that allocated it; it then moves to the cache of that
+     * thread.
+     *
+     * When the thread exits, its cache returns its blocks to the chunks.
+     */
+    class ThreadCache {
+    private:
+        std::vector<void*> m_blocks;
+    public:
+        ThreadCache() {
+            m_blocks.reserve(PoolSize);
+        }
+
+        ~ThreadCache() {
+            cacheDestroyed() = true;
+            deallocateBlocks(m_blocks.data(), m_blocks.data() + m_blocks.size());
+        }
+
+        void* allocate() {
+            if (m_blocks.empty()) {
+                allocateBlocks(CacheBatchSize, m_blocks);
+            }
+            void* t = m_blocks.back();
+            m_blocks.pop_back();
+            return t;
+        }
+
+        void deallocate(void* t) {
+            if (m_blocks.size() >= PoolSize) {
+                // return the blocks that were freed first, the most recently freed ones are more likely to be cached
+                deallocateBlocks(m_blocks.data(), m_blocks.data() + CacheBatchSize);
+                m_blocks.erase(std::begin(m_blocks), std::begin(m_blocks) + CacheBatchSize);
+            }
+            m_blocks.push_back(t);
+        }
+    };
+
+    static ThreadCache& threadCache() {
+        thread_local ThreadCache cache;
+        return cache;
+    }
+
+    // Objects that are deleted while the thread exits, after its cache was destroyed, bypass the cache.
+    static bool& cacheDestroyed() {
+        thread_local bool destroyed = false;
+        return destroyed;
+    }
+#endif
+public:
+    /**
+     * The number of bytes an object of type T occupies in an arena, not counting alignment padding.
+     */
+    static constexpr size_t arenaBlockSize() {
+        return sizeof(T);
+    }
+
     void* operator new(size_t size) {
         assert(size == sizeof(T));
-        
-        if (!pool().empty()) {
-            T* t = pool().top();
-            pool().pop();
-            return t;
+        return allocateBlock();
+    }
+
+    /**
+     * Allocates the object from the given arena, or from the pool if the arena is exhausted.
+     */
+    void* operator new(size_t size, AllocatorArena& arena) {
+        assert(size == sizeof(T));
+        void* block = arena.allocate(sizeof(T), alignof(T));
+        if (block == nullptr) {
+            return operator new(size);
+        }
+        return block;
+    }
+
+    void operator delete(void* block) {
+        if (block == nullptr) {
+            return;
+        }
+
+#ifdef TB_ENABLE_ALLOCATOR
+        AllocatorArena* arena = AllocatorPage::of(block)->arena;
+        if (arena != nullptr) {
+            arena->release();
+            return;
+        }
+#endif
+        deallocateBlock(block);
+    }
+
+    // called if a constructor throws when allocating from an arena
+    void operator delete(void* block, AllocatorArena& /* arena */) {
+        operator delete(block);
+    }
+private:
+#ifdef TB_ENABLE_ALLOCATOR
+    static void* allocateBlock() {
+        if (PoolSize == 0 || cacheDestroyed()) {
+            std::lock_guard<std::mutex> lock(mutex());
+            return allocateFromChunk();
+        }
+        return threadCache().allocate();
+    }
+
+    static void deallocateBlock(void* t) {
+        if (PoolSize == 0 || cacheDestroyed()) {
+            std::lock_guard<std::mutex> lock(mutex());
+            deallocateToChunk(t);
+        } else {
+            threadCache().deallocate(t);
+        }
+    }
+
+    static void allocateBlocks(const size_t count, std::vector<void*>& result) {
+        std::lock_guard<std::mutex> lock(mutex());
+        for (size_t i = 0; i < count; ++i) {
+            result.push_back(allocateFromChunk());
         }
-        
+    }
+
+    static void deallocateBlocks(void* const* first, void* const* last) {
+        std::lock_guard<std::mutex> lock(mutex());
+        for (; first != last; ++first) {
+            deallocateToChunk(*first);
+        }
+    }
+
+    // must be called with the mutex locked
+    static void* allocateFromChunk() {
         Chunk* chunk = nullptr;
         if (mixedChunks().empty()) {
             if (!emptyChunks().empty()) {
                 chunk = emptyChunks().back();
                 emptyChunks().pop_back();
             } else {
-                chunk = new Chunk();
+                chunk = Chunk::create();
             }
         } else {
             chunk = mixedChunks().back();
             mixedChunks().pop_back();
         }
-        
-        assert(!chunk->full());
-        T* block = chunk->allocate();
-        
-        if (chunk->full()) {
+
+        void* block = chunk->allocate();
+        if (chunk->full())
             fullChunks().push_back(chunk);
-        } else {
+        else
             mixedChunks().push_back(chunk);
-        }
         return block;
     }
-    
-    void operator delete(void* block) {
-        T* t = reinterpret_cast<T*>(block);
-        
-        if (PoolSize > 0 && pool().size() < PoolSize) {
-            pool().push(t);
-            return;
-        }
-        
-        typename ChunkList::reverse_iterator fullIt, fullEnd, mixedIt, mixedEnd;
-        fullIt = fullChunks().rbegin();
-        fullEnd = fullChunks().rend();
-        mixedIt = mixedChunks().rbegin();
-        mixedEnd = mixedChunks().rend();
-        
-        Chunk* chunk = nullptr;
-        while (fullIt < fullEnd || mixedIt < mixedEnd) {
-            if (fullIt < fullEnd) {
-                Chunk* fullChunk = *fullIt;
-                if (fullChunk->contains(t)) {
-                    chunk = fullChunk;
-                    break;
-                }
-                ++fullIt;
-            }
-            if (mixedIt < mixedEnd) {
-                Chunk* mixedChunk = *mixedIt;
-                if (mixedChunk->contains(t)) {
-                    chunk = mixedChunk;
-                    break;
-                }
-                ++mixedIt;
-            }
-        }
-        
-        assert(chunk != nullptr);
-        
+
+    // must be called with the mutex locked
+    static void deallocateToChunk(void* t) {
+        Chunk* chunk = Chunk::of(t);
+
         if (chunk->full()) {
-            fullChunks().erase((fullIt + 1).base());
+            removeChunk(fullChunks(), chunk);
             mixedChunks().push_back(chunk);
         }
-        
+
         chunk->deallocate(t);
-        
+
         if (chunk->empty()) {
-            mixedChunks().erase((mixedIt + 1).base());
+            removeChunk(mixedChunks(), chunk);
             if (emptyChunks().size() < 2)
                 emptyChunks().push_back(chunk);
-                else
-                    delete chunk;
+            else
+                Chunk::destroy(chunk);
         }
     }
+
+    static void removeChunk(ChunkList& chunks, Chunk* chunk) {
+        // chunks are mostly removed soon after they were added, and the order of the chunks does not matter
+        auto it = std::find(chunks.rbegin(), chunks.rend(), chunk);
+        assert(it != chunks.rend());
+        *it = chunks.back();
+        chunks.pop_back();
+    }
+#else
+    static void* allocateBlock() {
+        return ::operator new(sizeof(T));
+    }
+
+    static void deallocateBlock(void* t) {
+        ::operator delete(t);
+    }
 #endif
 };
 
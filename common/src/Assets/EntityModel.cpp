@@ -19,6 +19,7 @@
 
 #include "EntityModel.h"
 
+#include "MemoryUsage.h"
 #include "Renderer/TexturedIndexRangeRenderer.h"
 
 #include <vecmath/forward.h>
@@ -42,6 +43,10 @@ namespace TrenchBroom {
             return doBuildRenderer(skin, vertexArray);
         }
 
+        size_t EntityModel::Frame::memoryUsage() const {
+            return sizeof(Frame) + heapMemoryUsage(m_name) + heapMemoryUsage(m_vertices);
+        }
+
         EntityModel::IndexedFrame::IndexedFrame(const String& name, const vm::bbox3f& bounds, const EntityModel::VertexList& vertices, const EntityModel::Indices& indices) :
                 Frame(name, bounds, vertices),
                 m_indices(indices) {}
@@ -90,6 +95,14 @@ namespace TrenchBroom {
             return m_skins->textureCount();
         }
 
+        size_t EntityModel::memoryUsage() const {
+            size_t result = sizeof(EntityModel) + heapMemoryUsage(m_name) + heapMemoryUsage(m_frames);
+            for (const auto& frame : m_frames) {
+                result += frame->memoryUsage();
+            }
+            return result + m_skins->memoryUsage();
+        }
+
         bool EntityModel::prepared() const {
             return m_prepared;
         }
@@ -52,6 +52,7 @@ namespace TrenchBroom {
 
                 const vm::bbox3f& bounds() const;
                 Renderer::TexturedIndexRangeRenderer* buildRenderer(Assets::Texture* skin);
+                size_t memoryUsage() const;
             private:
                 virtual Renderer::TexturedIndexRangeRenderer* doBuildRenderer(Assets::Texture* skin, const Renderer::VertexArray& vertices) = 0;
             };
@@ -96,6 +97,11 @@ namespace TrenchBroom {
             bool prepared() const;
             void prepare(int minFilter, int magFilter);
             void setTextureMode(int minFilter, int magFilter);
+
+            /**
+             * Returns the number of bytes occupied by the frames and skins of this model in main memory.
+             */
+            size_t memoryUsage() const;
         public:
             void addSkin(Assets::Texture* skin);
             void addFrame(const String& name, const VertexList& vertices, const Indices& indices);
@@ -22,25 +22,40 @@
 #include "CollectionUtils.h"
 #include "Exceptions.h"
 #include "Logger.h"
+#include "MemoryUsage.h"
 #include "Assets/EntityModel.h"
 #include "IO/EntityModelLoader.h"
 #include "Model/Entity.h"
+#include "ParallelFor.h"
 #include "Renderer/TexturedIndexRangeRenderer.h"
 
+#include <algorithm>
+
 namespace TrenchBroom {
     namespace Assets {
+        EntityModelManager::LoadedModel::LoadedModel(const IO::Path& i_path, std::unique_ptr<EntityModel> i_model, const String& i_error) :
+        path(i_path),
+        model(std::move(i_model)),
+        error(i_error) {}
+
         EntityModelManager::EntityModelManager(Logger* logger, int minFilter, int magFilter) :
         m_logger(logger),
         m_loader(nullptr),
         m_minFilter(minFilter),
         m_magFilter(magFilter),
-        m_resetTextureMode(false) {}
+        m_resetTextureMode(false),
+        m_loadGeneration(0),
+        m_activeLoads(0),
+        m_stopWorkers(false) {}
         
         EntityModelManager::~EntityModelManager() {
+            stopWorkers();
             clear();
         }
         
         void EntityModelManager::clear() {
+            cancelLoads();
+
             MapUtils::clearAndDelete(m_renderers);
             MapUtils::clearAndDelete(m_models);
             m_rendererMismatches.clear();
@@ -60,9 +75,16 @@ namespace TrenchBroom {
 
         void EntityModelManager::setLoader(const IO::EntityModelLoader* loader) {
             clear();
+
+            std::lock_guard<std::mutex> lock(m_loadMutex);
             m_loader = loader;
         }
 
+        void EntityModelManager::setModelLoadedCallback(std::function<void()> callback) {
+            std::lock_guard<std::mutex> lock(m_loadMutex);
+            m_modelLoadedCallback = std::move(callback);
+        }
+
         EntityModel* EntityModelManager::model(const IO::Path& path) const {
             if (path.isEmpty())
                 return nullptr;
@@ -98,8 +120,31 @@ namespace TrenchBroom {
             }
         }
         
+        EntityModel* EntityModelManager::requestModel(const IO::Path& path) const {
+            if (path.isEmpty())
+                return nullptr;
+
+            ModelCache::const_iterator it = m_models.find(path);
+            if (it != std::end(m_models))
+                return it->second;
+
+            if (m_modelMismatches.count(path) > 0 || m_pendingModels.count(path) > 0)
+                return nullptr;
+
+            ensure(m_loader != nullptr, "loader is null");
+            startWorkers();
+
+            m_pendingModels.insert(path);
+            {
+                std::lock_guard<std::mutex> lock(m_loadMutex);
+                m_loadQueue.push_back(path);
+            }
+            m_loadCondition.notify_one();
+            return nullptr;
+        }
+
         Renderer::TexturedIndexRangeRenderer* EntityModelManager::renderer(const Assets::ModelSpecification& spec) const {
-            EntityModel* entityModel = safeGetModel(spec.path);
+            EntityModel* entityModel = requestModel(spec.path);
 
             if (entityModel == nullptr)
                 return nullptr;
@@ -129,6 +174,49 @@ namespace TrenchBroom {
             return renderer;
         }
         
+        bool EntityModelManager::collectLoadedModels() {
+            if (m_pendingModels.empty())
+                return false;
+
+            std::vector<LoadedModel> loadedModels;
+            {
+                std::lock_guard<std::mutex> lock(m_loadMutex);
+                loadedModels.swap(m_loadedModels);
+            }
+
+            bool added = false;
+            for (auto& loadedModel : loadedModels) {
+                m_pendingModels.erase(loadedModel.path);
+                if (loadedModel.model == nullptr) {
+                    m_modelMismatches.insert(loadedModel.path);
+
+                    if (m_logger != nullptr)
+                        m_logger->error(loadedModel.error);
+                } else if (m_models.count(loadedModel.path) == 0) {
+                    // the model might have been loaded synchronously in the meantime
+                    EntityModel* model = loadedModel.model.release();
+                    m_models[loadedModel.path] = model;
+                    m_unpreparedModels.push_back(model);
+                    added = true;
+
+                    if (m_logger != nullptr)
+                        m_logger->debug("Loaded entity model %s", loadedModel.path.asString().c_str());
+                }
+            }
+
+            if (added)
+                ++m_loadGeneration;
+            return added;
+        }
+
+        bool EntityModelManager::loading() const {
+            return !m_pendingModels.empty();
+        }
+
+        size_t EntityModelManager::loadGeneration() const {
+            return m_loadGeneration;
+        }
+
         bool EntityModelManager::hasModel(const Model::Entity* entity) const {
             return hasModel(entity->modelSpecification());
         }
@@ -137,11 +225,89 @@ namespace TrenchBroom {
             return renderer(spec) != nullptr;
         }
 
+        size_t EntityModelManager::memoryUsage() const {
+            size_t result = 0;
+            for (const auto& entry : m_models) {
+                if (entry.second != nullptr) {
+                    result += entry.second->memoryUsage();
+                }
+            }
+            return result;
+        }
+
         EntityModel* EntityModelManager::loadModel(const IO::Path& path) const {
             ensure(m_loader != nullptr, "loader is null");
             return m_loader->loadEntityModel(path);
         }
 
+        void EntityModelManager::startWorkers() const {
+            if (m_workers.empty()) {
+                const auto workerCount = std::min(defaultThreadCount(), size_t(4));
+                for (size_t i = 0; i < workerCount; ++i) {
+                    m_workers.emplace_back([this]() { runWorker(); });
+                }
+            }
+        }
+
+        void EntityModelManager::stopWorkers() {
+            {
+                std::lock_guard<std::mutex> lock(m_loadMutex);
+                m_stopWorkers = true;
+            }
+            m_loadCondition.notify_all();
+
+            for (auto& worker : m_workers) {
+                worker.join();
+            }
+            m_workers.clear();
+        }
+
+        void EntityModelManager::runWorker() const {
+            std::unique_lock<std::mutex> lock(m_loadMutex);
+            while (true) {
+                m_loadCondition.wait(lock, [this]() { return m_stopWorkers || !m_loadQueue.empty(); });
+                if (m_stopWorkers)
+                    return;
+
+                const IO::Path path = m_loadQueue.front();
+                m_loadQueue.pop_front();
+                const IO::EntityModelLoader* loader = m_loader;
+                ++m_activeLoads;
+                lock.unlock();
+
+                // a null model marks a model that could not be loaded, the error is logged when it is collected
+                std::unique_ptr<EntityModel> model;
+                String error;
+                try {
+                    model.reset(loader->loadEntityModel(path));
+                } catch (const Exception& e) {
+                    error = e.what();
+                }
+
+                lock.lock();
+                m_loadedModels.emplace_back(path, std::move(model), error);
+                --m_activeLoads;
+                m_loadCondition.notify_all();
+
+                if (m_modelLoadedCallback) {
+                    m_modelLoadedCallback();
+                }
+            }
+        }
+
+        void EntityModelManager::cancelLoads() {
+            std::vector<LoadedModel> loadedModels;
+            {
+                std::unique_lock<std::mutex> lock(m_loadMutex);
+                m_loadQueue.clear();
+
+                // loads in progress still use the current loader
+                m_loadCondition.wait(lock, [this]() { return m_activeLoads == 0; });
+                loadedModels.swap(m_loadedModels);
+            }
+            m_pendingModels.clear();
+        }
+
         void EntityModelManager::prepare(Renderer::Vbo& vbo) {
             resetTextureMode();
             prepareModels();
@@ -20,12 +20,19 @@
 #ifndef TrenchBroom_EntityModelManager
 #define TrenchBroom_EntityModelManager
 
+#include "StringUtils.h"
 #include "Assets/ModelDefinition.h"
 #include "IO/Path.h"
 #include "Model/ModelTypes.h"
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <thread>
 #include <vector>
 
 namespace TrenchBroom {
@@ -42,12 +49,32 @@ namespace TrenchBroom {
     
     namespace Assets {
         class EntityModel;
-        
+
+        /**
+         * Loads entity models and builds their renderers.
+         *
+         * Models are either loaded synchronously by calling model(), or in the background by calling renderer() or
+         * requestModel(). Background loads are parsed by a pool of worker threads and handed back to the manager when
+         * collectLoadedModels() is called, so the model and renderer caches are only ever accessed from the thread
+         * that owns the manager and lookups do not need to lock. Until a model has been loaded, renderer() returns
+         * nullptr and the entity is rendered using the bounds of its definition.
+         *
+         * The loader must be safe to call from multiple threads at once.
+         */
         class EntityModelManager {
         private:
             typedef std::map<IO::Path, EntityModel*> ModelCache;
             typedef std::set<IO::Path> ModelMismatches;
+            typedef std::set<IO::Path> PendingModels;
             typedef std::vector<EntityModel*> ModelList;
+
+            struct LoadedModel {
+                IO::Path path;
+                std::unique_ptr<EntityModel> model;
+                String error;
+
+                LoadedModel(const IO::Path& i_path, std::unique_ptr<EntityModel> i_model, const String& i_error);
+            };
             
             typedef std::map<Assets::ModelSpecification, Renderer::TexturedIndexRangeRenderer*> RendererCache;
             typedef std::set<Assets::ModelSpecification> RendererMismatches;
@@ -62,11 +89,23 @@ namespace TrenchBroom {
 
             mutable ModelCache m_models;
             mutable ModelMismatches m_modelMismatches;
+            mutable PendingModels m_pendingModels;
+            size_t m_loadGeneration;
             mutable RendererCache m_renderers;
             mutable RendererMismatches m_rendererMismatches;
 
             mutable ModelList m_unpreparedModels;
             mutable RendererList m_unpreparedRenderers;
+
+            // shared with the worker threads, guarded by m_loadMutex
+            mutable std::mutex m_loadMutex;
+            mutable std::condition_variable m_loadCondition;
+            mutable std::deque<IO::Path> m_loadQueue;
+            mutable std::vector<LoadedModel> m_loadedModels;
+            mutable size_t m_activeLoads;
+            mutable std::vector<std::thread> m_workers;
+            bool m_stopWorkers;
+            std::function<void()> m_modelLoadedCallback;
         public:
             EntityModelManager(Logger* logger, int minFilter, int magFilter);
             ~EntityModelManager();
@@ -75,15 +114,67 @@ namespace TrenchBroom {
 
             void setTextureMode(int minFilter, int magFilter);
             void setLoader(const IO::EntityModelLoader* loader);
+
+            /**
+             * Sets a function that is called whenever a model has been loaded in the background. The function is
+             * called on the worker thread that loaded the model, so it must not access the manager. It can be used to
+             * wake up the thread that owns the manager so that it calls collectLoadedModels().
+             */
+            void setModelLoadedCallback(std::function<void()> callback);
             
             EntityModel* model(const IO::Path& path) const;
             EntityModel* safeGetModel(const IO::Path& path) const;
+
+            /**
+             * Returns the model with the given path if it has been loaded. Otherwise, schedules the model to be loaded
+             * in the background and returns nullptr. Also returns nullptr if the model could not be loaded.
+             */
+            EntityModel* requestModel(const IO::Path& path) const;
+
+            /**
+             * Returns the renderer for the given model specification, or nullptr if the model is still being loaded
+             * or if the model or the renderer could not be loaded.
+             */
             Renderer::TexturedIndexRangeRenderer* renderer(const Assets::ModelSpecification& spec) const;
+
+            /**
+             * Adds the models that have been loaded in the background since the last call to the model cache.
+             *
+             * @return true if any models were added
+             */
+            bool collectLoadedModels();
+
+            /**
+             * Indicates whether any models are still being loaded in the background.
+             */
+            bool loading() const;
+
+            /**
+             * Returns a counter that is incremented whenever models loaded in the background are added to the model
+             * cache. Callers can compare it to a previous value to find out whether they must look up renderers that
+             * were not available before.
+             */
+            size_t loadGeneration() const;
             
             bool hasModel(const Model::Entity* entity) const;
             bool hasModel(const Assets::ModelSpecification& spec) const;
+
+            /**
+             * Returns the number of bytes occupied by the loaded models in main memory.
+             */
+            size_t memoryUsage() const;
+
+            /**
+             * Discards all pending background loads and waits until the loads in progress have finished. Must be
+             * called before the file system that the loader reads from is changed, because the worker threads read
+             * from it without holding any lock.
+             */
+            void cancelLoads();
         private:
             EntityModel* loadModel(const IO::Path& path) const;
+            void startWorkers() const;
+            void stopWorkers();
+            void runWorker() const;
         public:
             void prepare(Renderer::Vbo& vbo);
         private:
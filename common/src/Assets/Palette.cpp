@@ -29,13 +29,58 @@
 #include <cstring>
 #include <fstream>
 
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+// compiled for AVX2 regardless of the compiler flags, used if the CPU supports it
+#define TB_PALETTE_AVX2_DISPATCH 1
+#define TB_PALETTE_AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(__AVX2__)
+#define TB_PALETTE_AVX2_TARGET
+#include <immintrin.h>
+#endif
+
 namespace TrenchBroom {
     namespace Assets {
+#ifdef TB_PALETTE_AVX2_TARGET
+        /**
+         * Looks up the pixels of the given indices, eight at a time. Returns the number of pixels written, which is
+         * a multiple of eight.
+         */
+        TB_PALETTE_AVX2_TARGET
+        static size_t lookupPixelsAvx2(const unsigned char* indices, const size_t count, const uint32_t* pixels, unsigned char* rgbaImage) {
+            const auto* table = reinterpret_cast<const int*>(pixels);
+
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(indices + i));
+                const __m256i offsets = _mm256_cvtepu8_epi32(packed);
+                const __m256i rgba = _mm256_i32gather_epi32(table, offsets, 4);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(rgbaImage + 4 * i), rgba);
+            }
+            return i;
+        }
+#endif
+
+        static size_t lookupPixels(const unsigned char* indices, const size_t count, const uint32_t* pixels, unsigned char* rgbaImage) {
+#if defined(TB_PALETTE_AVX2_DISPATCH)
+            static const bool avx2 = __builtin_cpu_supports("avx2");
+            if (avx2) {
+                return lookupPixelsAvx2(indices, count, pixels, rgbaImage);
+            }
+            return 0;
+#elif defined(TB_PALETTE_AVX2_TARGET)
+            return lookupPixelsAvx2(indices, count, pixels, rgbaImage);
+#else
+            return 0;
+#endif
+        }
+
         Palette::Data::Data(const size_t size, RawDataPtr&& data) :
         m_size(size),
         m_data(std::move(data)) {
             ensure(m_size > 0, "size is 0");
             ensure(m_data.get() != nullptr, "data is null");
+            initializePixels();
         }
 
         Palette::Data::Data(const size_t size, unsigned char* data) :
@@ -43,6 +88,65 @@ namespace TrenchBroom {
         m_data(data) {
             ensure(m_size > 0, "size is 0");
             ensure(m_data.get() != nullptr, "data is null");
+            initializePixels();
+        }
+
+        void Palette::Data::initializePixels() {
+            const auto colorCount = std::min(m_size / 3, m_opaquePixels.size());
+            for (size_t i = 0; i < m_opaquePixels.size(); ++i) {
+                unsigned char rgba[4] = { 0x00, 0x00, 0x00, 0xFF };
+                if (i < colorCount) {
+                    std::memcpy(rgba, &m_data[i * 3], 3);
+                }
+                std::memcpy(&m_opaquePixels[i], rgba, 4);
+
+                rgba[3] = (i == 255) ? 0x00 : 0xFF;
+                std::memcpy(&m_maskedPixels[i], rgba, 4);
+            }
+        }
+
+        bool Palette::Data::indexedToRgba(const unsigned char* indexedImage, const size_t pixelCount, unsigned char* rgbaImage, const PaletteTransparency transparency, Color& averageColor) const {
+            const auto& pixels = (transparency == PaletteTransparency::Index255Transparent) ? m_maskedPixels : m_opaquePixels;
+
+            auto i = lookupPixels(indexedImage, pixelCount, pixels.data(), rgbaImage);
+            for (; i < pixelCount; ++i) {
+                assert(static_cast<size_t>(indexedImage[i]) * 3 < m_size);
+                std::memcpy(rgbaImage + 4 * i, &pixels[indexedImage[i]], 4);
+            }
+
+            // four separate histograms so that runs of the same index don't stall on the same counter
+            size_t counts[4][256] = {};
+            i = 0;
+            for (; i + 4 <= pixelCount; i += 4) {
+                ++counts[0][indexedImage[i + 0]];
+                ++counts[1][indexedImage[i + 1]];
+                ++counts[2][indexedImage[i + 2]];
+                ++counts[3][indexedImage[i + 3]];
+            }
+            for (; i < pixelCount; ++i) {
+                ++counts[0][indexedImage[i]];
+            }
+
+            // the sums are exact integers, so they are the same as summing up the colors of all pixels as doubles
+            const auto colorCount = std::min(m_size / 3, size_t(256));
+            uint64_t sum[3] = { 0, 0, 0 };
+            for (size_t index = 0; index < colorCount; ++index) {
+                const auto count = counts[0][index] + counts[1][index] + counts[2][index] + counts[3][index];
+                for (size_t j = 0; j < 3; ++j) {
+                    sum[j] += count * m_data[index * 3 + j];
+                }
+            }
+
+            for (size_t j = 0; j < 3; ++j) {
+                averageColor[j] = static_cast<float>(static_cast<double>(sum[j]) / pixelCount / 0xFF);
+            }
+            averageColor[3] = 1.0f;
+
+            if (transparency == PaletteTransparency::Index255Transparent) {
+                return counts[0][255] + counts[1][255] + counts[2][255] + counts[3][255] > 0;
+            } else {
+                return false;
+            }
         }
 
         Palette::Palette() {}
@@ -24,7 +24,9 @@
 #include "ByteBuffer.h"
 #include "IO/MappedFile.h"
 
+#include <array>
 #include <cassert>
+#include <cstdint>
 #include <memory>
 
 namespace TrenchBroom {
@@ -46,6 +48,9 @@ namespace TrenchBroom {
             private:
                 size_t m_size;
                 RawDataPtr m_data;
+                // the palette colors as RGBA pixels, with index 255 fully transparent in the masked variant
+                std::array<uint32_t, 256> m_opaquePixels;
+                std::array<uint32_t, 256> m_maskedPixels;
             public:
                 Data(size_t size, RawDataPtr&& data);
                 Data(size_t size, unsigned char* data);
@@ -83,35 +88,24 @@ namespace TrenchBroom {
                  */
                 template <typename IndexT, typename ColorT>
                 bool indexedToRgba(const IndexT* indexedImage, const size_t pixelCount, Buffer<ColorT>& rgbaImage, const PaletteTransparency transparency, Color& averageColor) const {
-                    double avg[3];
-                    avg[0] = avg[1] = avg[2] = 0.0;
-                    bool hasTransparency = false;
-                    for (size_t i = 0; i < pixelCount; ++i) {
-                        const size_t index = static_cast<size_t>(static_cast<unsigned char>(indexedImage[i]));
-                        assert(index < m_size);
-                        for (size_t j = 0; j < 3; ++j) {
-                            const unsigned char c = m_data[index * 3 + j];
-                            rgbaImage[i * 4 + j] = c;
-                            avg[j] += static_cast<double>(c);
-                        }
-                        switch (transparency) {
-                            case PaletteTransparency::Opaque:
-                                rgbaImage[i * 4 + 3] = 0xFF;
-                                break;
-                            case PaletteTransparency::Index255Transparent:
-                                rgbaImage[i * 4 + 3] = (index == 255) ? 0x00 : 0xFF;
-                                hasTransparency |= (index == 255);
-                                break;
-                        }
-                    }
-                    
-                    for (size_t i = 0; i < 3; ++i) {
-                        averageColor[i] = static_cast<float>(avg[i] / pixelCount / 0xFF);
-                    }
-                    averageColor[3] = 1.0f;
+                    static_assert(sizeof(IndexT) == 1, "index type must be a byte");
+                    static_assert(sizeof(ColorT) == 1, "color type must be a byte");
+                    assert(rgbaImage.size() >= 4 * pixelCount);
 
-                    return hasTransparency;
+                    return indexedToRgba(reinterpret_cast<const unsigned char*>(indexedImage), pixelCount,
+                                         reinterpret_cast<unsigned char*>(rgbaImage.ptr()), transparency, averageColor);
                 }
+
+                /**
+                 * Converts the given index buffer to an RGBA image by looking up every index in a table of RGBA pixels.
+                 * Uses AVX2 gather instructions to look up eight pixels at a time if the CPU supports them.
+                 *
+                 * The average color is computed from a histogram of the indices, so the result is the same as if the
+                 * colors of all pixels were summed up.
+                 */
+                bool indexedToRgba(const unsigned char* indexedImage, size_t pixelCount, unsigned char* rgbaImage, PaletteTransparency transparency, Color& averageColor) const;
+            private:
+                void initializePixels();
             };
             
             typedef std::shared_ptr<Data> DataPtr;
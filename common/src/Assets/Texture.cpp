@@ -18,6 +18,7 @@
  */
 
 #include "Texture.h"
+#include "MemoryUsage.h"
 #include "Assets/ImageUtils.h"
 #include "Assets/TextureCollection.h"
 
@@ -113,10 +114,7 @@ namespace TrenchBroom {
         m_textureId(0) {}
 
         Texture::~Texture() {
-            if (m_collection == nullptr && m_textureId != 0) {
-                glAssert(glDeleteTextures(1, &m_textureId));
-            }
-            m_textureId = 0;
+            unprepare();
         }
 
         TextureType Texture::selectTextureType(const bool masked) {
@@ -128,6 +126,10 @@ namespace TrenchBroom {
         }
 
         const String& Texture::name() const {
+            return m_name.name();
+        }
+
+        const TextureName& Texture::internedName() const {
             return m_name;
         }
         
@@ -159,6 +161,10 @@ namespace TrenchBroom {
             ++m_usageCount;
             if (m_collection != nullptr) {
                 m_collection->incUsageCount();
+                if (m_usageCount == 1) {
+                    // upload the texture once the first face references it
+                    m_collection->useTexture(this);
+                }
             }
         }
         
@@ -182,11 +188,13 @@ namespace TrenchBroom {
             return m_textureId != 0;
         }
 
-        void Texture::prepare(const GLuint textureId, const int minFilter, const int magFilter) {
-            assert(textureId > 0);
+        void Texture::prepare(const int minFilter, const int magFilter) {
             assert(m_textureId == 0);
 
             if (!m_buffers.empty()) {
+                GLuint textureId = 0;
+                glAssert(glGenTextures(1, &textureId));
+
                 glAssert(glPixelStorei(GL_UNPACK_SWAP_BYTES, false));
                 glAssert(glPixelStorei(GL_UNPACK_LSB_FIRST, false));
                 glAssert(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
@@ -225,10 +233,16 @@ namespace TrenchBroom {
                                           0, m_format, GL_UNSIGNED_BYTE, data));
                 }
 
-                m_buffers.clear();
                 m_textureId = textureId;
             }
         }
+
+        void Texture::unprepare() {
+            if (m_textureId != 0) {
+                glAssert(glDeleteTextures(1, &m_textureId));
+                m_textureId = 0;
+            }
+        }
         
         void Texture::setMode(const int minFilter, const int magFilter) {
             if (isPrepared()) {
@@ -246,9 +260,10 @@ namespace TrenchBroom {
         }
 
         void Texture::activate() const {
-            if (isPrepared()) {
-                glAssert(glBindTexture(GL_TEXTURE_2D, m_textureId));
+            if (m_collection != nullptr) {
+                m_collection->useTexture(this);
             }
+            glAssert(glBindTexture(GL_TEXTURE_2D, m_textureId));
         }
         
         void Texture::deactivate() const {
@@ -257,6 +272,34 @@ namespace TrenchBroom {
             }
         }
 
+        size_t Texture::memoryUsage() const {
+            size_t result = sizeof(Texture) + heapMemoryUsage(m_buffers);
+            for (const auto& buffer : m_buffers) {
+                result += buffer.size();
+            }
+            return result;
+        }
+
+        size_t Texture::videoMemoryUsage() const {
+            if (m_buffers.empty()) {
+                return 0;
+            }
+
+            // textures are stored as GL_RGBA, see prepare
+            const auto mipmapsToUpload = (m_type == TextureType::Masked) ? 1u : m_buffers.size();
+            size_t result = 0;
+            for (size_t level = 0; level < mipmapsToUpload; ++level) {
+                const auto mipSize = sizeAtMipLevel(m_width, m_height, level);
+                result += 4u * mipSize.x() * mipSize.y();
+            }
+
+            if (m_buffers.size() == 1) {
+                // OpenGL generates the mipmaps, which adds about a third
+                result += result / 3u;
+            }
+            return result;
+        }
+
         const TextureBuffer::List& Texture::buffersIfUnprepared() const {
             return m_buffers;
         }
@@ -272,5 +315,9 @@ namespace TrenchBroom {
         void Texture::setCollection(TextureCollection* collection) {
             m_collection = collection;
         }
+
+        void Texture::discardBuffers() {
+            m_buffers.clear();
+        }
     }
 }
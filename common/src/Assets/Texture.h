@@ -23,6 +23,7 @@
 #include "ByteBuffer.h"
 #include "Color.h"
 #include "StringUtils.h"
+#include "Assets/TextureName.h"
 #include "Renderer/GL.h"
 
 #include <vecmath/forward.h>
@@ -52,7 +53,7 @@ namespace TrenchBroom {
         class Texture {
         private:
             TextureCollection* m_collection;
-            String m_name;
+            TextureName m_name;
             
             size_t m_width;
             size_t m_height;
@@ -78,6 +79,7 @@ namespace TrenchBroom {
             static TextureType selectTextureType(bool masked);
 
             const String& name() const;
+            const TextureName& internedName() const;
             
             size_t width() const;
             size_t height() const;
@@ -93,15 +95,41 @@ namespace TrenchBroom {
             void setOverridden(const bool overridden);
 
             bool isPrepared() const;
-            void prepare(GLuint textureId, int minFilter, int magFilter);
+
+            /**
+             * Uploads this texture to video memory. The texture data is kept in main memory, so the texture can be
+             * evicted and uploaded again.
+             */
+            void prepare(int minFilter, int magFilter);
+
+            /**
+             * Releases the video memory occupied by this texture.
+             */
+            void unprepare();
             void setMode(int minFilter, int magFilter);
 
+            /**
+             * Binds this texture. If this texture is not prepared, no texture is bound, and if it belongs to a
+             * collection that manages its residency, it is uploaded before one of the next frames is rendered.
+             */
             void activate() const;
             void deactivate() const;
+
+            /**
+             * Returns the number of bytes occupied by this texture in main memory.
+             */
+            size_t memoryUsage() const;
+
+            /**
+             * Returns the number of bytes this texture occupies in video memory once it is prepared, including any
+             * mipmaps generated by OpenGL.
+             */
+            size_t videoMemoryUsage() const;
         public: // exposed for tests only
             /**
              * Returns the texture data in the format returned by format().
-             * Once prepare() is called, this will be an empty vector.
+             * Once the texture is prepared as part of a collection without residency management, this will be an
+             * empty vector.
              */
             const TextureBuffer::List& buffersIfUnprepared() const;
             /**
@@ -112,6 +140,7 @@ namespace TrenchBroom {
 
         private:
             void setCollection(TextureCollection* collection);
+            void discardBuffers();
             friend class TextureCollection;
         };
     }
@@ -20,39 +20,44 @@
 #include "TextureCollection.h"
 
 #include "CollectionUtils.h"
+#include "MemoryUsage.h"
 #include "Assets/Texture.h"
+#include "Assets/TextureResidency.h"
 
 namespace TrenchBroom {
     namespace Assets {
         TextureCollection::TextureCollection() :
         m_loaded(false),
-        m_usageCount(0) {}
+        m_usageCount(0),
+        m_prepared(false),
+        m_residency(nullptr) {}
         
         TextureCollection::TextureCollection(const TextureList& textures) :
         m_loaded(false),
-        m_usageCount(0) {
+        m_usageCount(0),
+        m_prepared(false),
+        m_residency(nullptr) {
             addTextures(textures);
         }
 
         TextureCollection::TextureCollection(const IO::Path& path) :
         m_loaded(false),
         m_path(path),
-        m_usageCount(0) {}
+        m_usageCount(0),
+        m_prepared(false),
+        m_residency(nullptr) {}
 
         TextureCollection::TextureCollection(const IO::Path& path, const TextureList& textures) :
         m_loaded(true),
         m_path(path),
-        m_usageCount(0) {
+        m_usageCount(0),
+        m_prepared(false),
+        m_residency(nullptr) {
             addTextures(textures);
         }
 
         TextureCollection::~TextureCollection() {
             VectorUtils::clearAndDelete(m_textures);
-            if (!m_textureIds.empty()) {
-                glAssert(glDeleteTextures(static_cast<GLsizei>(m_textureIds.size()),
-                                          static_cast<GLuint*>(&m_textureIds.front())));
-                m_textureIds.clear();
-            }
         }
 
         void TextureCollection::addTextures(const TextureList& textures) {
@@ -97,25 +102,34 @@ namespace TrenchBroom {
             }
         }
 
+        size_t TextureCollection::memoryUsage() const {
+            size_t result = sizeof(TextureCollection) + heapMemoryUsage(m_textures);
+            for (const Texture* texture : m_textures) {
+                result += texture->memoryUsage();
+            }
+            return result;
+        }
+
         size_t TextureCollection::usageCount() const {
             return m_usageCount;
         }
 
         bool TextureCollection::prepared() const {
-            return !m_textureIds.empty();
+            return m_prepared;
         }
 
         void TextureCollection::prepare(const int minFilter, const int magFilter) {
             assert(!prepared());
-            
-            m_textureIds.resize(textureCount());
-            glAssert(glGenTextures(static_cast<GLsizei>(textureCount()),
-                                   static_cast<GLuint*>(&m_textureIds.front())));
-
-            for (size_t i = 0; i < textureCount(); ++i) {
-                Texture* texture = m_textures[i];
-                texture->prepare(m_textureIds[i], minFilter, magFilter);
+
+            for (Texture* texture : m_textures) {
+                texture->prepare(minFilter, magFilter);
+                texture->discardBuffers();
             }
+            m_prepared = true;
+        }
+
+        void TextureCollection::setResidency(TextureResidency* residency) {
+            m_residency = residency;
         }
 
         void TextureCollection::setTextureMode(const int minFilter, const int magFilter) {
@@ -134,5 +148,11 @@ namespace TrenchBroom {
             --m_usageCount;
             usageCountDidChange();
         }
+
+        void TextureCollection::useTexture(const Texture* texture) {
+            if (m_residency != nullptr) {
+                m_residency->use(texture);
+            }
+        }
     }
 }
@@ -30,17 +30,19 @@
 
 namespace TrenchBroom {
     namespace Assets {
+        class TextureResidency;
+
         class TextureCollection {
         private:
-            typedef std::vector<GLuint> TextureIdList;
-            
             bool m_loaded;
             IO::Path m_path;
             TextureList m_textures;
             
             size_t m_usageCount;
             
-            TextureIdList m_textureIds;
+            bool m_prepared;
+            // decides when the textures are uploaded if they are not prepared all at once
+            TextureResidency* m_residency;
             
             friend class Texture;
         public:
@@ -62,14 +64,35 @@ namespace TrenchBroom {
             const TextureList& textures() const;
             Texture* textureByIndex(size_t index) const;
 
+            /**
+             * Returns the number of bytes occupied by this collection and its textures in main memory.
+             */
+            size_t memoryUsage() const;
+
             size_t usageCount() const;
             
+            /**
+             * Indicates whether all textures of this collection have been uploaded by a call to prepare.
+             */
             bool prepared() const;
+
+            /**
+             * Uploads all textures of this collection at once and discards their data from main memory. Use this for
+             * collections whose textures are always needed, such as entity model skins.
+             */
             void prepare(int minFilter, int magFilter);
+
+            /**
+             * Sets the residency manager that is notified when a texture of this collection is used. The textures
+             * are then uploaded and evicted by the owner of the residency manager, and their data is kept in main
+             * memory.
+             */
+            void setResidency(TextureResidency* residency);
             void setTextureMode(int minFilter, int magFilter);
         private:
             void incUsageCount();
             void decUsageCount();
+            void useTexture(const Texture* texture);
         };
     }
 }
@@ -22,13 +22,18 @@
 #include "Exceptions.h"
 #include "CollectionUtils.h"
 #include "Logger.h"
+#include "MemoryUsage.h"
 #include "Assets/Texture.h"
 #include "Assets/TextureCollection.h"
+#include "Assets/TextureName.h"
+#include "Assets/TextureResidency.h"
 #include "IO/TextureLoader.h"
 
 #include <algorithm>
 #include <iterator>
 
+#include <wx/string.h>
+
 namespace TrenchBroom {
     namespace Assets {
         class CompareByName {
@@ -50,13 +55,61 @@ namespace TrenchBroom {
             }
         };
         
+        const size_t TextureManager::DefaultUploadBudget = 16u * 1024u * 1024u;
+
+        class TextureManager::LoadLogger : public Logger {
+        private:
+            typedef std::pair<LogLevel, String> Message;
+
+            std::mutex m_mutex;
+            std::vector<Message> m_messages;
+        public:
+            void flush(Logger* logger) {
+                std::vector<Message> messages;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    messages.swap(m_messages);
+                }
+
+                if (logger != nullptr) {
+                    for (const auto& message : messages) {
+                        logger->log(message.first, message.second);
+                    }
+                }
+            }
+        private:
+            void doLog(const LogLevel level, const String& message) override {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_messages.emplace_back(level, message);
+            }
+
+            void doLog(const LogLevel level, const wxString& message) override {
+                doLog(level, message.ToStdString());
+            }
+        };
+
+        TextureManager::PendingCollection::PendingCollection(const IO::Path& i_path, std::shared_ptr<IO::TextureLoader> i_loader) :
+        path(i_path),
+        loader(std::move(i_loader)) {}
+
+        TextureManager::LoadedCollection::LoadedCollection(const IO::Path& i_path, std::unique_ptr<TextureCollection> i_collection, const String& i_error) :
+        path(i_path),
+        collection(std::move(i_collection)),
+        error(i_error) {}
+
         TextureManager::TextureManager(Logger* logger, int minFilter, int magFilter) :
         m_logger(logger),
         m_minFilter(minFilter),
         m_magFilter(magFilter),
-        m_resetTextureMode(false) {}
+        m_resetTextureMode(false),
+        m_uploadBudget(DefaultUploadBudget),
+        m_loadGeneration(0),
+        m_loadLogger(std::make_unique<LoadLogger>()),
+        m_activeLoads(0),
+        m_stopWorker(false) {}
         
         TextureManager::~TextureManager() {
+            stopWorker();
             clear();
         }
         
@@ -88,7 +141,186 @@ namespace TrenchBroom {
             }
             
             updateTextures();
-            VectorUtils::append(m_toRemove, collections);
+            for (const auto& entry : collections) {
+                removeTextureCollection(entry.second);
+            }
+        }
+
+        void TextureManager::requestTextureCollections(const IO::Path::List& paths, const TextureLoaderFactory& createLoader) {
+            // the loader may throw, so create it before changing anything
+            std::shared_ptr<IO::TextureLoader> loader = createLoader(m_loadLogger.get());
+
+            auto collections = collectionMap();
+            m_collections.clear();
+            clear();
+
+            std::vector<PendingCollection> pendingCollections;
+            for (const auto& path : paths) {
+                const auto it = collections.find(path);
+                if (it == std::end(collections)) {
+                    // a placeholder until the collection has been loaded
+                    addTextureCollection(new Assets::TextureCollection(path));
+                    pendingCollections.emplace_back(path, loader);
+                } else {
+                    addTextureCollection(it->second);
+                    if (!it->second->loaded()) {
+                        pendingCollections.emplace_back(path, loader);
+                    }
+                    collections.erase(it);
+                }
+            }
+
+            updateTextures();
+            for (const auto& entry : collections) {
+                removeTextureCollection(entry.second);
+            }
+
+            if (!pendingCollections.empty()) {
+                startWorker();
+                for (const auto& pendingCollection : pendingCollections) {
+                    m_pendingCollections.insert(pendingCollection.path);
+                }
+                {
+                    std::lock_guard<std::mutex> lock(m_loadMutex);
+                    m_loadQueue.insert(std::end(m_loadQueue), std::begin(pendingCollections), std::end(pendingCollections));
+                }
+                m_loadCondition.notify_one();
+            } else {
+                m_loadLogger->flush(m_logger);
+            }
+        }
+
+        void TextureManager::setCollectionLoadedCallback(std::function<void()> callback) {
+            std::lock_guard<std::mutex> lock(m_loadMutex);
+            m_collectionLoadedCallback = std::move(callback);
+        }
+
+        bool TextureManager::hasLoadedCollections() const {
+            std::lock_guard<std::mutex> lock(m_loadMutex);
+            return !m_loadedCollections.empty();
+        }
+
+        bool TextureManager::collectLoadedCollections() {
+            if (m_pendingCollections.empty()) {
+                return false;
+            }
+
+            std::vector<LoadedCollection> loadedCollections;
+            {
+                std::lock_guard<std::mutex> lock(m_loadMutex);
+                loadedCollections.swap(m_loadedCollections);
+            }
+            m_loadLogger->flush(m_logger);
+
+            bool replaced = false;
+            for (auto& loadedCollection : loadedCollections) {
+                m_pendingCollections.erase(loadedCollection.path);
+
+                const auto it = std::find_if(std::begin(m_collections), std::end(m_collections),
+                                             [&](const auto* collection) { return collection->path() == loadedCollection.path; });
+                if (it == std::end(m_collections) || (*it)->loaded()) {
+                    // the collection was removed or loaded synchronously in the meantime
+                    continue;
+                }
+
+                if (loadedCollection.collection == nullptr) {
+                    if (m_logger != nullptr) {
+                        m_logger->error("Could not load texture collection '" + loadedCollection.path.asString() + "': " + loadedCollection.error);
+                    }
+                } else {
+                    // the placeholder has no textures, but the UI may still refer to it until the next commit
+                    m_toRemove.push_back(*it);
+
+                    auto* collection = loadedCollection.collection.release();
+                    collection->usageCountDidChange.addObserver(usageCountDidChange);
+                    *it = collection;
+                    registerTextureCollection(collection);
+                    replaced = true;
+
+                    if (m_logger != nullptr) {
+                        m_logger->info("Loaded texture collection '" + collection->path().asString() + "'");
+                    }
+                }
+            }
+
+            if (replaced) {
+                updateTextures();
+                ++m_loadGeneration;
+            }
+            return replaced;
+        }
+
+        bool TextureManager::loading() const {
+            return !m_pendingCollections.empty();
+        }
+
+        size_t TextureManager::loadGeneration() const {
+            return m_loadGeneration;
+        }
+
+        void TextureManager::cancelLoads() {
+            std::vector<LoadedCollection> loadedCollections;
+            {
+                std::unique_lock<std::mutex> lock(m_loadMutex);
+                m_loadQueue.clear();
+
+                // the load in progress still uses its loader
+                m_loadCondition.wait(lock, [this]() { return m_activeLoads == 0; });
+                loadedCollections.swap(m_loadedCollections);
+            }
+            m_pendingCollections.clear();
+        }
+
+        void TextureManager::startWorker() {
+            if (!m_worker.joinable()) {
+                // one thread suffices because the textures of a collection are decoded in parallel
+                m_worker = std::thread([this]() { runWorker(); });
+            }
+        }
+
+        void TextureManager::stopWorker() {
+            {
+                std::lock_guard<std::mutex> lock(m_loadMutex);
+                m_stopWorker = true;
+            }
+            m_loadCondition.notify_all();
+
+            if (m_worker.joinable()) {
+                m_worker.join();
+            }
+        }
+
+        void TextureManager::runWorker() {
+            std::unique_lock<std::mutex> lock(m_loadMutex);
+            while (true) {
+                m_loadCondition.wait(lock, [this]() { return m_stopWorker || !m_loadQueue.empty(); });
+                if (m_stopWorker) {
+                    return;
+                }
+
+                auto pendingCollection = std::move(m_loadQueue.front());
+                m_loadQueue.pop_front();
+                ++m_activeLoads;
+                lock.unlock();
+
+                // a null collection marks a collection that could not be loaded, the error is logged when it is collected
+                std::unique_ptr<TextureCollection> collection;
+                String error;
+                try {
+                    collection = pendingCollection.loader->loadTextureCollection(pendingCollection.path);
+                } catch (const Exception& e) {
+                    error = e.what();
+                }
+
+                lock.lock();
+                m_loadedCollections.emplace_back(pendingCollection.path, std::move(collection), error);
+                --m_activeLoads;
+                m_loadCondition.notify_all();
+
+                if (m_collectionLoadedCallback) {
+                    m_collectionLoadedCallback();
+                }
+            }
         }
 
         TextureManager::TextureCollectionMap TextureManager::collectionMap() const {
@@ -101,8 +333,15 @@ namespace TrenchBroom {
 
         void TextureManager::addTextureCollection(Assets::TextureCollection* collection) {
             m_collections.push_back(collection);
-            if (collection->loaded() && !collection->prepared()) {
-                m_toPrepare.push_back(collection);
+            registerTextureCollection(collection);
+        }
+
+        void TextureManager::registerTextureCollection(Assets::TextureCollection* collection) {
+            if (collection->loaded()) {
+                collection->setResidency(&m_residency);
+                for (auto* texture : collection->textures()) {
+                    m_residency.add(texture, texture->videoMemoryUsage(), texture->isPrepared());
+                }
             }
 
             if (m_logger != nullptr) {
@@ -111,11 +350,14 @@ namespace TrenchBroom {
         }
 
         void TextureManager::clear() {
+            cancelLoads();
+
             VectorUtils::clearAndDelete(m_collections);
             VectorUtils::clearAndDelete(m_toRemove);
             
-            m_toPrepare.clear();
+            m_residency.clear();
             m_texturesByName.clear();
+            m_texturesById.clear();
             m_textures.clear();
             
             // Remove logging because it might fail when the document is already destroyed.
@@ -127,11 +369,31 @@ namespace TrenchBroom {
             m_resetTextureMode = true;
         }
 
+        void TextureManager::setUploadBudget(const size_t uploadBudget) {
+            m_uploadBudget = uploadBudget;
+        }
+
+        void TextureManager::setResidencyBudget(const size_t residencyBudget) {
+            m_residency.setBudget(residencyBudget);
+        }
+
+        const TextureResidency& TextureManager::residency() const {
+            return m_residency;
+        }
+
         void TextureManager::commitChanges() {
             resetTextureMode();
-            prepare();
+            updateResidency();
             VectorUtils::clearAndDelete(m_toRemove);
         }
+
+        bool TextureManager::hasPendingChanges() const {
+            return m_residency.hasPendingUploads() || !m_toRemove.empty();
+        }
+
+        void TextureManager::nextFrame() {
+            m_residency.nextFrame();
+        }
         
         Texture* TextureManager::texture(const String& name) const {
             auto it = m_texturesByName.find(StringUtils::toLower(name));
@@ -142,6 +404,15 @@ namespace TrenchBroom {
             }
         }
         
+        Texture* TextureManager::texture(const TextureName& name) const {
+            const auto id = name.caseInsensitiveId();
+            if (id >= m_texturesById.size()) {
+                return nullptr;
+            } else {
+                return m_texturesById[id];
+            }
+        }
+
         const TextureList& TextureManager::textures() const {
             return m_textures;
         }
@@ -158,6 +429,14 @@ namespace TrenchBroom {
             return result;
         }
         
+        size_t TextureManager::memoryUsage() const {
+            size_t result = heapMemoryUsage(m_textures) + heapMemoryUsage(m_texturesById);
+            for (const TextureCollection* collection : m_collections) {
+                result += collection->memoryUsage();
+            }
+            return result;
+        }
+
         void TextureManager::resetTextureMode() {
             if (m_resetTextureMode) {
                 std::for_each(std::begin(m_collections), std::end(m_collections),
@@ -166,10 +445,22 @@ namespace TrenchBroom {
             }
         }
         
-        void TextureManager::prepare() {
-            std::for_each(std::begin(m_toPrepare), std::end(m_toPrepare),
-                          [this](auto collection) { collection->prepare(m_minFilter, m_magFilter); });
-            m_toPrepare.clear();
+        void TextureManager::updateResidency() {
+            const auto changes = m_residency.update(m_uploadBudget);
+            for (auto* texture : changes.evict) {
+                texture->unprepare();
+            }
+            for (auto* texture : changes.upload) {
+                texture->prepare(m_minFilter, m_magFilter);
+            }
+        }
+
+        void TextureManager::removeTextureCollection(TextureCollection* collection) {
+            for (const auto* texture : collection->textures()) {
+                m_residency.remove(texture);
+            }
+            collection->setResidency(nullptr);
+            m_toRemove.push_back(collection);
         }
         
         void TextureManager::updateTextures() {
@@ -192,6 +483,15 @@ namespace TrenchBroom {
             }
 
             m_textures = MapUtils::valueList(m_texturesByName);
+
+            m_texturesById.clear();
+            for (const auto& entry : m_texturesByName) {
+                const auto id = entry.second->internedName().caseInsensitiveId();
+                if (id >= m_texturesById.size()) {
+                    m_texturesById.resize(id + 1, nullptr);
+                }
+                m_texturesById[id] = entry.second;
+            }
         }
     }
 }
@@ -22,10 +22,18 @@
 
 #include "Notifier.h"
 #include "Assets/AssetTypes.h"
+#include "Assets/TextureResidency.h"
 #include "IO/Path.h"
 #include "Model/ModelTypes.h"
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
 #include <vector>
 
 namespace TrenchBroom {
@@ -36,25 +44,79 @@ namespace TrenchBroom {
     }
     
     namespace Assets {
+        class TextureName;
+
+        /**
+         * Manages the texture collections of a map and uploads their textures.
+         *
+         * Collections are either loaded synchronously by calling setTextureCollections(), or on a background thread by
+         * calling requestTextureCollections(). Background loads are handed back to the manager when
+         * collectLoadedCollections() is called, so the collections and the texture lookup tables are only ever
+         * accessed from the thread that owns the manager. Until a collection has been loaded, it is represented by an
+         * empty placeholder collection, and faces that use its textures have no texture.
+         */
         class TextureManager {
+        public:
+            typedef std::function<std::unique_ptr<IO::TextureLoader>(Logger* logger)> TextureLoaderFactory;
+
+            /**
+             * The number of bytes of texture data that commitChanges uploads at most, not counting the last texture.
+             */
+            static const size_t DefaultUploadBudget;
         private:
             typedef std::map<IO::Path, TextureCollection*> TextureCollectionMap;
             typedef std::pair<IO::Path, TextureCollection*> TextureCollectionMapEntry;
             typedef std::map<String, Texture*> TextureMap;
+
+            class LoadLogger;
+
+            struct PendingCollection {
+                IO::Path path;
+                std::shared_ptr<IO::TextureLoader> loader;
+
+                PendingCollection(const IO::Path& i_path, std::shared_ptr<IO::TextureLoader> i_loader);
+            };
+
+            struct LoadedCollection {
+                IO::Path path;
+                std::unique_ptr<TextureCollection> collection;
+                String error;
+
+                LoadedCollection(const IO::Path& i_path, std::unique_ptr<TextureCollection> i_collection, const String& i_error);
+            };
             
             Logger* m_logger;
             
             TextureCollectionList m_collections;
             
-            TextureCollectionList m_toPrepare;
             TextureCollectionList m_toRemove;
+            TextureResidency m_residency;
             
             TextureMap m_texturesByName;
+            // indexed by the case insensitive ID of the texture names, see TextureName
+            TextureList m_texturesById;
             TextureList m_textures;
             
             int m_minFilter;
             int m_magFilter;
             bool m_resetTextureMode;
+            size_t m_uploadBudget;
+
+            std::set<IO::Path> m_pendingCollections;
+            size_t m_loadGeneration;
+
+            // the loaders log to this while loading in the background, the messages are logged when the loads are collected
+            std::unique_ptr<LoadLogger> m_loadLogger;
+
+            // shared with the worker thread, guarded by m_loadMutex
+            mutable std::mutex m_loadMutex;
+            std::condition_variable m_loadCondition;
+            std::deque<PendingCollection> m_loadQueue;
+            std::vector<LoadedCollection> m_loadedCollections;
+            size_t m_activeLoads;
+            std::thread m_worker;
+            bool m_stopWorker;
+            std::function<void()> m_collectionLoadedCallback;
         public:
             Notifier0 usageCountDidChange;
         public:
@@ -62,22 +124,108 @@ namespace TrenchBroom {
             ~TextureManager();
 
             void setTextureCollections(const IO::Path::List& paths, IO::TextureLoader& loader);
+
+            /**
+             * Like setTextureCollections(), but the collections that have not been loaded yet are loaded on a
+             * background thread, so this returns without decoding any textures. The loaded collections replace their
+             * placeholders when collectLoadedCollections() is called. Pending loads of a previous call are cancelled.
+             *
+             * The loader is created on the calling thread by the given factory and used by the background thread until
+             * its loads have finished or have been cancelled. It must log to the logger passed to the factory.
+             */
+            void requestTextureCollections(const IO::Path::List& paths, const TextureLoaderFactory& createLoader);
+
+            /**
+             * Sets a function that is called whenever a collection has been loaded in the background. The function is
+             * called on the loading thread, so it must not access the manager. It can be used to wake up the thread
+             * that owns the manager so that it calls collectLoadedCollections().
+             */
+            void setCollectionLoadedCallback(std::function<void()> callback);
+
+            /**
+             * Indicates whether any collections that have been loaded in the background are waiting to be collected.
+             */
+            bool hasLoadedCollections() const;
+
+            /**
+             * Replaces the placeholders of the collections that have been loaded in the background since the last
+             * call. The textures of the affected faces must be updated afterwards.
+             *
+             * @return true if any placeholders were replaced
+             */
+            bool collectLoadedCollections();
+
+            /**
+             * Indicates whether any collections are still being loaded in the background.
+             */
+            bool loading() const;
+
+            /**
+             * Returns a counter that is incremented whenever collections loaded in the background are collected.
+             */
+            size_t loadGeneration() const;
+
+            /**
+             * Discards all pending background loads and waits until the load in progress has finished. Must be called
+             * before the file system that the loaders read from is changed. Called by clear().
+             */
+            void cancelLoads();
         private:
             TextureCollectionMap collectionMap() const;
             void addTextureCollection(Assets::TextureCollection* collection);
+            void registerTextureCollection(Assets::TextureCollection* collection);
+            void startWorker();
+            void stopWorker();
+            void runWorker();
         public:
             void clear();
             
             void setTextureMode(int minFilter, int magFilter);
+            void setUploadBudget(size_t uploadBudget);
+
+            /**
+             * Sets the number of bytes of video memory that the uploaded textures may occupy. Once this is exceeded,
+             * the least recently used textures are evicted.
+             */
+            void setResidencyBudget(size_t residencyBudget);
+            const TextureResidency& residency() const;
+
+            /**
+             * Uploads the textures that have been used since the last call, evicts textures that exceed the residency
+             * budget and deletes removed texture collections. A texture is used when a face references it or when it
+             * is activated for rendering.
+             *
+             * To keep the frame time low, textures are uploaded in batches of at most the upload budget, so this must
+             * be called repeatedly until hasPendingChanges returns false. Textures that have not been uploaded yet are
+             * not prepared and should be rendered using their average color.
+             */
             void commitChanges();
+            bool hasPendingChanges() const;
+
+            /**
+             * Starts a new frame. Textures that were used in the current frame are not evicted by commitChanges, so
+             * this must be called once per rendered frame and not by the individual views.
+             */
+            void nextFrame();
             
             Texture* texture(const String& name) const;
+            /**
+             * Finds the texture with the given name regardless of case. Unlike the other overload, this doesn't
+             * need a string comparison.
+             */
+            Texture* texture(const TextureName& name) const;
             const TextureList& textures() const;
             const TextureCollectionList& collections() const;
             const StringList collectionNames() const;
+
+            /**
+             * Returns the number of bytes occupied by the loaded texture collections in main memory.
+             */
+            size_t memoryUsage() const;
         private:
             void resetTextureMode();
-            void prepare();
+            void updateResidency();
+            void removeTextureCollection(TextureCollection* collection);
 
             void updateTextures();
         };
@@ -0,0 +1,145 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TextureName.h"
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace TrenchBroom {
+    namespace Assets {
+        struct TextureName::Entry {
+            String name;
+            Id id;
+            Id caseInsensitiveId;
+
+            Entry(const std::string_view i_name, const Id i_id) :
+            name(i_name),
+            id(i_id),
+            caseInsensitiveId(i_id) {}
+        };
+
+        class TextureName::Table {
+        private:
+            std::mutex m_mutex;
+            // a deque never moves its elements, so the keys of the index can refer to the names of the entries
+            std::deque<Entry> m_entries;
+            std::unordered_map<std::string_view, const Entry*> m_index;
+            const Entry* m_empty;
+        public:
+            static Table& instance() {
+                static Table table;
+                return table;
+            }
+
+            const Entry* empty() {
+                return m_empty;
+            }
+
+            const Entry* intern(const std::string_view name) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return doIntern(name);
+            }
+
+            const Entry* find(const std::string_view name) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                const auto it = m_index.find(name);
+                return it != std::end(m_index) ? it->second : nullptr;
+            }
+
+            size_t count() {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_entries.size();
+            }
+        private:
+            Table() :
+            m_empty(doIntern("")) {}
+
+            const Entry* doIntern(const std::string_view name) {
+                const auto it = m_index.find(name);
+                if (it != std::end(m_index)) {
+                    return it->second;
+                }
+
+                auto& entry = m_entries.emplace_back(name, m_entries.size());
+                m_index.insert(std::make_pair(std::string_view(entry.name), &entry));
+
+                const auto lowerName = StringUtils::toLower(entry.name);
+                if (lowerName != entry.name) {
+                    entry.caseInsensitiveId = doIntern(lowerName)->id;
+                }
+                return &entry;
+            }
+        };
+
+        TextureName::TextureName() :
+        m_entry(Table::instance().empty()) {}
+
+        TextureName::TextureName(const String& name) :
+        m_entry(intern(name)) {}
+
+        TextureName::TextureName(const std::string_view name) :
+        m_entry(intern(name)) {}
+
+        TextureName::TextureName(const Entry* entry) :
+        m_entry(entry) {}
+
+        const String& TextureName::name() const {
+            return m_entry->name;
+        }
+
+        TextureName::Id TextureName::id() const {
+            return m_entry->id;
+        }
+
+        TextureName::Id TextureName::caseInsensitiveId() const {
+            return m_entry->caseInsensitiveId;
+        }
+
+        bool TextureName::empty() const {
+            return m_entry->name.empty();
+        }
+
+        bool TextureName::operator==(const TextureName& other) const {
+            return m_entry == other.m_entry;
+        }
+
+        bool TextureName::operator!=(const TextureName& other) const {
+            return m_entry != other.m_entry;
+        }
+
+        bool TextureName::find(const std::string_view name, TextureName& result) {
+            const Entry* entry = Table::instance().find(name);
+            if (entry == nullptr) {
+                return false;
+            }
+            result = TextureName(entry);
+            return true;
+        }
+
+        size_t TextureName::count() {
+            return Table::instance().count();
+        }
+
+        const TextureName::Entry* TextureName::intern(const std::string_view name) {
+            return Table::instance().intern(name);
+        }
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_TextureName
+#define TrenchBroom_TextureName
+
+#include "StringUtils.h"
+
+#include <cstddef>
+#include <string_view>
+
+namespace TrenchBroom {
+    namespace Assets {
+        /**
+         * An interned texture name. Every distinct name is stored only once in a global table, and a texture name
+         * only refers to its entry in that table. Copying and comparing texture names are therefore cheap integer
+         * operations, and a map with many faces stores each of its texture names only once.
+         *
+         * Each name has an ID that is unique among all interned names, and the IDs are assigned consecutively
+         * starting at 0, so they can be used to index arrays. Since textures are looked up regardless of case, each
+         * name also knows the ID of its lower case variant.
+         *
+         * Interning a name is thread safe. The table is never shrunk, which is fine because the number of distinct
+         * texture names is small.
+         */
+        class TextureName {
+        public:
+            using Id = size_t;
+        private:
+            struct Entry;
+            class Table;
+            const Entry* m_entry;
+        public:
+            /**
+             * Creates the empty texture name, which has ID 0.
+             */
+            TextureName();
+            explicit TextureName(const String& name);
+            explicit TextureName(std::string_view name);
+
+            const String& name() const;
+            Id id() const;
+            Id caseInsensitiveId() const;
+            bool empty() const;
+
+            bool operator==(const TextureName& other) const;
+            bool operator!=(const TextureName& other) const;
+
+            /**
+             * Looks up the given name without interning it, so that looking up arbitrary names, e.g. names
+             * entered by the user, does not grow the table.
+             *
+             * @param name the name to look up
+             * @param result set to the interned name if it was found
+             * @return true if the name has been interned before, and false otherwise
+             */
+            static bool find(std::string_view name, TextureName& result);
+
+            /**
+             * Returns the number of names that have been interned so far. All IDs are less than this number.
+             */
+            static size_t count();
+        private:
+            explicit TextureName(const Entry* entry);
+
+            static const Entry* intern(std::string_view name);
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_TextureName) */
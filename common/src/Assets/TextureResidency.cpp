@@ -0,0 +1,155 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "TextureResidency.h"
+
+#include "Ensure.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <limits>
+
+namespace TrenchBroom {
+    namespace Assets {
+        const size_t TextureResidency::DefaultBudget = 512u * 1024u * 1024u;
+        static const size_t NeverUsed = std::numeric_limits<size_t>::max();
+
+        TextureResidency::TextureResidency(const size_t budget) :
+        m_budget(budget),
+        m_residentBytes(0),
+        m_frame(0) {}
+
+        size_t TextureResidency::budget() const {
+            return m_budget;
+        }
+
+        void TextureResidency::setBudget(const size_t budget) {
+            m_budget = budget;
+        }
+
+        size_t TextureResidency::residentBytes() const {
+            return m_residentBytes;
+        }
+
+        bool TextureResidency::resident(const Texture* texture) const {
+            const auto it = m_entries.find(texture);
+            return it != std::end(m_entries) && it->second.resident;
+        }
+
+        void TextureResidency::add(Texture* texture, const size_t size, const bool resident) {
+            ensure(texture != nullptr, "texture is null");
+            const auto result = m_entries.insert(std::make_pair(texture, Entry{ texture, size, false, false, NeverUsed, std::end(m_lru) }));
+            if (resident && result.second) {
+                auto& entry = result.first->second;
+                entry.resident = true;
+                entry.lruPosition = m_lru.insert(std::end(m_lru), texture);
+                m_residentBytes += size;
+            }
+        }
+
+        void TextureResidency::remove(const Texture* texture) {
+            const auto it = m_entries.find(texture);
+            if (it == std::end(m_entries)) {
+                return;
+            }
+
+            auto& entry = it->second;
+            if (entry.resident) {
+                m_lru.erase(entry.lruPosition);
+                m_residentBytes -= entry.size;
+            }
+            if (entry.requested) {
+                m_requested.erase(std::remove(std::begin(m_requested), std::end(m_requested), entry.texture), std::end(m_requested));
+            }
+            m_entries.erase(it);
+        }
+
+        void TextureResidency::clear() {
+            m_entries.clear();
+            m_requested.clear();
+            m_lru.clear();
+            m_residentBytes = 0;
+        }
+
+        void TextureResidency::use(const Texture* texture) {
+            const auto it = m_entries.find(texture);
+            if (it == std::end(m_entries)) {
+                return;
+            }
+
+            auto& entry = it->second;
+            entry.lastUse = m_frame;
+            if (entry.resident) {
+                m_lru.splice(std::begin(m_lru), m_lru, entry.lruPosition);
+            } else if (!entry.requested) {
+                entry.requested = true;
+                m_requested.push_back(entry.texture);
+            }
+        }
+
+        bool TextureResidency::hasPendingUploads() const {
+            return !m_requested.empty();
+        }
+
+        TextureResidency::Changes TextureResidency::update(const size_t uploadBudget) {
+            Changes changes;
+
+            size_t uploaded = 0;
+            auto it = std::begin(m_requested);
+            while (it != std::end(m_requested) && uploaded < uploadBudget) {
+                auto& entry = m_entries.at(*it++);
+                entry.requested = false;
+                entry.resident = true;
+                entry.lastUse = m_frame;
+                entry.lruPosition = m_lru.insert(std::begin(m_lru), entry.texture);
+                m_residentBytes += entry.size;
+                uploaded += entry.size;
+                changes.upload.push_back(entry.texture);
+            }
+            m_requested.erase(std::begin(m_requested), it);
+
+            // the LRU list is ordered by the time of last use, so once we find a texture that was used in this frame,
+            // all remaining textures were used in this frame, too
+            while (m_residentBytes > m_budget && !m_lru.empty()) {
+                auto& entry = m_entries.at(m_lru.back());
+                if (entry.lastUse == m_frame) {
+                    break;
+                }
+                evict(entry, changes);
+            }
+
+            return changes;
+        }
+
+        void TextureResidency::nextFrame() {
+            ++m_frame;
+        }
+
+        void TextureResidency::evict(Entry& entry, Changes& changes) {
+            assert(entry.resident);
+            m_lru.erase(entry.lruPosition);
+            entry.lruPosition = std::end(m_lru);
+            entry.resident = false;
+            m_residentBytes -= entry.size;
+            changes.evict.push_back(entry.texture);
+        }
+    }
+}
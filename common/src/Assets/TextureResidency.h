@@ -0,0 +1,139 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TrenchBroom_TextureResidency
+#define TrenchBroom_TextureResidency
+
+#include "Assets/AssetTypes.h"
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+
+namespace TrenchBroom {
+    namespace Assets {
+        /**
+         * Decides which textures are kept in video memory. A texture is uploaded when it is first used, i.e. when
+         * a face references it or when it is drawn, and the least recently used textures are evicted when the
+         * uploaded textures exceed the budget.
+         *
+         * This class only makes decisions and never calls OpenGL; the caller uploads and evicts the textures
+         * returned by update. This allows testing the policy without a GL context.
+         */
+        class TextureResidency {
+        public:
+            /**
+             * The default number of bytes of video memory that uploaded textures may occupy.
+             */
+            static const size_t DefaultBudget;
+
+            struct Changes {
+                TextureList upload;
+                TextureList evict;
+            };
+        private:
+            using LruList = std::list<Texture*>;
+
+            struct Entry {
+                Texture* texture;
+                size_t size;
+                bool resident;
+                bool requested;
+                // the frame in which the texture was last used
+                size_t lastUse;
+                // the position in the LRU list if the texture is resident
+                LruList::iterator lruPosition;
+            };
+
+            std::unordered_map<const Texture*, Entry> m_entries;
+            // textures that were used but are not resident, in the order of their first use
+            TextureList m_requested;
+            // the resident textures, the most recently used texture comes first
+            LruList m_lru;
+
+            size_t m_budget;
+            size_t m_residentBytes;
+            size_t m_frame;
+        public:
+            explicit TextureResidency(size_t budget = DefaultBudget);
+
+            size_t budget() const;
+            void setBudget(size_t budget);
+
+            /**
+             * Returns the number of bytes of video memory occupied by the resident textures.
+             */
+            size_t residentBytes() const;
+            bool resident(const Texture* texture) const;
+
+            /**
+             * Registers the given texture. Textures that are not registered are ignored by use.
+             *
+             * @param texture the texture
+             * @param size the number of bytes the texture occupies in video memory
+             * @param resident whether the texture has already been uploaded
+             */
+            void add(Texture* texture, size_t size, bool resident = false);
+
+            /**
+             * Unregisters the given texture. If the texture is resident, the caller must release its video memory.
+             */
+            void remove(const Texture* texture);
+            void clear();
+
+            /**
+             * Marks the given texture as used in the current frame. If it is not resident, it will be uploaded by the
+             * next call to update.
+             */
+            void use(const Texture* texture);
+
+            /**
+             * Indicates whether there are textures that have been used, but not uploaded yet.
+             */
+            bool hasPendingUploads() const;
+
+            /**
+             * Returns the textures that must be uploaded and evicted. Requested textures are uploaded in the order in
+             * which they were first used until the given number of bytes has been uploaded; the last texture may
+             * exceed the budget. Then the least recently used textures are evicted until the resident textures fit
+             * into the budget again. Textures that were used in the current frame are never evicted, so the budget
+             * may be exceeded if a single frame uses more textures than fit into it.
+             *
+             * This may be called several times per frame, e.g. once for every view that renders the textures.
+             *
+             * The caller should evict textures before uploading new ones.
+             *
+             * @param uploadBudget the maximum number of bytes to upload
+             * @return the textures to upload and to evict
+             */
+            Changes update(size_t uploadBudget);
+
+            /**
+             * Starts a new frame. Call this once per rendered frame, not once per view, otherwise the textures used by
+             * one view may be evicted when another view is rendered.
+             */
+            void nextFrame();
+        private:
+            void evict(Entry& entry, Changes& changes);
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_TextureResidency) */
@@ -22,6 +22,8 @@
 
 #include "Ensure.h"
 
+#include <cassert>
+#include <cstddef>
 #include <iterator>
 
 template <typename Item, typename GetLink>
@@ -71,140 +73,61 @@ public:
             swap(m_previous, m_next);
         }
     };
-private:
-    template <typename ListType, typename ItemType, typename LinkType>
-    class iterator_delegate_item;
-
-    template <typename ListType, typename ItemType, typename LinkType>
-    class iterator_delegate_end;
-
-    template <typename ListType, typename ItemType, typename LinkType>
-    class iterator_delegate_base {
-    protected:
-        ListType* m_list;
-    private:
-        size_t m_listVersion;
-    protected:
-        iterator_delegate_base(ListType& list) :
-                m_list(&list),
-                m_listVersion(m_list->m_version) {}
-    public:
-        virtual ~iterator_delegate_base() {}
-    public:
-        iterator_delegate_base* clone() const { return doClone(); }
-
-        int compare(const iterator_delegate_base& other) const {
-            if (index() < other.index())
-                return -1;
-            if (index() > other.index())
-                return 1;
-            return 0;
-        }
-
-        void increment()      { assert(checkListVersion()); doIncrement(); }
-        size_t index() const  { assert(checkListVersion()); return doGetIndex(); }
-        ItemType& reference() { assert(checkListVersion()); return doGetItem(); }
-        ItemType item()       { assert(checkListVersion()); return doGetItem(); }
-    private:
-        bool checkListVersion() const { return m_listVersion == m_list->m_version; }
-    private:
-        virtual iterator_delegate_base* doClone() const = 0;
-        virtual void doIncrement() = 0;
-        virtual size_t doGetIndex() const = 0;
-        virtual ItemType& doGetItem() = 0;
-    };
-
-    template <typename ListType, typename ItemType, typename LinkType>
-    class iterator_delegate_item : public iterator_delegate_base<ListType, ItemType, LinkType> {
-    private:
-        using base = iterator_delegate_base<ListType, ItemType, LinkType>;
-        ItemType m_item;
-        size_t m_index;
-    public:
-        iterator_delegate_item(ListType& list, ItemType item, const size_t index) :
-                base(list),
-                m_item(item),
-                m_index(index) {}
-    private:
-        base* doClone() const override {
-            return new iterator_delegate_item(*base::m_list, m_item, m_index);
-        }
-
-        void doIncrement() override {
-            ++m_index;
-
-            LinkType& link = base::m_list->getLink(m_item);
-            m_item = link.next();
-        }
-
-        size_t doGetIndex() const override {
-            return m_index;
-        }
-
-        ItemType& doGetItem() override {
-            assert(m_index < base::m_list->size());
-            return m_item;
-        }
-    };
-
-    template <typename ListType, typename ItemType, typename LinkType>
-    class iterator_delegate_end : public iterator_delegate_base<ListType, ItemType, LinkType> {
-    private:
-        using base = iterator_delegate_base<ListType, ItemType, LinkType>;
-    public:
-        iterator_delegate_end(ListType& list) :
-                base(list) {}
-    private:
-        base* doClone() const override {
-            return new iterator_delegate_end(*base::m_list);
-        }
-
-        void doIncrement() override {}
-
-        size_t doGetIndex() const override {
-            return base::m_list->size();
-        }
-
-        ItemType& doGetItem() override {
-            static ItemType null = nullptr;
-            return null;
-        }
-    };
 public:
+    /**
+     * Iterates over the items of a list. An iterator stores the current item and its index, so it can be
+     * copied without allocating memory. Iterators are ordered and compared by their index, and the end
+     * iterator has the index of the list size.
+     *
+     * In debug builds, the iterator also stores the version of the list when it was created and asserts that
+     * the list was not modified when it is used.
+     */
     template <typename ListType, typename ItemType, typename LinkType>
     class iterator_base {
     public:
         using iterator_category = std::forward_iterator_tag;
         using difference_type = std::ptrdiff_t;
         using value_type = ItemType;
-        using pointer = ItemType*;
-        using reference = ItemType&;
+        using pointer = const ItemType*;
+        using reference = const ItemType&;
     private:
         friend class DoublyLinkedList<Item, GetLink>;
 
-        using delegate = iterator_delegate_base<ListType, ItemType, LinkType>;
-        delegate* m_delegate;
+        ListType* m_list;
+        ItemType m_item;
+        size_t m_index;
+#ifndef NDEBUG
+        size_t m_listVersion;
+#endif
+    public:
+        iterator_base() :
+                m_list(nullptr),
+                m_item(nullptr),
+                m_index(0)
+#ifndef NDEBUG
+                , m_listVersion(0)
+#endif
+        {}
+    private:
+        iterator_base(ListType& list, ItemType item, const size_t index) :
+                m_list(&list),
+                m_item(item),
+                m_index(index)
+#ifndef NDEBUG
+                , m_listVersion(list.m_version)
+#endif
+        {}
     public:
-        iterator_base(delegate* delegate = nullptr) : m_delegate(delegate) {}
-        iterator_base(const iterator_base& other) : m_delegate(other.m_delegate->clone()) {}
-        ~iterator_base() { delete m_delegate; }
-
         static iterator_base begin(ListType& list) {
             return item(list, list.m_head, 0);
         }
 
         static iterator_base item(ListType& list, Item* item, const size_t index) {
-            return iterator_base(new iterator_delegate_item<ListType, ItemType, LinkType>(list, item, index));
+            return iterator_base(list, item, index);
         }
 
         static iterator_base end(ListType& list) {
-            return iterator_base(new iterator_delegate_end<ListType, ItemType, LinkType>(list));
-        }
-
-        iterator_base& operator=(const iterator_base& other) {
-            delete m_delegate;
-            m_delegate = other.m_delegate->clone();
-            return *this;
+            return iterator_base(list, nullptr, list.size());
         }
 
         bool operator<(const iterator_base& other) const  { return compare(other) <  0; }
@@ -214,30 +137,51 @@ public:
 
         // prefix increment
         iterator_base& operator++() {
-            m_delegate->increment();
+            assert(checkListVersion());
+            assert(m_index < m_list->size());
+
+            ++m_index;
+            LinkType& link = m_list->getLink(m_item);
+            m_item = link.next();
             return *this;
         }
 
         // postfix increment
         iterator_base operator++(int) {
             iterator_base result(*this);
-            m_delegate->increment();
+            ++*this;
             return result;
         }
 
-        ItemType& operator*() const { return m_delegate->reference(); }
-        ItemType operator->() const { return m_delegate->item(); }
+        reference operator*() const {
+            assert(checkListVersion());
+            assert(m_index < m_list->size());
+            return m_item;
+        }
+
+        ItemType operator->() const {
+            return **this;
+        }
     private:
         int compare(const iterator_base& other) const {
-            ensure(m_delegate != nullptr, "delegate is null");
-            ensure(other.m_delegate != nullptr, "other delegate is null");
-            return m_delegate->compare(*other.m_delegate);
+            if (index() < other.index())
+                return -1;
+            if (index() > other.index())
+                return 1;
+            return 0;
         }
 
         size_t index() const {
-            ensure(m_delegate != nullptr, "delegate is null");
-            return m_delegate->index();
+            ensure(m_list != nullptr, "list is null");
+            assert(checkListVersion());
+            return m_index;
         }
+
+#ifndef NDEBUG
+        bool checkListVersion() const {
+            return m_listVersion == m_list->m_version;
+        }
+#endif
     };
 
     using iterator       = iterator_base<      DoublyLinkedList<Item, GetLink>, Item*,       Link>;
@@ -33,10 +33,13 @@
 
 namespace TrenchBroom {
     namespace IO {
+        class FileSystemIndex;
         class Path;
         
         class FileSystem {
             deleteCopyAndMove(FileSystem)
+            // the index enumerates and opens the files of each file system in the chain separately
+            friend class FileSystemIndex;
         protected:
             std::unique_ptr<FileSystem> m_next;
         public: // public API
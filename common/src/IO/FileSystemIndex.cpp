@@ -0,0 +1,151 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FileSystemIndex.h"
+
+#include "Exceptions.h"
+#include "IO/FileSystem.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace TrenchBroom {
+    namespace IO {
+        FileSystemIndex::Entry::Entry(const FileSystem* i_fileSystem, const Path& i_path, const bool i_directory) :
+        fileSystem(i_fileSystem),
+        path(i_path),
+        directory(i_directory) {}
+
+        /**
+         * Compares the given keys like strings, except that the path separator is ordered before every other
+         * character. This way, the descendants of an item immediately follow it even if a sibling's name extends
+         * the item's name, e.g. "gfx" < "gfx/palette.lmp" < "gfx.wad".
+         */
+        static bool keyLess(const String& lhs, const String& rhs) {
+            const auto rank = [](const char c) {
+                return c == '/' ? 0 : static_cast<int>(static_cast<unsigned char>(c)) + 1;
+            };
+            return std::lexicographical_compare(std::begin(lhs), std::end(lhs), std::begin(rhs), std::end(rhs),
+                                                [&](const char l, const char r) { return rank(l) < rank(r); });
+        }
+
+        FileSystemIndex::FileSystemIndex() = default;
+
+        void FileSystemIndex::build(const FileSystem& fileSystem) {
+            clear();
+
+            std::unordered_map<String, Entry> entries;
+            const auto add = [&](const FileSystem* owner, const Path& path, const bool directory) {
+                // the first file system to contain an item shadows the following ones
+                entries.emplace(key(path), Entry(owner, path, directory));
+            };
+
+            for (const FileSystem* current = &fileSystem; current != nullptr; current = current->m_next.get()) {
+                Path::List unused;
+                current->doFindItems(Path(""), [&](const Path& path, const bool directory) {
+                    // make sure that every item can be found when scanning the contents of its parents
+                    for (auto parent = path.deleteLastComponent(); !parent.isEmpty(); parent = parent.deleteLastComponent()) {
+                        add(current, parent, true);
+                    }
+                    add(current, path, directory);
+                    return false;
+                }, true, unused);
+            }
+
+            m_entries.reserve(entries.size());
+            for (auto& entry : entries) {
+                m_entries.emplace_back(entry.first, std::move(entry.second));
+            }
+            std::sort(std::begin(m_entries), std::end(m_entries), [](const KeyedEntry& lhs, const KeyedEntry& rhs) { return keyLess(lhs.first, rhs.first); });
+
+            m_lookup.reserve(m_entries.size());
+            for (size_t i = 0; i < m_entries.size(); ++i) {
+                m_lookup.emplace(m_entries[i].first, i);
+            }
+        }
+
+        void FileSystemIndex::clear() {
+            m_lookup.clear();
+            m_entries.clear();
+        }
+
+        bool FileSystemIndex::empty() const {
+            return m_entries.empty();
+        }
+
+        size_t FileSystemIndex::size() const {
+            return m_entries.size();
+        }
+
+        const FileSystemIndex::Entry* FileSystemIndex::find(const Path& path) const {
+            const auto it = m_lookup.find(key(path));
+            if (it == std::end(m_lookup)) {
+                return nullptr;
+            }
+            return &m_entries[it->second].second;
+        }
+
+        bool FileSystemIndex::directoryExists(const Path& path) const {
+            if (path.isEmpty()) {
+                return true;
+            }
+            const auto* entry = find(path);
+            return entry != nullptr && entry->directory;
+        }
+
+        bool FileSystemIndex::fileExists(const Path& path) const {
+            const auto* entry = find(path);
+            return entry != nullptr && !entry->directory;
+        }
+
+        Path::List FileSystemIndex::directoryContents(const Path& directoryPath) const {
+            const auto prefix = directoryPath.isEmpty() ? String() : key(directoryPath) + "/";
+            const auto pastPrefix = [&](const EntryList::const_iterator from, const String& value) {
+                // the entries that start with the given value form a contiguous range
+                return std::partition_point(from, std::end(m_entries), [&](const KeyedEntry& entry) { return StringUtils::isPrefix(entry.first, value); });
+            };
+
+            Path::List result;
+
+            auto it = std::lower_bound(std::begin(m_entries), std::end(m_entries), prefix, [](const KeyedEntry& entry, const String& value) { return keyLess(entry.first, value); });
+            const auto end = pastPrefix(it, prefix);
+            while (it != end) {
+                result.push_back(it->second.path.lastComponent());
+
+                // skip the descendants of the current item, they follow it immediately
+                const auto childPrefix = it->first + "/";
+                it = pastPrefix(std::next(it), childPrefix);
+            }
+
+            return result;
+        }
+
+        MappedFile::Ptr FileSystemIndex::openFile(const Path& path) const {
+            const auto* entry = find(path);
+            if (entry == nullptr || entry->directory) {
+                throw FileSystemException("File not found: '" + path.asString() + "'");
+            }
+            return entry->fileSystem->doOpenFile(entry->path);
+        }
+
+        String FileSystemIndex::key(const Path& path) {
+            return StringUtils::toLower(path.asString('/'));
+        }
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_FileSystemIndex
+#define TrenchBroom_FileSystemIndex
+
+#include "Macros.h"
+#include "StringUtils.h"
+#include "IO/MappedFile.h"
+#include "IO/Path.h"
+
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        class FileSystem;
+
+        /**
+         * A case insensitive index of the files and directories of a chain of file systems.
+         *
+         * The index is built once from the contents of every file system in the chain. If an item exists in more
+         * than one file system, the index refers to the file system that comes first in the chain, so that the
+         * lookups return the same results as walking the chain. Lookups are a single hash table probe, and
+         * directory contents are found by scanning a range of the sorted entries.
+         *
+         * The index is a snapshot. Items that are added to or removed from the file systems after the index was
+         * built are not reflected until it is rebuilt.
+         */
+        class FileSystemIndex {
+            deleteCopyAndMove(FileSystemIndex)
+        public:
+            struct Entry {
+                const FileSystem* fileSystem;
+                Path path;
+                bool directory;
+
+                Entry(const FileSystem* i_fileSystem, const Path& i_path, bool i_directory);
+            };
+        private:
+            using KeyedEntry = std::pair<String, Entry>;
+            using EntryList = std::vector<KeyedEntry>;
+            using EntryMap = std::unordered_map<std::string_view, size_t>;
+
+            // sorted by key, which is the lower case path, with the path separator ordered before every other character
+            EntryList m_entries;
+            // maps the keys to positions in m_entries
+            EntryMap m_lookup;
+        public:
+            FileSystemIndex();
+
+            /**
+             * Replaces the contents of this index with the contents of the given file system and the file systems
+             * it is chained to.
+             */
+            void build(const FileSystem& fileSystem);
+            void clear();
+
+            bool empty() const;
+            size_t size() const;
+
+            /**
+             * Returns the entry for the given path, or nullptr if no file system contains it.
+             */
+            const Entry* find(const Path& path) const;
+
+            bool directoryExists(const Path& path) const;
+            bool fileExists(const Path& path) const;
+
+            /**
+             * Returns the names of the files and directories in the given directory.
+             */
+            Path::List directoryContents(const Path& directoryPath) const;
+
+            /**
+             * Opens the given file in the file system that contains it.
+             *
+             * @throw FileSystemException if the file is not in this index
+             */
+            MappedFile::Ptr openFile(const Path& path) const;
+        private:
+            static String key(const Path& path);
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_FileSystemIndex) */
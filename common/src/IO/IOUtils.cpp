@@ -91,6 +91,11 @@ namespace TrenchBroom {
             std::fprintf(stream, "// Format: %s\n", mapFormat.c_str());
         }
 
+        void writeGameComment(String& buffer, const String& gameName, const String& mapFormat) {
+            buffer += "// Game: " + gameName + "\n";
+            buffer += "// Format: " + mapFormat + "\n";
+        }
+
         vm::vec3f readVec3f(const char*& cursor) {
             vm::vec3f value;
             for (size_t i = 0; i < 3; i++) {
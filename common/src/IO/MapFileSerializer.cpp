@@ -21,128 +21,118 @@
 
 #include "Exceptions.h"
 #include "Macros.h"
+#include "ParallelFor.h"
+#include "StringUtils.h"
 #include "IO/DiskFileSystem.h"
 #include "IO/Path.h"
 #include "Model/BrushFace.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace TrenchBroom {
     namespace IO {
         class QuakeFileSerializer : public MapFileSerializer {
-        private:
-            String FacePointFormat;
-            String TextureInfoFormat;
         public:
             QuakeFileSerializer(FILE* stream) :
-            MapFileSerializer(stream) {
-                StringStream str;
-                str <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g )";
-
-                FacePointFormat = str.str();
-                TextureInfoFormat = " %s %.6g %.6g %.6g %.6g %.6g";
-            }
+            MapFileSerializer(stream) {}
+
+            QuakeFileSerializer(String& buffer) :
+            MapFileSerializer(buffer) {}
         private:
-            size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) override {
-                writeFacePoints(stream, face);
-                writeTextureInfo(stream, face);
-                std::fprintf(stream, "\n");
+            size_t doWriteBrushFace(String& buffer, Model::BrushFace* face) override {
+                writeFacePoints(buffer, face);
+                writeTextureInfo(buffer, face);
+                buffer += "\n";
                 return 1;
             }
         protected:
-            void writeFacePoints(FILE* stream, Model::BrushFace* face) {
+            // writes the points like printf's "( %.17g %.17g %.17g ) ( %.17g %.17g %.17g ) ( %.17g %.17g %.17g )"
+            void writeFacePoints(String& buffer, Model::BrushFace* face) {
                 const Model::BrushFace::Points& points = face->points();
 
-                std::fprintf(stream, FacePointFormat.c_str(),
-                             points[0].x(),
-                             points[0].y(),
-                             points[0].z(),
-                             points[1].x(),
-                             points[1].y(),
-                             points[1].z(),
-                             points[2].x(),
-                             points[2].y(),
-                             points[2].z());
+                buffer += "( ";
+                StringUtils::appendGeneral(buffer, points[0].x(), FloatPrecision); buffer += " ";
+                StringUtils::appendGeneral(buffer, points[0].y(), FloatPrecision); buffer += " ";
+                StringUtils::appendGeneral(buffer, points[0].z(), FloatPrecision); buffer += " ) ( ";
+                StringUtils::appendGeneral(buffer, points[1].x(), FloatPrecision); buffer += " ";
+                StringUtils::appendGeneral(buffer, points[1].y(), FloatPrecision); buffer += " ";
+                StringUtils::appendGeneral(buffer, points[1].z(), FloatPrecision); buffer += " ) ( ";
+                StringUtils::appendGeneral(buffer, points[2].x(), FloatPrecision); buffer += " ";
+                StringUtils::appendGeneral(buffer, points[2].y(), FloatPrecision); buffer += " ";
+                StringUtils::appendGeneral(buffer, points[2].z(), FloatPrecision); buffer += " )";
             }
 
-            void writeTextureInfo(FILE* stream, Model::BrushFace* face) {
+            // writes the texture info like printf's " %s %.6g %.6g %.6g %.6g %.6g"
+            void writeTextureInfo(String& buffer, Model::BrushFace* face) {
                 const String& textureName = face->textureName().empty() ? Model::BrushFace::NoTextureName : face->textureName();
-                std::fprintf(stream, TextureInfoFormat.c_str(),
-                             textureName.c_str(),
-                             face->xOffset(),
-                             face->yOffset(),
-                             face->rotation(),
-                             face->xScale(),
-                             face->yScale());
+                buffer += " ";
+                buffer += textureName;
+                buffer += " "; StringUtils::appendGeneral(buffer, face->xOffset(), 6);
+                buffer += " "; StringUtils::appendGeneral(buffer, face->yOffset(), 6);
+                buffer += " "; StringUtils::appendGeneral(buffer, face->rotation(), 6);
+                buffer += " "; StringUtils::appendGeneral(buffer, face->xScale(), 6);
+                buffer += " "; StringUtils::appendGeneral(buffer, face->yScale(), 6);
             }
         };
 
         class Quake2FileSerializer : public QuakeFileSerializer {
-        private:
-            String SurfaceAttributesFormat;
         public:
             Quake2FileSerializer(FILE* stream) :
-            QuakeFileSerializer(stream) {
-                SurfaceAttributesFormat = " %d %d %.6g";
-            }
+            QuakeFileSerializer(stream) {}
+
+            Quake2FileSerializer(String& buffer) :
+            QuakeFileSerializer(buffer) {}
         private:
-            size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) override {
-                writeFacePoints(stream, face);
-                writeTextureInfo(stream, face);
+            size_t doWriteBrushFace(String& buffer, Model::BrushFace* face) override {
+                writeFacePoints(buffer, face);
+                writeTextureInfo(buffer, face);
 
                 if (face->hasSurfaceAttributes()) {
-                    writeSurfaceAttributes(stream, face);
+                    writeSurfaceAttributes(buffer, face);
                 }
 
-                std::fprintf(stream, "\n");
+                buffer += "\n";
                 return 1;
             }
         protected:
-            void writeSurfaceAttributes(FILE* stream, Model::BrushFace* face) {
-                std::fprintf(stream, SurfaceAttributesFormat.c_str(),
-                             face->surfaceContents(),
-                             face->surfaceFlags(),
-                             face->surfaceValue());
+            // writes the surface attributes like printf's " %d %d %.6g"
+            void writeSurfaceAttributes(String& buffer, Model::BrushFace* face) {
+                buffer += " "; buffer += std::to_string(face->surfaceContents());
+                buffer += " "; buffer += std::to_string(face->surfaceFlags());
+                buffer += " "; StringUtils::appendGeneral(buffer, face->surfaceValue(), 6);
             }
         };
 
 
         class DaikatanaFileSerializer : public Quake2FileSerializer {
-        private:
-            String SurfaceColorFormat;
         public:
             DaikatanaFileSerializer(FILE* stream) :
-            Quake2FileSerializer(stream) {
-                SurfaceColorFormat = " %d %d %d";
-            }
+            Quake2FileSerializer(stream) {}
+
+            DaikatanaFileSerializer(String& buffer) :
+            Quake2FileSerializer(buffer) {}
         private:
-            size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) override {
-                writeFacePoints(stream, face);
-                writeTextureInfo(stream, face);
+            size_t doWriteBrushFace(String& buffer, Model::BrushFace* face) override {
+                writeFacePoints(buffer, face);
+                writeTextureInfo(buffer, face);
 
                 if (face->hasSurfaceAttributes() || face->hasColor()) {
-                    writeSurfaceAttributes(stream, face);
+                    writeSurfaceAttributes(buffer, face);
                 }
                 if (face->hasColor()) {
-                    writeSurfaceColor(stream, face);
+                    writeSurfaceColor(buffer, face);
                 }
 
-                std::fprintf(stream, "\n");
+                buffer += "\n";
                 return 1;
             }
         protected:
-            void writeSurfaceColor(FILE* stream, Model::BrushFace* face) {
-                std::fprintf(stream, SurfaceColorFormat.c_str(),
-                             static_cast<int>(face->color().r()),
-                             static_cast<int>(face->color().g()),
-                             static_cast<int>(face->color().b()));
+            // writes the color like printf's " %d %d %d"
+            void writeSurfaceColor(String& buffer, Model::BrushFace* face) {
+                buffer += " "; buffer += std::to_string(static_cast<int>(face->color().r()));
+                buffer += " "; buffer += std::to_string(static_cast<int>(face->color().g()));
+                buffer += " "; buffer += std::to_string(static_cast<int>(face->color().b()));
             }
         };
 
@@ -150,55 +140,63 @@ namespace TrenchBroom {
         public:
             Hexen2FileSerializer(FILE* stream):
             QuakeFileSerializer(stream) {}
+
+            Hexen2FileSerializer(String& buffer):
+            QuakeFileSerializer(buffer) {}
         private:
-            size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) override {
-                writeFacePoints(stream, face);
-                writeTextureInfo(stream, face);
-                std::fprintf(stream, " 0\n"); // extra value written here
+            size_t doWriteBrushFace(String& buffer, Model::BrushFace* face) override {
+                writeFacePoints(buffer, face);
+                writeTextureInfo(buffer, face);
+                buffer += " 0\n"; // extra value written here
                 return 1;
             }
         };
         
         class ValveFileSerializer : public QuakeFileSerializer {
-        private:
-            String ValveTextureInfoFormat;
         public:
             ValveFileSerializer(FILE* stream) :
-            QuakeFileSerializer(stream),
-            ValveTextureInfoFormat(" %s [ %.6g %.6g %.6g %.6g ] [ %.6g %.6g %.6g %.6g ] %.6g %.6g %.6g") {}
+            QuakeFileSerializer(stream) {}
+
+            ValveFileSerializer(String& buffer) :
+            QuakeFileSerializer(buffer) {}
         private:
-            size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) override {
-                writeFacePoints(stream, face);
-                writeValveTextureInfo(stream, face);
-                std::fprintf(stream, "\n");
+            size_t doWriteBrushFace(String& buffer, Model::BrushFace* face) override {
+                writeFacePoints(buffer, face);
+                writeValveTextureInfo(buffer, face);
+                buffer += "\n";
                 return 1;
             }
         private:
-            void writeValveTextureInfo(FILE* stream, Model::BrushFace* face) {
+            // writes the texture info like printf's " %s [ %.6g %.6g %.6g %.6g ] [ %.6g %.6g %.6g %.6g ] %.6g %.6g %.6g"
+            void writeValveTextureInfo(String& buffer, Model::BrushFace* face) {
                 const String& textureName = face->textureName().empty() ? Model::BrushFace::NoTextureName : face->textureName();
                 const vm::vec3 xAxis = face->textureXAxis();
                 const vm::vec3 yAxis = face->textureYAxis();
 
-                std::fprintf(stream, ValveTextureInfoFormat.c_str(),
-                             textureName.c_str(),
+                buffer += " ";
+                buffer += textureName;
 
-                             xAxis.x(),
-                             xAxis.y(),
-                             xAxis.z(),
-                             face->xOffset(),
+                buffer += " [ ";
+                StringUtils::appendGeneral(buffer, xAxis.x(), 6);        buffer += " ";
+                StringUtils::appendGeneral(buffer, xAxis.y(), 6);        buffer += " ";
+                StringUtils::appendGeneral(buffer, xAxis.z(), 6);        buffer += " ";
+                StringUtils::appendGeneral(buffer, face->xOffset(), 6);
 
-                             yAxis.x(),
-                             yAxis.y(),
-                             yAxis.z(),
-                             face->yOffset(),
+                buffer += " ] [ ";
+                StringUtils::appendGeneral(buffer, yAxis.x(), 6);        buffer += " ";
+                StringUtils::appendGeneral(buffer, yAxis.y(), 6);        buffer += " ";
+                StringUtils::appendGeneral(buffer, yAxis.z(), 6);        buffer += " ";
+                StringUtils::appendGeneral(buffer, face->yOffset(), 6);
 
-                             face->rotation(),
-                             face->xScale(),
-                             face->yScale());
+                buffer += " ] ";
+                StringUtils::appendGeneral(buffer, face->rotation(), 6); buffer += " ";
+                StringUtils::appendGeneral(buffer, face->xScale(), 6);   buffer += " ";
+                StringUtils::appendGeneral(buffer, face->yScale(), 6);
             }
         };
 
-        NodeSerializer::Ptr MapFileSerializer::create(const Model::MapFormat format, FILE* stream) {
+        template <typename S>
+        NodeSerializer::Ptr createMapFileSerializer(const Model::MapFormat format, S& stream) {
             switch (format) {
                 case Model::MapFormat::Standard:
                     return NodeSerializer::Ptr(new QuakeFileSerializer(stream));
@@ -218,56 +216,128 @@ namespace TrenchBroom {
                 switchDefault()
             }
         }
+
+        NodeSerializer::Ptr MapFileSerializer::create(const Model::MapFormat format, FILE* stream) {
+            return createMapFileSerializer(format, stream);
+        }
+
+        NodeSerializer::Ptr MapFileSerializer::create(const Model::MapFormat format, String& buffer) {
+            return createMapFileSerializer(format, buffer);
+        }
         
         MapFileSerializer::MapFileSerializer(FILE* stream) :
         m_line(1),
-        m_stream(stream) {
+        m_stream(stream),
+        m_buffer(nullptr) {
             ensure(m_stream != nullptr, "stream is null");
         }
+
+        MapFileSerializer::MapFileSerializer(String& buffer) :
+        m_line(1),
+        m_stream(nullptr),
+        m_buffer(&buffer) {}
         
         void MapFileSerializer::doBeginFile() {}
         void MapFileSerializer::doEndFile() {}
 
         void MapFileSerializer::doBeginEntity(const Model::Node* node) {
-            std::fprintf(m_stream, "// entity %u\n", entityNo());
+            write("// entity " + std::to_string(entityNo()) + "\n");
             ++m_line;
             m_startLineStack.push_back(m_line);
-            std::fprintf(m_stream, "{\n");
+            write("{\n");
             ++m_line;
         }
         
         void MapFileSerializer::doEndEntity(Model::Node* node) {
-            std::fprintf(m_stream, "}\n");
+            write("}\n");
             ++m_line;
             setFilePosition(node);
         }
         
         void MapFileSerializer::doEntityAttribute(const Model::EntityAttribute& attribute) { 
-            std::fprintf(m_stream, "\"%s\" \"%s\"\n",
-                         escapeEntityAttribute( attribute.name()).c_str(),
-                         escapeEntityAttribute(attribute.value()).c_str());
+            write("\"" + escapeEntityAttribute(attribute.name()) + "\" \"" + escapeEntityAttribute(attribute.value()) + "\"\n");
             ++m_line;
         }
         
         void MapFileSerializer::doBeginBrush(const Model::Brush* brush) {
-            std::fprintf(m_stream, "// brush %u\n", brushNo());
+            write("// brush " + std::to_string(brushNo()) + "\n");
             ++m_line;
             m_startLineStack.push_back(m_line);
-            std::fprintf(m_stream, "{\n");
+            write("{\n");
             ++m_line;
         }
         
         void MapFileSerializer::doEndBrush(Model::Brush* brush) {
-            std::fprintf(m_stream, "}\n");
+            write("}\n");
             ++m_line;
             setFilePosition(brush);
         }
         
         void MapFileSerializer::doBrushFace(Model::BrushFace* face) {
-            const size_t lines = doWriteBrushFace(m_stream, face);
+            String buffer;
+            const size_t lines = doWriteBrushFace(buffer, face);
+            write(buffer);
             face->setFilePosition(m_line, lines);
             m_line += lines;
         }
+
+        struct MapFileSerializer::BrushChunk {
+            String text;
+            std::vector<size_t> faceLines;
+        };
+
+        void MapFileSerializer::doBrushes(const Model::BrushList& brushes) {
+            // The brushes are formatted in batches so that only the text of one batch must be kept in memory.
+            std::vector<BrushChunk> chunks;
+            for (size_t first = 0; first < brushes.size(); first += BrushBatchSize) {
+                const size_t count = std::min(BrushBatchSize, brushes.size() - first);
+                chunks.resize(count);
+
+                parallelFor(count, [&](const size_t i) {
+                    formatBrush(chunks[i], brushes[first + i], static_cast<ObjectNo>(brushNo() + first + i));
+                });
+
+                // the file positions are set here because they depend on the preceding brushes
+                for (size_t i = 0; i < count; ++i) {
+                    writeBrush(chunks[i], brushes[first + i]);
+                }
+            }
+        }
+
+        void MapFileSerializer::formatBrush(BrushChunk& chunk, Model::Brush* brush, const ObjectNo no) {
+            chunk.text.clear();
+            chunk.faceLines.clear();
+
+            chunk.text += "// brush ";
+            chunk.text += std::to_string(no);
+            chunk.text += "\n{\n";
+            for (Model::BrushFace* face : brush->faces()) {
+                chunk.faceLines.push_back(doWriteBrushFace(chunk.text, face));
+            }
+            chunk.text += "}\n";
+        }
+
+        void MapFileSerializer::writeBrush(const BrushChunk& chunk, Model::Brush* brush) {
+            write(chunk.text);
+
+            const Model::BrushFaceList& faces = brush->faces();
+            assert(faces.size() == chunk.faceLines.size());
+
+            // skip the comment
+            ++m_line;
+            const size_t start = m_line;
+
+            // skip the opening brace
+            ++m_line;
+            for (size_t i = 0; i < faces.size(); ++i) {
+                faces[i]->setFilePosition(m_line, chunk.faceLines[i]);
+                m_line += chunk.faceLines[i];
+            }
+
+            // skip the closing brace
+            ++m_line;
+            brush->setFilePosition(start, m_line - start);
+        }
         
         void MapFileSerializer::setFilePosition(Model::Node* node) {
             const size_t start = startLine();
@@ -280,5 +350,13 @@ namespace TrenchBroom {
             m_startLineStack.pop_back();
             return result;
         }
+
+        void MapFileSerializer::write(const String& str) {
+            if (m_stream != nullptr) {
+                std::fwrite(str.data(), 1, str.size(), m_stream);
+            } else {
+                m_buffer->append(str);
+            }
+        }
     }
 }
@@ -33,14 +33,24 @@ namespace TrenchBroom {
         
         class MapFileSerializer : public NodeSerializer {
         private:
+            struct BrushChunk;
+
             typedef std::vector<size_t> LineStack;
             LineStack m_startLineStack;
             size_t m_line;
             FILE* m_stream;
+            String* m_buffer;
         public:
             static Ptr create(Model::MapFormat format, FILE* stream);
+
+            /**
+             * Creates a serializer that appends the map to the given buffer instead of writing it to a file. The
+             * buffer receives exactly the same text that would be written to a file.
+             */
+            static Ptr create(Model::MapFormat format, String& buffer);
         protected:
             MapFileSerializer(FILE* file);
+            MapFileSerializer(String& buffer);
         private:
             void doBeginFile() override;
             void doEndFile() override;
@@ -51,11 +61,19 @@ namespace TrenchBroom {
             void doBeginBrush(const Model::Brush* brush) override;
             void doEndBrush(Model::Brush* brush) override;
             void doBrushFace(Model::BrushFace* face) override;
+            void doBrushes(const Model::BrushList& brushes) override;
         private:
+            void formatBrush(BrushChunk& chunk, Model::Brush* brush, ObjectNo no);
+            void writeBrush(const BrushChunk& chunk, Model::Brush* brush);
+
             void setFilePosition(Model::Node* node);
             size_t startLine();
+
+            void write(const String& str);
         private:
-            virtual size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) = 0;
+            // Appends the given face to the given buffer and returns the number of lines written. This may be
+            // called from multiple threads at once.
+            virtual size_t doWriteBrushFace(String& buffer, Model::BrushFace* face) = 0;
         };
     }
 }
@@ -28,6 +28,7 @@
 #include "Model/Group.h"
 #include "Model/Layer.h"
 #include "Model/ModelFactory.h"
+#include "ParallelFor.h"
 
 namespace TrenchBroom {
     namespace IO {
@@ -55,6 +56,14 @@ namespace TrenchBroom {
             return m_id;
         }
 
+        MapReader::BrushInfo::BrushInfo(Model::Node* i_parent, const Model::BrushFaceList& i_faces, const size_t i_startLine, const size_t i_lineCount, const ExtraAttributes& i_extraAttributes) :
+        parent(i_parent),
+        faces(i_faces),
+        startLine(i_startLine),
+        lineCount(i_lineCount),
+        extraAttributes(i_extraAttributes),
+        brush(nullptr) {}
+
         MapReader::MapReader(const char* begin, const char* end) :
         StandardMapParser(begin, end),
         m_factory(nullptr),
@@ -69,17 +78,30 @@ namespace TrenchBroom {
         
         MapReader::~MapReader() {
             VectorUtils::clearAndDelete(m_faces);
+            clearDeferredNodes();
         }
 
         void MapReader::readEntities(Model::MapFormat format, const vm::bbox3& worldBounds, ParserStatus& status) {
             m_worldBounds = worldBounds;
-            parseEntities(format, status);
+            try {
+                parseEntities(format, status);
+            } catch (...) {
+                clearDeferredNodes();
+                throw;
+            }
+            createBrushes(status);
             resolveNodes(status);
         }
         
         void MapReader::readBrushes(Model::MapFormat format, const vm::bbox3& worldBounds, ParserStatus& status) {
             m_worldBounds = worldBounds;
-            parseBrushes(format, status);
+            try {
+                parseBrushes(format, status);
+            } catch (...) {
+                clearDeferredNodes();
+                throw;
+            }
+            createBrushes(status);
         }
         
         void MapReader::readBrushFaces(Model::MapFormat format, const vm::bbox3& worldBounds, ParserStatus& status) {
@@ -165,7 +187,7 @@ namespace TrenchBroom {
             setExtraAttributes(layer, extraAttributes);
             m_layers.insert(std::make_pair(layerId, layer));
             
-            onLayer(layer, status);
+            deferLayer(layer);
             
             m_currentNode = layer;
             m_brushParent = layer;
@@ -223,23 +245,13 @@ namespace TrenchBroom {
         }
 
         void MapReader::createBrush(const size_t startLine, const size_t lineCount, const ExtraAttributes& extraAttributes, ParserStatus& status) {
-            try {
-                // sort the faces by the weight of their plane normals like QBSP does
-                Model::BrushFace::sortFaces(m_faces);
-                
-                Model::Brush* brush = m_factory->createBrush(m_worldBounds, m_faces);
-                setFilePosition(brush, startLine, lineCount);
-                setExtraAttributes(brush, extraAttributes);
-                
-                onBrush(m_brushParent, brush, status);
-                m_faces.clear();
-            } catch (GeometryException& e) {
-                StringStream msg;
-                msg << "Skipping brush: " << e.what();
-                status.error(startLine, msg.str());
-                m_faces.clear(); // the faces will have been deleted by the brush's constructor
-            }
+            // sort the faces by the weight of their plane normals like QBSP does
+            Model::BrushFace::sortFaces(m_faces);
 
+            // the geometry is built later in createBrushes
+            m_nodeInfos.push_back({ NodeInfo::Type_Brush, m_brushParent, nullptr, m_brushInfos.size() });
+            m_brushInfos.emplace_back(m_brushParent, m_faces, startLine, lineCount, extraAttributes);
+            m_faces.clear();
         }
 
         MapReader::ParentInfo::Type MapReader::storeNode(Model::Node* node, const Model::EntityAttribute::List& attributes, ParserStatus& status) {
@@ -250,7 +262,7 @@ namespace TrenchBroom {
                     const Model::IdType layerId = static_cast<Model::IdType>(rawId);
                     Model::Layer* layer = MapUtils::find(m_layers, layerId, static_cast<Model::Layer*>(nullptr));
                     if (layer != nullptr)
-                        onNode(layer, node, status);
+                        deferNode(layer, node);
                     else
                         m_unresolvedNodes.push_back(std::make_pair(node, ParentInfo::layer(layerId)));
                     return ParentInfo::Type_Layer;
@@ -267,7 +279,7 @@ namespace TrenchBroom {
                         const Model::IdType groupId = static_cast<Model::IdType>(rawId);
                         Model::Group* group = MapUtils::find(m_groups, groupId, static_cast<Model::Group*>(nullptr));
                         if (group != nullptr)
-                            onNode(group, node, status);
+                            deferNode(group, node);
                         else
                             m_unresolvedNodes.push_back(std::make_pair(node, ParentInfo::group(groupId)));
                         return ParentInfo::Type_Group;
@@ -279,7 +291,7 @@ namespace TrenchBroom {
                 }
             }
             
-            onNode(nullptr, node, status);
+            deferNode(nullptr, node);
             return ParentInfo::Type_None;
         }
 
@@ -297,6 +309,88 @@ namespace TrenchBroom {
             }
         }
 
+        void MapReader::deferLayer(Model::Layer* layer) {
+            m_nodeInfos.push_back({ NodeInfo::Type_Layer, nullptr, layer, 0 });
+        }
+
+        void MapReader::deferNode(Model::Node* parent, Model::Node* node) {
+            m_nodeInfos.push_back({ NodeInfo::Type_Node, parent, node, 0 });
+        }
+
+        /**
+         * Builds the geometry of all brushes collected during parsing in parallel, and then issues the node
+         * callbacks in file order. Since building the geometry is the most expensive part of loading a map, this
+         * makes use of all available cores while keeping the node tree and the reported diagnostics identical
+         * to those of a sequential load.
+         */
+        void MapReader::createBrushes(ParserStatus& status) {
+            parallelFor(m_brushInfos.size(), [this](const size_t index) {
+                auto& info = m_brushInfos[index];
+                try {
+                    info.brush = m_factory->createBrush(m_worldBounds, info.faces);
+                } catch (const GeometryException& e) {
+                    info.error = e.what();
+                }
+                // the faces are now owned by the brush, or they have been deleted by the brush's constructor
+                info.faces.clear();
+            });
+
+            NodeInfoList nodeInfos;
+            std::swap(nodeInfos, m_nodeInfos);
+
+            for (const auto& nodeInfo : nodeInfos) {
+                switch (nodeInfo.type) {
+                    case NodeInfo::Type_Layer:
+                        onLayer(static_cast<Model::Layer*>(nodeInfo.node), status);
+                        break;
+                    case NodeInfo::Type_Node:
+                        onNode(nodeInfo.parent, nodeInfo.node, status);
+                        break;
+                    case NodeInfo::Type_Brush: {
+                        auto& brushInfo = m_brushInfos[nodeInfo.brushIndex];
+                        auto* brush = brushInfo.brush;
+                        brushInfo.brush = nullptr;
+
+                        if (brush != nullptr) {
+                            setFilePosition(brush, brushInfo.startLine, brushInfo.lineCount);
+                            setExtraAttributes(brush, brushInfo.extraAttributes);
+                            onBrush(brushInfo.parent, brush, status);
+                        } else {
+                            StringStream msg;
+                            msg << "Skipping brush: " << brushInfo.error;
+                            status.error(brushInfo.startLine, msg.str());
+                        }
+                        break;
+                    }
+                    switchDefault()
+                }
+            }
+
+            m_brushInfos.clear();
+        }
+
+        void MapReader::clearDeferredNodes() {
+            for (auto& brushInfo : m_brushInfos) {
+                VectorUtils::clearAndDelete(brushInfo.faces);
+                delete brushInfo.brush;
+            }
+            m_brushInfos.clear();
+
+            // none of these nodes have been passed on yet, and none of them have children
+            for (const auto& nodeInfo : m_nodeInfos) {
+                delete nodeInfo.node;
+            }
+            m_nodeInfos.clear();
+
+            for (const auto& entry : m_unresolvedNodes) {
+                delete entry.first;
+            }
+            m_unresolvedNodes.clear();
+
+            m_layers.clear();
+            m_groups.clear();
+        }
+
         void MapReader::resolveNodes(ParserStatus& status) {
             for (const auto& entry : m_unresolvedNodes) {
                 Model::Node* node = entry.first;
@@ -308,6 +402,7 @@ namespace TrenchBroom {
                 else
                     onNode(parent, node, status);
             }
+            m_unresolvedNodes.clear();
         }
 
         Model::Node* MapReader::resolveParent(const ParentInfo& parentInfo) const {
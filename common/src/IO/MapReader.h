@@ -70,6 +70,40 @@ namespace TrenchBroom {
             
             typedef std::pair<Model::Node*, ParentInfo> NodeParentPair;
             typedef std::vector<NodeParentPair> NodeParentList;
+
+            /**
+             * A brush whose faces have been parsed, but whose geometry has not been built yet.
+             */
+            struct BrushInfo {
+                Model::Node* parent;
+                Model::BrushFaceList faces;
+                size_t startLine;
+                size_t lineCount;
+                ExtraAttributes extraAttributes;
+                Model::Brush* brush;
+                String error;
+
+                BrushInfo(Model::Node* i_parent, const Model::BrushFaceList& i_faces, size_t i_startLine, size_t i_lineCount, const ExtraAttributes& i_extraAttributes);
+            };
+            typedef std::vector<BrushInfo> BrushInfoList;
+
+            /**
+             * A node callback that is deferred until all brushes have been built, so that the callbacks are
+             * issued in file order.
+             */
+            struct NodeInfo {
+                typedef enum {
+                    Type_Layer,
+                    Type_Node,
+                    Type_Brush
+                } Type;
+
+                Type type;
+                Model::Node* parent;
+                Model::Node* node;
+                size_t brushIndex;
+            };
+            typedef std::vector<NodeInfo> NodeInfoList;
             
             vm::bbox3 m_worldBounds;
             Model::ModelFactory* m_factory;
@@ -81,6 +115,9 @@ namespace TrenchBroom {
             LayerMap m_layers;
             GroupMap m_groups;
             NodeParentList m_unresolvedNodes;
+
+            BrushInfoList m_brushInfos;
+            NodeInfoList m_nodeInfos;
         protected:
             MapReader(const char* begin, const char* end);
             MapReader(const String& str);
@@ -106,6 +143,11 @@ namespace TrenchBroom {
             ParentInfo::Type storeNode(Model::Node* node, const Model::EntityAttribute::List& attributes, ParserStatus& status);
             void stripParentAttributes(Model::AttributableNode* attributable, ParentInfo::Type parentType);
             
+            void deferLayer(Model::Layer* layer);
+            void deferNode(Model::Node* parent, Model::Node* node);
+            void createBrushes(ParserStatus& status);
+            void clearDeferredNodes();
+
             void resolveNodes(ParserStatus& status);
             Model::Node* resolveParent(const ParentInfo& parentInfo) const;
             
@@ -20,9 +20,14 @@
 #include "MapStreamSerializer.h"
 
 #include "Macros.h"
+#include "ParallelFor.h"
 #include "StringUtils.h"
+#include "Model/Brush.h"
 #include "Model/BrushFace.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace TrenchBroom {
     namespace IO {
         class QuakeStreamSerializer : public MapStreamSerializer {
@@ -30,37 +35,36 @@ namespace TrenchBroom {
             QuakeStreamSerializer(std::ostream& stream) :
             MapStreamSerializer(stream) {}
         private:
-            virtual void doWriteBrushFace(std::ostream& stream, Model::BrushFace* face) override {
-                writeFacePoints(stream, face);
-                stream << " ";
-                writeTextureInfo(stream, face);
-                stream << "\n";
+            virtual void doWriteBrushFace(String& buffer, Model::BrushFace* face) override {
+                writeFacePoints(buffer, face);
+                buffer += " ";
+                writeTextureInfo(buffer, face);
+                buffer += "\n";
             }
         protected:
-            void writeFacePoints(std::ostream& stream, Model::BrushFace* face) {
+            void writeFacePoints(String& buffer, Model::BrushFace* face) {
                 const Model::BrushFace::Points& points = face->points();
 
-                stream.precision(FloatPrecision);
-                stream << "( " <<
-                StringUtils::ftos(points[0].x(), FloatPrecision) << " " <<
-                StringUtils::ftos(points[0].y(), FloatPrecision) << " " <<
-                StringUtils::ftos(points[0].z(), FloatPrecision) <<" ) ( " <<
-                StringUtils::ftos(points[1].x(), FloatPrecision) << " " <<
-                StringUtils::ftos(points[1].y(), FloatPrecision) << " " <<
-                StringUtils::ftos(points[1].z(), FloatPrecision) << " ) ( " <<
-                StringUtils::ftos(points[2].x(), FloatPrecision) << " " <<
-                StringUtils::ftos(points[2].y(), FloatPrecision) << " " <<
-                StringUtils::ftos(points[2].z(), FloatPrecision) << " )";
+                buffer += "( ";
+                StringUtils::appendFtos(buffer, points[0].x(), FloatPrecision); buffer += " ";
+                StringUtils::appendFtos(buffer, points[0].y(), FloatPrecision); buffer += " ";
+                StringUtils::appendFtos(buffer, points[0].z(), FloatPrecision); buffer += " ) ( ";
+                StringUtils::appendFtos(buffer, points[1].x(), FloatPrecision); buffer += " ";
+                StringUtils::appendFtos(buffer, points[1].y(), FloatPrecision); buffer += " ";
+                StringUtils::appendFtos(buffer, points[1].z(), FloatPrecision); buffer += " ) ( ";
+                StringUtils::appendFtos(buffer, points[2].x(), FloatPrecision); buffer += " ";
+                StringUtils::appendFtos(buffer, points[2].y(), FloatPrecision); buffer += " ";
+                StringUtils::appendFtos(buffer, points[2].z(), FloatPrecision); buffer += " )";
             }
 
-            void writeTextureInfo(std::ostream& stream, Model::BrushFace* face) {
+            void writeTextureInfo(String& buffer, Model::BrushFace* face) {
                 const String& textureName = face->textureName().empty() ? Model::BrushFace::NoTextureName : face->textureName();
-                stream << textureName << " " <<
-                StringUtils::ftos(face->xOffset(), FloatPrecision)  << " " <<
-                StringUtils::ftos(face->yOffset(), FloatPrecision)  << " " <<
-                StringUtils::ftos(face->rotation(), FloatPrecision) << " " <<
-                StringUtils::ftos(face->xScale(), FloatPrecision)   << " " <<
-                StringUtils::ftos(face->yScale(), FloatPrecision);
+                buffer += textureName; buffer += " ";
+                StringUtils::appendFtos(buffer, face->xOffset(), FloatPrecision);  buffer += " ";
+                StringUtils::appendFtos(buffer, face->yOffset(), FloatPrecision);  buffer += " ";
+                StringUtils::appendFtos(buffer, face->rotation(), FloatPrecision); buffer += " ";
+                StringUtils::appendFtos(buffer, face->xScale(), FloatPrecision);   buffer += " ";
+                StringUtils::appendFtos(buffer, face->yScale(), FloatPrecision);
             }
         };
 
@@ -69,23 +73,22 @@ namespace TrenchBroom {
             Quake2StreamSerializer(std::ostream& stream) :
             QuakeStreamSerializer(stream) {}
         private:
-            virtual void doWriteBrushFace(std::ostream& stream, Model::BrushFace* face) override {
-                writeFacePoints(stream, face);
-                stream << " ";
-                writeTextureInfo(stream, face);
+            virtual void doWriteBrushFace(String& buffer, Model::BrushFace* face) override {
+                writeFacePoints(buffer, face);
+                buffer += " ";
+                writeTextureInfo(buffer, face);
                 if (face->hasSurfaceAttributes()) {
-                    stream << " ";
-                    writeSurfaceAttributes(stream, face);
+                    buffer += " ";
+                    writeSurfaceAttributes(buffer, face);
 
                 }
-                stream << "\n";
+                buffer += "\n";
             }
         protected:
-            void writeSurfaceAttributes(std::ostream& stream, Model::BrushFace* face) {
-                stream <<
-                face->surfaceContents()  << " " <<
-                face->surfaceFlags()     << " " <<
-                StringUtils::ftos(face->surfaceValue(), FloatPrecision);
+            void writeSurfaceAttributes(String& buffer, Model::BrushFace* face) {
+                buffer += std::to_string(face->surfaceContents()); buffer += " ";
+                buffer += std::to_string(face->surfaceFlags());    buffer += " ";
+                StringUtils::appendFtos(buffer, face->surfaceValue(), FloatPrecision);
             }
         };
 
@@ -94,27 +97,26 @@ namespace TrenchBroom {
             DaikatanaStreamSerializer(std::ostream& stream) :
             Quake2StreamSerializer(stream) {}
         private:
-            virtual void doWriteBrushFace(std::ostream& stream, Model::BrushFace* face) override {
-                writeFacePoints(stream, face);
-                stream << " ";
-                writeTextureInfo(stream, face);
+            virtual void doWriteBrushFace(String& buffer, Model::BrushFace* face) override {
+                writeFacePoints(buffer, face);
+                buffer += " ";
+                writeTextureInfo(buffer, face);
                 if (face->hasSurfaceAttributes() || face->hasColor()) {
-                    stream << " ";
-                    writeSurfaceAttributes(stream, face);
+                    buffer += " ";
+                    writeSurfaceAttributes(buffer, face);
 
                 }
                 if (face->hasColor()) {
-                    stream << " ";
-                    writeSurfaceColor(stream, face);
+                    buffer += " ";
+                    writeSurfaceColor(buffer, face);
                 }
-                stream << "\n";
+                buffer += "\n";
             }
         protected:
-            void writeSurfaceColor(std::ostream& stream, Model::BrushFace* face) {
-                stream <<
-                static_cast<int>(face->color().r()) << " " <<
-                static_cast<int>(face->color().g()) << " " <<
-                static_cast<int>(face->color().b());
+            void writeSurfaceColor(String& buffer, Model::BrushFace* face) {
+                buffer += std::to_string(static_cast<int>(face->color().r())); buffer += " ";
+                buffer += std::to_string(static_cast<int>(face->color().g())); buffer += " ";
+                buffer += std::to_string(static_cast<int>(face->color().b()));
             }
         };
 
@@ -123,36 +125,35 @@ namespace TrenchBroom {
             ValveStreamSerializer(std::ostream& stream) :
             QuakeStreamSerializer(stream) {}
         private:
-            void doWriteBrushFace(std::ostream& stream, Model::BrushFace* face) override {
+            void doWriteBrushFace(String& buffer, Model::BrushFace* face) override {
 
-                writeFacePoints(stream, face);
-                stream << " ";
-                writeValveTextureInfo(stream, face);
-                stream << "\n";
+                writeFacePoints(buffer, face);
+                buffer += " ";
+                writeValveTextureInfo(buffer, face);
+                buffer += "\n";
             }
         private:
-            void writeValveTextureInfo(std::ostream& stream, Model::BrushFace* face) {
+            void writeValveTextureInfo(String& buffer, Model::BrushFace* face) {
                 const String& textureName = face->textureName().empty() ? Model::BrushFace::NoTextureName : face->textureName();
                 const vm::vec3& xAxis = face->textureXAxis();
                 const vm::vec3& yAxis = face->textureYAxis();
 
-                stream.precision(6);
-                stream <<
-                textureName     << " " <<
-                "[ " <<
-                xAxis.x() << " " <<
-                xAxis.y() << " " <<
-                xAxis.z() << " " <<
-                face->xOffset()   <<
-                " ] [ " <<
-                yAxis.x() << " " <<
-                yAxis.y() << " " <<
-                yAxis.z() << " " <<
-                face->yOffset()   <<
-                " ] " <<
-                face->rotation() << " " <<
-                face->xScale()   << " " <<
-                face->yScale();
+                // the stream used to write these with its default precision of 6
+                buffer += textureName; buffer += " ";
+                buffer += "[ ";
+                StringUtils::appendGeneral(buffer, xAxis.x(), 6);        buffer += " ";
+                StringUtils::appendGeneral(buffer, xAxis.y(), 6);        buffer += " ";
+                StringUtils::appendGeneral(buffer, xAxis.z(), 6);        buffer += " ";
+                StringUtils::appendGeneral(buffer, face->xOffset(), 6);
+                buffer += " ] [ ";
+                StringUtils::appendGeneral(buffer, yAxis.x(), 6);        buffer += " ";
+                StringUtils::appendGeneral(buffer, yAxis.y(), 6);        buffer += " ";
+                StringUtils::appendGeneral(buffer, yAxis.z(), 6);        buffer += " ";
+                StringUtils::appendGeneral(buffer, face->yOffset(), 6);
+                buffer += " ] ";
+                StringUtils::appendGeneral(buffer, face->rotation(), 6); buffer += " ";
+                StringUtils::appendGeneral(buffer, face->xScale(), 6);   buffer += " ";
+                StringUtils::appendGeneral(buffer, face->yScale(), 6);
             }
         };
         
@@ -161,11 +162,11 @@ namespace TrenchBroom {
             Hexen2StreamSerializer(std::ostream& stream) :
             QuakeStreamSerializer(stream) {}
         private:
-            virtual void doWriteBrushFace(std::ostream& stream, Model::BrushFace* face) override {
-                writeFacePoints(stream, face);
-                stream << " ";
-                writeTextureInfo(stream, face);
-                stream << " 0\n"; // extra value written here
+            virtual void doWriteBrushFace(String& buffer, Model::BrushFace* face) override {
+                writeFacePoints(buffer, face);
+                buffer += " ";
+                writeTextureInfo(buffer, face);
+                buffer += " 0\n"; // extra value written here
             }
         };
         
@@ -221,7 +222,38 @@ namespace TrenchBroom {
         }
         
         void MapStreamSerializer::doBrushFace(Model::BrushFace* face) {
-            doWriteBrushFace(m_stream, face);
+            String buffer;
+            doWriteBrushFace(buffer, face);
+            m_stream << buffer;
+        }
+
+        void MapStreamSerializer::doBrushes(const Model::BrushList& brushes) {
+            // The brushes are formatted in batches so that only the text of one batch must be kept in memory.
+            std::vector<String> buffers;
+            for (size_t first = 0; first < brushes.size(); first += BrushBatchSize) {
+                const size_t count = std::min(BrushBatchSize, brushes.size() - first);
+                buffers.resize(count);
+
+                parallelFor(count, [&](const size_t i) {
+                    String& buffer = buffers[i];
+                    buffer.clear();
+                    writeBrush(buffer, brushes[first + i], static_cast<ObjectNo>(brushNo() + first + i));
+                });
+
+                for (size_t i = 0; i < count; ++i) {
+                    m_stream.write(buffers[i].data(), static_cast<std::streamsize>(buffers[i].size()));
+                }
+            }
+        }
+
+        void MapStreamSerializer::writeBrush(String& buffer, Model::Brush* brush, const ObjectNo no) {
+            buffer += "// brush ";
+            buffer += std::to_string(no);
+            buffer += "\n{\n";
+            for (Model::BrushFace* face : brush->faces()) {
+                doWriteBrushFace(buffer, face);
+            }
+            buffer += "}\n";
         }
     }
 }
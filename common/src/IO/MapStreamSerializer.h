@@ -46,8 +46,12 @@ namespace TrenchBroom {
             void doBeginBrush(const Model::Brush* brush) override;
             void doEndBrush(Model::Brush* brush) override;
             void doBrushFace(Model::BrushFace* face) override;
+            void doBrushes(const Model::BrushList& brushes) override;
+
+            void writeBrush(String& buffer, Model::Brush* brush, ObjectNo no);
         private:
-            virtual void doWriteBrushFace(std::ostream& stream, Model::BrushFace* face) = 0;
+            // Appends the given face to the given buffer. This may be called from multiple threads at once.
+            virtual void doWriteBrushFace(String& buffer, Model::BrushFace* face) = 0;
         };
     }
 }
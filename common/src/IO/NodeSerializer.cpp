@@ -27,17 +27,19 @@
 
 namespace TrenchBroom {
     namespace IO {
-        class NodeSerializer::BrushSerializer : public Model::NodeVisitor {
+        class NodeSerializer::CollectBrushes : public Model::NodeVisitor {
         private:
-            NodeSerializer& m_serializer;
+            Model::BrushList m_brushes;
         public:
-            BrushSerializer(NodeSerializer& serializer) : m_serializer(serializer) {}
-            
+            const Model::BrushList& brushes() const {
+                return m_brushes;
+            }
+        private:
             void doVisit(Model::World* world) override   {}
             void doVisit(Model::Layer* layer) override   {}
             void doVisit(Model::Group* group) override   {}
             void doVisit(Model::Entity* entity) override {}
-            void doVisit(Model::Brush* brush) override   { m_serializer.brush(brush); }
+            void doVisit(Model::Brush* brush) override   { m_brushes.push_back(brush); }
         };
 
         NodeSerializer::NodeSerializer() :
@@ -79,8 +81,9 @@ namespace TrenchBroom {
         void NodeSerializer::entity(Model::Node* node, const Model::EntityAttribute::List& attributes, const Model::EntityAttribute::List& parentAttributes, Model::Node* brushParent) {
             beginEntity(node, attributes, parentAttributes);
             
-            BrushSerializer brushSerializer(*this);
-            brushParent->iterate(brushSerializer);
+            CollectBrushes collectBrushes;
+            brushParent->iterate(collectBrushes);
+            brushes(collectBrushes.brushes());
             
             endEntity(node);
         }
@@ -117,6 +120,16 @@ namespace TrenchBroom {
         }
         
         void NodeSerializer::brushes(const Model::BrushList& brushes) {
+            const ObjectNo firstBrushNo = m_brushNo;
+            if (brushes.size() < MinParallelBrushCount) {
+                NodeSerializer::doBrushes(brushes);
+            } else {
+                doBrushes(brushes);
+            }
+            m_brushNo = firstBrushNo + static_cast<ObjectNo>(brushes.size());
+        }
+
+        void NodeSerializer::doBrushes(const Model::BrushList& brushes) {
             std::for_each(std::begin(brushes), std::end(brushes),
                           [this](Model::Brush* brush) { this->brush(brush); });
         }
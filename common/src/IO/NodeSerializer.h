@@ -32,9 +32,13 @@ namespace TrenchBroom {
         
         class NodeSerializer {
         private:
-            class BrushSerializer;
+            class CollectBrushes;
         protected:
             static const int FloatPrecision = 17;
+            // the number of brushes that are formatted at once when brushes are formatted in parallel
+            static constexpr size_t BrushBatchSize = 1024;
+            // entities with fewer brushes, which are most brush entities, are always serialized one brush at a time
+            static constexpr size_t MinParallelBrushCount = 64;
             typedef unsigned int ObjectNo;
         private:
             template <typename T>
@@ -125,6 +129,15 @@ namespace TrenchBroom {
             virtual void doBeginBrush(const Model::Brush* brush) = 0;
             virtual void doEndBrush(Model::Brush* brush) = 0;
             virtual void doBrushFace(Model::BrushFace* face) = 0;
+
+            /**
+             * Serializes the given brushes of the current entity. The default implementation serializes them one
+             * by one by calling brush for each of them. Subclasses may override this to format the brushes in
+             * parallel, but the output must be the same. This is only called for entities with at least
+             * MinParallelBrushCount brushes. When this is called, brushNo returns the number of the first of the
+             * given brushes.
+             */
+            virtual void doBrushes(const Model::BrushList& brushes);
         };
     }
 }
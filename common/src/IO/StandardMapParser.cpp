@@ -26,8 +26,175 @@
 #include <vecmath/plane.h>
 #include <vecmath/vec.h>
 
+#include <cstdint>
+#include <cstdlib>
+
 namespace TrenchBroom {
     namespace IO {
+        QuakeMapFaceTokenizer::QuakeMapFaceTokenizer(const char* begin, const char* end) :
+        m_cur(begin),
+        m_end(end) {}
+
+        bool QuakeMapFaceTokenizer::readFace(QuakeMapFace& face, const bool valve) {
+            if (!readPoint(face.p1) || !readPoint(face.p2) || !readPoint(face.p3)) {
+                return false;
+            }
+            if (!readTextureName(face.textureName)) {
+                return false;
+            }
+
+            if (valve) {
+                if (!readTextureAxis(face.texX) || !readTextureAxis(face.texY)) {
+                    return false;
+                }
+                face.xOffset = face.texX.w();
+                face.yOffset = face.texY.w();
+            } else if (!readNumber(face.xOffset) || !readNumber(face.yOffset)) {
+                return false;
+            }
+
+            return readNumber(face.rotation) && readNumber(face.xScale) && readNumber(face.yScale);
+        }
+
+        const char* QuakeMapFaceTokenizer::curPos() const {
+            return m_cur;
+        }
+
+        bool QuakeMapFaceTokenizer::readPoint(vm::vec3& point) {
+            return (readChar('(') &&
+                    readNumber(point[0]) &&
+                    readNumber(point[1]) &&
+                    readNumber(point[2]) &&
+                    readChar(')'));
+        }
+
+        bool QuakeMapFaceTokenizer::readTextureName(std::string_view& textureName) {
+            skipWhitespace();
+
+            // quoted texture names are left to the regular tokenizer
+            if (m_cur == m_end || *m_cur == '"') {
+                return false;
+            }
+
+            const auto* begin = m_cur++;
+            while (m_cur != m_end && *m_cur != ' ' && *m_cur != '\t' && *m_cur != '\n' && *m_cur != '\r') {
+                ++m_cur;
+            }
+            textureName = std::string_view(begin, static_cast<size_t>(m_cur - begin));
+            return true;
+        }
+
+        bool QuakeMapFaceTokenizer::readTextureAxis(vm::vec<FloatType,4>& axis) {
+            return (readChar('[') &&
+                    readNumber(axis[0]) &&
+                    readNumber(axis[1]) &&
+                    readNumber(axis[2]) &&
+                    readNumber(axis[3]) &&
+                    readChar(']'));
+        }
+
+        bool QuakeMapFaceTokenizer::readNumber(double& value) {
+            // powers of ten that are exactly representable as doubles
+            static constexpr double PowersOfTen[] = {
+                1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+            };
+            static constexpr int MaxExactPower = 22;
+            static constexpr uint64_t MaxExactMantissa = uint64_t(1) << 53;
+            static constexpr size_t MaxMantissaDigits = 19;
+
+            skipWhitespace();
+            const auto* begin = m_cur;
+
+            auto negative = false;
+            if (m_cur != m_end && (*m_cur == '+' || *m_cur == '-')) {
+                negative = *m_cur == '-';
+                ++m_cur;
+            }
+
+            uint64_t mantissa = 0;
+            size_t mantissaDigits = 0;
+            auto exponent = 0;
+            auto digits = false;
+            auto truncated = false;
+
+            const auto readDigit = [&](const bool fraction) {
+                const auto digit = static_cast<uint64_t>(*m_cur - '0');
+                if (mantissa == 0 && digit == 0) {
+                    // leading zeros are not significant
+                } else if (mantissaDigits < MaxMantissaDigits) {
+                    mantissa = 10u * mantissa + digit;
+                    ++mantissaDigits;
+                } else {
+                    truncated = true;
+                    if (!fraction) {
+                        ++exponent;
+                    }
+                    return;
+                }
+                if (fraction) {
+                    --exponent;
+                }
+            };
+
+            while (m_cur != m_end && *m_cur >= '0' && *m_cur <= '9') {
+                readDigit(false);
+                digits = true;
+                ++m_cur;
+            }
+            if (m_cur != m_end && *m_cur == '.') {
+                ++m_cur;
+                while (m_cur != m_end && *m_cur >= '0' && *m_cur <= '9') {
+                    readDigit(true);
+                    digits = true;
+                    ++m_cur;
+                }
+            }
+
+            // numbers must be delimited like the regular tokenizer expects, exponents are not handled here
+            if (!digits || (m_cur != m_end && *m_cur != ' ' && *m_cur != '\t' && *m_cur != '\n' && *m_cur != '\r' && *m_cur != ')')) {
+                return false;
+            }
+
+            if (!truncated && mantissa <= MaxExactMantissa && exponent >= -MaxExactPower && exponent <= MaxExactPower) {
+                // both the mantissa and the power of ten are exact, so this is rounded correctly, just like atof
+                value = static_cast<double>(mantissa);
+                if (exponent < 0) {
+                    value /= PowersOfTen[-exponent];
+                } else {
+                    value *= PowersOfTen[exponent];
+                }
+                if (negative) {
+                    value = -value;
+                }
+            } else {
+                char buffer[64];
+                const auto length = static_cast<size_t>(m_cur - begin);
+                if (length >= sizeof(buffer)) {
+                    return false;
+                }
+                std::copy(begin, m_cur, buffer);
+                buffer[length] = 0;
+                value = std::strtod(buffer, nullptr);
+            }
+            return true;
+        }
+
+        bool QuakeMapFaceTokenizer::readChar(const char c) {
+            skipWhitespace();
+            if (m_cur == m_end || *m_cur != c) {
+                return false;
+            }
+            ++m_cur;
+            return true;
+        }
+
+        void QuakeMapFaceTokenizer::skipWhitespace() {
+            while (m_cur != m_end && (*m_cur == ' ' || *m_cur == '\t' || *m_cur == '\n' || *m_cur == '\r')) {
+                ++m_cur;
+            }
+        }
+
         const String& QuakeMapTokenizer::NumberDelim() {
             static const String numberDelim(Whitespace() + ")");
             return numberDelim;
@@ -44,6 +211,17 @@ namespace TrenchBroom {
         void QuakeMapTokenizer::setSkipEol(bool skipEol) {
             m_skipEol = skipEol;
         }
+
+        bool QuakeMapTokenizer::readFace(QuakeMapFace& face, const bool valve) {
+            QuakeMapFaceTokenizer faceTokenizer(curPos(), endPos());
+            if (!faceTokenizer.readFace(face, valve)) {
+                return false;
+            }
+
+            // updates the line and column
+            advance(static_cast<size_t>(faceTokenizer.curPos() - curPos()));
+            return true;
+        }
         
         QuakeMapTokenizer::Token QuakeMapTokenizer::emitToken() {
             while (!eof()) {
@@ -420,15 +598,7 @@ namespace TrenchBroom {
         void StandardMapParser::parseQuakeFace(ParserStatus& status) {
             const auto line = m_tokenizer.line();
 
-            const auto [p1, p2, p3] = parseFacePoints(status);
-            const auto textureName = parseTextureName(status);
-
-            auto attribs = Model::BrushFaceAttributes(textureName);
-            attribs.setXOffset(parseFloat());
-            attribs.setYOffset(parseFloat());
-            attribs.setRotation(parseFloat());
-            attribs.setXScale(parseFloat());
-            attribs.setYScale(parseFloat());
+            auto [p1, p2, p3, attribs] = parseFacePointsAndAttributes(status);
 
             if (checkFacePoints(status, p1, p2, p3, line)) {
                 brushFace(line, p1, p2, p3, attribs, vm::vec3::zero, vm::vec3::zero, status);
@@ -438,15 +608,7 @@ namespace TrenchBroom {
         void StandardMapParser::parseQuake2Face(ParserStatus& status) {
             const auto line = m_tokenizer.line();
 
-            const auto [p1, p2, p3] = parseFacePoints(status);
-            const auto textureName = parseTextureName(status);
-
-            auto attribs = Model::BrushFaceAttributes(textureName);
-            attribs.setXOffset(parseFloat());
-            attribs.setYOffset(parseFloat());
-            attribs.setRotation(parseFloat());
-            attribs.setXScale(parseFloat());
-            attribs.setYScale(parseFloat());
+            auto [p1, p2, p3, attribs] = parseFacePointsAndAttributes(status);
 
             // Quake 2 extra info is optional
             if (!check(QuakeMapToken::OParenthesis | QuakeMapToken::CBrace | QuakeMapToken::Eof, m_tokenizer.peekToken())) {
@@ -463,15 +625,7 @@ namespace TrenchBroom {
         void StandardMapParser::parseHexen2Face(ParserStatus& status) {
             const auto line = m_tokenizer.line();
 
-            const auto [p1, p2, p3] = parseFacePoints(status);
-            const auto textureName = parseTextureName(status);
-
-            auto attribs = Model::BrushFaceAttributes(textureName);
-            attribs.setXOffset(parseFloat());
-            attribs.setYOffset(parseFloat());
-            attribs.setRotation(parseFloat());
-            attribs.setXScale(parseFloat());
-            attribs.setYScale(parseFloat());
+            auto [p1, p2, p3, attribs] = parseFacePointsAndAttributes(status);
 
             // Hexen 2 extra info is optional
             if (!check(QuakeMapToken::OParenthesis | QuakeMapToken::CBrace | QuakeMapToken::Eof, m_tokenizer.peekToken())) {
@@ -486,15 +640,7 @@ namespace TrenchBroom {
         void StandardMapParser::parseDaikatanaFace(ParserStatus& status) {
             const auto line = m_tokenizer.line();
 
-            const auto [p1, p2, p3] = parseFacePoints(status);
-            const auto textureName = parseTextureName(status);
-
-            auto attribs = Model::BrushFaceAttributes(textureName);
-            attribs.setXOffset(parseFloat());
-            attribs.setYOffset(parseFloat());
-            attribs.setRotation(parseFloat());
-            attribs.setXScale(parseFloat());
-            attribs.setYScale(parseFloat());
+            auto [p1, p2, p3, attribs] = parseFacePointsAndAttributes(status);
 
             // Daikatana extra info is optional
             if (check(QuakeMapToken::Integer, m_tokenizer.peekToken())) {
@@ -517,6 +663,25 @@ namespace TrenchBroom {
         void StandardMapParser::parseValveFace(ParserStatus& status) {
             const auto line = m_tokenizer.line();
 
+            QuakeMapFace face;
+            if (m_tokenizer.readFace(face, true)) {
+                const auto p1 = correct(face.p1);
+                const auto p2 = correct(face.p2);
+                const auto p3 = correct(face.p3);
+
+                auto attribs = Model::BrushFaceAttributes(textureName(face.textureName));
+                attribs.setXOffset(static_cast<float>(face.xOffset));
+                attribs.setYOffset(static_cast<float>(face.yOffset));
+                attribs.setRotation(static_cast<float>(face.rotation));
+                attribs.setXScale(static_cast<float>(face.xScale));
+                attribs.setYScale(static_cast<float>(face.yScale));
+
+                if (checkFacePoints(status, p1, p2, p3, line)) {
+                    brushFace(line, p1, p2, p3, attribs, face.texX.xyz(), face.texY.xyz(), status);
+                }
+                return;
+            }
+
             const auto [p1, p2, p3] = parseFacePoints(status);
             const auto textureName = parseTextureName(status);
 
@@ -616,6 +781,28 @@ namespace TrenchBroom {
             status.warn(startLine, "Skipping patch: currently not supported");
         }
 
+        std::tuple<vm::vec3, vm::vec3, vm::vec3, Model::BrushFaceAttributes> StandardMapParser::parseFacePointsAndAttributes(ParserStatus& status) {
+            QuakeMapFace face;
+            if (m_tokenizer.readFace(face, false)) {
+                auto attribs = Model::BrushFaceAttributes(textureName(face.textureName));
+                attribs.setXOffset(static_cast<float>(face.xOffset));
+                attribs.setYOffset(static_cast<float>(face.yOffset));
+                attribs.setRotation(static_cast<float>(face.rotation));
+                attribs.setXScale(static_cast<float>(face.xScale));
+                attribs.setYScale(static_cast<float>(face.yScale));
+                return std::make_tuple(correct(face.p1), correct(face.p2), correct(face.p3), std::move(attribs));
+            }
+
+            const auto [p1, p2, p3] = parseFacePoints(status);
+            auto attribs = Model::BrushFaceAttributes(parseTextureName(status));
+            attribs.setXOffset(parseFloat());
+            attribs.setYOffset(parseFloat());
+            attribs.setRotation(parseFloat());
+            attribs.setXScale(parseFloat());
+            attribs.setYScale(parseFloat());
+            return std::make_tuple(p1, p2, p3, std::move(attribs));
+        }
+
         std::tuple<vm::vec3, vm::vec3, vm::vec3> StandardMapParser::parseFacePoints(ParserStatus& status) {
             const auto p1 = correct(parseFloatVector(QuakeMapToken::OParenthesis, QuakeMapToken::CParenthesis));
             const auto p2 = correct(parseFloatVector(QuakeMapToken::OParenthesis, QuakeMapToken::CParenthesis));
@@ -624,12 +811,15 @@ namespace TrenchBroom {
             return std::make_tuple(p1, p2, p3);
         }
 
-        String StandardMapParser::parseTextureName(ParserStatus& status) {
-            auto textureName = m_tokenizer.readAnyString(QuakeMapTokenizer::Whitespace());
-            if (textureName == Model::BrushFace::NoTextureName) {
-                textureName = "";
+        Assets::TextureName StandardMapParser::parseTextureName(ParserStatus& status) {
+            return textureName(m_tokenizer.readAnyString(QuakeMapTokenizer::Whitespace()));
+        }
+
+        Assets::TextureName StandardMapParser::textureName(const std::string_view name) {
+            if (name == Model::BrushFace::NoTextureName) {
+                return Assets::TextureName();
             }
-            return textureName;
+            return Assets::TextureName(name);
         }
 
         std::tuple<vm::vec3, float, vm::vec3, float> StandardMapParser::parseValveTextureAxes(ParserStatus& status) {
@@ -21,6 +21,7 @@
 #define TrenchBroom_StandardMapParser
 
 #include "TrenchBroom.h"
+#include "Assets/TextureName.h"
 #include "IO/MapParser.h"
 #include "IO/Parser.h"
 #include "IO/Token.h"
@@ -28,7 +29,9 @@
 #include "Model/MapFormat.h"
 
 #include <vecmath/forward.h>
+#include <vecmath/vec.h>
 
+#include <string_view>
 #include <tuple>
 
 namespace TrenchBroom {
@@ -50,6 +53,54 @@ namespace TrenchBroom {
             static const Type Number        = Integer | Decimal;
         }
         
+        /**
+         * The points, texture name and texture attributes of a brush face as read by QuakeMapFaceTokenizer. The
+         * texture name refers to the input buffer. The texture axes and the offsets are only read for faces in
+         * Valve 220 format.
+         */
+        struct QuakeMapFace {
+            vm::vec3 p1, p2, p3;
+            std::string_view textureName;
+            vm::vec<FloatType,4> texX, texY;
+            double xOffset, yOffset;
+            double rotation;
+            double xScale, yScale;
+        };
+
+        /**
+         * A specialized tokenizer for the common part of brush face lines, e.g.
+         *
+         * ( x y z ) ( x y z ) ( x y z ) TEX xOffset yOffset rotation xScale yScale
+         *
+         * It reads directly from the input buffer, keeps no state besides its position and allocates no memory. It
+         * only accepts the usual form of such lines: numbers without exponents, unquoted texture names and no
+         * comments. Anything else makes it fail, and the caller must then fall back to the regular tokenizer, which
+         * also reports any errors. For the input it accepts, it yields exactly the same values as the regular
+         * tokenizer.
+         */
+        class QuakeMapFaceTokenizer {
+        private:
+            const char* m_cur;
+            const char* m_end;
+        public:
+            QuakeMapFaceTokenizer(const char* begin, const char* end);
+
+            /**
+             * Reads a face in the given format. Returns false if the face could not be read, in which case the
+             * position of this tokenizer is unspecified.
+             */
+            bool readFace(QuakeMapFace& face, bool valve);
+
+            const char* curPos() const;
+        private:
+            bool readPoint(vm::vec3& point);
+            bool readTextureName(std::string_view& textureName);
+            bool readTextureAxis(vm::vec<FloatType,4>& axis);
+            bool readNumber(double& value);
+            bool readChar(char c);
+            void skipWhitespace();
+        };
+
         class QuakeMapTokenizer : public Tokenizer<QuakeMapToken::Type> {
         private:
             static const String& NumberDelim();
@@ -59,6 +110,12 @@ namespace TrenchBroom {
             QuakeMapTokenizer(const String& str);
             
             void setSkipEol(bool skipEol);
+
+            /**
+             * Reads a face using QuakeMapFaceTokenizer and skips the consumed input if that succeeds. Otherwise,
+             * nothing is consumed and false is returned.
+             */
+            bool readFace(QuakeMapFace& face, bool valve);
         private:
             Token emitToken() override;
         };
@@ -109,8 +166,10 @@ namespace TrenchBroom {
 
             void parsePatch(ParserStatus& status, size_t startLine);
 
+            std::tuple<vm::vec3, vm::vec3, vm::vec3, Model::BrushFaceAttributes> parseFacePointsAndAttributes(ParserStatus& status);
             std::tuple<vm::vec3, vm::vec3, vm::vec3> parseFacePoints(ParserStatus& status);
-            String parseTextureName(ParserStatus& status);
+            Assets::TextureName parseTextureName(ParserStatus& status);
+            static Assets::TextureName textureName(std::string_view name);
             std::tuple<vm::vec3, float, vm::vec3, float> parseValveTextureAxes(ParserStatus& status);
             std::tuple<vm::vec3, vm::vec3> parsePrimitiveTextureAxes(ParserStatus& status);
 
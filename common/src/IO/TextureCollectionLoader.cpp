@@ -20,6 +20,8 @@
 #include "TextureCollectionLoader.h"
 
 #include "Logger.h"
+#include "ParallelFor.h"
+#include "Assets/Texture.h"
 #include "Assets/AssetTypes.h"
 #include "Assets/TextureCollection.h"
 #include "Assets/TextureManager.h"
@@ -31,6 +33,7 @@
 
 #include <cassert>
 #include <memory>
+#include <vector>
 
 namespace TrenchBroom {
     namespace IO {
@@ -42,9 +45,15 @@ namespace TrenchBroom {
         std::unique_ptr<Assets::TextureCollection> TextureCollectionLoader::loadTextureCollection(const Path& path, const StringList& textureExtensions, const TextureReader& textureReader) {
             auto collection = std::make_unique<Assets::TextureCollection>(path);
 
-            for (auto file : doFindTextures(path, textureExtensions)) {
-                auto* texture = textureReader.readTexture(file);
-                collection->addTexture(texture);
+            // decoding the textures is independent of each other, only adding them to the collection must be in order
+            const auto files = doFindTextures(path, textureExtensions);
+            std::vector<std::unique_ptr<Assets::Texture>> textures(files.size());
+            parallelFor(files.size(), [&](const size_t i) {
+                textures[i].reset(textureReader.readTexture(files[i]));
+            });
+
+            for (auto& texture : textures) {
+                collection->addTexture(texture.release());
             }
             
             return collection;
@@ -218,6 +218,10 @@ namespace TrenchBroom {
                 return m_state->curPos();
             }
 
+            const char* endPos() const {
+                return m_state->end();
+            }
+
             char curChar() const {
                 if (eof()) {
                     return 0;
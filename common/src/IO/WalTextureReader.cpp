@@ -56,9 +56,9 @@ namespace TrenchBroom {
 
         Assets::Texture* WalTextureReader::readQ2Wal(CharArrayReader& reader, const Path& path) const {
             static const size_t MaxMipLevels = 4;
-            static Color tempColor, averageColor;
-            static Assets::TextureBuffer::List buffers(MaxMipLevels);
-            static size_t offsets[MaxMipLevels];
+            Color averageColor;
+            Assets::TextureBuffer::List buffers(MaxMipLevels);
+            size_t offsets[MaxMipLevels];
 
             const String name = reader.readString(WalLayout::TextureNameLength);
             const size_t width = reader.readSize<uint32_t>();
@@ -76,9 +76,9 @@ namespace TrenchBroom {
 
         Assets::Texture* WalTextureReader::readDkWal(CharArrayReader& reader, const Path& path) const {
             static const size_t MaxMipLevels = 9;
-            static Color tempColor, averageColor;
-            static Assets::TextureBuffer::List buffers(MaxMipLevels);
-            static size_t offsets[MaxMipLevels];
+            Color averageColor;
+            Assets::TextureBuffer::List buffers(MaxMipLevels);
+            size_t offsets[MaxMipLevels];
 
             const char version = reader.readChar<char>();
             ensure(version == 3, "Unknown WAL texture version");
@@ -117,7 +117,7 @@ namespace TrenchBroom {
         }
 
         bool WalTextureReader::readMips(const Assets::Palette& palette, const size_t mipLevels, const size_t offsets[], const size_t width, const size_t height, CharArrayReader& reader, Assets::TextureBuffer::List& buffers, Color& averageColor, const Assets::PaletteTransparency transparency) {
-            static Color tempColor;
+            Color tempColor;
 
             auto hasTransparency = false;
             for (size_t i = 0; i < mipLevels; ++i) {
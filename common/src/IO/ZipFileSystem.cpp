@@ -34,12 +34,14 @@
 
 namespace TrenchBroom {
     namespace IO {
-        ZipFileSystem::ZipCompressedFile::ZipCompressedFile(std::shared_ptr<wxZipInputStream> stream, std::unique_ptr<wxZipEntry> entry) :
+        ZipFileSystem::ZipCompressedFile::ZipCompressedFile(std::shared_ptr<wxZipInputStream> stream, std::mutex& streamMutex, std::unique_ptr<wxZipEntry> entry) :
         m_stream(std::move(stream)),
+        m_streamMutex(streamMutex),
         m_entry(std::move(entry)) {}
 
         MappedFile::Ptr ZipFileSystem::ZipCompressedFile::doOpen() const {
             const auto path = Path(m_entry->GetName().ToStdString());
+            std::lock_guard<std::mutex> lock(m_streamMutex);
 
             if (!m_stream->OpenEntry(*m_entry)) {
                 throw FileSystemException("Could not open zip entry at " + path.asString());
@@ -76,7 +78,7 @@ namespace TrenchBroom {
                 auto entry = std::unique_ptr<wxZipEntry>(stream->GetNextEntry());
                 if (!entry->IsDir()) {
                     const auto path = Path(entry->GetName().ToStdString());
-                    m_root.addFile(path, std::make_unique<ZipCompressedFile>(stream, std::move(entry)));
+                    m_root.addFile(path, std::make_unique<ZipCompressedFile>(stream, m_streamMutex, std::move(entry)));
                 }
             }
 
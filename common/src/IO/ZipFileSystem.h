@@ -26,6 +26,7 @@
 #include "IO/Path.h"
 
 #include <memory>
+#include <mutex>
 
 class wxZipInputStream;
 class wxZipEntry;
@@ -37,12 +38,16 @@ namespace TrenchBroom {
             class ZipCompressedFile : public File {
             private:
                 std::shared_ptr<wxZipInputStream> m_stream;
+                std::mutex& m_streamMutex;
                 std::unique_ptr<wxZipEntry> m_entry;
             public:
-                ZipCompressedFile(std::shared_ptr<wxZipInputStream> stream, std::unique_ptr<wxZipEntry> entry);
+                ZipCompressedFile(std::shared_ptr<wxZipInputStream> stream, std::mutex& streamMutex, std::unique_ptr<wxZipEntry> entry);
             private:
                 MappedFile::Ptr doOpen() const override;
             };
+
+            // all files share the stream, so files may only be decompressed one at a time
+            std::mutex m_streamMutex;
         public:
             ZipFileSystem(const Path& path, MappedFile::Ptr file);
             ZipFileSystem(std::unique_ptr<FileSystem> next, const Path& path, MappedFile::Ptr file);
@@ -0,0 +1,115 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MemoryUsage.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+namespace TrenchBroom {
+    MemoryUsage::MemoryUsage() {
+        m_bytes.fill(0);
+    }
+
+    void MemoryUsage::add(const Category category, const size_t bytes) {
+        assert(category != Category::Count);
+        m_bytes[static_cast<size_t>(category)] += bytes;
+    }
+
+    size_t MemoryUsage::bytes(const Category category) const {
+        assert(category != Category::Count);
+        return m_bytes[static_cast<size_t>(category)];
+    }
+
+    size_t MemoryUsage::total() const {
+        return std::accumulate(std::begin(m_bytes), std::end(m_bytes), size_t(0));
+    }
+
+    MemoryUsage& MemoryUsage::operator+=(const MemoryUsage& other) {
+        for (size_t i = 0; i < CategoryCount; ++i) {
+            m_bytes[i] += other.m_bytes[i];
+        }
+        return *this;
+    }
+
+    const char* MemoryUsage::categoryName(const Category category) {
+        switch (category) {
+            case Category::Nodes:
+                return "Nodes";
+            case Category::EntityAttributes:
+                return "Entity attributes";
+            case Category::BrushFaces:
+                return "Brush faces";
+            case Category::FaceAttributes:
+                return "Face attributes";
+            case Category::TexCoordSystems:
+                return "Texture coordinate systems";
+            case Category::PolyhedronElements:
+                return "Polyhedron elements";
+            case Category::RendererCaches:
+                return "Renderer caches";
+            case Category::Snapshots:
+                return "Undo snapshots";
+            case Category::Textures:
+                return "Textures";
+            case Category::EntityModels:
+                return "Entity models";
+            case Category::Count:
+                break;
+        }
+        return "Unknown";
+    }
+
+    String formatBytes(const size_t bytes) {
+        std::stringstream str;
+        str << std::fixed << std::setprecision(2) << static_cast<double>(bytes) / (1024.0 * 1024.0) << " MiB";
+        return str.str();
+    }
+
+    String MemoryUsage::asString() const {
+        size_t nameWidth = 0;
+        for (size_t i = 0; i < CategoryCount; ++i) {
+            nameWidth = std::max(nameWidth, std::strlen(categoryName(static_cast<Category>(i))));
+        }
+
+        std::stringstream str;
+        for (size_t i = 0; i < CategoryCount; ++i) {
+            str << std::left << std::setw(static_cast<int>(nameWidth)) << categoryName(static_cast<Category>(i)) << "  "
+                << std::right << std::setw(12) << formatBytes(m_bytes[i]) << "\n";
+        }
+        str << std::left << std::setw(static_cast<int>(nameWidth)) << "Total" << "  "
+            << std::right << std::setw(12) << formatBytes(total()) << "\n";
+        return str.str();
+    }
+
+    size_t heapMemoryUsage(const String& str) {
+        // short strings are stored inside of the string object
+        const auto data = reinterpret_cast<uintptr_t>(str.data());
+        const auto object = reinterpret_cast<uintptr_t>(&str);
+        if (data >= object && data < object + sizeof(String)) {
+            return 0;
+        }
+        return str.capacity() + 1;
+    }
+}
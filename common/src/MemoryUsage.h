@@ -0,0 +1,92 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MemoryUsage_h
+#define TrenchBroom_MemoryUsage_h
+
+#include "StringUtils.h"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace TrenchBroom {
+    /**
+     * Accumulates the number of bytes used by the different parts of a document, broken down by category.
+     *
+     * The numbers are estimates: they include the size of the objects and the memory they allocate on the
+     * heap, but not the overhead of the heap itself.
+     */
+    class MemoryUsage {
+    public:
+        enum class Category : size_t {
+            Nodes,
+            EntityAttributes,
+            BrushFaces,
+            FaceAttributes,
+            TexCoordSystems,
+            PolyhedronElements,
+            RendererCaches,
+            Snapshots,
+            Textures,
+            EntityModels,
+            Count
+        };
+    private:
+        static constexpr size_t CategoryCount = static_cast<size_t>(Category::Count);
+        std::array<size_t, CategoryCount> m_bytes;
+    public:
+        MemoryUsage();
+
+        void add(Category category, size_t bytes);
+        size_t bytes(Category category) const;
+        size_t total() const;
+
+        MemoryUsage& operator+=(const MemoryUsage& other);
+
+        static const char* categoryName(Category category);
+
+        /**
+         * Returns a table with one line per category and a line for the total.
+         */
+        String asString() const;
+    };
+
+    /**
+     * Returns the given number of bytes as a human readable string in MiB.
+     */
+    String formatBytes(size_t bytes);
+
+    /**
+     * Returns the number of bytes the given string has allocated on the heap, which is 0 if the string is
+     * stored in the string object itself.
+     */
+    size_t heapMemoryUsage(const String& str);
+
+    /**
+     * Returns the number of bytes the given vector has allocated for its elements, not counting any memory
+     * the elements have allocated themselves.
+     */
+    template <typename T, typename A>
+    size_t heapMemoryUsage(const std::vector<T, A>& vec) {
+        return vec.capacity() * sizeof(T);
+    }
+}
+
+#endif /* TrenchBroom_MemoryUsage_h */
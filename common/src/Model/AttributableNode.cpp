@@ -536,7 +536,7 @@ namespace TrenchBroom {
                 target->addLinkSource(this);
                 m_linkTargets.push_back(target);
             }
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::Links);
         }
         
         void AttributableNode::addKillTargets(const AttributableNodeList& targets) {
@@ -545,7 +545,7 @@ namespace TrenchBroom {
                 target->addKillSource(this);
                 m_killTargets.push_back(target);
             }
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::Links);
         }
 
         void AttributableNode::addLinkSources(const AttributableNodeList& sources) {
@@ -554,7 +554,7 @@ namespace TrenchBroom {
                 linkSource->addLinkTarget(this);
                 m_linkSources.push_back(linkSource);
             }
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::Links);
         }
         
         void AttributableNode::addKillSources(const AttributableNodeList& sources) {
@@ -563,35 +563,35 @@ namespace TrenchBroom {
                 killSource->addKillTarget(this);
                 m_killSources.push_back(killSource);
             }
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::Links);
         }
 
         void AttributableNode::removeAllLinkSources() {
             for (AttributableNode* linkSource : m_linkSources)
                 linkSource->removeLinkTarget(this);
             m_linkSources.clear();
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::Links);
         }
         
         void AttributableNode::removeAllLinkTargets() {
             for (AttributableNode* linkTarget : m_linkTargets)
                 linkTarget->removeLinkSource(this);
             m_linkTargets.clear();
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::Links);
         }
         
         void AttributableNode::removeAllKillSources() {
             for (AttributableNode* killSource : m_killSources)
                 killSource->removeKillTarget(this);
             m_killSources.clear();
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::Links);
         }
         
         void AttributableNode::removeAllKillTargets() {
             for (AttributableNode* killTarget : m_killTargets)
                 killTarget->removeKillSource(this);
             m_killTargets.clear();
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::Links);
         }
 
         void AttributableNode::removeAllLinks() {
@@ -625,43 +625,43 @@ namespace TrenchBroom {
         void AttributableNode::addLinkSource(AttributableNode* attributable) {
             ensure(attributable != nullptr, "attributable is null");
             m_linkSources.push_back(attributable);
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::Links);
         }
         
         void AttributableNode::addLinkTarget(AttributableNode* attributable) {
             ensure(attributable != nullptr, "attributable is null");
             m_linkTargets.push_back(attributable);
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::Links);
         }
         
         void AttributableNode::addKillSource(AttributableNode* attributable) {
             ensure(attributable != nullptr, "attributable is null");
             m_killSources.push_back(attributable);
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::Links);
         }
         
         void AttributableNode::addKillTarget(AttributableNode* attributable) {
             ensure(attributable != nullptr, "attributable is null");
             m_killTargets.push_back(attributable);
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::Links);
         }
         
         void AttributableNode::removeLinkSource(AttributableNode* attributable) {
             ensure(attributable != nullptr, "attributable is null");
             VectorUtils::erase(m_linkSources, attributable);
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::Links);
         }
         
         void AttributableNode::removeLinkTarget(AttributableNode* attributable) {
             ensure(attributable != nullptr, "attributable is null");
             VectorUtils::erase(m_linkTargets, attributable);
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::Links);
         }
         
         void AttributableNode::removeKillSource(AttributableNode* attributable) {
             ensure(attributable != nullptr, "attributable is null");
             VectorUtils::erase(m_killSources, attributable);
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::Links);
         }
         
         AttributableNode::AttributableNode() :
@@ -19,8 +19,10 @@
 
 #include "Brush.h"
 
+#include "AABBTree.h"
 #include "CollectionUtils.h"
 #include "Macros.h"
+#include "MemoryUsage.h"
 #include "Model/BrushContentTypeBuilder.h"
 #include "Model/BrushFace.h"
 #include "Model/BrushGeometry.h"
@@ -42,19 +44,22 @@
 #include <vecmath/segment.h>
 #include <vecmath/polygon.h>
 #include <vecmath/util.h>
+#include <vecmath/intersection_batch.h>
 
 #include <algorithm>
+#include <functional>
 #include <iterator>
+#include <memory>
 
 namespace TrenchBroom {
     namespace Model {
         const Hit::HitType Brush::BrushHit = Hit::freeHitType();
 
-        BrushVertex*& Brush::ProjectToVertex::project(BrushVertex*& vertex) {
+        BrushVertex* Brush::ProjectToVertex::project(BrushVertex* vertex) {
             return vertex;
         }
 
-        BrushEdge*& Brush::ProjectToEdge::project(BrushEdge*& edge) {
+        BrushEdge* Brush::ProjectToEdge::project(BrushEdge* edge) {
             return edge;
         }
 
@@ -299,6 +304,16 @@ namespace TrenchBroom {
             }
         }
 
+        Brush::Brush(const BrushFaceList& faces, std::shared_ptr<BrushGeometry> geometry) :
+        m_geometry(std::move(geometry)),
+        m_contentTypeBuilder(nullptr),
+        m_contentType(0),
+        m_transparent(false),
+        m_contentTypeValid(true) {
+            addFaces(faces);
+            assert(checkGeometry());
+        }
+
         Brush::~Brush() {
             cleanup();
         }
@@ -341,8 +356,14 @@ namespace TrenchBroom {
         }
 
         BrushFace* Brush::findFace(const String& textureName) const {
+            Assets::TextureName name;
+            if (!Assets::TextureName::find(textureName, name)) {
+                // no face can have a texture whose name was never interned
+                return nullptr;
+            }
+
             for (BrushFace* face : m_faces) {
-                if (face->textureName() == textureName) {
+                if (face->internedTextureName() == name) {
                     return face;
                 }
             }
@@ -408,6 +429,27 @@ namespace TrenchBroom {
             nodeBoundsDidChange(oldBounds);
         }
 
+        void Brush::restoreFaces(const BrushFaceList& faces, std::shared_ptr<BrushGeometry> geometry, const std::vector<BrushFaceGeometry*>& faceGeometries) {
+            assert(faces.size() == faceGeometries.size());
+            const NotifyNodeChange nodeChange(this);
+
+            const vm::bbox3 oldBounds = bounds();
+            deleteGeometry();
+
+            detachFaces(m_faces);
+            VectorUtils::clearAndDelete(m_faces);
+
+            for (size_t i = 0; i < faces.size(); ++i) {
+                faces[i]->setGeometry(faceGeometries[i]);
+                faces[i]->resetTexCoordSystemCache();
+            }
+            addFaces(faces);
+            m_geometry = std::move(geometry);
+            assert(checkGeometry());
+
+            nodeBoundsDidChange(oldBounds);
+        }
+
         bool Brush::closed() const {
             ensure(m_geometry != nullptr, "geometry is null");
             return m_geometry->closed();
@@ -949,20 +991,23 @@ namespace TrenchBroom {
 
             BrushGeometry remaining;
             BrushGeometry moving;
-            BrushGeometry result;
+            std::vector<vm::vec3> resultPositions;
+            resultPositions.reserve(vertexCount());
             for (const auto* vertex : m_geometry->vertices()) {
                 const auto& position = vertex->position();
                 if (!vertexSet.count(position)) {
                     // the vertex is not moving
                     remaining.addPoint(position);
-                    result.addPoint(position);
+                    resultPositions.push_back(position);
                 } else {
                     // the vertex is moving
                     moving.addPoint(position);
-                    result.addPoint(position + delta);
+                    resultPositions.push_back(position + delta);
                 }
             }
 
+            BrushGeometry result(resultPositions);
+
             // Will the result go out of world bounds?
             if (!worldBounds.contains(result.bounds())) {
                 return CanMoveVerticesResult::rejectVertexMove();
@@ -1026,18 +1071,21 @@ namespace TrenchBroom {
             ensure(!vertexPositions.empty(), "no vertex positions");
             assert(canMoveVertices(worldBounds, vertexPositions, delta));
 
-            BrushGeometry newGeometry;
             const auto vertexSet = Brush::createVertexSet(vertexPositions);
 
+            std::vector<vm::vec3> newPositions;
+            newPositions.reserve(vertexCount());
             for (auto* vertex : m_geometry->vertices()) {
                 const auto& position = vertex->position();
                 if (vertexSet.count(position)) {
-                    newGeometry.addPoint(position + delta);
+                    newPositions.push_back(position + delta);
                 } else {
-                    newGeometry.addPoint(position);
+                    newPositions.push_back(position);
                 }
             }
 
+            BrushGeometry newGeometry(newPositions);
+
             using VecMap = std::map<vm::vec3, vm::vec3>;
             VecMap vertexMapping;
             for (auto* oldVertex : m_geometry->vertices()) {
@@ -1160,18 +1208,7 @@ namespace TrenchBroom {
         }
 
         BrushList Brush::subtract(const ModelFactory& factory, const vm::bbox3& worldBounds, const String& defaultTextureName, const BrushList& subtrahends) const {
-            auto result = std::list<BrushGeometry>{*m_geometry};
-
-            for (auto* subtrahend : subtrahends) {
-                auto nextResults = std::list<BrushGeometry>();
-
-                for (const BrushGeometry& fragment : result) {
-                    const auto subFragments = fragment.subtract(*subtrahend->m_geometry);
-                    ListUtils::append(nextResults, subFragments);
-                }
-
-                result = nextResults;
-            }
+            const auto result = subtractGeometry(subtrahends);
 
             BrushList brushes;
             brushes.reserve(result.size());
@@ -1188,6 +1225,158 @@ namespace TrenchBroom {
             return subtract(factory, worldBounds, defaultTextureName, BrushList{subtrahend});
         }
 
+        std::vector<BrushList> Brush::subtractAll(const ModelFactory& factory, const vm::bbox3& worldBounds, const String& defaultTextureName, const BrushList& minuends, const BrushList& subtrahends, const size_t threadCount) {
+            // the tree stores the indices of the subtrahends so that each minuend can process its subtrahends in
+            // the given order, which determines the fragments and the face attributes of the result
+            using SubtrahendTree = AABBTree<FloatType, 3, size_t>;
+
+            SubtrahendTree::EntryList entries;
+            entries.reserve(subtrahends.size());
+            for (size_t i = 0; i < subtrahends.size(); ++i) {
+                entries.emplace_back(subtrahends[i]->bounds(), i);
+            }
+
+            SubtrahendTree tree;
+            tree.clearAndBuild(entries, threadCount);
+
+            struct Subtraction {
+                BrushList subtrahends;
+                std::vector<std::vector<vm::vec3>> fragments;
+            };
+
+            std::vector<Subtraction> subtractions(minuends.size());
+            parallelFor(minuends.size(), [&](const size_t i) {
+                const auto* minuend = minuends[i];
+                auto& subtraction = subtractions[i];
+
+                std::vector<size_t> indices;
+                tree.findIntersectors(minuend->bounds(), std::back_inserter(indices));
+                std::sort(std::begin(indices), std::end(indices));
+
+                subtraction.subtrahends.reserve(indices.size());
+                for (const auto index : indices) {
+                    subtraction.subtrahends.push_back(subtrahends[index]);
+                }
+
+                auto fragments = minuend->subtractGeometry(subtraction.subtrahends);
+                mergeFragments(fragments);
+
+                subtraction.fragments.reserve(fragments.size());
+                for (const auto& fragment : fragments) {
+                    subtraction.fragments.push_back(facePoints(fragment));
+                }
+            }, threadCount);
+
+            // Creating the brushes changes the usage counts of their textures, which is not thread safe.
+            std::vector<BrushList> result;
+            result.reserve(minuends.size());
+
+            for (size_t i = 0; i < minuends.size(); ++i) {
+                const auto& subtraction = subtractions[i];
+
+                BrushList brushes;
+                brushes.reserve(subtraction.fragments.size());
+                for (const auto& points : subtraction.fragments) {
+                    brushes.push_back(minuends[i]->createBrush(factory, worldBounds, defaultTextureName, points, subtraction.subtrahends));
+                }
+                result.push_back(std::move(brushes));
+            }
+
+            return result;
+        }
+
+        Brush::FragmentList Brush::subtractGeometry(const BrushList& subtrahends) const {
+            auto result = FragmentList{*m_geometry};
+
+            for (const auto* subtrahend : subtrahends) {
+                const auto& subtrahendBounds = subtrahend->bounds();
+                auto nextResults = FragmentList();
+
+                for (auto& fragment : result) {
+                    if (fragment.bounds().intersects(subtrahendBounds)) {
+                        nextResults.splice(std::end(nextResults), fragment.subtract(*subtrahend->m_geometry));
+                    } else {
+                        nextResults.push_back(std::move(fragment));
+                    }
+                }
+
+                result = std::move(nextResults);
+            }
+
+            return result;
+        }
+
+        void Brush::mergeFragments(FragmentList& fragments) {
+            static constexpr FloatType RelativeVolumeEpsilon = 1e-9;
+
+            // Each fragment absorbs as many others as possible before moving on. A fragment that was rejected earlier
+            // may fit the grown hull, so all other fragments are checked again after a merge, but the scan never
+            // restarts from the beginning of the list.
+            for (auto first = std::begin(fragments); first != std::end(fragments); ++first) {
+                bool merged;
+                do {
+                    merged = false;
+                    auto second = std::begin(fragments);
+                    while (second != std::end(fragments)) {
+                        if (second == first || !first->bounds().intersects(second->bounds()) || !shareFace(*first, *second)) {
+                            ++second;
+                            continue;
+                        }
+
+                        auto hull = *first;
+                        hull.merge(*second);
+
+                        // The hull contains both fragments, so it is their union if it isn't any larger. The rounding
+                        // error of a volume grows with the volume itself, so the tolerance is relative to the hull.
+                        if (!hull.polyhedron()) {
+                            ++second;
+                            continue;
+                        }
+
+                        const auto hullVolume = hull.volume();
+                        if (hullVolume - first->volume() - second->volume() <= RelativeVolumeEpsilon * hullVolume) {
+                            *first = std::move(hull);
+                            second = fragments.erase(second);
+                            merged = true;
+                        } else {
+                            ++second;
+                        }
+                    }
+                } while (merged);
+            }
+        }
+
+        bool Brush::shareFace(const BrushGeometry& lhs, const BrushGeometry& rhs) {
+            for (const auto* lhsFace : lhs.faces()) {
+                // the shared face is oriented the other way in the other fragment
+                auto lhsPositions = lhsFace->vertexPositions();
+                std::reverse(std::begin(lhsPositions), std::end(lhsPositions));
+                for (const auto* rhsFace : rhs.faces()) {
+                    if (rhsFace->vertexCount() == lhsPositions.size() && rhsFace->hasVertexPositions(lhsPositions, vm::constants<FloatType>::almostZero())) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        std::vector<vm::vec3> Brush::facePoints(const BrushGeometry& geometry) {
+            std::vector<vm::vec3> result;
+            result.reserve(3u * geometry.faceCount());
+
+            for (const auto* face : geometry.faces()) {
+                const auto* h1 = face->boundary().front();
+                const auto* h0 = h1->next();
+                const auto* h2 = h0->next();
+
+                result.push_back(h0->origin()->position());
+                result.push_back(h1->origin()->position());
+                result.push_back(h2->origin()->position());
+            }
+
+            return result;
+        }
+
         void Brush::intersect(const vm::bbox3& worldBounds, const Brush* brush) {
             for (const auto* face : brush->faces()) {
                 addFace(face->clone());
@@ -1211,20 +1400,18 @@ namespace TrenchBroom {
         }
 
         Brush* Brush::createBrush(const ModelFactory& factory, const vm::bbox3& worldBounds, const String& defaultTextureName, const BrushGeometry& geometry, const BrushList& subtrahends) const {
-            BrushFaceList faces(0);
-            faces.reserve(geometry.faceCount());
+            return createBrush(factory, worldBounds, defaultTextureName, facePoints(geometry), subtrahends);
+        }
 
-            for (const auto* face : geometry.faces()) {
-                const auto* h1 = face->boundary().front();
-                const auto* h0 = h1->next();
-                const auto* h2 = h0->next();
+        Brush* Brush::createBrush(const ModelFactory& factory, const vm::bbox3& worldBounds, const String& defaultTextureName, const std::vector<vm::vec3>& facePoints, const BrushList& subtrahends) const {
+            assert(facePoints.size() % 3u == 0u);
 
-                const auto& p0 = h0->origin()->position();
-                const auto& p1 = h1->origin()->position();
-                const auto& p2 = h2->origin()->position();
+            BrushFaceList faces(0);
+            faces.reserve(facePoints.size() / 3u);
 
+            for (size_t i = 0; i < facePoints.size(); i += 3u) {
                 BrushFaceAttributes attribs(defaultTextureName);
-                faces.push_back(factory.createFace(p0, p1, p2, attribs));
+                faces.push_back(factory.createFace(facePoints[i], facePoints[i + 1u], facePoints[i + 2u], attribs));
             }
 
             auto* brush = factory.createBrush(worldBounds, faces);
@@ -1273,7 +1460,11 @@ namespace TrenchBroom {
         void Brush::buildGeometry(const vm::bbox3& worldBounds) {
             assert(m_geometry == nullptr);
 
-            m_geometry = new BrushGeometry(worldBounds.expand(1.0));
+            if (buildGeometryFromPlanes(worldBounds)) {
+                return;
+            }
+
+            m_geometry = std::make_shared<BrushGeometry>(worldBounds.expand(1.0));
 
             AddFacesToGeometry addFacesToGeometry(*m_geometry, m_faces);
             updateFacesFromGeometry(worldBounds, *m_geometry);
@@ -1287,6 +1478,55 @@ namespace TrenchBroom {
             }
         }
 
+        bool Brush::buildGeometryFromPlanes(const vm::bbox3& worldBounds) {
+            assert(m_geometry == nullptr);
+
+            std::vector<vm::plane3> planes;
+            planes.reserve(m_faces.size());
+            for (const auto* face : m_faces) {
+                planes.push_back(face->boundary());
+            }
+
+            auto geometry = std::make_unique<BrushGeometry>();
+            std::vector<BrushFaceGeometry*> faceGeometries;
+            if (!geometry->setPlanes(planes, faceGeometries)) {
+                return false;
+            }
+
+            // the clipping path reports brushes that touch or exceed the expanded world bounds as not fully specified
+            const auto bounds = worldBounds.expand(1.0);
+            const auto& geometryBounds = geometry->bounds();
+            for (size_t i = 0; i < 3; ++i) {
+                if (geometryBounds.min[i] <= bounds.min[i] || geometryBounds.max[i] >= bounds.max[i]) {
+                    return false;
+                }
+            }
+
+            m_geometry = std::move(geometry);
+            for (size_t i = 0; i < m_faces.size(); ++i) {
+                auto* brushFace = m_faces[i];
+                if (faceGeometries[i] != nullptr) {
+                    brushFace->setGeometry(faceGeometries[i]);
+                } else {
+                    // the face does not contribute to the brush, this is what clipping does with faces that are
+                    // removed by subsequent faces
+                    ensure(!brushFace->selected(), "brush face is selected");
+                    delete brushFace;
+                }
+            }
+
+            m_geometry->correctVertexPositions();
+
+            HealEdgesCallback healCallback;
+            const auto valid = m_geometry->healEdges(healCallback);
+            updateFacesFromGeometry(worldBounds, *m_geometry);
+
+            if (!valid) {
+                throw GeometryException("Brush is invalid");
+            }
+            return true;
+        }
+
         void Brush::deleteGeometry() {
             assert(m_geometry != nullptr);
 
@@ -1294,8 +1534,7 @@ namespace TrenchBroom {
             for (auto* brushFace : m_faces) {
                 brushFace->setGeometry(nullptr);
             }
-            delete m_geometry;
-            m_geometry = nullptr;
+            m_geometry.reset();
         }
 
         bool Brush::checkGeometry() const {
@@ -1384,11 +1623,34 @@ namespace TrenchBroom {
             BrushFaceList faceClones;
             faceClones.reserve(m_faces.size());
 
+            // the geometry faces are not in the same order as m_faces, so the clones are looked up in a sorted table
+            using CloneTable = std::vector<std::pair<const BrushFace*, BrushFace*>>;
+            CloneTable clones;
+            clones.reserve(m_faces.size());
+
             for (const auto* face : m_faces) {
-                faceClones.push_back(face->clone());
+                auto* clone = face->clone();
+                faceClones.push_back(clone);
+                clones.emplace_back(face, clone);
+            }
+
+            const auto compare = [](const CloneTable::value_type& entry, const BrushFace* face) {
+                return std::less<const BrushFace*>()(entry.first, face);
+            };
+            std::sort(std::begin(clones), std::end(clones), [&](const auto& lhs, const auto& rhs) { return compare(lhs, rhs.first); });
+
+            // Copying the geometry is much cheaper than building it from the faces again. The copy has the same
+            // face order as the original.
+            auto geometry = std::make_shared<BrushGeometry>(*m_geometry);
+            auto copy = std::begin(geometry->faces());
+            for (const auto* original : m_geometry->faces()) {
+                const auto it = std::lower_bound(std::begin(clones), std::end(clones), original->payload(), compare);
+                assert(it != std::end(clones) && it->first == original->payload());
+                it->second->setGeometry(*copy);
+                ++copy;
             }
 
-            auto* brush = new Brush(worldBounds, faceClones);
+            auto* brush = new Brush(faceClones, std::move(geometry));
             brush->setContentTypeBuilder(m_contentTypeBuilder);
             cloneAttributes(brush);
             return brush;
@@ -1459,6 +1721,26 @@ namespace TrenchBroom {
                 return BrushFaceHit();
             }
 
+            // Since the brush is convex, the ray hits the face whose plane it enters last. Clip the ray against all
+            // face planes at once if they fit on the stack, otherwise test each face polygon.
+            static const size_t MaxPackedFaces = 64;
+            if (m_faces.size() <= MaxPackedFaces) {
+                FloatType nx[MaxPackedFaces], ny[MaxPackedFaces], nz[MaxPackedFaces], d[MaxPackedFaces];
+                for (size_t i = 0; i < m_faces.size(); ++i) {
+                    const auto& boundary = m_faces[i]->boundary();
+                    nx[i] = boundary.normal.x();
+                    ny[i] = boundary.normal.y();
+                    nz[i] = boundary.normal.z();
+                    d[i] = boundary.distance;
+                }
+
+                const auto [index, distance] = vm::intersectConvex(ray, nx, ny, nz, d, m_faces.size());
+                if (index < m_faces.size()) {
+                    return BrushFaceHit(m_faces[index], distance);
+                }
+                return BrushFaceHit();
+            }
+
             for (auto* face : m_faces) {
                 const auto distance = face->intersectWithRay(ray);
                 if (!vm::isnan(distance)) {
@@ -1571,5 +1853,18 @@ namespace TrenchBroom {
         Renderer::BrushRendererBrushCache& Brush::brushRendererBrushCache() const {
             return m_brushRendererBrushCache;
         }
+
+        void Brush::accountMemoryUsage(MemoryUsage& usage) const {
+            usage.add(MemoryUsage::Category::BrushFaces, heapMemoryUsage(m_faces));
+            for (const auto* face : m_faces) {
+                face->accountMemoryUsage(usage);
+            }
+
+            if (m_geometry != nullptr) {
+                usage.add(MemoryUsage::Category::PolyhedronElements, m_geometry->memoryUsage());
+            }
+
+            usage.add(MemoryUsage::Category::RendererCaches, m_brushRendererBrushCache.memoryUsage());
+        }
     }
 }
@@ -22,6 +22,7 @@
 
 #include "TrenchBroom.h"
 #include "Hit.h"
+#include "ParallelFor.h"
 #include "ProjectingSequence.h"
 #include "Polyhedron_Matcher.h"
 #include "Model/BrushContentType.h"
@@ -40,10 +41,14 @@
 #include <vecmath/segment.h>
 #include <vecmath/polygon.h>
 
+#include <list>
+#include <memory>
 #include <set>
 #include <vector>
 
 namespace TrenchBroom {
+    class MemoryUsage;
+
     namespace Model {
         struct BrushAlgorithmResult;
         class BrushContentTypeBuilder;
@@ -54,15 +59,16 @@ namespace TrenchBroom {
         class Brush : public Node, public Object {
         private:
             friend class SetTempFaceLinks;
+            friend class BrushSnapshot;
         public:
             static const Hit::HitType BrushHit;
         private:
             struct ProjectToVertex : public ProjectingSequenceProjector<BrushVertex*, BrushVertex*> {
-                static BrushVertex*& project(BrushVertex*& vertex);
+                static BrushVertex* project(BrushVertex* vertex);
             };
 
             struct ProjectToEdge : public ProjectingSequenceProjector<BrushEdge*, BrushEdge*> {
-                static BrushEdge*& project(BrushEdge*& edge);
+                static BrushEdge* project(BrushEdge* edge);
             };
 
             class AddFaceToGeometryCallback;
@@ -79,7 +85,13 @@ namespace TrenchBroom {
 
         private:
             BrushFaceList m_faces;
-            BrushGeometry* m_geometry;
+
+            /**
+             * The geometry is never modified once it has been built, any change to the brush replaces it with a new
+             * geometry instead. This allows snapshots to share it with the brush so that it need not be rebuilt
+             * when a snapshot is restored.
+             */
+            std::shared_ptr<BrushGeometry> m_geometry;
 
             const BrushContentTypeBuilder* m_contentTypeBuilder;
             mutable BrushContentType::FlagType m_contentType;
@@ -90,6 +102,12 @@ namespace TrenchBroom {
             Brush(const vm::bbox3& worldBounds, const BrushFaceList& faces);
             ~Brush() override;
         private:
+            /**
+             * Creates a brush with the given faces and geometry. The faces must already be attached to the faces of
+             * the given geometry.
+             */
+            Brush(const BrushFaceList& faces, std::shared_ptr<BrushGeometry> geometry);
+
             void cleanup();
         public:
             Brush* clone(const vm::bbox3& worldBounds) const;
@@ -105,6 +123,14 @@ namespace TrenchBroom {
             size_t faceCount() const;
             const BrushFaceList& faces() const;
             void setFaces(const vm::bbox3& worldBounds, const BrushFaceList& faces);
+        private:
+            /**
+             * Replaces the faces of this brush with the given faces and the geometry with the given geometry, which
+             * must be the geometry that the faces had when they were captured. The given face geometries contain the
+             * face of the given geometry for each of the given faces.
+             */
+            void restoreFaces(const BrushFaceList& faces, std::shared_ptr<BrushGeometry> geometry, const std::vector<BrushFaceGeometry*>& faceGeometries);
+        public:
 
             bool closed() const;
             bool fullySpecified() const;
@@ -255,11 +281,58 @@ namespace TrenchBroom {
              */
             BrushList subtract(const ModelFactory& factory, const vm::bbox3& worldBounds, const String& defaultTextureName, const BrushList& subtrahends) const;
             BrushList subtract(const ModelFactory& factory, const vm::bbox3& worldBounds, const String& defaultTextureName, Brush* subtrahend) const;
+
+            /**
+             * Subtracts the given subtrahends from each of the given minuends, returning the results but without
+             * modifying any of the given brushes.
+             *
+             * Only the subtrahends whose bounds intersect a minuend's bounds are subtracted from it, and they are
+             * found using an AABB tree. The fragments of the minuends are computed in parallel. Afterwards, the
+             * fragments of each minuend are merged wherever two of them form a convex polyhedron, so that the
+             * result consists of fewer brushes than the result of calling subtract for each minuend. The brushes
+             * are created on the calling thread.
+             *
+             * @param factory the model factory
+             * @param worldBounds the world bounds
+             * @param defaultTextureName the texture name for faces that don't inherit their attributes
+             * @param minuends the brushes to subtract from
+             * @param subtrahends the brushes to subtract from each minuend
+             * @param threadCount the maximum number of threads to use
+             * @return the subtraction result of each minuend, in the order of the minuends
+             */
+            static std::vector<BrushList> subtractAll(const ModelFactory& factory, const vm::bbox3& worldBounds, const String& defaultTextureName, const BrushList& minuends, const BrushList& subtrahends, size_t threadCount = defaultThreadCount());
             void intersect(const vm::bbox3& worldBounds, const Brush* brush);
 
             // transformation
             bool canTransform(const vm::mat4x4& transformation, const vm::bbox3& worldBounds) const;
         private:
+            using FragmentList = std::list<BrushGeometry>;
+
+            /**
+             * Subtracts the geometries of the given subtrahends from the geometry of `this`. Subtrahends whose bounds
+             * don't intersect the bounds of a fragment are skipped for that fragment.
+             */
+            FragmentList subtractGeometry(const BrushList& subtrahends) const;
+
+            /**
+             * Repeatedly replaces two of the given fragments by their convex hull if the hull has the same volume as
+             * the two fragments together, i.e., if their union is convex. Every pass over the fragments either merges
+             * a fragment or moves on to the next one, so at most O(n^2) pairs are checked.
+             */
+            static void mergeFragments(FragmentList& fragments);
+
+            /**
+             * Indicates whether the given fragments have a face with the same vertices. The union of two fragments
+             * can only be convex if this is the case.
+             */
+            static bool shareFace(const BrushGeometry& lhs, const BrushGeometry& rhs);
+
+            /**
+             * Returns three points on the plane of each face of the given geometry, in the order expected by
+             * ModelFactory::createFace.
+             */
+            static std::vector<vm::vec3> facePoints(const BrushGeometry& geometry);
+
             /**
              * Final step of CSG subtraction; takes the geometry that is the result of the subtraction, and turns it
              * into a Brush by copying texturing from `this` (for un-clipped faces) or the brushes in `subtrahends`
@@ -273,6 +346,7 @@ namespace TrenchBroom {
              * @return the newly created brush
              */
             Brush* createBrush(const ModelFactory& factory, const vm::bbox3& worldBounds, const String& defaultTextureName, const BrushGeometry& geometry, const BrushList& subtrahends) const;
+            Brush* createBrush(const ModelFactory& factory, const vm::bbox3& worldBounds, const String& defaultTextureName, const std::vector<vm::vec3>& facePoints, const BrushList& subtrahends) const;
         private:
             void updateFacesFromGeometry(const vm::bbox3& worldBounds, const BrushGeometry& geometry);
             void updatePointsFromVertices(const vm::bbox3& worldBounds);
@@ -280,6 +354,13 @@ namespace TrenchBroom {
             void rebuildGeometry(const vm::bbox3& worldBounds);
         private:
             void buildGeometry(const vm::bbox3& worldBounds);
+            /**
+             * Builds the geometry directly from the face planes, which is much faster than clipping a cube by every
+             * face. Returns false and leaves the brush without geometry if that is not possible, e.g. if the brush
+             * is not closed or exceeds the world bounds, in which case the caller must fall back to clipping so that
+             * the usual errors are reported.
+             */
+            bool buildGeometryFromPlanes(const vm::bbox3& worldBounds);
             void deleteGeometry();
             bool checkGeometry() const;
         public:
@@ -348,6 +429,13 @@ namespace TrenchBroom {
              */
             void invalidateVertexCache();
             Renderer::BrushRendererBrushCache& brushRendererBrushCache() const;
+
+        public: // memory usage
+            /**
+             * Adds the memory occupied by the faces, the geometry and the renderer cache of this brush to the given
+             * memory usage. The brush node itself is not included.
+             */
+            void accountMemoryUsage(MemoryUsage& usage) const;
         };
     }
 }
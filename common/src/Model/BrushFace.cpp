@@ -19,6 +19,7 @@
 
 #include "BrushFace.h"
 
+#include "MemoryUsage.h"
 #include "Assets/Texture.h"
 #include "Assets/TextureManager.h"
 #include "Model/Brush.h"
@@ -123,7 +124,7 @@ namespace TrenchBroom {
         }
 
         BrushFace* BrushFace::clone() const {
-            BrushFace* result = new BrushFace(points()[0], points()[1], points()[2], textureName(), m_texCoordSystem->clone());
+            BrushFace* result = new BrushFace(points()[0], points()[1], points()[2], internedTextureName(), m_texCoordSystem->clone());
             result->m_attribs = m_attribs;
             result->setFilePosition(m_lineNumber, m_lineCount);
             if (m_selected)
@@ -139,6 +140,12 @@ namespace TrenchBroom {
             return m_texCoordSystem->takeSnapshot();
         }
         
+        void BrushFace::accountMemoryUsage(MemoryUsage& usage) const {
+            usage.add(MemoryUsage::Category::BrushFaces, sizeof(BrushFace) - sizeof(BrushFaceAttributes));
+            usage.add(MemoryUsage::Category::FaceAttributes, sizeof(BrushFaceAttributes));
+            usage.add(MemoryUsage::Category::TexCoordSystems, m_texCoordSystem->memoryUsage());
+        }
+
         void BrushFace::restoreTexCoordSystemSnapshot(const TexCoordSystemSnapshot& coordSystemSnapshot) {
             coordSystemSnapshot.restore(*m_texCoordSystem);
             invalidateVertexCache();
@@ -278,6 +285,10 @@ namespace TrenchBroom {
             return m_attribs.textureName();
         }
 
+        const Assets::TextureName& BrushFace::internedTextureName() const {
+            return m_attribs.internedTextureName();
+        }
+
         Assets::Texture* BrushFace::texture() const {
             return m_attribs.texture();
         }
@@ -348,7 +359,7 @@ namespace TrenchBroom {
 
         void BrushFace::updateTexture(Assets::TextureManager* textureManager) {
             ensure(textureManager != nullptr, "textureManager is null");
-            Assets::Texture* texture = textureManager->texture(textureName());
+            Assets::Texture* texture = textureManager->texture(internedTextureName());
             setTexture(texture);
         }
 
@@ -39,6 +39,8 @@
 #include <vector>
 
 namespace TrenchBroom {
+    class MemoryUsage;
+
     namespace Assets {
         class TextureManager;
     }
@@ -50,8 +52,11 @@ namespace TrenchBroom {
     namespace Model {
         class Brush;
         class BrushFaceSnapshot;
+        class BrushSnapshot;
         
         class BrushFace {
+        private:
+            friend class BrushSnapshot;
         public:
             /*
              * The order of points, when looking from outside the face:
@@ -109,6 +114,12 @@ namespace TrenchBroom {
             void restoreTexCoordSystemSnapshot(const TexCoordSystemSnapshot& coordSystemSnapshot);
             void copyTexCoordSystemFromFace(const TexCoordSystemSnapshot& coordSystemSnapshot, const BrushFaceAttributes& attribs, const vm::plane3& sourceFacePlane, WrapStyle wrapStyle);
 
+            /**
+             * Adds the memory occupied by this face, its attributes and its texture coordinate system to the
+             * given memory usage.
+             */
+            void accountMemoryUsage(MemoryUsage& usage) const;
+
             Brush* brush() const;
             void setBrush(Brush* brush);
             
@@ -126,6 +137,7 @@ namespace TrenchBroom {
             void resetTexCoordSystemCache();
             
             const String& textureName() const;
+            const Assets::TextureName& internedTextureName() const;
             Assets::Texture* texture() const;
             vm::vec2f textureSize() const;
             
@@ -26,6 +26,9 @@
 namespace TrenchBroom {
     namespace Model {
         BrushFaceAttributes::BrushFaceAttributes(const String& textureName) :
+        BrushFaceAttributes(Assets::TextureName(textureName)) {}
+
+        BrushFaceAttributes::BrushFaceAttributes(const Assets::TextureName& textureName) :
         m_textureName(textureName),
         m_texture(nullptr),
         m_offset(vm::vec2f::zero),
@@ -88,6 +91,10 @@ namespace TrenchBroom {
         }
 
         const String& BrushFaceAttributes::textureName() const {
+            return m_textureName.name();
+        }
+
+        const Assets::TextureName& BrushFaceAttributes::internedTextureName() const {
             return m_textureName;
         }
         
@@ -155,7 +162,7 @@ namespace TrenchBroom {
             m_texture = texture;
             if (m_texture != nullptr) {
                 m_texture->incUsageCount();
-                m_textureName = m_texture->name();
+                m_textureName = m_texture->internedName();
             }
         }
         
@@ -164,7 +171,8 @@ namespace TrenchBroom {
                 m_texture->decUsageCount();
             }
             m_texture = nullptr;
-            m_textureName = BrushFace::NoTextureName;
+            static const Assets::TextureName NoTextureName(BrushFace::NoTextureName);
+            m_textureName = NoTextureName;
         }
 
         void BrushFaceAttributes::setOffset(const vm::vec2f& offset) {
@@ -35,5 +35,13 @@ namespace TrenchBroom {
                 face->restoreTexCoordSystemSnapshot(*m_coordSystemSnapshot);
             }
         }
+
+        size_t BrushFaceSnapshot::memoryUsage() const {
+            size_t result = sizeof(BrushFaceSnapshot);
+            if (m_coordSystemSnapshot != nullptr) {
+                result += m_coordSystemSnapshot->memoryUsage();
+            }
+            return result;
+        }
     }
 }
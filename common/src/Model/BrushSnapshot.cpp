@@ -20,11 +20,30 @@
 #include "BrushSnapshot.h"
 
 #include "CollectionUtils.h"
+#include "MemoryUsage.h"
 #include "Model/Brush.h"
 #include "Model/BrushFace.h"
 
+#include <cassert>
+
 namespace TrenchBroom {
     namespace Model {
+        static bool samePoints(const BrushFace::Points& lhs, const BrushFace::Points& rhs) {
+            return lhs[0] == rhs[0] && lhs[1] == rhs[1] && lhs[2] == rhs[2];
+        }
+
+        // the texture itself is not compared because snapshots never hold on to textures
+        static bool sameAttributes(const BrushFaceAttributes& lhs, const BrushFaceAttributes& rhs) {
+            return (lhs.internedTextureName() == rhs.internedTextureName() &&
+                    lhs.offset() == rhs.offset() &&
+                    lhs.scale() == rhs.scale() &&
+                    lhs.rotation() == rhs.rotation() &&
+                    lhs.surfaceContents() == rhs.surfaceContents() &&
+                    lhs.surfaceFlags() == rhs.surfaceFlags() &&
+                    lhs.surfaceValue() == rhs.surfaceValue() &&
+                    lhs.color() == rhs.color());
+        }
+
         BrushSnapshot::BrushSnapshot(Brush* brush) :
         m_brush(brush) {
             takeSnapshot(brush);
@@ -35,16 +54,109 @@ namespace TrenchBroom {
         }
 
         void BrushSnapshot::takeSnapshot(Brush* brush) {
+            // The brush never modifies its geometry, so it can be shared instead of being rebuilt on restore.
+            m_geometry = brush->m_geometry;
+
+            m_faces.reserve(brush->faceCount());
+            m_faceGeometries.reserve(brush->faceCount());
             for (BrushFace* face : brush->faces()) {
                 BrushFace *faceClone = face->clone();
                 faceClone->setTexture(nullptr);
                 m_faces.push_back(faceClone);
+                m_faceGeometries.push_back(face->geometry());
             }
         }
         
         void BrushSnapshot::doRestore(const vm::bbox3& worldBounds) {
-            m_brush->setFaces(worldBounds, m_faces);
-            m_faces.clear();
+            if (!m_faceDeltas.empty()) {
+                restoreFaceDeltas(worldBounds);
+            } else {
+                m_brush->restoreFaces(m_faces, std::move(m_geometry), m_faceGeometries);
+                m_faces.clear();
+                m_faceGeometries.clear();
+            }
+        }
+
+        void BrushSnapshot::restoreFaceDeltas(const vm::bbox3& worldBounds) {
+            const BrushFaceList& currentFaces = m_brush->faces();
+            assert(currentFaces.size() == m_faceDeltas.size());
+
+            BrushFaceList faces;
+            faces.reserve(m_faceDeltas.size());
+            for (size_t i = 0; i < m_faceDeltas.size(); ++i) {
+                const FaceDelta& delta = m_faceDeltas[i];
+
+                BrushFace* face = currentFaces[i]->clone();
+                if (delta.pointsChanged) {
+                    face->setPoints(delta.points[0], delta.points[1], delta.points[2]);
+                }
+                if (delta.attribs != nullptr) {
+                    face->m_attribs = *delta.attribs;
+                }
+                face->setTexture(nullptr);
+                if (delta.coordSystemSnapshot != nullptr) {
+                    face->restoreTexCoordSystemSnapshot(*delta.coordSystemSnapshot);
+                }
+                faces.push_back(face);
+            }
+
+            // the geometry was discarded when compacting, so it must be rebuilt
+            m_brush->setFaces(worldBounds, faces);
+            m_faceDeltas.clear();
+        }
+
+        size_t BrushSnapshot::doGetMemoryUsage() const {
+            MemoryUsage usage;
+            for (const BrushFace* face : m_faces)
+                face->accountMemoryUsage(usage);
+
+            // the geometry only takes up additional memory once the brush has replaced it
+            const auto geometryUsage = m_geometry != nullptr && m_geometry.use_count() == 1 ? m_geometry->memoryUsage() : 0u;
+            size_t deltaUsage = heapMemoryUsage(m_faceDeltas);
+            for (const FaceDelta& delta : m_faceDeltas) {
+                if (delta.attribs != nullptr) {
+                    deltaUsage += sizeof(BrushFaceAttributes);
+                }
+                if (delta.coordSystemSnapshot != nullptr) {
+                    deltaUsage += delta.coordSystemSnapshot->memoryUsage();
+                }
+            }
+
+            return sizeof(BrushSnapshot) + heapMemoryUsage(m_faces) + heapMemoryUsage(m_faceGeometries) + usage.total() + geometryUsage + deltaUsage;
+        }
+
+        void BrushSnapshot::doCompact() {
+            // Faces are matched by their index, so the brush must still have the same number of faces. Otherwise, or
+            // if the snapshot has already been compacted or restored, the snapshot is kept as it is.
+            if (m_faces.empty() || m_faces.size() != m_brush->faceCount()) {
+                return;
+            }
+
+            const BrushFaceList& currentFaces = m_brush->faces();
+            m_faceDeltas.resize(m_faces.size());
+            for (size_t i = 0; i < m_faces.size(); ++i) {
+                const BrushFace* face = m_faces[i];
+                const BrushFace* currentFace = currentFaces[i];
+                FaceDelta& delta = m_faceDeltas[i];
+
+                delta.pointsChanged = !samePoints(face->points(), currentFace->points());
+                if (delta.pointsChanged) {
+                    delta.points[0] = face->points()[0];
+                    delta.points[1] = face->points()[1];
+                    delta.points[2] = face->points()[2];
+                }
+                if (!sameAttributes(face->attribs(), currentFace->attribs())) {
+                    delta.attribs = std::make_unique<BrushFaceAttributes>(face->attribs().takeSnapshot());
+                }
+                delta.coordSystemSnapshot = face->takeTexCoordSystemSnapshot();
+            }
+
+            // The geometry can be rebuilt from the face points when the snapshot is restored, which is cheap compared
+            // to the memory it takes up.
+            VectorUtils::clearAndDelete(m_faces);
+            VectorUtils::clearToZero(m_faces);
+            VectorUtils::clearToZero(m_faceGeometries);
+            m_geometry.reset();
         }
     }
 }
@@ -20,9 +20,12 @@
 #ifndef TrenchBroom_BrushSnapshot
 #define TrenchBroom_BrushSnapshot
 
+#include "Model/BrushFace.h"
+#include "Model/BrushGeometry.h"
 #include "Model/ModelTypes.h"
 #include "Model/NodeSnapshot.h"
 
+#include <memory>
 #include <vector>
 
 namespace TrenchBroom {
@@ -32,14 +35,33 @@ namespace TrenchBroom {
         
         class BrushSnapshot : public NodeSnapshot {
         private:
+            /**
+             * The changes to apply to a face of the brush in order to restore it. The points and attributes are
+             * only stored if they differ from the face's current values.
+             */
+            struct FaceDelta {
+                bool pointsChanged;
+                BrushFace::Points points;
+                std::unique_ptr<BrushFaceAttributes> attribs;
+                std::unique_ptr<TexCoordSystemSnapshot> coordSystemSnapshot;
+            };
+
             Brush* m_brush;
             BrushFaceList m_faces;
+            std::shared_ptr<BrushGeometry> m_geometry;
+            std::vector<BrushFaceGeometry*> m_faceGeometries;
+
+            // only used once the snapshot has been compacted, in which case m_faces is empty
+            std::vector<FaceDelta> m_faceDeltas;
         public:
             BrushSnapshot(Brush* brush);
             ~BrushSnapshot() override;
         private:
             void takeSnapshot(Brush* brush);
             void doRestore(const vm::bbox3& worldBounds) override;
+            void restoreFaceDeltas(const vm::bbox3& worldBounds);
+            size_t doGetMemoryUsage() const override;
+            void doCompact() override;
         };
     }
 }
@@ -0,0 +1,78 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CollectMemoryUsageVisitor.h"
+
+#include "Model/Brush.h"
+#include "Model/Entity.h"
+#include "Model/Group.h"
+#include "Model/Layer.h"
+#include "Model/World.h"
+
+namespace TrenchBroom {
+    namespace Model {
+        const MemoryUsage& CollectMemoryUsageVisitor::usage() const {
+            return m_usage;
+        }
+
+        void CollectMemoryUsageVisitor::doVisit(const World* world) {
+            accountNode(world, sizeof(World));
+            accountAttributes(world);
+        }
+
+        void CollectMemoryUsageVisitor::doVisit(const Layer* layer) {
+            accountNode(layer, sizeof(Layer) + heapMemoryUsage(layer->name()));
+        }
+
+        void CollectMemoryUsageVisitor::doVisit(const Group* group) {
+            accountNode(group, sizeof(Group) + heapMemoryUsage(group->name()));
+        }
+
+        void CollectMemoryUsageVisitor::doVisit(const Entity* entity) {
+            accountNode(entity, sizeof(Entity));
+            accountAttributes(entity);
+        }
+
+        void CollectMemoryUsageVisitor::doVisit(const Brush* brush) {
+            accountNode(brush, sizeof(Brush));
+            brush->accountMemoryUsage(m_usage);
+        }
+
+        void CollectMemoryUsageVisitor::accountNode(const Node* node, const size_t size) {
+            m_usage.add(MemoryUsage::Category::Nodes, size + heapMemoryUsage(node->children()));
+        }
+
+        void CollectMemoryUsageVisitor::accountAttributes(const AttributableNode* node) {
+            // every attribute is stored in a list node with two pointers
+            size_t bytes = heapMemoryUsage(node->classname());
+            for (const auto& attribute : node->attributes()) {
+                bytes += sizeof(EntityAttribute) + 2 * sizeof(void*);
+                bytes += heapMemoryUsage(attribute.name());
+                bytes += heapMemoryUsage(attribute.value());
+            }
+            m_usage.add(MemoryUsage::Category::EntityAttributes, bytes);
+        }
+
+        MemoryUsage collectMemoryUsage(const Node* node) {
+            CollectMemoryUsageVisitor visitor;
+            node->acceptAndRecurse(visitor);
+            return visitor.usage();
+        }
+    }
+}
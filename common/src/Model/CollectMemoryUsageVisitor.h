@@ -0,0 +1,59 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_CollectMemoryUsageVisitor
+#define TrenchBroom_CollectMemoryUsageVisitor
+
+#include "MemoryUsage.h"
+#include "Model/NodeVisitor.h"
+
+namespace TrenchBroom {
+    namespace Model {
+        class AttributableNode;
+        class Node;
+
+        /**
+         * Accumulates the memory used by the visited nodes, including their faces, geometry, attributes and
+         * renderer caches. The nodes are not visited recursively, so use acceptAndRecurse to account for a
+         * whole subtree.
+         */
+        class CollectMemoryUsageVisitor : public ConstNodeVisitor {
+        private:
+            MemoryUsage m_usage;
+        public:
+            const MemoryUsage& usage() const;
+        private:
+            void doVisit(const World* world) override;
+            void doVisit(const Layer* layer) override;
+            void doVisit(const Group* group) override;
+            void doVisit(const Entity* entity) override;
+            void doVisit(const Brush* brush) override;
+
+            void accountNode(const Node* node, size_t size);
+            void accountAttributes(const AttributableNode* node);
+        };
+
+        /**
+         * Returns the memory used by the given node and all of its descendants.
+         */
+        MemoryUsage collectMemoryUsage(const Node* node);
+    }
+}
+
+#endif /* defined(TrenchBroom_CollectMemoryUsageVisitor) */
@@ -60,7 +60,7 @@ namespace TrenchBroom {
         };
         
         EmptyGroupIssueGenerator::EmptyGroupIssueGenerator() :
-        IssueGenerator(EmptyGroupIssue::Type, "Empty group") {
+        IssueGenerator(EmptyGroupIssue::Type, "Empty group", NodeChanges::Descendants) {
             addQuickFix(new EmptyGroupIssueQuickFix());
         }
         
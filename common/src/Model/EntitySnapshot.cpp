@@ -19,6 +19,7 @@
 
 #include "EntitySnapshot.h"
 
+#include "MemoryUsage.h"
 #include "Model/Entity.h"
 
 namespace TrenchBroom {
@@ -48,5 +49,13 @@ namespace TrenchBroom {
             restoreAttribute(m_entity, m_origin);
             restoreAttribute(m_entity, m_rotation);
         }
+
+        static size_t attributeMemoryUsage(const EntityAttribute& attribute) {
+            return heapMemoryUsage(attribute.name()) + heapMemoryUsage(attribute.value());
+        }
+
+        size_t EntitySnapshot::doGetMemoryUsage() const {
+            return sizeof(EntitySnapshot) + attributeMemoryUsage(m_origin) + attributeMemoryUsage(m_rotation);
+        }
     }
 }
@@ -78,6 +78,11 @@ namespace TrenchBroom {
             doWriteMap(world, path);
         }
 
+        void Game::writeMap(World* world, String& buffer) const {
+            ensure(world != nullptr, "world is null");
+            doWriteMap(world, buffer);
+        }
+
         void Game::exportMap(World* world, const Model::ExportFormat format, const IO::Path& path) const {
             ensure(world != nullptr, "world is null");
             doExportMap(world, format, path);
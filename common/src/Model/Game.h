@@ -72,6 +72,12 @@ namespace TrenchBroom {
             World* newMap(MapFormat format, const vm::bbox3& worldBounds, Logger* logger) const;
             World* loadMap(MapFormat format, const vm::bbox3& worldBounds, const IO::Path& path, Logger* logger) const;
             void writeMap(World* world, const IO::Path& path) const;
+
+            /**
+             * Appends the given map to the given buffer in exactly the form in which writeMap would write it to a
+             * file. This allows taking a snapshot of the map which can then be written to disk on another thread.
+             */
+            void writeMap(World* world, String& buffer) const;
             void exportMap(World* world, Model::ExportFormat format, const IO::Path& path) const;
         public: // parsing and serializing objects
             NodeList parseNodes(const String& str, World* world, const vm::bbox3& worldBounds, Logger* logger) const;
@@ -81,6 +87,9 @@ namespace TrenchBroom {
             void writeBrushFacesToStream(World* world, const BrushFaceList& faces, std::ostream& stream) const;
         public: // texture collection handling
             TexturePackageType texturePackageType() const;
+            /**
+             * The collections may be loaded in the background, see TextureManager::requestTextureCollections().
+             */
             void loadTextureCollections(AttributableNode* node, const IO::Path& documentPath, Assets::TextureManager& textureManager, Logger* logger) const;
             bool isTextureCollection(const IO::Path& path) const;
             IO::Path::List findTextureCollections() const;
@@ -115,6 +124,7 @@ namespace TrenchBroom {
             virtual World* doNewMap(MapFormat format, const vm::bbox3& worldBounds, Logger* logger) const = 0;
             virtual World* doLoadMap(MapFormat format, const vm::bbox3& worldBounds, const IO::Path& path, Logger* logger) const = 0;
             virtual void doWriteMap(World* world, const IO::Path& path) const = 0;
+            virtual void doWriteMap(World* world, String& buffer) const = 0;
             virtual void doExportMap(World* world, Model::ExportFormat format, const IO::Path& path) const = 0;
 
             virtual NodeList doParseNodes(const String& str, World* world, const vm::bbox3& worldBounds, Logger* logger) const = 0;
@@ -38,7 +38,8 @@ namespace TrenchBroom {
 
         void GameFileSystem::initialize(const GameConfig& config, const IO::Path& gamePath, const std::vector<IO::Path>& additionalSearchPaths, Logger* logger) {
             // delete the existing file system
-            releaseNext();
+            m_index.clear();
+            m_fileSystems.reset();
             m_shaderFS = nullptr;
 
             addDefaultAssetPath(config, logger);
@@ -47,11 +48,25 @@ namespace TrenchBroom {
                 addGameFileSystems(config, gamePath, additionalSearchPaths, logger);
                 addShaderFileSystem(config, logger);
             }
+
+            buildIndex();
+            if (m_fileSystems != nullptr) {
+                logger->info() << "Indexed " << m_index.size() << " files and directories";
+            }
         }
 
         void GameFileSystem::reloadShaders() {
             if (m_shaderFS != nullptr) {
                 m_shaderFS->reload();
+                buildIndex();
+            }
+        }
+
+        void GameFileSystem::buildIndex() {
+            if (m_fileSystems != nullptr) {
+                m_index.build(*m_fileSystems);
+            } else {
+                m_index.clear();
             }
         }
 
@@ -80,7 +95,7 @@ namespace TrenchBroom {
         void GameFileSystem::addFileSystemPath(const IO::Path& path, Logger* logger) {
             try {
                 logger->info() << "Adding file system path " << path;
-                m_next = std::make_unique<IO::DiskFileSystem>(std::move(m_next), path);
+                m_fileSystems = std::make_unique<IO::DiskFileSystem>(std::move(m_fileSystems), path);
             } catch (const FileSystemException& e) {
                 logger->error() << "Could not add file system search path '" << path << "': " << e.what();
             }
@@ -104,13 +119,13 @@ namespace TrenchBroom {
                     try {
                         if (StringUtils::caseInsensitiveEqual(packageFormat, "idpak")) {
                             logger->info() << "Adding file system package " << packagePath;
-                            m_next = std::make_unique<IO::IdPakFileSystem>(std::move(m_next), packagePath, packageFile);
+                            m_fileSystems = std::make_unique<IO::IdPakFileSystem>(std::move(m_fileSystems), packagePath, packageFile);
                         } else if (StringUtils::caseInsensitiveEqual(packageFormat, "dkpak")) {
                             logger->info() << "Adding file system package " << packagePath;
-                            m_next = std::make_unique<IO::DkPakFileSystem>(std::move(m_next), packagePath, packageFile);
+                            m_fileSystems = std::make_unique<IO::DkPakFileSystem>(std::move(m_fileSystems), packagePath, packageFile);
                         } else if (StringUtils::caseInsensitiveEqual(packageFormat, "zip")) {
                             logger->info() << "Adding file system package " << packagePath;
-                            m_next = std::make_unique<IO::ZipFileSystem>(std::move(m_next), packagePath, packageFile);
+                            m_fileSystems = std::make_unique<IO::ZipFileSystem>(std::move(m_fileSystems), packagePath, packageFile);
                         }
                     } catch (const std::exception& e) {
                         logger->error() << e.what();
@@ -127,26 +142,37 @@ namespace TrenchBroom {
             if (StringUtils::caseInsensitiveEqual(textureFormat, "q3shader")) {
                 logger->info() << "Adding shader file system";
                 const auto texturePrefix = textureConfig.package.rootDirectory;
-                auto shaderFS = std::make_unique<IO::Quake3ShaderFileSystem>(std::move(m_next), texturePrefix, logger);
+                auto shaderFS = std::make_unique<IO::Quake3ShaderFileSystem>(std::move(m_fileSystems), texturePrefix, logger);
                 m_shaderFS = shaderFS.get();
-                m_next = std::move(shaderFS);
+                m_fileSystems = std::move(shaderFS);
+            }
+        }
+
+        bool GameFileSystem::doCanMakeAbsolute(const IO::Path& path) const {
+            return m_fileSystems != nullptr && m_fileSystems->canMakeAbsolute(path);
+        }
+
+        IO::Path GameFileSystem::doMakeAbsolute(const IO::Path& path) const {
+            if (m_fileSystems == nullptr) {
+                throw FileSystemException("Cannot make absolute path of '" + path.asString() + "'");
             }
+            return m_fileSystems->makeAbsolute(path);
         }
 
         bool GameFileSystem::doDirectoryExists(const IO::Path& path) const {
-            return false;
+            return m_fileSystems != nullptr && m_index.directoryExists(path);
         }
 
         bool GameFileSystem::doFileExists(const IO::Path& path) const {
-            return false;
+            return m_index.fileExists(path);
         }
 
         IO::Path::List GameFileSystem::doGetDirectoryContents(const IO::Path& path) const {
-            return TrenchBroom::IO::Path::List();
+            return m_index.directoryContents(path);
         }
 
         const IO::MappedFile::Ptr GameFileSystem::doOpenFile(const IO::Path& path) const {
-            throw FileSystemException("File not found: '" + path.asString() + "'");
+            return m_index.openFile(path);
         }
     }
 }
@@ -21,6 +21,9 @@
 #define TRENCHBROOM_GAMEFILESYSTEM_H
 
 #include "IO/FileSystem.h"
+#include "IO/FileSystemIndex.h"
+
+#include <memory>
 
 #include <vector>
 
@@ -36,20 +39,38 @@ namespace TrenchBroom {
     namespace Model {
         class GameConfig;
 
+        /**
+         * Combines the file systems of a game, i.e. the search paths and the packages they contain, into a single
+         * file system.
+         *
+         * The file systems are chained so that the ones added later shadow the ones added earlier. Instead of
+         * walking the chain for every query, this file system answers queries from an index of all items in the
+         * chain, which is built when the file system is initialized and when the shaders are reloaded.
+         *
+         * Queries may be made from several threads at once, e.g. by the background model loaders, but initialize
+         * and reloadShaders replace the file systems and the index without any synchronization. Callers must make
+         * sure that no other thread reads from this file system while they run.
+         */
         class GameFileSystem : public IO::FileSystem {
         private:
+            std::unique_ptr<IO::FileSystem> m_fileSystems;
             IO::Quake3ShaderFileSystem* m_shaderFS;
+            IO::FileSystemIndex m_index;
         public:
             GameFileSystem();
             void initialize(const GameConfig& config, const IO::Path& gamePath, const std::vector<IO::Path>& additionalSearchPaths, Logger* logger);
             void reloadShaders();
         private:
+            void buildIndex();
             void addDefaultAssetPath(const GameConfig& config, Logger* logger);
             void addGameFileSystems(const GameConfig& config, const IO::Path& gamePath, const std::vector<IO::Path>& additionalSearchPaths, Logger* logger);
             void addShaderFileSystem(const GameConfig& config, Logger* logger);
             void addFileSystemPath(const IO::Path& path, Logger* logger);
             void addFileSystemPackages(const GameConfig& config, const IO::Path& searchPath, Logger* logger);
         private:
+            bool doCanMakeAbsolute(const IO::Path& path) const override;
+            IO::Path doMakeAbsolute(const IO::Path& path) const override;
+
             bool doDirectoryExists(const IO::Path& path) const override;
             bool doFileExists(const IO::Path& path) const override;
             IO::Path::List doGetDirectoryContents(const IO::Path& path) const override;
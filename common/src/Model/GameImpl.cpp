@@ -21,6 +21,7 @@
 
 #include "Macros.h"
 #include "Assets/Palette.h"
+#include "Assets/TextureManager.h"
 #include "IO/BrushFaceReader.h"
 #include "IO/Bsp29Parser.h"
 #include "IO/DefParser.h"
@@ -53,6 +54,7 @@
 #include "Exceptions.h"
 
 #include <cstdio>
+#include <memory>
 
 namespace TrenchBroom {
     namespace Model {
@@ -139,6 +141,14 @@ namespace TrenchBroom {
             writer.writeMap();
         }
 
+        void GameImpl::doWriteMap(World* world, String& buffer) const {
+            const auto mapFormatName = formatName(world->format());
+            IO::writeGameComment(buffer, gameName(), mapFormatName);
+
+            IO::NodeWriter writer(world, buffer);
+            writer.writeMap();
+        }
+
         void GameImpl::doExportMap(World* world, const Model::ExportFormat format, const IO::Path& path) const {
             IO::OpenFile open(path, true);
 
@@ -188,8 +198,11 @@ namespace TrenchBroom {
             const auto paths = extractTextureCollections(node);
 
             const auto fileSearchPaths = textureCollectionSearchPaths(documentPath);
-            IO::TextureLoader textureLoader(m_fs, fileSearchPaths, m_config.textureConfig(), logger);
-            textureLoader.loadTextures(paths, textureManager);
+
+            // the collections are decoded in the background, so the loader must log to the texture manager's logger
+            textureManager.requestTextureCollections(paths, [this, &fileSearchPaths](Logger* loadLogger) {
+                return std::make_unique<IO::TextureLoader>(m_fs, fileSearchPaths, m_config.textureConfig(), loadLogger);
+            });
         }
 
         IO::Path::List GameImpl::textureCollectionSearchPaths(const IO::Path& documentPath) const {
@@ -20,6 +20,7 @@
 #include "GroupSnapshot.h"
 
 #include "CollectionUtils.h"
+#include "MemoryUsage.h"
 #include "Model/Group.h"
 #include "Model/ModelTypes.h"
 #include "Model/Node.h"
@@ -48,5 +49,12 @@ namespace TrenchBroom {
             for (NodeSnapshot* snapshot : m_snapshots)
                 snapshot->restore(worldBounds);
         }
+
+        size_t GroupSnapshot::doGetMemoryUsage() const {
+            size_t result = sizeof(GroupSnapshot) + heapMemoryUsage(m_snapshots);
+            for (const NodeSnapshot* snapshot : m_snapshots)
+                result += snapshot->memoryUsage();
+            return result;
+        }
     }
 }
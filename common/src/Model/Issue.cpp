@@ -24,6 +24,7 @@
 #include "Model/EditorContext.h"
 #include "Model/Node.h"
 
+#include <atomic>
 #include <cassert>
 
 namespace TrenchBroom {
@@ -34,6 +35,10 @@ namespace TrenchBroom {
             return m_seqId;
         }
 
+        void Issue::renumber() {
+            m_seqId = nextSeqId();
+        }
+
         size_t Issue::lineNumber() const {
             return m_node->lineNumber();
         }
@@ -87,7 +92,8 @@ namespace TrenchBroom {
         }
 
         size_t Issue::nextSeqId() {
-            static size_t seqId = 0;
+            // issues are generated on several threads, see World::validateIssues
+            static std::atomic<size_t> seqId(0);
             return seqId++;
         }
 
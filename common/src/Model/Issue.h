@@ -35,6 +35,12 @@ namespace TrenchBroom {
             virtual ~Issue();
 
             size_t seqId() const;
+
+            /**
+             * Assigns the next sequence number to this issue. Issues that were generated concurrently are renumbered in
+             * a deterministic order once all of them have been generated.
+             */
+            void renumber();
             size_t lineNumber() const;
             const String description() const;
             
@@ -36,6 +36,10 @@ namespace TrenchBroom {
             return m_type;
         }
         
+        NodeChange IssueGenerator::dependencies() const {
+            return m_dependencies;
+        }
+
         const String& IssueGenerator::description() const {
             return m_description;
         }
@@ -64,8 +68,9 @@ namespace TrenchBroom {
             doGenerate(brush, issues);
         }
 
-        IssueGenerator::IssueGenerator(const IssueType type, const String& description) :
+        IssueGenerator::IssueGenerator(const IssueType type, const String& description, const NodeChange dependencies) :
         m_type(type),
+        m_dependencies(dependencies),
         m_description(description) {}
         
         void IssueGenerator::addQuickFix(IssueQuickFix* quickFix) {
@@ -27,12 +27,18 @@ namespace TrenchBroom {
         class IssueGenerator {
         private:
             IssueType m_type;
+            NodeChange m_dependencies;
             String m_description;
             IssueQuickFixList m_quickFixes;
         public:
             virtual ~IssueGenerator();
             
             IssueType type() const;
+
+            /**
+             * Returns the kinds of node changes that can affect the issues generated by this generator.
+             */
+            NodeChange dependencies() const;
             const String& description() const;
             const IssueQuickFixList& quickFixes() const;
             
@@ -42,9 +48,10 @@ namespace TrenchBroom {
             void generate(Entity* entity, IssueList& issues) const;
             void generate(Brush* brush,   IssueList& issues) const;
         protected:
-            IssueGenerator(IssueType type, const String& description);
+            IssueGenerator(IssueType type, const String& description, NodeChange dependencies = NodeChanges::Contents);
             void addQuickFix(IssueQuickFix* quickFix);
         private:
+            // World::validateIssues calls these concurrently for different nodes, so they must not modify the generator
             virtual void doGenerate(World* world,           IssueList& issues) const;
             virtual void doGenerate(Layer* layer,           IssueList& issues) const;
             virtual void doGenerate(Group* group,           IssueList& issues) const;
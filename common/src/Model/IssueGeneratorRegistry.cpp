@@ -43,6 +43,15 @@ namespace TrenchBroom {
             return result;
         }
 
+        IssueType IssueGeneratorRegistry::issueTypes(const NodeChange changes) const {
+            IssueType result = 0;
+            for (const IssueGenerator* generator : m_generators) {
+                if ((generator->dependencies() & changes) != 0)
+                    result |= generator->type();
+            }
+            return result;
+        }
+
         void IssueGeneratorRegistry::registerGenerator(IssueGenerator* generator) {
             ensure(generator != nullptr, "generator is null");
             assert(!VectorUtils::contains(m_generators, generator));
@@ -36,6 +36,11 @@ namespace TrenchBroom {
             
             const IssueGeneratorList& registeredGenerators() const;
             IssueQuickFixList quickFixes(IssueType issueTypes) const;
+
+            /**
+             * Returns the types of the issues that the given kinds of node changes can affect.
+             */
+            IssueType issueTypes(NodeChange changes) const;
             
             void registerGenerator(IssueGenerator* generator);
             void unregisterAllGenerators();
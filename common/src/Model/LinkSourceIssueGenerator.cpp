@@ -67,7 +67,7 @@ namespace TrenchBroom {
         };
         
         LinkSourceIssueGenerator::LinkSourceIssueGenerator() :
-        IssueGenerator(LinkSourceIssue::Type, "Missing entity link source") {
+        IssueGenerator(LinkSourceIssue::Type, "Missing entity link source", NodeChanges::Contents | NodeChanges::Links) {
             addQuickFix(new LinkSourceIssueQuickFix());
         }
 
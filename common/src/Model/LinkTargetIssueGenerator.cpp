@@ -78,7 +78,7 @@ namespace TrenchBroom {
         };
         
         LinkTargetIssueGenerator::LinkTargetIssueGenerator() :
-        IssueGenerator(LinkTargetIssue::Type, "Missing entity link source") {
+        IssueGenerator(LinkTargetIssue::Type, "Missing entity link source", NodeChanges::Contents | NodeChanges::Links) {
             addQuickFix(new LinkTargetIssueQuickFix());
         }
 
@@ -103,10 +103,6 @@ namespace TrenchBroom {
             
             GameSPtr game = lock(m_game);
             const StringList mods = game->extractEnabledMods(node);
-            
-            if (mods == m_lastMods)
-                return;
-            
             const IO::Path::List additionalSearchPaths = IO::Path::asPaths(mods);
             const Game::PathErrors errors = game->checkAdditionalSearchPaths(additionalSearchPaths);
             typedef Game::PathErrors::value_type PathError;
@@ -116,8 +112,6 @@ namespace TrenchBroom {
                 const String& message = error.second;
                 return new MissingModIssue(node, searchPath.asString(), message);
             });
-            
-            m_lastMods = mods;
         }
     }
 }
@@ -31,7 +31,6 @@ namespace TrenchBroom {
             class MissingModIssueQuickFix;
             
             GameWPtr m_game;
-            mutable StringList m_lastMods;
         public:
             MissingModIssueGenerator(GameWPtr game);
         private:
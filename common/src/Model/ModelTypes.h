@@ -127,6 +127,24 @@ namespace TrenchBroom {
         
         using IssueType = int;
 
+        /**
+         * The kinds of changes to a node that can affect its issues. Every issue generator declares the kinds of
+         * changes its issues depend on, so that a change only invalidates the issues it can affect.
+         */
+        using NodeChange = int;
+        namespace NodeChanges {
+            // the attributes, the entity definition or the geometry of the node itself
+            static const NodeChange Contents           = 1 << 0;
+            // a descendant of the node was added or removed
+            static const NodeChange Descendants        = 1 << 1;
+            // the contents of a descendant of the node
+            static const NodeChange DescendantContents = 1 << 2;
+            // an ancestor of the node
+            static const NodeChange Ancestors          = 1 << 3;
+            // the link or kill sources or targets of the node
+            static const NodeChange Links              = 1 << 4;
+        }
+
         class Issue;
         using IssueList = std::vector<Issue*>;
         static const IssueList EmptyIssueList(0);
@@ -37,7 +37,7 @@ namespace TrenchBroom {
         m_lockState(Lock_Inherited),
         m_lineNumber(0),
         m_lineCount(0),
-        m_issuesValid(false),
+        m_invalidIssueTypes(~IssueType(0)),
         m_hiddenIssues(0) {}
         
         Node::~Node() {
@@ -239,7 +239,7 @@ namespace TrenchBroom {
             doDescendantWasAdded(node, depth);
             if (shouldPropagateDescendantEvents() && m_parent != nullptr)
                 m_parent->descendantWasAdded(node, depth + 1);
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::Descendants);
         }
         
         void Node::descendantWillBeRemoved(Node* node, const size_t depth) {
@@ -252,7 +252,7 @@ namespace TrenchBroom {
             doDescendantWasRemoved(oldParent, node, depth);
             if (shouldPropagateDescendantEvents() && m_parent != nullptr)
                 m_parent->descendantWasRemoved(oldParent, node, depth + 1);
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::Descendants);
         }
 
         bool Node::shouldPropagateDescendantEvents() const {
@@ -300,25 +300,25 @@ namespace TrenchBroom {
         void Node::ancestorWillChange() {
             doAncestorWillChange();
             std::for_each(std::begin(m_children), std::end(m_children), [](Node* child) { child->ancestorWillChange(); });
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::Ancestors);
         }
 
         void Node::ancestorDidChange() {
             doAncestorDidChange();
             std::for_each(std::begin(m_children), std::end(m_children), [](Node* child) { child->ancestorDidChange(); });
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::Ancestors);
         }
         
         void Node::nodeWillChange() {
             if (m_parent != nullptr)
                 m_parent->childWillChange(this);
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::Contents);
         }
         
         void Node::nodeDidChange() {
             if (m_parent != nullptr)
                 m_parent->childDidChange(this);
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::Contents);
         }
         
         Node::NotifyNodeChange::NotifyNodeChange(Node* node) :
@@ -361,7 +361,7 @@ namespace TrenchBroom {
             if (shouldPropagateDescendantEvents() && m_parent != nullptr) {
                 m_parent->descendantWillChange(node);
             }
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::DescendantContents);
         }
         
         void Node::descendantDidChange(Node* node) {
@@ -369,7 +369,7 @@ namespace TrenchBroom {
             if (shouldPropagateDescendantEvents() && m_parent != nullptr) {
                 m_parent->descendantDidChange(node);
             }
-            invalidateIssues();
+            invalidateIssuesAffectedBy(NodeChanges::DescendantContents);
         }
 
         void Node::childBoundsDidChange(Node* node, const vm::bbox3& oldBounds) {
@@ -598,17 +598,58 @@ namespace TrenchBroom {
         }
 
         void Node::validateIssues(const IssueGeneratorList& issueGenerators) {
-            if (!m_issuesValid) {
-                std::for_each(std::begin(issueGenerators), std::end(issueGenerators), [this](const IssueGenerator* generator) { doGenerateIssues(generator, m_issues); });
-                m_issuesValid = true;
+            if (m_invalidIssueTypes != 0) {
+                for (const IssueGenerator* generator : issueGenerators) {
+                    if ((generator->type() & m_invalidIssueTypes) != 0) {
+                        doGenerateIssues(generator, m_issues);
+                    }
+                }
+                m_invalidIssueTypes = 0;
             }
         }
         
         void Node::invalidateIssues() const {
             clearIssues();
-            m_issuesValid = false;
+            m_invalidIssueTypes = ~IssueType(0);
+        }
+
+        void Node::invalidateIssues(const IssueType types) const {
+            if (types == 0)
+                return;
+
+            auto it = std::begin(m_issues);
+            while (it != std::end(m_issues)) {
+                if (((*it)->type() & types) != 0) {
+                    delete *it;
+                    it = m_issues.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            m_invalidIssueTypes |= types;
+        }
+
+        IssueType Node::invalidIssueTypes() const {
+            return m_invalidIssueTypes;
+        }
+
+        void Node::generateIssues(const IssueGenerator* generator, IssueList& issues) {
+            doGenerateIssues(generator, issues);
+        }
+
+        void Node::addValidatedIssues(const IssueList& issues) {
+            VectorUtils::append(m_issues, issues);
+            m_invalidIssueTypes = 0;
         }
         
+        void Node::invalidateIssuesAffectedBy(const NodeChange changes) const {
+            invalidateIssues(issueTypesAffectedBy(changes));
+        }
+
+        IssueType Node::issueTypesAffectedBy(const NodeChange changes) const {
+            return doGetIssueTypesAffectedBy(changes);
+        }
+
         void Node::clearIssues() const {
             VectorUtils::clearAndDelete(m_issues);
         }
@@ -683,5 +724,11 @@ namespace TrenchBroom {
             if (m_parent != nullptr)
                 m_parent->removeFromIndex(attributable, name, value);
         }
+
+        IssueType Node::doGetIssueTypesAffectedBy(const NodeChange changes) const {
+            if (m_parent != nullptr)
+                return m_parent->issueTypesAffectedBy(changes);
+            return ~IssueType(0);
+        }
     }
 }
@@ -44,7 +44,8 @@ namespace TrenchBroom {
             size_t m_lineCount;
 
             mutable IssueList m_issues;
-            mutable bool m_issuesValid;
+            // the types of the issues that must be regenerated, one bit per issue generator
+            mutable IssueType m_invalidIssueTypes;
             IssueType m_hiddenIssues;
         protected:
             Node();
@@ -267,6 +268,36 @@ namespace TrenchBroom {
             void setIssueHidden(IssueType type, bool hidden);
         public: // should only be called from this and from the world
             void invalidateIssues() const;
+
+            /**
+             * Removes the issues of the given types. They are regenerated by the next call to issues or by
+             * World::validateIssues.
+             */
+            void invalidateIssues(IssueType types) const;
+
+            /**
+             * Returns the types of the issues that must be regenerated.
+             */
+            IssueType invalidIssueTypes() const;
+
+            /**
+             * Generates the issues of the given generator without adding them to this node. This does not modify this
+             * node, so it can be called for several generators or nodes concurrently.
+             */
+            void generateIssues(const IssueGenerator* generator, IssueList& issues);
+
+            /**
+             * Adds the given issues, which must have been generated by calling generateIssues for every invalid issue
+             * type, and marks the issues of this node as valid.
+             */
+            void addValidatedIssues(const IssueList& issues);
+        protected:
+            /**
+             * Removes the issues that the given kinds of changes can affect, as determined by the issue generators of
+             * the world this node belongs to. If this node doesn't belong to a world, all issues are removed.
+             */
+            void invalidateIssuesAffectedBy(NodeChange changes) const;
+            IssueType issueTypesAffectedBy(NodeChange changes) const;
         private:
             void validateIssues(const IssueGeneratorList& issueGenerators);
             void clearIssues() const;
@@ -461,6 +492,8 @@ namespace TrenchBroom {
             
             virtual void doAddToIndex(AttributableNode* attributable, const AttributeName& name, const AttributeValue& value);
             virtual void doRemoveFromIndex(AttributableNode* attributable, const AttributeName& name, const AttributeValue& value);
+
+            virtual IssueType doGetIssueTypesAffectedBy(NodeChange changes) const;
         };
     }
 }
@@ -32,8 +32,18 @@ namespace TrenchBroom {
         public:
             virtual ~NodeSnapshot();
             void restore(const vm::bbox3& worldBounds);
+            size_t memoryUsage() const;
+
+            /**
+             * Reduces the memory held by this snapshot by only keeping what differs from the current state of the
+             * node. This must only be called while the node is in the state that it will be in when the snapshot is
+             * restored.
+             */
+            void compact();
         private:
             virtual void doRestore(const vm::bbox3& worldBounds) = 0;
+            virtual size_t doGetMemoryUsage() const = 0;
+            virtual void doCompact();
         };
     }
 }
@@ -43,6 +43,10 @@ namespace TrenchBroom {
         std::unique_ptr<TexCoordSystemSnapshot> ParallelTexCoordSystemSnapshot::doClone() const {
             return std::make_unique<ParallelTexCoordSystemSnapshot>(m_xAxis, m_yAxis);
         }
+
+        size_t ParallelTexCoordSystemSnapshot::doGetMemoryUsage() const {
+            return sizeof(ParallelTexCoordSystemSnapshot);
+        }
         
         void ParallelTexCoordSystemSnapshot::doRestore(ParallelTexCoordSystem& coordSystem) const {
             coordSystem.m_xAxis = m_xAxis;
@@ -70,6 +74,10 @@ namespace TrenchBroom {
         std::unique_ptr<TexCoordSystemSnapshot> ParallelTexCoordSystem::doTakeSnapshot() {
             return std::make_unique<ParallelTexCoordSystemSnapshot>(this);
         }
+
+        size_t ParallelTexCoordSystem::doGetMemoryUsage() const {
+            return sizeof(ParallelTexCoordSystem);
+        }
         
         void ParallelTexCoordSystem::doRestoreSnapshot(const TexCoordSystemSnapshot& snapshot) {
             snapshot.doRestore(*this);
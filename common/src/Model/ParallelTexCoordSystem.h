@@ -43,6 +43,7 @@ namespace TrenchBroom {
             ParallelTexCoordSystemSnapshot(ParallelTexCoordSystem* coordSystem);
         private:
             std::unique_ptr<TexCoordSystemSnapshot> doClone() const override;
+            size_t doGetMemoryUsage() const override;
             void doRestore(ParallelTexCoordSystem& coordSystem) const override;
             void doRestore(ParaxialTexCoordSystem& coordSystem) const override;
         };
@@ -59,6 +60,7 @@ namespace TrenchBroom {
         private:
             std::unique_ptr<TexCoordSystem> doClone() const override;
             std::unique_ptr<TexCoordSystemSnapshot> doTakeSnapshot() override;
+            size_t doGetMemoryUsage() const override;
             void doRestoreSnapshot(const TexCoordSystemSnapshot& snapshot) override;
             
             vm::vec3 getXAxis() const override;
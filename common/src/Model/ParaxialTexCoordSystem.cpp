@@ -83,6 +83,10 @@ namespace TrenchBroom {
         std::unique_ptr<TexCoordSystemSnapshot> ParaxialTexCoordSystem::doTakeSnapshot() {
             return std::unique_ptr<TexCoordSystemSnapshot>();
         }
+
+        size_t ParaxialTexCoordSystem::doGetMemoryUsage() const {
+            return sizeof(ParaxialTexCoordSystem);
+        }
         
         void ParaxialTexCoordSystem::doRestoreSnapshot(const TexCoordSystemSnapshot& snapshot) {
             ensure(false, "unsupported");
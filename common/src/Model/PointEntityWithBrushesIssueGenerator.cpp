@@ -74,7 +74,7 @@ namespace TrenchBroom {
         };
         
         PointEntityWithBrushesIssueGenerator::PointEntityWithBrushesIssueGenerator() :
-        IssueGenerator(PointEntityWithBrushesIssue::Type, "Point entity with brushes") {
+        IssueGenerator(PointEntityWithBrushesIssue::Type, "Point entity with brushes", NodeChanges::Contents | NodeChanges::Descendants) {
             addQuickFix(new PointEntityWithBrushesIssueQuickFix());
         }
         
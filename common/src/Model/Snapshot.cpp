@@ -20,6 +20,7 @@
 #include "Snapshot.h"
 
 #include "CollectionUtils.h"
+#include "MemoryUsage.h"
 #include "Model/BrushFaceSnapshot.h"
 #include "Model/Node.h"
 #include "Model/NodeSnapshot.h"
@@ -41,6 +42,20 @@ namespace TrenchBroom {
                 snapshot->restore();
         }
 
+        size_t Snapshot::memoryUsage() const {
+            size_t result = sizeof(Snapshot) + heapMemoryUsage(m_nodeSnapshots) + heapMemoryUsage(m_brushFaceSnapshots);
+            for (const NodeSnapshot* snapshot : m_nodeSnapshots)
+                result += snapshot->memoryUsage();
+            for (const BrushFaceSnapshot* snapshot : m_brushFaceSnapshots)
+                result += snapshot->memoryUsage();
+            return result;
+        }
+
+        void Snapshot::compact() {
+            for (NodeSnapshot* snapshot : m_nodeSnapshots)
+                snapshot->compact();
+        }
+
         void Snapshot::takeSnapshot(Node* node) {
             NodeSnapshot* snapshot = node->takeSnapshot();
             if (snapshot != nullptr)
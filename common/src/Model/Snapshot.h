@@ -46,6 +46,19 @@ namespace TrenchBroom {
             
             void restoreNodes(const vm::bbox3& worldBounds);
             void restoreBrushFaces();
+
+            /**
+             * Returns the number of bytes occupied by this snapshot.
+             */
+            size_t memoryUsage() const;
+
+            /**
+             * Compacts the node snapshots. Must only be called while the nodes are in the state in which they will
+             * be when this snapshot is restored.
+             *
+             * @see NodeSnapshot::compact()
+             */
+            void compact();
         private:
             void takeSnapshot(Node* node);
             void takeSnapshot(BrushFace* face);
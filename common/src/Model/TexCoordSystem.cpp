@@ -34,6 +34,10 @@ namespace TrenchBroom {
         std::unique_ptr<TexCoordSystemSnapshot> TexCoordSystemSnapshot::clone() const {
             return doClone();
         }
+
+        size_t TexCoordSystemSnapshot::memoryUsage() const {
+            return doGetMemoryUsage();
+        }
         
         TexCoordSystem::TexCoordSystem() = default;
 
@@ -47,6 +51,10 @@ namespace TrenchBroom {
             return doTakeSnapshot();
         }
 
+        size_t TexCoordSystem::memoryUsage() const {
+            return doGetMemoryUsage();
+        }
+
         vm::vec3 TexCoordSystem::xAxis() const {
             return getXAxis();
         }
@@ -43,8 +43,10 @@ namespace TrenchBroom {
             virtual ~TexCoordSystemSnapshot();
             void restore(TexCoordSystem& coordSystem) const;
             std::unique_ptr<TexCoordSystemSnapshot> clone() const;
+            size_t memoryUsage() const;
         private:
             virtual std::unique_ptr<TexCoordSystemSnapshot> doClone() const = 0;
+            virtual size_t doGetMemoryUsage() const = 0;
             virtual void doRestore(ParallelTexCoordSystem& coordSystem) const = 0;
             virtual void doRestore(ParaxialTexCoordSystem& coordSystem) const = 0;
             
@@ -64,6 +66,11 @@ namespace TrenchBroom {
             
             std::unique_ptr<TexCoordSystem> clone() const;
             std::unique_ptr<TexCoordSystemSnapshot> takeSnapshot();
+
+            /**
+             * Returns the number of bytes occupied by this coordinate system.
+             */
+            size_t memoryUsage() const;
             
             vm::vec3 xAxis() const;
             vm::vec3 yAxis() const;
@@ -89,6 +96,7 @@ namespace TrenchBroom {
         private:
             virtual std::unique_ptr<TexCoordSystem> doClone() const = 0;
             virtual std::unique_ptr<TexCoordSystemSnapshot> doTakeSnapshot() = 0;
+            virtual size_t doGetMemoryUsage() const = 0;
             virtual void doRestoreSnapshot(const TexCoordSystemSnapshot& snapshot) = 0;
             friend class TexCoordSystemSnapshot;
             
@@ -19,19 +19,27 @@
 
 #include "World.h"
 
+#include "ParallelFor.h"
+#include "Profiler.h"
 #include "Model/AssortNodesVisitor.h"
 #include "Model/Brush.h"
 #include "Model/BrushFace.h"
 #include "Model/CollectNodesWithDescendantSelectionCountVisitor.h"
+#include "Model/Issue.h"
 #include "Model/IssueGenerator.h"
 
+#include <iterator>
+
 namespace TrenchBroom {
     namespace Model {
         World::World(MapFormat mapFormat, const BrushContentTypeBuilder* brushContentTypeBuilder, const vm::bbox3& worldBounds) :
         m_factory(mapFormat, brushContentTypeBuilder),
         m_defaultLayer(nullptr),
         // m_nodeTree(VecCodeComputer<vm::vec3>(worldBounds)),
-        m_updateNodeTree(true) {
+        m_updateNodeTree(true),
+        m_deferNodeTreeUpdates(false),
+        m_nodeTreeSnapshotValid(false),
+        m_nodeTreeChangedSinceLastQuery(false) {
             addOrUpdateAttribute(AttributeNames::Classname, AttributeValues::WorldspawnClassname);
             createDefaultLayer(worldBounds);
         }
@@ -73,7 +81,8 @@ namespace TrenchBroom {
 
         void World::registerIssueGenerator(IssueGenerator* issueGenerator) {
             m_issueGeneratorRegistry.registerGenerator(issueGenerator);
-            invalidateAllIssues();
+            // only the issues of the new generator are missing
+            invalidateIssues(issueGenerator->type());
         }
 
         void World::unregisterAllIssueGenerators() {
@@ -152,10 +161,66 @@ namespace TrenchBroom {
             CollectTreeNodes collect;
             acceptAndRecurse(collect);
 
-            m_nodeTree.clearAndBuild(collect.nodes(), [](const auto* node){ return node->bounds(); });
+            const auto& nodes = collect.nodes();
+            NodeTree::EntryList entries;
+            entries.reserve(nodes.size());
+            for (auto* node : nodes) {
+                entries.emplace_back(node->bounds(), node);
+            }
+
+            m_nodeTree.clearAndBuild(entries, defaultThreadCount());
+            m_nodeTreeSnapshotValid = false;
+            m_nodeTreeChangedSinceLastQuery = false;
+        }
+
+        void World::deferNodeTreeUpdates() {
+            assert(!m_deferNodeTreeUpdates);
+            m_deferNodeTreeUpdates = true;
+        }
+
+        void World::applyDeferredNodeTreeUpdates() {
+            assert(m_deferNodeTreeUpdates);
+            m_deferNodeTreeUpdates = false;
+            updateDeferredNodesInNodeTree();
         }
 
-        class World::InvalidateAllIssuesVisitor : public NodeVisitor {
+        void World::updateDeferredNodesInNodeTree() {
+            NodeTree::UpdateList updates;
+            updates.reserve(m_deferredNodeTreeUpdates.size());
+            for (const auto& [node, oldBounds] : m_deferredNodeTreeUpdates) {
+                if (node->bounds() != oldBounds) {
+                    updates.push_back(NodeTree::Update{ oldBounds, node->bounds(), node });
+                }
+            }
+            m_deferredNodeTreeUpdates.clear();
+
+            m_nodeTree.update(updates);
+        }
+
+        void World::invalidateNodeTreeSnapshot() {
+            m_nodeTreeSnapshotValid = false;
+            m_nodeTreeChangedSinceLastQuery = true;
+        }
+
+        const World::NodeTree::Snapshot* World::nodeTreeSnapshot() const {
+            if (!m_nodeTreeSnapshotValid) {
+                if (m_nodeTreeChangedSinceLastQuery) {
+                    m_nodeTreeChangedSinceLastQuery = false;
+                    return nullptr;
+                }
+
+                m_nodeTreeSnapshot = NodeTree::Snapshot(m_nodeTree);
+                m_nodeTreeSnapshotValid = true;
+            }
+            return &m_nodeTreeSnapshot;
+        }
+
+        class World::InvalidateIssuesVisitor : public NodeVisitor {
+        private:
+            IssueType m_types;
+        public:
+            InvalidateIssuesVisitor(const IssueType types) :
+            m_types(types) {}
         private:
             void doVisit(World* world) override   { invalidateIssues(world);  }
             void doVisit(Layer* layer) override   { invalidateIssues(layer);  }
@@ -163,12 +228,92 @@ namespace TrenchBroom {
             void doVisit(Entity* entity) override { invalidateIssues(entity); }
             void doVisit(Brush* brush) override   { invalidateIssues(brush);  }
             
-            void invalidateIssues(Node* node) { node->invalidateIssues(); }
+            void invalidateIssues(Node* node) { node->invalidateIssues(m_types); }
         };
         
         void World::invalidateAllIssues() {
-            InvalidateAllIssuesVisitor visitor;
+            invalidateIssues(~IssueType(0));
+        }
+
+        void World::invalidateIssues(const IssueType types) {
+            InvalidateIssuesVisitor visitor(types);
+            acceptAndRecurse(visitor);
+        }
+
+        class World::CollectNodesWithInvalidIssuesVisitor : public NodeVisitor {
+        private:
+            IssueType m_types;
+            NodeList m_nodes;
+        public:
+            CollectNodesWithInvalidIssuesVisitor(const IssueType types) :
+            m_types(types) {}
+
+            const NodeList& nodes() const {
+                return m_nodes;
+            }
+        private:
+            void doVisit(World* world) override   { collect(world);  }
+            void doVisit(Layer* layer) override   { collect(layer);  }
+            void doVisit(Group* group) override   { collect(group);  }
+            void doVisit(Entity* entity) override { collect(entity); }
+            void doVisit(Brush* brush) override   { collect(brush);  }
+
+            void collect(Node* node) {
+                if ((node->invalidIssueTypes() & m_types) != 0) {
+                    m_nodes.push_back(node);
+                }
+            }
+        };
+
+        void World::validateIssues(const size_t threadCount) {
+            TB_PROFILE_SCOPE("World::validateIssues");
+            const auto& generators = registeredIssueGenerators();
+
+            IssueType generatorTypes = 0;
+            for (const auto* generator : generators) {
+                generatorTypes |= generator->type();
+            }
+
+            // the dirty set: all nodes that have invalid issues of any registered type
+            CollectNodesWithInvalidIssuesVisitor visitor(generatorTypes);
             acceptAndRecurse(visitor);
+            const auto& nodes = visitor.nodes();
+
+            // every pair of a dirty node and one of its invalid generators is an independent work item
+            struct WorkItem {
+                Node* node;
+                const IssueGenerator* generator;
+                IssueList issues;
+            };
+
+            std::vector<WorkItem> workItems;
+            for (auto* node : nodes) {
+                const auto invalidTypes = node->invalidIssueTypes();
+                for (const auto* generator : generators) {
+                    if ((generator->type() & invalidTypes) != 0) {
+                        workItems.push_back(WorkItem{ node, generator, IssueList() });
+                    }
+                }
+            }
+
+            parallelFor(workItems.size(), [&](const size_t i) {
+                auto& workItem = workItems[i];
+                workItem.node->generateIssues(workItem.generator, workItem.issues);
+            }, threadCount);
+
+            // the work items of a node are adjacent and in the order of the generators, as in Node::validateIssues
+            auto it = std::begin(workItems);
+            for (auto* node : nodes) {
+                IssueList issues;
+                while (it != std::end(workItems) && it->node == node) {
+                    for (auto* issue : it->issues) {
+                        issue->renumber();
+                    }
+                    VectorUtils::append(issues, it->issues);
+                    ++it;
+                }
+                node->addValidatedIssues(issues);
+            }
         }
 
         const vm::bbox3& World::doGetBounds() const {
@@ -249,20 +394,33 @@ namespace TrenchBroom {
             if (m_updateNodeTree && node->shouldAddToSpacialIndex()) {
                 AddNodeToNodeTree visitor(m_nodeTree);
                 node->acceptAndRecurse(visitor);
+                invalidateNodeTreeSnapshot();
             }
         }
 
         void World::doDescendantWillBeRemoved(Node* node, const size_t depth) {
             if (m_updateNodeTree && node->shouldAddToSpacialIndex()) {
+                // the node or its descendants may be in the tree with their bounds before the deferred changes
+                if (!m_deferredNodeTreeUpdates.empty()) {
+                    updateDeferredNodesInNodeTree();
+                }
+
                 RemoveNodeFromNodeTree visitor(m_nodeTree);
                 node->acceptAndRecurse(visitor);
+                invalidateNodeTreeSnapshot();
             }
         }
 
         void World::doDescendantBoundsDidChange(Node* node, const vm::bbox3& oldBounds, const size_t depth) {
             if (m_updateNodeTree && node->shouldAddToSpacialIndex()) {
-                UpdateNodeInNodeTree visitor(m_nodeTree, oldBounds);
-                node->accept(visitor);
+                if (m_deferNodeTreeUpdates) {
+                    // keeps the bounds before the first change if the node changes more than once
+                    m_deferredNodeTreeUpdates.emplace(node, oldBounds);
+                } else {
+                    UpdateNodeInNodeTree visitor(m_nodeTree, oldBounds);
+                    node->accept(visitor);
+                }
+                invalidateNodeTreeSnapshot();
             }
         }
 
@@ -271,13 +429,27 @@ namespace TrenchBroom {
         }
 
         void World::doPick(const vm::ray3& ray, PickResult& pickResult) const {
-            for (const auto* node : m_nodeTree.findIntersectors(ray)) {
+            NodeList nodes;
+            if (const auto* snapshot = nodeTreeSnapshot()) {
+                snapshot->findIntersectors(ray, std::back_inserter(nodes));
+            } else {
+                m_nodeTree.findIntersectors(ray, std::back_inserter(nodes));
+            }
+
+            for (const auto* node : nodes) {
                 node->pick(ray, pickResult);
             }
         }
         
         void World::doFindNodesContaining(const vm::vec3& point, NodeList& result) {
-            for (auto* node : m_nodeTree.findContainers(point)) {
+            NodeList nodes;
+            if (const auto* snapshot = nodeTreeSnapshot()) {
+                snapshot->findContainers(point, std::back_inserter(nodes));
+            } else {
+                m_nodeTree.findContainers(point, std::back_inserter(nodes));
+            }
+
+            for (auto* node : nodes) {
                 node->findNodesContaining(point, result);
             }
         }
@@ -314,6 +486,10 @@ namespace TrenchBroom {
             m_attributableIndex.removeAttribute(attributable, name, value);
         }
 
+        IssueType World::doGetIssueTypesAffectedBy(const NodeChange changes) const {
+            return m_issueGeneratorRegistry.issueTypes(changes);
+        }
+
         void World::doAttributesDidChange(const vm::bbox3& oldBounds) {}
 
         bool World::doIsAttributeNameMutable(const AttributeName& name) const {
@@ -381,5 +557,31 @@ namespace TrenchBroom {
         BrushFace* World::doCreateFace(const vm::vec3& point1, const vm::vec3& point2, const vm::vec3& point3, const BrushFaceAttributes& attribs, const vm::vec3& texAxisX, const vm::vec3& texAxisY) const {
             return m_factory.createFace(point1, point2, point3, attribs, texAxisX, texAxisY);
         }
+
+        DeferNodeTreeUpdates::DeferNodeTreeUpdates(World& world) :
+        m_world(world),
+        m_applied(false) {
+            m_world.deferNodeTreeUpdates();
+        }
+
+        DeferNodeTreeUpdates::~DeferNodeTreeUpdates() {
+            if (!m_applied) {
+                try {
+                    m_world.applyDeferredNodeTreeUpdates();
+                } catch (const NodeTreeException&) {
+                    m_world.rebuildNodeTree();
+                }
+            }
+        }
+
+        void DeferNodeTreeUpdates::apply() {
+            m_applied = true;
+            try {
+                m_world.applyDeferredNodeTreeUpdates();
+            } catch (const NodeTreeException&) {
+                m_world.rebuildNodeTree();
+                throw;
+            }
+        }
     }
 }
@@ -22,6 +22,8 @@
 
 #include "TrenchBroom.h"
 #include "AABBTree.h"
+#include "Macros.h"
+#include "ParallelFor.h"
 #include "Model/AttributableNode.h"
 #include "Model/AttributableNodeIndex.h"
 #include "Model/IssueGeneratorRegistry.h"
@@ -30,6 +32,8 @@
 #include "Model/ModelFactoryImpl.h"
 #include "Model/Node.h"
 
+#include <map>
+
 namespace TrenchBroom {
     namespace Model {
         class BrushContentTypeBuilder;
@@ -45,6 +49,22 @@ namespace TrenchBroom {
             using NodeTree = AABBTree<FloatType, 3, Node*>;
             NodeTree m_nodeTree;
             bool m_updateNodeTree;
+
+            /**
+             * While node tree updates are deferred, the bounds of the nodes whose bounds changed are recorded here
+             * before their first change, so that the tree can be updated in one batch afterwards.
+             */
+            bool m_deferNodeTreeUpdates;
+            std::map<Node*, vm::bbox3> m_deferredNodeTreeUpdates;
+
+            /**
+             * Picking and point queries use a flattened snapshot of the node tree. While the tree is being changed
+             * between queries, e.g. when dragging objects, the tree is queried directly instead so that the snapshot
+             * is not recreated for every query.
+             */
+            mutable NodeTree::Snapshot m_nodeTreeSnapshot;
+            mutable bool m_nodeTreeSnapshotValid;
+            mutable bool m_nodeTreeChangedSinceLastQuery;
         public:
             World(MapFormat mapFormat, const BrushContentTypeBuilder* brushContentTypeBuilder, const vm::bbox3& worldBounds);
         public: // layer management
@@ -61,6 +81,15 @@ namespace TrenchBroom {
             IssueQuickFixList quickFixes(IssueType issueTypes) const;
             void registerIssueGenerator(IssueGenerator* issueGenerator);
             void unregisterAllIssueGenerators();
+
+            /**
+             * Regenerates the issues of all nodes whose issues are out of date. Only the generators whose issues were
+             * invalidated are run for each such node, and the work is distributed over the given number of threads.
+             * Afterwards, calling issues on any node of this world does not generate any issues.
+             *
+             * Issue generators must therefore not modify the nodes that they inspect.
+             */
+            void validateIssues(size_t threadCount = defaultThreadCount());
         private:
             class AddNodeToNodeTree;
             class RemoveNodeFromNodeTree;
@@ -70,9 +99,29 @@ namespace TrenchBroom {
             void disableNodeTreeUpdates();
             void enableNodeTreeUpdates();
             void rebuildNodeTree();
+
+            /**
+             * Defers updating the node tree when the bounds of nodes change until applyDeferredNodeTreeUpdates is
+             * called. Use this when changing the bounds of many nodes at once, e.g. when transforming objects. The
+             * node tree must not be queried while its updates are deferred. Prefer DeferNodeTreeUpdates, which
+             * applies the deferred updates even if an exception is thrown.
+             */
+            void deferNodeTreeUpdates();
+
+            /**
+             * Updates the node tree for all nodes whose bounds changed since deferNodeTreeUpdates was called, and
+             * stops deferring updates.
+             */
+            void applyDeferredNodeTreeUpdates();
+        private:
+            void updateDeferredNodesInNodeTree();
+            void invalidateNodeTreeSnapshot();
+            const NodeTree::Snapshot* nodeTreeSnapshot() const;
         private:
-            class InvalidateAllIssuesVisitor;
+            class InvalidateIssuesVisitor;
+            class CollectNodesWithInvalidIssuesVisitor;
             void invalidateAllIssues();
+            void invalidateIssues(IssueType types);
         private: // implement Node interface
             const vm::bbox3& doGetBounds() const override;
             Node* doClone(const vm::bbox3& worldBounds) const override;
@@ -97,6 +146,8 @@ namespace TrenchBroom {
             void doFindAttributableNodesWithNumberedAttribute(const AttributeName& prefix, const AttributeValue& value, AttributableNodeList& result) const override;
             void doAddToIndex(AttributableNode* attributable, const AttributeName& name, const AttributeValue& value) override;
             void doRemoveFromIndex(AttributableNode* attributable, const AttributeName& name, const AttributeValue& value) override;
+
+            IssueType doGetIssueTypesAffectedBy(NodeChange changes) const override;
         private: // implement AttributableNode interface
             void doAttributesDidChange(const vm::bbox3& oldBounds) override;
             bool doIsAttributeNameMutable(const AttributeName& name) const override;
@@ -116,6 +167,34 @@ namespace TrenchBroom {
             World(const World&);
             World& operator=(const World&);
         };
+
+        /**
+         * Defers the node tree updates of a world while it is in scope. Call apply once the nodes have been changed.
+         * If that does not happen, e.g. because an exception is thrown while the nodes are being changed, the
+         * updates are applied when this goes out of scope.
+         */
+        class DeferNodeTreeUpdates {
+            deleteCopyAndMove(DeferNodeTreeUpdates)
+        private:
+            World& m_world;
+            bool m_applied;
+        public:
+            explicit DeferNodeTreeUpdates(World& world);
+
+            /**
+             * Applies the deferred updates if apply has not been called. A destructor must not throw, so if
+             * applying the updates fails, the node tree is rebuilt instead.
+             */
+            ~DeferNodeTreeUpdates();
+
+            /**
+             * Applies the deferred updates and stops deferring updates. If applying the updates fails, the node
+             * tree is rebuilt before the exception is rethrown.
+             *
+             * @throws NodeTreeException if the node tree could not be updated
+             */
+            void apply();
+        };
     }
 }
 
@@ -62,7 +62,7 @@ namespace TrenchBroom {
         const IssueType WorldBoundsIssueGenerator::WorldBoundsIssue::Type = Issue::freeType();
         
         WorldBoundsIssueGenerator::WorldBoundsIssueGenerator(const vm::bbox3& bounds) :
-        IssueGenerator(WorldBoundsIssue::Type, "Objects out of world bounds"),
+        IssueGenerator(WorldBoundsIssue::Type, "Objects out of world bounds", NodeChanges::Contents | NodeChanges::Descendants | NodeChanges::DescendantContents),
         m_bounds(bounds) {
             addQuickFix(new WorldBoundsIssueQuickFix());
         }
@@ -0,0 +1,145 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ParallelFor.h"
+
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+namespace TrenchBroom {
+    size_t defaultThreadCount() {
+        const auto count = static_cast<size_t>(std::thread::hardware_concurrency());
+        return std::max(count, size_t(1));
+    }
+
+    namespace {
+        // set while the thread runs a function passed to runOnWorkerThreads, so that nested calls run inline
+        thread_local bool runningOnWorkerThreads = false;
+
+        /**
+         * The worker threads shared by all calls to runOnWorkerThreads. Only one function runs on the workers at a
+         * time. The workers wait for the next function between calls, so that parallel loops don't pay for starting
+         * threads every time.
+         */
+        class WorkerThreads {
+        private:
+            std::vector<std::thread> m_threads;
+            // held by the thread that runs a function on the workers
+            std::mutex m_runMutex;
+
+            std::mutex m_mutex;
+            std::condition_variable m_funcAvailable;
+            std::condition_variable m_funcDone;
+            const std::function<void()>* m_func;
+            // the number of workers that may still start to call m_func
+            size_t m_unclaimed;
+            // the number of workers that are calling m_func
+            size_t m_running;
+            bool m_stop;
+        public:
+            WorkerThreads() :
+            m_func(nullptr),
+            m_unclaimed(0),
+            m_running(0),
+            m_stop(false) {}
+
+            ~WorkerThreads() {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stop = true;
+                }
+                m_funcAvailable.notify_all();
+                for (auto& thread : m_threads) {
+                    thread.join();
+                }
+            }
+
+            size_t threadCount() {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_threads.size();
+            }
+
+            void run(const size_t workerCount, const std::function<void()>& func) {
+                std::unique_lock<std::mutex> runLock(m_runMutex, std::try_to_lock);
+                if (workerCount == 0 || runningOnWorkerThreads || !runLock.owns_lock()) {
+                    func();
+                    return;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    while (m_threads.size() < workerCount) {
+                        m_threads.emplace_back([this]() { work(); });
+                    }
+                    m_func = &func;
+                    m_unclaimed = workerCount;
+                }
+                m_funcAvailable.notify_all();
+
+                runningOnWorkerThreads = true;
+                func();
+                runningOnWorkerThreads = false;
+
+                // workers that have not started yet are not needed anymore, and must not start once we return
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_unclaimed = 0;
+                m_funcDone.wait(lock, [this]() { return m_running == 0; });
+                m_func = nullptr;
+            }
+        private:
+            void work() {
+                runningOnWorkerThreads = true;
+
+                std::unique_lock<std::mutex> lock(m_mutex);
+                while (true) {
+                    m_funcAvailable.wait(lock, [this]() { return m_stop || m_unclaimed > 0; });
+                    if (m_stop) {
+                        return;
+                    }
+
+                    --m_unclaimed;
+                    ++m_running;
+                    const auto* func = m_func;
+
+                    lock.unlock();
+                    (*func)();
+                    lock.lock();
+
+                    if (--m_running == 0) {
+                        m_funcDone.notify_all();
+                    }
+                }
+            }
+        };
+
+        WorkerThreads& workerThreads() {
+            static WorkerThreads threads;
+            return threads;
+        }
+    }
+
+    void runOnWorkerThreads(const size_t workerCount, const std::function<void()>& func) {
+        workerThreads().run(workerCount, func);
+    }
+
+    size_t workerThreadCount() {
+        return workerThreads().threadCount();
+    }
+}
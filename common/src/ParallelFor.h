@@ -0,0 +1,123 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_ParallelFor_h
+#define TrenchBroom_ParallelFor_h
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+
+namespace TrenchBroom {
+    /**
+     * Returns the number of threads to use for parallel work, which is the number of hardware threads, but at
+     * least 1.
+     */
+    size_t defaultThreadCount();
+
+    /**
+     * The default minimum number of indices that parallelFor hands to each thread. Running fewer indices per
+     * thread costs more in synchronization than it saves, unless every index is expensive.
+     */
+    static const size_t DefaultMinCountPerThread = 32;
+
+    /**
+     * Calls the given function on the calling thread and on up to the given number of worker threads, and returns
+     * once all of these calls have returned. The worker threads are shared by all calls and are started when they
+     * are first needed.
+     *
+     * If the workers are busy, e.g. if this is called from one of them, the function is only called on the calling
+     * thread. The function must not throw.
+     *
+     * @param workerCount the maximum number of worker threads to use
+     * @param func the function to call
+     */
+    void runOnWorkerThreads(size_t workerCount, const std::function<void()>& func);
+
+    /**
+     * Returns the number of worker threads that have been started. Only exposed for testing.
+     */
+    size_t workerThreadCount();
+
+    /**
+     * Calls the given function for every index in [0, count), distributing the indices over up to the given
+     * number of threads. The calling thread takes part in the work.
+     *
+     * Indices are handed out in small batches from a shared counter, so threads that finish early pick up the
+     * remaining work of slower threads. The order in which the indices are processed is unspecified. If there are
+     * fewer than 2 * minCountPerThread indices, they are processed on the calling thread.
+     *
+     * If the function throws an exception, the remaining indices are skipped and the first exception is
+     * rethrown on the calling thread once all threads have finished.
+     *
+     * @param count the number of indices
+     * @param func the function to call, must accept a single size_t argument
+     * @param threadCount the maximum number of threads to use
+     * @param minCountPerThread the minimum number of indices per thread, pass 1 if every index is expensive
+     */
+    template <typename F>
+    void parallelFor(const size_t count, F func, const size_t threadCount = defaultThreadCount(), const size_t minCountPerThread = DefaultMinCountPerThread) {
+        const auto threadCountForWork = count / std::max(minCountPerThread, size_t(1));
+        const auto workerCount = std::min(std::max(threadCount, size_t(1)), threadCountForWork);
+        if (workerCount <= 1) {
+            for (size_t i = 0; i < count; ++i) {
+                func(i);
+            }
+            return;
+        }
+
+        const auto batchSize = std::max(size_t(1), count / (workerCount * 16u));
+
+        std::atomic<size_t> next(0);
+        std::atomic<bool> failed(false);
+        std::exception_ptr exception;
+        std::mutex exceptionMutex;
+
+        runOnWorkerThreads(workerCount - 1, [&]() {
+            try {
+                while (!failed) {
+                    const auto first = next.fetch_add(batchSize);
+                    if (first >= count) {
+                        break;
+                    }
+
+                    const auto last = std::min(first + batchSize, count);
+                    for (auto i = first; i < last; ++i) {
+                        func(i);
+                    }
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(exceptionMutex);
+                if (!failed) {
+                    exception = std::current_exception();
+                    failed = true;
+                }
+            }
+        });
+
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+}
+
+#endif /* TrenchBroom_ParallelFor_h */
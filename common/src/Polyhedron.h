@@ -367,6 +367,17 @@ public: // Accessors
 
     const vm::bbox<T,3>& bounds() const;
 
+    /**
+     * Returns the volume enclosed by this polyhedron, or 0 if this is not a closed polyhedron.
+     */
+    T volume() const;
+
+    /**
+     * Returns the number of bytes occupied by this polyhedron and its vertices, edges, half edges and faces,
+     * not counting any memory held by the vertex and face payloads.
+     */
+    size_t memoryUsage() const;
+
     bool empty() const;
     bool point() const;
     bool edge() const;
@@ -453,12 +464,16 @@ private:
     Vertex* addFurtherPointToPolyhedron(const V& position, Callback& callback);
     Vertex* addPointToPolyhedron(const V& position, const Seam& seam, Callback& callback);
 
+    class ConflictCallback;
+    void addPointsToPolyhedron(const std::vector<V>& positions, Callback& callback);
+
     class SplittingCriterion;
     class SplitByVisibilityCriterion;
     class SplitByConnectivityCriterion;
     class SplitByNormalCriterion;
 
     Seam createSeam(const SplittingCriterion& criterion);
+    Seam createSeam(const SplittingCriterion& criterion, Edge* first);
 
     void split(const Seam& seam, Callback& callback);
     void deleteFaces(HalfEdge* current, FaceSet& visitedFaces, VertexList& verticesToDelete, Callback& callback);
@@ -515,6 +530,29 @@ private:
     HalfEdge* intersectWithPlane(HalfEdge* firstBoundaryEdge, const vm::plane<T,3>& plane, Callback& callback);
     void intersectWithPlane(HalfEdge* remainingFirst, HalfEdge* deletedFirst, Callback& callback);
     HalfEdge* findNextIntersectingEdge(HalfEdge* searchFrom, const vm::plane<T,3>& plane) const;
+public: // Building from planes
+    /**
+     * Replaces the contents of this polyhedron with the convex polyhedron that is bounded by the given planes. Unlike
+     * clipping a large polyhedron by each plane, the vertices are computed directly from the plane intersections and
+     * the half edge structure is built in one pass. Six axis aligned planes are handled without any intersection
+     * tests.
+     *
+     * The given vector receives one entry per plane: the face that lies on the plane, or null if the plane does not
+     * contribute a face, e.g. because it is redundant or coincides with a previous plane.
+     *
+     * Returns false if the planes don't bound a closed polyhedron, if there are more than 64 planes, or if the
+     * planes are too degenerate to build the polyhedron reliably. This polyhedron remains unchanged in that case,
+     * and the caller should fall back to clipping.
+     *
+     * No callbacks are called, and the vertex positions are not corrected.
+     */
+    bool setPlanes(const std::vector<vm::plane<T,3>>& planes, std::vector<Face*>& faces);
+private:
+    using FaceVertices = std::vector<std::vector<size_t>>;
+
+    static bool findCuboidFaces(const std::vector<vm::plane<T,3>>& planes, std::vector<V>& positions, FaceVertices& faceVertices);
+    static bool findPlaneFaces(const std::vector<vm::plane<T,3>>& planes, std::vector<V>& positions, FaceVertices& faceVertices);
+    bool setFaces(const std::vector<V>& positions, const FaceVertices& faceVertices, std::vector<Face*>& faces);
 public: // Subtraction
     typedef std::list<Polyhedron> SubtractResult;
 
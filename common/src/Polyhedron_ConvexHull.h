@@ -26,7 +26,10 @@
 #include <vecmath/constants.h>
 #include <vecmath/util.h>
 
+#include <algorithm>
 #include <list>
+#include <unordered_map>
+#include <vector>
 
 template <typename T, typename FP, typename VP>
 class Polyhedron<T,FP,VP>::Seam {
@@ -176,14 +179,19 @@ void Polyhedron<T,FP,VP>::addPoints(const std::vector<V>& points, Callback& call
 template <typename T, typename FP, typename VP> template <typename I>
 void Polyhedron<T,FP,VP>::addPoints(I cur, I end) {
     Callback c;
-    while (cur != end)
-        addPoint(*cur++, c);
+    addPoints(cur, end, c);
 }
 
 template <typename T, typename FP, typename VP> template <typename I>
 void Polyhedron<T,FP,VP>::addPoints(I cur, I end, Callback& callback) {
-    while (cur != end)
+    // Add the points one by one until they span a polyhedron, then add the remaining points all at once.
+    while (cur != end && !polyhedron()) {
         addPoint(*cur++, callback);
+    }
+
+    if (cur != end) {
+        addPointsToPolyhedron(std::vector<V>(cur, end), callback);
+    }
 }
 
 template <typename T, typename FP, typename VP>
@@ -232,12 +240,7 @@ void Polyhedron<T,FP,VP>::merge(const Polyhedron& other) {
 template <typename T, typename FP, typename VP>
 void Polyhedron<T,FP,VP>::merge(const Polyhedron& other, Callback& callback) {
     if (!other.empty()) {
-        const Vertex* firstVertex = other.vertices().front();
-        const Vertex* currentVertex = firstVertex;
-        do {
-            addPoint(currentVertex->position(), callback);
-            currentVertex = currentVertex->next();
-        } while (currentVertex != firstVertex);
+        addPoints(other.vertexPositions(), callback);
     }
 }
 
@@ -537,6 +540,190 @@ typename Polyhedron<T,FP,VP>::Vertex* Polyhedron<T,FP,VP>::addFurtherPointToPoly
     return addPointToPolyhedron(position, seam, callback);
 }
 
+/**
+ Forwards all notifications to another callback and keeps track of the points that lie above the faces of this
+ polyhedron while a set of points is added to it. Every point is assigned to one face it lies above. When a face is
+ deleted, its points are collected so that they can be distributed among the faces that replace it.
+ */
+template <typename T, typename FP, typename VP>
+class Polyhedron<T,FP,VP>::ConflictCallback : public Polyhedron<T,FP,VP>::Callback {
+private:
+    struct ConflictList {
+        vm::plane<T,3> plane;
+        std::vector<V> points;
+    };
+
+    Callback& m_callback;
+    std::unordered_map<Face*, ConflictList> m_conflicts;
+    std::vector<Face*> m_facesWithConflicts;
+    std::vector<Face*> m_createdFaces;
+    std::vector<V> m_orphanedPoints;
+public:
+    explicit ConflictCallback(Callback& callback) :
+    m_callback(callback) {}
+
+    /**
+     Assigns each of the given points to the first of the given faces that it lies above. Points that don't lie
+     above any of the faces are discarded.
+     */
+    void assignPoints(const std::vector<V>& points, const std::vector<Face*>& faces) {
+        std::vector<vm::plane<T,3>> planes;
+        planes.reserve(faces.size());
+        for (const auto* face : faces) {
+            planes.emplace_back(face->origin(), face->normal());
+        }
+
+        const auto epsilon = vm::constants<T>::pointStatusEpsilon();
+        for (const auto& point : points) {
+            for (size_t i = 0; i < faces.size(); ++i) {
+                if (planes[i].pointDistance(point) > epsilon) {
+                    auto& conflicts = m_conflicts[faces[i]];
+                    if (conflicts.points.empty()) {
+                        conflicts.plane = planes[i];
+                        m_facesWithConflicts.push_back(faces[i]);
+                    }
+                    conflicts.points.push_back(point);
+                    break;
+                }
+            }
+        }
+    }
+
+    /**
+     Distributes the points of the faces deleted since the last call among the faces created since then.
+     */
+    void reassignOrphanedPoints() {
+        assignPoints(m_orphanedPoints, m_createdFaces);
+        m_orphanedPoints.clear();
+        m_createdFaces.clear();
+    }
+
+    /**
+     Removes the point that is furthest from its face from the conflict list of some face and returns it along
+     with the face. Returns false if no points are left.
+     */
+    bool takeFurthestPoint(Face*& face, V& point) {
+        while (!m_facesWithConflicts.empty()) {
+            auto* candidate = m_facesWithConflicts.back();
+            auto it = m_conflicts.find(candidate);
+            if (it == std::end(m_conflicts)) {
+                // the face was deleted
+                m_facesWithConflicts.pop_back();
+                continue;
+            }
+
+            auto& conflicts = it->second;
+            const auto& plane = conflicts.plane;
+            auto furthest = std::max_element(std::begin(conflicts.points), std::end(conflicts.points), [&](const V& lhs, const V& rhs) {
+                return plane.pointDistance(lhs) < plane.pointDistance(rhs);
+            });
+
+            face = candidate;
+            point = *furthest;
+
+            *furthest = conflicts.points.back();
+            conflicts.points.pop_back();
+            if (conflicts.points.empty()) {
+                m_conflicts.erase(it);
+            }
+            return true;
+        }
+        return false;
+    }
+public:
+    void vertexWasCreated(Vertex* vertex) override {
+        m_callback.vertexWasCreated(vertex);
+    }
+
+    void vertexWillBeDeleted(Vertex* vertex) override {
+        m_callback.vertexWillBeDeleted(vertex);
+    }
+
+    void vertexWasAdded(Vertex* vertex) override {
+        m_callback.vertexWasAdded(vertex);
+    }
+
+    void vertexWillBeRemoved(Vertex* vertex) override {
+        m_callback.vertexWillBeRemoved(vertex);
+    }
+
+    vm::plane<T,3> getPlane(const Face* face) const override {
+        return m_callback.getPlane(face);
+    }
+
+    void faceWasCreated(Face* face) override {
+        m_createdFaces.push_back(face);
+        m_callback.faceWasCreated(face);
+    }
+
+    void faceWillBeDeleted(Face* face) override {
+        auto it = m_conflicts.find(face);
+        if (it != std::end(m_conflicts)) {
+            auto& points = it->second.points;
+            m_orphanedPoints.insert(std::end(m_orphanedPoints), std::begin(points), std::end(points));
+            m_conflicts.erase(it);
+        }
+        m_callback.faceWillBeDeleted(face);
+    }
+
+    void faceDidChange(Face* face) override {
+        m_callback.faceDidChange(face);
+    }
+
+    void faceWasFlipped(Face* face) override {
+        m_callback.faceWasFlipped(face);
+    }
+
+    void faceWasSplit(Face* original, Face* clone) override {
+        m_callback.faceWasSplit(original, clone);
+    }
+
+    void facesWillBeMerged(Face* remaining, Face* toDelete) override {
+        m_callback.facesWillBeMerged(remaining, toDelete);
+    }
+};
+
+/**
+ Adds the given points to this polyhedron using the quickhull algorithm. Adding the points one by one would test
+ every point against every face. Instead, every face keeps a list of the points above it, and the point furthest
+ from its face is added first. The points of the faces that are removed by adding a point are then only tested
+ against the faces that replace them, and points that are not above any of these faces are discarded because they
+ are contained in the polyhedron.
+ */
+template <typename T, typename FP, typename VP>
+void Polyhedron<T,FP,VP>::addPointsToPolyhedron(const std::vector<V>& positions, Callback& callback) {
+    assert(polyhedron());
+
+    ConflictCallback conflictCallback(callback);
+
+    std::vector<Face*> faces;
+    faces.reserve(faceCount());
+    for (auto* face : m_faces) {
+        faces.push_back(face);
+    }
+    conflictCallback.assignPoints(positions, faces);
+
+    Face* face = nullptr;
+    V position;
+    while (conflictCallback.takeFurthestPoint(face, position)) {
+        const SplitByVisibilityCriterion criterion(position);
+        const Seam seam = createSeam(criterion, criterion.findFirstSplittingEdge(face));
+
+        // See addFurtherPointToPolyhedron.
+        if (seam.size() < 3 || seam.hasMultipleLoops()) {
+            continue;
+        }
+
+        split(seam, conflictCallback);
+        auto* vertex = addPointToPolyhedron(position, seam, conflictCallback);
+        m_bounds = vm::merge(m_bounds, position);
+        conflictCallback.reassignOrphanedPoints();
+
+        assert(checkInvariant());
+        callback.vertexWasAdded(vertex);
+    }
+}
+
 // Adds the given point to this polyhedron by weaving a cap over the given seam.
 // Assumes that this polyhedron has been split by the given seam.
 template <typename T, typename FP, typename VP>
@@ -551,9 +738,13 @@ typename Polyhedron<T,FP,VP>::Vertex* Polyhedron<T,FP,VP>::addPointToPolyhedron(
 
 template <typename T, typename FP, typename VP>
 typename Polyhedron<T,FP,VP>::Seam Polyhedron<T,FP,VP>::createSeam(const SplittingCriterion& criterion) {
+    return createSeam(criterion, criterion.findFirstSplittingEdge(m_edges));
+}
+
+template <typename T, typename FP, typename VP>
+typename Polyhedron<T,FP,VP>::Seam Polyhedron<T,FP,VP>::createSeam(const SplittingCriterion& criterion, Edge* first) {
     Seam seam;
     
-    Edge* first = criterion.findFirstSplittingEdge(m_edges);
     if (first != nullptr) {
         Edge* current = first;
         do {
@@ -816,6 +1007,32 @@ public:
         }
         return nullptr;
     }
+
+    // finds a seam edge that borders the region of faces that do not match and that contains the given face
+    Edge* findFirstSplittingEdge(Face* face) const {
+        assert(!matches(face));
+
+        std::vector<Face*> stack({ face });
+        FaceSet visitedFaces({ face });
+        while (!stack.empty()) {
+            const Face* current = stack.back();
+            stack.pop_back();
+
+            for (HalfEdge* halfEdge : current->boundary()) {
+                Edge* edge = halfEdge->edge();
+                Face* neighbour = halfEdge->twin()->face();
+                if (matches(neighbour)) {
+                    if (edge->firstFace() != neighbour) {
+                        edge->flip();
+                    }
+                    return edge;
+                } else if (visitedFaces.insert(neighbour).second) {
+                    stack.push_back(neighbour);
+                }
+            }
+        }
+        return nullptr;
+    }
     
     // finds the next seam edge in counter clockwise orientation
     Edge* findNextSplittingEdge(Edge* last) const {
@@ -29,7 +29,10 @@
 #include <vecmath/scalar.h>
 #include <vecmath/util.h>
 
-#include <map>
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
 
 template <typename T, typename FP, typename VP>
 class Polyhedron<T,FP,VP>::VertexDistanceCmp {
@@ -316,17 +319,29 @@ void Polyhedron<T,FP,VP>::setBounds(const vm::bbox<T,3>& bounds, Callback& callb
     m_bounds = bounds;
 }
 
+/**
+ * Copies the elements of a polyhedron into a destination polyhedron.
+ *
+ * All elements of the copy are allocated from a single arena that is sized to hold all elements of
+ * the original, so that the copy occupies one contiguous block of memory which is freed when its last
+ * element is deleted. The copy can still be modified afterwards; new elements are allocated from the
+ * regular allocator then.
+ *
+ * The original elements are mapped to their copies using sorted tables instead of node based maps, so that
+ * copying a polyhedron does not allocate memory per element.
+ */
 template <typename T, typename FP, typename VP>
 class Polyhedron<T,FP,VP>::Copy {
 private:
-    typedef std::map<const Vertex*, Vertex*> VertexMap;
-    typedef typename VertexMap::value_type VertexMapEntry;
-    
-    typedef std::map<const HalfEdge*, HalfEdge*> HalfEdgeMap;
-    typedef typename HalfEdgeMap::value_type HalfEdgeMapEntry;
-    
-    VertexMap m_vertexMap;
-    HalfEdgeMap m_halfEdgeMap;
+    template <typename E>
+    using MappingTable = std::vector<std::pair<const E*, E*>>;
+
+    typedef MappingTable<Vertex> VertexTable;
+    typedef MappingTable<HalfEdge> HalfEdgeTable;
+
+    AllocatorArena* m_arena;
+    VertexTable m_vertexTable;
+    HalfEdgeTable m_halfEdgeTable;
     
     VertexList m_vertices;
     EdgeList m_edges;
@@ -334,24 +349,93 @@ private:
     Polyhedron& m_destination;
 public:
     Copy(const FaceList& originalFaces, const EdgeList& originalEdges, const VertexList& originalVertices, Polyhedron& destination) :
+    m_arena(nullptr),
     m_destination(destination) {
+        createArena(originalFaces, originalEdges, originalVertices);
         copyVertices(originalVertices);
         copyFaces(originalFaces);
         copyEdges(originalEdges);
         swapContents();
     }
 private:
+    void createArena(const FaceList& originalFaces, const EdgeList& originalEdges, const VertexList& originalVertices) {
+        // Every half edge belongs to a face boundary, except for the half edges of degenerate polyhedra.
+        size_t halfEdgeCount = 0;
+        if (!originalFaces.empty()) {
+            const Face* firstFace = originalFaces.front();
+            const Face* currentFace = firstFace;
+            do {
+                halfEdgeCount += currentFace->m_boundary.size();
+                currentFace = currentFace->next();
+            } while (currentFace != firstFace);
+        }
+        if (!originalEdges.empty()) {
+            const Edge* firstEdge = originalEdges.front();
+            const Edge* currentEdge = firstEdge;
+            do {
+                if (currentEdge->firstEdge()->face() == nullptr) {
+                    ++halfEdgeCount;
+                }
+                if (currentEdge->fullySpecified() && currentEdge->secondEdge()->face() == nullptr) {
+                    ++halfEdgeCount;
+                }
+                currentEdge = currentEdge->next();
+            } while (currentEdge != firstEdge);
+        }
+
+        const size_t capacity =
+            originalVertices.size() * arenaSize<Vertex>() +
+            halfEdgeCount * arenaSize<HalfEdge>() +
+            originalEdges.size() * arenaSize<Edge>() +
+            originalFaces.size() * arenaSize<Face>();
+        const size_t maxBlockSize = std::max({ arenaSize<Vertex>(), arenaSize<HalfEdge>(), arenaSize<Edge>(), arenaSize<Face>() });
+        m_arena = AllocatorArena::create(capacity, maxBlockSize);
+
+        m_vertexTable.reserve(originalVertices.size());
+        m_halfEdgeTable.reserve(halfEdgeCount);
+    }
+
+    template <typename E>
+    static constexpr size_t arenaSize() {
+        // round up to the alignment so that no element has to be padded
+        return (E::arenaBlockSize() + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+    }
+
+    template <typename E, typename... Args>
+    E* create(Args&&... args) {
+        if (m_arena != nullptr) {
+            return new (*m_arena) E(std::forward<Args>(args)...);
+        } else {
+            return new E(std::forward<Args>(args)...);
+        }
+    }
+
+    template <typename E>
+    static void sortTable(MappingTable<E>& table) {
+        std::sort(std::begin(table), std::end(table), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+    }
+
+    template <typename E>
+    static E* findInTable(const MappingTable<E>& table, const E* original) {
+        const auto it = std::lower_bound(std::begin(table), std::end(table), original, [](const auto& entry, const E* element) { return entry.first < element; });
+        if (it == std::end(table) || it->first != original) {
+            return nullptr;
+        }
+        return it->second;
+    }
+
     void copyVertices(const VertexList& originalVertices) {
         if (!originalVertices.empty()) {
             const Vertex* firstVertex = originalVertices.front();
             const Vertex* currentVertex = firstVertex;
             do {
-                Vertex* copy = new Vertex(currentVertex->position());
-                assertResult(MapUtils::insertOrFail(m_vertexMap, currentVertex, copy));
+                Vertex* copy = create<Vertex>(currentVertex->position());
+                m_vertexTable.emplace_back(currentVertex, copy);
                 m_vertices.append(copy, 1);
                 currentVertex = currentVertex->next();
             } while (currentVertex != firstVertex);
         }
+        sortTable(m_vertexTable);
     }
     
     void copyFaces(const FaceList& originalFaces) {
@@ -363,6 +447,7 @@ private:
                 currentFace = currentFace->next();
             } while (currentFace != firstFace);
         }
+        sortTable(m_halfEdgeTable);
     }
     
     void copyFace(const Face* originalFace) {
@@ -375,36 +460,23 @@ private:
             currentHalfEdge = currentHalfEdge->next();
         } while (currentHalfEdge != firstHalfEdge);
         
-        Face* copy = new Face(myBoundary);
+        Face* copy = create<Face>(myBoundary);
         m_faces.append(copy, 1);
     }
     
-    HalfEdgeList copyBoundary(const HalfEdgeList& original) {
-        HalfEdgeList result;
-        
-        const HalfEdge* firstHalfEdge = original.front();
-        const HalfEdge* currentHalfEdge = firstHalfEdge;
-        do {
-            result.append(copyHalfEdge(currentHalfEdge), 1);
-            currentHalfEdge = currentHalfEdge->next();
-        } while (currentHalfEdge != firstHalfEdge);
-        
-        return result;
-    }
-    
     HalfEdge* copyHalfEdge(const HalfEdge* original) {
         const Vertex* originalOrigin = original->origin();
         
         Vertex* myOrigin = findVertex(originalOrigin);
-        HalfEdge* copy = new HalfEdge(myOrigin);
-        m_halfEdgeMap.insert(std::make_pair(original, copy));
+        HalfEdge* copy = create<HalfEdge>(myOrigin);
+        m_halfEdgeTable.emplace_back(original, copy);
         return copy;
     }
     
     Vertex* findVertex(const Vertex* original) {
-        typename VertexMap::iterator it = m_vertexMap.find(original);
-        assert(it != std::end(m_vertexMap));
-        return it->second;
+        Vertex* result = findInTable(m_vertexTable, original);
+        assert(result != nullptr);
+        return result;
     }
     
     void copyEdges(const EdgeList& originalEdges) {
@@ -421,25 +493,22 @@ private:
     Edge* copyEdge(const Edge* original) {
         HalfEdge* myFirst = findOrCopyHalfEdge(original->firstEdge());
         if (!original->fullySpecified())
-            return new Edge(myFirst);
+            return create<Edge>(myFirst);
         
         HalfEdge* mySecond = findOrCopyHalfEdge(original->secondEdge());
-        return new Edge(myFirst, mySecond);
+        return create<Edge>(myFirst, mySecond);
     }
     
     HalfEdge* findOrCopyHalfEdge(const HalfEdge* original) {
-        const auto insertPos = MapUtils::findInsertPos(m_halfEdgeMap, original);
-        if (!insertPos.first) {
+        // Half edges which do not belong to a face are not in the table, but every half edge belongs to only
+        // one edge, so they need not be added to it.
+        HalfEdge* copy = findInTable(m_halfEdgeTable, original);
+        if (copy == nullptr) {
             const Vertex* originalOrigin = original->origin();
             Vertex* myOrigin = findVertex(originalOrigin);
-            HalfEdge* copy = new HalfEdge(myOrigin);
-            m_halfEdgeMap.insert(insertPos.second, std::make_pair(original, copy));
-            return copy;
+            copy = create<HalfEdge>(myOrigin);
         }
-        
-        const auto it = insertPos.second;
-        assert(it != std::begin(m_halfEdgeMap));
-        return std::prev(it)->second;
+        return copy;
     }
     
     void swapContents() {
@@ -587,6 +656,54 @@ const vm::bbox<T,3>& Polyhedron<T,FP,VP>::bounds() const {
     return m_bounds;
 }
 
+template <typename T, typename FP, typename VP>
+T Polyhedron<T,FP,VP>::volume() const {
+    if (!polyhedron()) {
+        return static_cast<T>(0.0);
+    }
+
+    // Sum up the signed volumes of the tetrahedra spanned by the bounds center and a fan triangulation of every
+    // face. Using the center instead of the origin keeps the products small for polyhedra far from the origin.
+    const V center = bounds().center();
+    T result = static_cast<T>(0.0);
+
+    const Face* firstFace = m_faces.front();
+    const Face* currentFace = firstFace;
+    do {
+        const HalfEdge* firstEdge = currentFace->boundary().front();
+        const V p0 = firstEdge->origin()->position() - center;
+        const HalfEdge* currentEdge = firstEdge->next();
+        while (currentEdge->next() != firstEdge) {
+            const V p1 = currentEdge->origin()->position() - center;
+            const V p2 = currentEdge->next()->origin()->position() - center;
+            result += dot(p0, cross(p1, p2));
+            currentEdge = currentEdge->next();
+        }
+        currentFace = currentFace->next();
+    } while (currentFace != firstFace);
+
+    return vm::abs(result) / static_cast<T>(6.0);
+}
+
+template <typename T, typename FP, typename VP>
+size_t Polyhedron<T,FP,VP>::memoryUsage() const {
+    size_t halfEdgeCount = 0;
+    if (!m_edges.empty()) {
+        const Edge* firstEdge = m_edges.front();
+        const Edge* currentEdge = firstEdge;
+        do {
+            halfEdgeCount += currentEdge->fullySpecified() ? 2u : 1u;
+            currentEdge = currentEdge->next();
+        } while (currentEdge != firstEdge);
+    }
+
+    return sizeof(Polyhedron) +
+        vertexCount() * Vertex::arenaBlockSize() +
+        edgeCount() * Edge::arenaBlockSize() +
+        halfEdgeCount * HalfEdge::arenaBlockSize() +
+        faceCount() * Face::arenaBlockSize();
+}
+
 template <typename T, typename FP, typename VP>
 bool Polyhedron<T,FP,VP>::empty() const {
     return vertexCount() == 0;
@@ -619,6 +736,12 @@ bool Polyhedron<T,FP,VP>::closed() const {
 
 template <typename T, typename FP, typename VP>
 void Polyhedron<T,FP,VP>::clear() {
+    // The half edges of an edge polyhedron do not belong to a face boundary, so they must be deleted here.
+    if (edge()) {
+        Edge* edge = m_edges.front();
+        delete edge->firstEdge();
+        delete edge->secondEdge();
+    }
     m_faces.clear();
     m_edges.clear();
     m_vertices.clear();
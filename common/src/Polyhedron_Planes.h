@@ -0,0 +1,389 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TrenchBroom_Polyhedron_Planes_h
+#define TrenchBroom_Polyhedron_Planes_h
+
+#include <vecmath/plane.h>
+#include <vecmath/vec.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+template <typename T, typename FP, typename VP>
+bool Polyhedron<T,FP,VP>::setPlanes(const std::vector<vm::plane<T,3>>& planes, std::vector<Face*>& faces) {
+    std::vector<V> positions;
+    FaceVertices faceVertices;
+    if (!findCuboidFaces(planes, positions, faceVertices) &&
+        !findPlaneFaces(planes, positions, faceVertices)) {
+        return false;
+    }
+    return setFaces(positions, faceVertices, faces);
+}
+
+/**
+ * Handles six planes whose normals are the six axis directions. The vertex positions are read off the plane
+ * distances, and the face vertices are the same as those of the polyhedron created by setBounds.
+ */
+template <typename T, typename FP, typename VP>
+bool Polyhedron<T,FP,VP>::findCuboidFaces(const std::vector<vm::plane<T,3>>& planes, std::vector<V>& positions, FaceVertices& faceVertices) {
+    if (planes.size() != 6) {
+        return false;
+    }
+
+    // for every plane, the index of the face it creates in the face order of setBounds
+    size_t faceIndices[6];
+    bool found[6] = { false, false, false, false, false, false };
+    V min, max;
+
+    for (size_t i = 0; i < 6; ++i) {
+        const auto& plane = planes[i];
+        const auto& normal = plane.normal;
+
+        size_t axis = 3;
+        for (size_t j = 0; j < 3; ++j) {
+            if (normal[j] == static_cast<T>(1.0) || normal[j] == static_cast<T>(-1.0)) {
+                axis = j;
+            } else if (normal[j] != static_cast<T>(0.0)) {
+                return false;
+            }
+        }
+        if (axis == 3) {
+            return false;
+        }
+
+        // front (-y), left (-x), bottom (-z), top (+z), back (+y), right (+x)
+        static const size_t MinFaces[3] = { 1, 0, 2 };
+        static const size_t MaxFaces[3] = { 5, 4, 3 };
+
+        const auto positive = normal[axis] > static_cast<T>(0.0);
+        const auto faceIndex = positive ? MaxFaces[axis] : MinFaces[axis];
+        if (found[faceIndex]) {
+            return false;
+        }
+        found[faceIndex] = true;
+        faceIndices[i] = faceIndex;
+
+        if (positive) {
+            max[axis] = plane.distance;
+        } else {
+            min[axis] = -plane.distance;
+        }
+    }
+
+    for (size_t i = 0; i < 3; ++i) {
+        if (min[i] >= max[i]) {
+            return false;
+        }
+    }
+
+    positions = {
+        V(min.x(), min.y(), min.z()),
+        V(min.x(), min.y(), max.z()),
+        V(min.x(), max.y(), min.z()),
+        V(min.x(), max.y(), max.z()),
+        V(max.x(), min.y(), min.z()),
+        V(max.x(), min.y(), max.z()),
+        V(max.x(), max.y(), min.z()),
+        V(max.x(), max.y(), max.z())
+    };
+
+    static const std::vector<size_t> CuboidFaces[6] = {
+        { 0, 4, 5, 1 }, // front
+        { 0, 1, 3, 2 }, // left
+        { 0, 2, 6, 4 }, // bottom
+        { 1, 5, 7, 3 }, // top
+        { 2, 3, 7, 6 }, // back
+        { 4, 6, 7, 5 }  // right
+    };
+
+    faceVertices.clear();
+    for (size_t i = 0; i < 6; ++i) {
+        faceVertices.push_back(CuboidFaces[faceIndices[i]]);
+    }
+    return true;
+}
+
+/**
+ * Enumerates the vertices as the intersection points of plane triples that lie inside of all planes. Every vertex
+ * records the planes it lies on as a bit set, which is used both to skip triples whose intersection point is
+ * already known and to find the vertices of every face.
+ */
+template <typename T, typename FP, typename VP>
+bool Polyhedron<T,FP,VP>::findPlaneFaces(const std::vector<vm::plane<T,3>>& planes, std::vector<V>& positions, FaceVertices& faceVertices) {
+    using PlaneSet = uint64_t;
+
+    const auto planeCount = planes.size();
+    if (planeCount < 4 || planeCount > 64) {
+        return false;
+    }
+
+    const auto epsilon = vm::constants<T>::pointStatusEpsilon();
+
+    // triples that are closer to parallel than this are skipped because their intersection point is too imprecise;
+    // if the point is a vertex, the faces around it won't match up and we bail out below
+    static constexpr T MinDeterminant = static_cast<T>(1e-6);
+
+    struct Candidate {
+        V position;
+        PlaneSet planes;
+    };
+    std::vector<Candidate> candidates;
+
+    for (size_t i = 0; i < planeCount; ++i) {
+        for (size_t j = i + 1; j < planeCount; ++j) {
+            const auto ij = (PlaneSet(1) << i) | (PlaneSet(1) << j);
+            const auto& ni = planes[i].normal;
+            const auto& nj = planes[j].normal;
+            const auto nij = vm::cross(ni, nj);
+
+            for (size_t k = j + 1; k < planeCount; ++k) {
+                const auto ijk = ij | (PlaneSet(1) << k);
+                const auto known = std::any_of(std::begin(candidates), std::end(candidates), [&](const Candidate& c) {
+                    return (c.planes & ijk) == ijk;
+                });
+                if (known) {
+                    continue;
+                }
+
+                const auto& nk = planes[k].normal;
+                const auto njk = vm::cross(nj, nk);
+                const auto det = vm::dot(ni, njk);
+                if (std::abs(det) < MinDeterminant) {
+                    continue;
+                }
+
+                const auto position = (planes[i].distance * njk +
+                                       planes[j].distance * vm::cross(nk, ni) +
+                                       planes[k].distance * nij) / det;
+
+                auto onPlanes = PlaneSet(0);
+                auto inside = true;
+                for (size_t m = 0; m < planeCount && inside; ++m) {
+                    const auto distance = planes[m].pointDistance(position);
+                    if (distance > epsilon) {
+                        inside = false;
+                    } else if (distance >= -epsilon) {
+                        onPlanes |= PlaneSet(1) << m;
+                    }
+                }
+
+                if (inside && (onPlanes & ijk) == ijk) {
+                    candidates.push_back(Candidate{ position, onPlanes });
+                }
+            }
+        }
+    }
+
+    const auto countVertices = [&](const size_t planeIndex) {
+        const auto bit = PlaneSet(1) << planeIndex;
+        return static_cast<size_t>(std::count_if(std::begin(candidates), std::end(candidates), [&](const Candidate& c) {
+            return (c.planes & bit) != 0;
+        }));
+    };
+
+    const auto countPlanes = [](PlaneSet set) {
+        size_t count = 0;
+        for (; set != 0; set &= set - 1) {
+            ++count;
+        }
+        return count;
+    };
+
+    // A plane creates a face if it has at least three vertices and if it doesn't coincide with a previous face.
+    // Points where fewer than three faces meet lie on an edge or inside of a face and are dropped, which may leave
+    // other planes with fewer than three vertices, so we repeat until nothing changes.
+    auto facePlanes = PlaneSet(0);
+    for (;;) {
+        facePlanes = PlaneSet(0);
+        for (size_t i = 0; i < planeCount; ++i) {
+            if (countVertices(i) < 3) {
+                continue;
+            }
+
+            const auto bit = PlaneSet(1) << i;
+            auto coincident = false;
+            for (size_t j = 0; j < i && !coincident; ++j) {
+                const auto other = PlaneSet(1) << j;
+                if ((facePlanes & other) != 0 && vm::dot(planes[i].normal, planes[j].normal) > static_cast<T>(0.0)) {
+                    coincident = std::all_of(std::begin(candidates), std::end(candidates), [&](const Candidate& c) {
+                        return (c.planes & bit) == 0 || (c.planes & other) != 0;
+                    });
+                }
+            }
+
+            if (!coincident) {
+                facePlanes |= bit;
+            }
+        }
+
+        const auto oldSize = candidates.size();
+        candidates.erase(std::remove_if(std::begin(candidates), std::end(candidates), [&](const Candidate& c) {
+            return countPlanes(c.planes & facePlanes) < 3;
+        }), std::end(candidates));
+
+        if (candidates.size() == oldSize) {
+            break;
+        }
+    }
+
+    if (candidates.size() < 4) {
+        return false;
+    }
+
+    positions.clear();
+    positions.reserve(candidates.size());
+    for (const auto& candidate : candidates) {
+        positions.push_back(candidate.position);
+    }
+
+    // sort the vertices of every face counter clockwise when viewed from above
+    faceVertices.assign(planeCount, std::vector<size_t>());
+    std::vector<std::tuple<T, size_t>> angles;
+    for (size_t i = 0; i < planeCount; ++i) {
+        const auto bit = PlaneSet(1) << i;
+        if ((facePlanes & bit) == 0) {
+            continue;
+        }
+
+        auto center = V::zero;
+        auto count = size_t(0);
+        for (const auto& candidate : candidates) {
+            if ((candidate.planes & bit) != 0) {
+                center = center + candidate.position;
+                ++count;
+            }
+        }
+        if (count < 3) {
+            return false;
+        }
+        center = center / static_cast<T>(count);
+
+        const auto& normal = planes[i].normal;
+        V u, v;
+        angles.clear();
+        for (size_t j = 0; j < candidates.size(); ++j) {
+            if ((candidates[j].planes & bit) != 0) {
+                const auto offset = candidates[j].position - center;
+                if (angles.empty()) {
+                    u = vm::normalize(offset);
+                    v = vm::cross(normal, u);
+                }
+                angles.emplace_back(std::atan2(vm::dot(offset, v), vm::dot(offset, u)), j);
+            }
+        }
+
+        std::sort(std::begin(angles), std::end(angles));
+        for (const auto& [angle, index] : angles) {
+            faceVertices[i].push_back(index);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Creates the vertices and faces and pairs up the half edges to create the edges. Returns false if the half edges
+ * do not pair up or if the result does not have the Euler characteristic of a convex polyhedron.
+ */
+template <typename T, typename FP, typename VP>
+bool Polyhedron<T,FP,VP>::setFaces(const std::vector<V>& positions, const FaceVertices& faceVertices, std::vector<Face*>& faces) {
+    Polyhedron result;
+
+    std::vector<Vertex*> vertices;
+    vertices.reserve(positions.size());
+    for (const auto& position : positions) {
+        auto* vertex = new Vertex(position);
+        result.m_vertices.append(vertex, 1);
+        vertices.push_back(vertex);
+    }
+
+    // the vertex indices of every half edge, with the smaller one first, and whether they were swapped
+    struct HalfEdgeInfo {
+        size_t first;
+        size_t second;
+        bool reversed;
+        HalfEdge* halfEdge;
+
+        bool operator<(const HalfEdgeInfo& other) const {
+            return std::tie(first, second, reversed) < std::tie(other.first, other.second, other.reversed);
+        }
+    };
+    std::vector<HalfEdgeInfo> halfEdges;
+
+    std::vector<Face*> resultFaces(faceVertices.size(), nullptr);
+    for (size_t i = 0; i < faceVertices.size(); ++i) {
+        const auto& indices = faceVertices[i];
+        if (indices.empty()) {
+            continue;
+        }
+
+        HalfEdgeList boundary;
+        for (size_t j = 0; j < indices.size(); ++j) {
+            const auto origin = indices[j];
+            const auto destination = indices[(j + 1) % indices.size()];
+            auto* halfEdge = new HalfEdge(vertices[origin]);
+            boundary.append(halfEdge, 1);
+            halfEdges.push_back(HalfEdgeInfo{
+                std::min(origin, destination),
+                std::max(origin, destination),
+                origin > destination,
+                halfEdge
+            });
+        }
+
+        auto* face = new Face(boundary);
+        result.m_faces.append(face, 1);
+        resultFaces[i] = face;
+    }
+
+    std::sort(std::begin(halfEdges), std::end(halfEdges));
+    if (halfEdges.size() % 2 != 0) {
+        return false;
+    }
+
+    for (size_t i = 0; i < halfEdges.size(); i += 2) {
+        const auto& first = halfEdges[i];
+        const auto& second = halfEdges[i + 1];
+        if (first.first != second.first || first.second != second.second ||
+            first.reversed || !second.reversed ||
+            (i + 2 < halfEdges.size() && halfEdges[i + 2].first == first.first && halfEdges[i + 2].second == first.second)) {
+            return false;
+        }
+        result.m_edges.append(new Edge(first.halfEdge, second.halfEdge), 1);
+    }
+
+    if (result.vertexCount() + result.faceCount() != result.edgeCount() + 2) {
+        return false;
+    }
+
+    result.updateBounds();
+    assert(result.checkInvariant());
+
+    using std::swap;
+    swap(*this, result);
+    faces = std::move(resultFaces);
+    return true;
+}
+
+#endif
@@ -120,6 +120,9 @@ namespace TrenchBroom {
 
         Preference<int> TextureMinFilter(IO::Path("Renderer/Texture mode min filter"), 0x2700);
         Preference<int> TextureMagFilter(IO::Path("Renderer/Texture mode mag filter"), 0x2600);
+        Preference<int> TextureMemoryBudget(IO::Path("Renderer/Texture memory budget"), 512);
+
+        Preference<int> UndoMemoryBudget(IO::Path("Editor/Undo memory budget"), 512);
 
         Preference<bool> TextureLock(IO::Path("Editor/Texture lock"), true);
         Preference<bool> UVLock(IO::Path("Editor/UV lock"), false);
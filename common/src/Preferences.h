@@ -117,6 +117,11 @@ namespace TrenchBroom {
         
         extern Preference<int> TextureMinFilter;
         extern Preference<int> TextureMagFilter;
+        // in MiB
+        extern Preference<int> TextureMemoryBudget;
+        
+        // in MiB, 0 means unlimited; the oldest undo steps are discarded when the undo history exceeds it
+        extern Preference<int> UndoMemoryBudget;
         
         extern Preference<bool> TextureLock;
         extern Preference<bool> UVLock;
@@ -0,0 +1,299 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+namespace TrenchBroom {
+    namespace Profiler {
+        static constexpr size_t ZonesPerThread = 32768;
+
+        struct Zone {
+            const char* name;
+            Clock::time_point start;
+            Clock::time_point end;
+        };
+
+        /**
+         * Holds the most recent zones of one thread. Only the owning thread adds zones, the mutex is only contended
+         * while the zones are being read for export.
+         */
+        class ThreadBuffer {
+        private:
+            size_t m_id;
+            std::mutex m_mutex;
+            std::vector<Zone> m_zones;
+            size_t m_next;
+        public:
+            explicit ThreadBuffer(const size_t id) :
+            m_id(id),
+            m_next(0) {}
+
+            size_t id() const {
+                return m_id;
+            }
+
+            void add(const Zone& zone) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_zones.size() < ZonesPerThread) {
+                    m_zones.push_back(zone);
+                } else {
+                    m_zones[m_next % ZonesPerThread] = zone;
+                }
+                ++m_next;
+            }
+
+            /**
+             * Calls the given function for every zone, from the oldest to the newest.
+             */
+            template <typename F>
+            void forEach(F f) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                const auto first = m_zones.size() < ZonesPerThread ? size_t(0) : m_next % ZonesPerThread;
+                for (size_t i = 0; i < m_zones.size(); ++i) {
+                    f(m_zones[(first + i) % m_zones.size()]);
+                }
+            }
+
+            void clear() {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_zones.clear();
+                m_next = 0;
+            }
+        };
+
+        /**
+         * Owns the buffers of all threads. The buffer of a thread that has finished is handed to the next new
+         * thread, so that short lived worker threads don't accumulate buffers.
+         */
+        class Registry {
+        private:
+            std::mutex m_mutex;
+            std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+            std::vector<ThreadBuffer*> m_freeBuffers;
+            Clock::time_point m_epoch;
+            Clock::time_point m_frameStart;
+            Clock::time_point m_frameEnd;
+        public:
+            Registry() :
+            m_epoch(Clock::now()),
+            m_frameStart(m_epoch),
+            m_frameEnd(m_epoch) {}
+
+            ThreadBuffer* acquireBuffer() {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_freeBuffers.empty()) {
+                    auto* buffer = m_freeBuffers.back();
+                    m_freeBuffers.pop_back();
+                    return buffer;
+                }
+
+                m_buffers.push_back(std::make_unique<ThreadBuffer>(m_buffers.size()));
+                return m_buffers.back().get();
+            }
+
+            void releaseBuffer(ThreadBuffer* buffer) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_freeBuffers.push_back(buffer);
+            }
+
+            void endFrame() {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_frameStart = m_frameEnd;
+                m_frameEnd = Clock::now();
+            }
+
+            Clock::time_point epoch() const {
+                return m_epoch;
+            }
+
+            std::pair<Clock::time_point, Clock::time_point> lastFrame() {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return { m_frameStart, m_frameEnd };
+            }
+
+            /**
+             * Calls the given function for every buffer. Buffers are never destroyed, so they can be used after the
+             * registry's mutex was released.
+             */
+            template <typename F>
+            void forEachBuffer(F f) {
+                std::vector<ThreadBuffer*> buffers;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    for (const auto& buffer : m_buffers) {
+                        buffers.push_back(buffer.get());
+                    }
+                }
+                for (auto* buffer : buffers) {
+                    f(*buffer);
+                }
+            }
+
+            void clear() {
+                forEachBuffer([](ThreadBuffer& buffer) { buffer.clear(); });
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_frameStart = m_frameEnd = Clock::now();
+            }
+        };
+
+        static Registry& registry() {
+            static Registry instance;
+            return instance;
+        }
+
+        class ThreadBufferHolder {
+        private:
+            ThreadBuffer* m_buffer;
+        public:
+            ThreadBufferHolder() :
+            m_buffer(registry().acquireBuffer()) {}
+
+            ~ThreadBufferHolder() {
+                registry().releaseBuffer(m_buffer);
+            }
+
+            ThreadBuffer& buffer() {
+                return *m_buffer;
+            }
+        };
+
+        void recordZone(const char* name, const Clock::time_point start, const Clock::time_point end) {
+            thread_local ThreadBufferHolder holder;
+            holder.buffer().add(Zone{ name, start, end });
+        }
+
+        void endFrame() {
+            registry().endFrame();
+        }
+
+        static double toMs(const Clock::duration duration) {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        }
+
+        std::vector<ZoneStats> lastFrameStats() {
+            auto& reg = registry();
+            const auto [frameStart, frameEnd] = reg.lastFrame();
+
+            std::map<String, ZoneStats> statsByName;
+            reg.forEachBuffer([&, frameStart = frameStart, frameEnd = frameEnd](ThreadBuffer& buffer) {
+                buffer.forEach([&](const Zone& zone) {
+                    if (zone.start >= frameStart && zone.end <= frameEnd) {
+                        auto it = statsByName.find(zone.name);
+                        if (it == std::end(statsByName)) {
+                            it = statsByName.insert({ zone.name, ZoneStats{ zone.name, 0, 0.0, 0.0 } }).first;
+                        }
+
+                        auto& stats = it->second;
+                        const auto ms = toMs(zone.end - zone.start);
+                        ++stats.count;
+                        stats.totalMs += ms;
+                        stats.maxMs = std::max(stats.maxMs, ms);
+                    }
+                });
+            });
+
+            std::vector<ZoneStats> result;
+            result.reserve(statsByName.size());
+            for (auto& [name, stats] : statsByName) {
+                result.push_back(std::move(stats));
+            }
+            std::stable_sort(std::begin(result), std::end(result), [](const ZoneStats& lhs, const ZoneStats& rhs) {
+                return lhs.totalMs > rhs.totalMs;
+            });
+            return result;
+        }
+
+        String formatLastFrameStats() {
+            const auto [frameStart, frameEnd] = registry().lastFrame();
+
+            StringStream str;
+            str << "Frame time: " << std::fixed << std::setprecision(3) << toMs(frameEnd - frameStart) << "ms\n";
+            for (const auto& stats : lastFrameStats()) {
+                str << std::left << std::setw(40) << stats.name
+                    << std::right << std::setw(6) << stats.count << "x"
+                    << std::setw(12) << stats.totalMs << "ms total"
+                    << std::setw(12) << stats.maxMs << "ms max\n";
+            }
+            return str.str();
+        }
+
+        static void writeJsonString(std::ostream& str, const char* value) {
+            str << '"';
+            for (const char* c = value; *c != 0; ++c) {
+                switch (*c) {
+                    case '"':
+                        str << "\\\"";
+                        break;
+                    case '\\':
+                        str << "\\\\";
+                        break;
+                    default:
+                        if (static_cast<unsigned char>(*c) < 0x20) {
+                            str << ' ';
+                        } else {
+                            str << *c;
+                        }
+                        break;
+                }
+            }
+            str << '"';
+        }
+
+        void writeChromeTrace(std::ostream& str) {
+            auto& reg = registry();
+            const auto epoch = reg.epoch();
+            const auto toUs = [&](const Clock::time_point time) {
+                return std::chrono::duration<double, std::micro>(time - epoch).count();
+            };
+
+            str << "{\"traceEvents\":[";
+            bool first = true;
+            reg.forEachBuffer([&](ThreadBuffer& buffer) {
+                buffer.forEach([&](const Zone& zone) {
+                    if (!first) {
+                        str << ",";
+                    }
+                    first = false;
+
+                    str << "\n{\"name\":";
+                    writeJsonString(str, zone.name);
+                    str << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer.id()
+                        << std::fixed << std::setprecision(3)
+                        << ",\"ts\":" << toUs(zone.start)
+                        << ",\"dur\":" << toUs(zone.end) - toUs(zone.start) << "}";
+                });
+            });
+            str << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        }
+
+        void clear() {
+            registry().clear();
+        }
+    }
+}
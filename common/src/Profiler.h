@@ -0,0 +1,133 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TrenchBroom_Profiler_h
+#define TrenchBroom_Profiler_h
+
+#include "StringUtils.h"
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+namespace TrenchBroom {
+    /**
+     * A lightweight instrumentation layer for finding out where the time of a frame or a command goes.
+     *
+     * Code is instrumented with the TB_PROFILE_SCOPE macro, which records the time spent in the enclosing scope
+     * as a zone. Every thread records its zones into its own ring buffer, so recording does not contend with other
+     * threads. The ring buffers keep the most recent zones, older zones are overwritten.
+     *
+     * The macros expand to nothing unless TrenchBroom is built with TB_ENABLE_PROFILER, so instrumentation has no
+     * overhead in regular builds.
+     */
+    namespace Profiler {
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * Indicates whether the instrumentation was compiled in.
+         */
+        constexpr bool enabled() {
+#ifdef TB_ENABLE_PROFILER
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        /**
+         * The aggregated times of all zones with the same name.
+         */
+        struct ZoneStats {
+            String name;
+            size_t count;
+            double totalMs;
+            double maxMs;
+        };
+
+        /**
+         * Records a zone for the calling thread. The name must outlive the profiler, i.e., it should be a string
+         * literal.
+         */
+        void recordZone(const char* name, Clock::time_point start, Clock::time_point end);
+
+        /**
+         * Marks the end of the current frame. The zones that were recorded between the previous call and this call
+         * make up the last frame.
+         */
+        void endFrame();
+
+        /**
+         * Returns the aggregated zones of the last frame, sorted by decreasing total time. A zone belongs to the
+         * frame if it was recorded on any thread and lies entirely within the frame.
+         */
+        std::vector<ZoneStats> lastFrameStats();
+
+        /**
+         * Returns a table with one line per zone of the last frame.
+         */
+        String formatLastFrameStats();
+
+        /**
+         * Writes all recorded zones in the Chrome trace event format, which can be loaded in chrome://tracing and
+         * compatible trace viewers.
+         */
+        void writeChromeTrace(std::ostream& str);
+
+        /**
+         * Discards all recorded zones and frames.
+         */
+        void clear();
+
+        /**
+         * Records the time from its construction to its destruction as a zone.
+         */
+        class ScopedZone {
+        private:
+            const char* m_name;
+            Clock::time_point m_start;
+        public:
+            explicit ScopedZone(const char* name) :
+            m_name(name),
+            m_start(Clock::now()) {}
+
+            ~ScopedZone() {
+                recordZone(m_name, m_start, Clock::now());
+            }
+
+            ScopedZone(const ScopedZone& other) = delete;
+            ScopedZone& operator=(const ScopedZone& other) = delete;
+        };
+    }
+}
+
+#define TB_PROFILE_CONCAT_(a, b) a##b
+#define TB_PROFILE_CONCAT(a, b) TB_PROFILE_CONCAT_(a, b)
+
+#ifdef TB_ENABLE_PROFILER
+#define TB_PROFILE_SCOPE(name) const TrenchBroom::Profiler::ScopedZone TB_PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define TB_PROFILE_FRAME() TrenchBroom::Profiler::endFrame()
+#else
+#define TB_PROFILE_SCOPE(name) do {} while (false)
+#define TB_PROFILE_FRAME() do {} while (false)
+#endif
+
+#endif /* TrenchBroom_Profiler_h */
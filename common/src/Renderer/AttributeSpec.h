@@ -90,7 +90,8 @@ namespace TrenchBroom {
             static const size_t Size = sizeof(DataType) * S;
             
             static void setup(const size_t index, const size_t stride, const size_t offset) {
-                assert(S == 3);
+                // a fourth component is only padding, GL always reads three components
+                assert(S == 3 || S == 4);
                 glAssert(glEnableClientState(GL_NORMAL_ARRAY));
                 glAssert(glNormalPointer(D, static_cast<GLsizei>(stride), reinterpret_cast<GLvoid*>(offset)));
             }
@@ -200,6 +201,8 @@ namespace TrenchBroom {
             typedef AttributeSpec<AttributeType_Position, GL_FLOAT, 2> P2;
             typedef AttributeSpec<AttributeType_Position, GL_FLOAT, 3> P3;
             typedef AttributeSpec<AttributeType_Normal, GL_FLOAT, 3> N;
+            // normal packed into signed normalized bytes, padded to four bytes
+            typedef AttributeSpec<AttributeType_Normal, GL_BYTE, 4> Nb;
             typedef AttributeSpec<AttributeType_TexCoord0, GL_FLOAT, 2> T02;
             typedef AttributeSpec<AttributeType_TexCoord1, GL_FLOAT, 2> T12;
             typedef AttributeSpec<AttributeType_Color, GL_FLOAT, 4> C4;
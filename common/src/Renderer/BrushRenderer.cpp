@@ -21,6 +21,7 @@
 
 #include "Preferences.h"
 #include "PreferenceManager.h"
+#include "Profiler.h"
 #include "Model/Brush.h"
 #include "Model/BrushFace.h"
 #include "Model/BrushGeometry.h"
@@ -114,10 +115,37 @@ namespace TrenchBroom {
                                    EdgeRenderPolicy::RenderAll);
         }
 
+        // BrushInfo
+
+        BrushRenderer::BrushInfo::BrushInfo() :
+        vertexHolderKey(nullptr),
+        edgeIndicesKey(nullptr) {}
+
+        bool BrushRenderer::BrushInfo::inVbo() const {
+            return vertexHolderKey != nullptr;
+        }
+
+        void BrushRenderer::BrushInfo::clear() {
+            vertexHolderKey = nullptr;
+            edgeIndicesKey = nullptr;
+            opaqueFaceIndicesKeys.clear();
+            transparentFaceIndicesKeys.clear();
+        }
+
+        // BrushSlot
+
+        BrushRenderer::BrushSlot::BrushSlot() :
+        brush(nullptr),
+        generation(0),
+        epoch(0),
+        invalid(false) {}
+
         // BrushRenderer
 
         BrushRenderer::BrushRenderer(const bool transparent) :
         m_filter(new NoFilter(transparent)),
+        m_invalidCount(0),
+        m_epoch(0),
         m_showEdges(false),
         m_grayscale(false),
         m_tint(false),
@@ -139,36 +167,36 @@ namespace TrenchBroom {
         }
 
         void BrushRenderer::setBrushes(const Model::BrushList& brushes) {
-            // start with adding nothing, and removing everything
-            std::set<const Model::Brush*> toAdd;
-            std::set<const Model::Brush*> toRemove = m_allBrushes;
-
-            // update toAdd and toRemove using the input list
+            // mark every brush in the input list, adding the ones that are new
+            ++m_epoch;
             for (const auto* brush : brushes) {
-                if (auto it = toRemove.find(brush); it != toRemove.end()) {
-                    toRemove.erase(it);
-                } else {
-                    toAdd.insert(brush);
-                }
+                m_slots[addBrush(brush)].epoch = m_epoch;
             }
 
-            for (auto brush : toRemove) {
-                removeBrush(brush);
+            // remove the brushes that were not marked
+            for (size_t i = 0; i < m_slots.size(); ++i) {
+                const auto& slot = m_slots[i];
+                if (slot.brush != nullptr && slot.epoch != m_epoch) {
+                    removeBrush(i);
+                }
             }
-            for (auto brush : toAdd) {
-                addBrush(brush);
+        }
+
+        void BrushRenderer::removeBrushes(const Model::BrushList& brushes) {
+            for (const auto* brush : brushes) {
+                if (auto it = m_slotIndices.find(brush); it != m_slotIndices.end()) {
+                    removeBrush(it->second);
+                }
             }
         }
 
         void BrushRenderer::invalidate() {
-            for (auto& brush : m_allBrushes) {
-                // this will also invalidate already invalid brushes, which
-                // is unnecessary
-                removeBrushFromVbo(brush);
+            for (size_t i = 0; i < m_slots.size(); ++i) {
+                if (m_slots[i].brush != nullptr) {
+                    invalidateSlot(i);
+                }
             }
-            m_invalidBrushes = m_allBrushes;
 
-            assert(m_brushInfo.empty());
             assert(m_transparentFaces->empty());
             assert(m_opaqueFaces->empty());
         }
@@ -176,27 +204,23 @@ namespace TrenchBroom {
         void BrushRenderer::invalidateBrushes(const Model::BrushList& brushes) {
             for (auto& brush : brushes) {
                 // skip brushes that are not in the renderer
-                if (m_allBrushes.find(brush) == m_allBrushes.end()) {
-                    assert(m_brushInfo.find(brush) == m_brushInfo.end());
-                    assert(m_invalidBrushes.find(brush) == m_invalidBrushes.end());
-                    continue;
-                }
-                // if it's not in the invalid set, put it in
-                if (auto it = m_invalidBrushes.find(brush); it == m_invalidBrushes.end()) {
-                    removeBrushFromVbo(brush);
-                    m_invalidBrushes.insert(brush);
+                if (auto it = m_slotIndices.find(brush); it != m_slotIndices.end()) {
+                    invalidateSlot(it->second);
                 }
             }
         }
 
         bool BrushRenderer::valid() const {
-            return m_invalidBrushes.empty();
+            return m_invalidCount == 0;
         }
         
         void BrushRenderer::clear() {
-            m_brushInfo.clear();
-            m_allBrushes.clear();
-            m_invalidBrushes.clear();
+            m_slots.clear();
+            m_freeSlots.clear();
+            m_slotIndices.clear();
+            m_invalidSlots.clear();
+            m_invalidCount = 0;
+            m_epoch = 0;
 
             m_vertexArray = std::make_shared<BrushVertexArray>();
             m_edgeIndices = std::make_shared<BrushIndexArray>();
@@ -257,7 +281,7 @@ namespace TrenchBroom {
         }
         
         void BrushRenderer::renderOpaque(RenderContext& renderContext, RenderBatch& renderBatch) {
-            if (!m_allBrushes.empty()) {
+            if (!m_slotIndices.empty()) {
                 if (!valid()) {
                     validate();
                 }
@@ -271,7 +295,7 @@ namespace TrenchBroom {
         }
         
         void BrushRenderer::renderTransparent(RenderContext& renderContext, RenderBatch& renderBatch) {
-            if (!m_allBrushes.empty()) {
+            if (!m_slotIndices.empty()) {
                 if (!valid()) {
                     validate();
                 }
@@ -328,12 +352,18 @@ namespace TrenchBroom {
         };
 
         void BrushRenderer::validate() {
+            TB_PROFILE_SCOPE("BrushRenderer::validate");
             assert(!valid());
 
-            for (auto brush : m_invalidBrushes) {
-                validateBrush(brush);
+            for (const auto& handle : m_invalidSlots) {
+                auto& slot = m_slots[handle.index];
+                // skip slots whose brush was removed after it was invalidated
+                if (slot.generation == handle.generation && slot.invalid) {
+                    validateBrush(slot);
+                }
             }
-            m_invalidBrushes.clear();
+            m_invalidSlots.clear();
+            m_invalidCount = 0;
             assert(valid());
 
             m_opaqueFaceRenderer = FaceRenderer(m_vertexArray, m_opaqueFaces, m_faceColor);
@@ -341,6 +371,10 @@ namespace TrenchBroom {
             m_edgeRenderer = IndexedEdgeRenderer(m_vertexArray, m_edgeIndices);
         }
 
+        size_t BrushRenderer::slotCount() const {
+            return m_slots.size();
+        }
+
         static size_t triIndicesCountForPolygon(const size_t vertexCount) {
             assert(vertexCount >= 3);
             const size_t indexCount = 3 * (vertexCount - 2);
@@ -408,10 +442,13 @@ namespace TrenchBroom {
             }
         }
 
-        void BrushRenderer::validateBrush(const Model::Brush* brush) {
-            assert(m_allBrushes.find(brush) != m_allBrushes.end());
-            assert(m_invalidBrushes.find(brush) != m_invalidBrushes.end());
-            assert(m_brushInfo.find(brush) == m_brushInfo.end());
+        void BrushRenderer::validateBrush(BrushSlot& slot) {
+            assert(slot.brush != nullptr);
+            assert(slot.invalid);
+            assert(!slot.info.inVbo());
+
+            const Model::Brush* brush = slot.brush;
+            slot.invalid = false;
 
             const FilterWrapper wrapper(*m_filter, m_showHiddenBrushes);
 
@@ -421,11 +458,11 @@ namespace TrenchBroom {
 
             if (facePolicy == Filter::FaceRenderPolicy::RenderNone &&
                 edgePolicy == Filter::EdgeRenderPolicy::RenderNone) {
-                // NOTE: this skips inserting the brush into m_brushInfo
+                // NOTE: this skips inserting the brush into the VBO
                 return;
             }
 
-            BrushInfo& info = m_brushInfo[brush];
+            BrushInfo& info = slot.info;
 
             // collect vertices
             auto& brushCache = brush->brushRendererBrushCache();
@@ -522,48 +559,71 @@ namespace TrenchBroom {
             }
         }
 
-        void BrushRenderer::addBrush(const Model::Brush* brush) {
+        size_t BrushRenderer::addBrush(const Model::Brush* brush) {
             // i.e. insert the brush as "invalid" if it's not already present.
             // if it is present, its validity is unchanged.
-            if (m_allBrushes.find(brush) == m_allBrushes.end()) {
-                assert(m_brushInfo.find(brush) == m_brushInfo.end());
+            if (auto it = m_slotIndices.find(brush); it != m_slotIndices.end()) {
+                return it->second;
+            }
 
-                [[maybe_unused]] auto result = m_allBrushes.insert(brush);
-                [[maybe_unused]] auto result2 = m_invalidBrushes.insert(brush);
+            size_t index;
+            if (!m_freeSlots.empty()) {
+                index = m_freeSlots.back();
+                m_freeSlots.pop_back();
+            } else {
+                index = m_slots.size();
+                m_slots.emplace_back();
             }
+            m_slotIndices.insert({ brush, index });
+
+            auto& slot = m_slots[index];
+            assert(slot.brush == nullptr);
+            assert(!slot.info.inVbo());
+            slot.brush = brush;
+            slot.invalid = false;
+            invalidateSlot(index);
+
+            return index;
         }
 
-        void BrushRenderer::removeBrush(const Model::Brush* brush) {
-            // update m_brushValid
-            {
-                auto it = m_allBrushes.find(brush);
-                assert(it != m_allBrushes.end());
-                m_allBrushes.erase(it);
-            }
+        void BrushRenderer::removeBrush(const size_t index) {
+            auto& slot = m_slots[index];
+            assert(slot.brush != nullptr);
 
-            {
-                auto it = m_invalidBrushes.find(brush);
-                if (it != m_invalidBrushes.end()) {
-                    m_invalidBrushes.erase(it);
-                    // invalid brushes are not in the VBO, so we can return  now.
-                    assert(m_brushInfo.find(brush) == m_brushInfo.end());
-                    return;
-                }
+            m_slotIndices.erase(slot.brush);
+
+            if (slot.invalid) {
+                // invalid brushes are not in the VBO. the slot's handle in m_invalidSlots becomes stale below.
+                assert(!slot.info.inVbo());
+                --m_invalidCount;
+            } else {
+                removeBrushFromVbo(slot);
             }
 
-            removeBrushFromVbo(brush);
+            slot.brush = nullptr;
+            slot.invalid = false;
+            ++slot.generation;
+            m_freeSlots.push_back(index);
         }
 
-        void BrushRenderer::removeBrushFromVbo(const Model::Brush* brush) {
-            auto it = m_brushInfo.find(brush);
+        void BrushRenderer::invalidateSlot(const size_t index) {
+            auto& slot = m_slots[index];
+            if (!slot.invalid) {
+                removeBrushFromVbo(slot);
+                slot.invalid = true;
+                m_invalidSlots.push_back({ index, slot.generation });
+                ++m_invalidCount;
+            }
+        }
 
-            if (it == m_brushInfo.end()) {
+        void BrushRenderer::removeBrushFromVbo(BrushSlot& slot) {
+            if (!slot.info.inVbo()) {
                 // This means BrushRenderer::validateBrush skipped rendering the brush, so it was never
                 // uploaded to the VBO's
                 return;
             }
 
-            const BrushInfo& info = it->second;
+            BrushInfo& info = slot.info;
 
             // update Vbo's
             m_vertexArray->deleteVerticesWithKey(info.vertexHolderKey);
@@ -590,7 +650,7 @@ namespace TrenchBroom {
                 }
             }
 
-            m_brushInfo.erase(it);
+            info.clear();
         }
     }
 }
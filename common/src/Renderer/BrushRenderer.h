@@ -30,6 +30,7 @@
 #include <tuple>
 #include <map>
 #include <unordered_map>
+#include <vector>
 
 namespace TrenchBroom {
     namespace Model {
@@ -133,19 +134,58 @@ namespace TrenchBroom {
                 AllocationTracker::Block* edgeIndicesKey;
                 std::vector<std::pair<const Assets::Texture*, AllocationTracker::Block*>> opaqueFaceIndicesKeys;
                 std::vector<std::pair<const Assets::Texture*, AllocationTracker::Block*>> transparentFaceIndicesKeys;
+
+                BrushInfo();
+                /**
+                 * Indicates whether the brush is stored in the VBO.
+                 */
+                bool inVbo() const;
+                void clear();
+            };
+
+            /**
+             * Stores a brush that was added to this renderer, with the information necessary to remove it from the VBO
+             * later. Slots are reused when brushes are removed, so their BrushInfo keeps its allocated memory.
+             */
+            struct BrushSlot {
+                const Model::Brush* brush;
+                /**
+                 * Incremented whenever the brush is removed from the slot, which makes all handles to the slot stale.
+                 */
+                size_t generation;
+                /**
+                 * The value of m_epoch when setBrushes last encountered the brush.
+                 */
+                size_t epoch;
+                /**
+                 * If a brush is in the VBO, it's always valid.
+                 * If a brush is valid, it might not be in the VBO if it was hidden by the Filter.
+                 */
+                bool invalid;
+                BrushInfo info;
+
+                BrushSlot();
             };
+
             /**
-             * Tracks all brushes that are stored in the VBO, with the information necessary to remove them
-             * from the VBO later.
+             * Refers to a slot as long as the slot's generation is unchanged.
              */
-            std::unordered_map<const Model::Brush*, BrushInfo> m_brushInfo;
+            struct BrushHandle {
+                size_t index;
+                size_t generation;
+            };
+
+            std::vector<BrushSlot> m_slots;
+            std::vector<size_t> m_freeSlots;
+            std::unordered_map<const Model::Brush*, size_t> m_slotIndices;
 
             /**
-             * If a brush is in the VBO, it's always valid.
-             * If a brush is valid, it might not be in the VBO if it was hidden by the Filter.
+             * The slots that were invalidated since the last call to validate. Brushes are not taken off this list when
+             * they are removed, instead their handles become stale and are skipped by validate.
              */
-            std::set<const Model::Brush*> m_allBrushes;
-            std::set<const Model::Brush*> m_invalidBrushes;
+            std::vector<BrushHandle> m_invalidSlots;
+            size_t m_invalidCount;
+            size_t m_epoch;
 
             BrushVertexArrayPtr m_vertexArray;
             BrushIndexArrayPtr m_edgeIndices;
@@ -171,6 +211,8 @@ namespace TrenchBroom {
             template <typename FilterT>
             explicit BrushRenderer(const FilterT& filter) :
             m_filter(new FilterT(filter)),
+            m_invalidCount(0),
+            m_epoch(0),
             m_showEdges(false),
             m_grayscale(false),
             m_tint(false),
@@ -189,9 +231,18 @@ namespace TrenchBroom {
              */
             void addBrushes(const Model::BrushList& brushes);
             /**
-             * New brushes are invalidated, brushes already in the BrushRenderer are not invalidated.
+             * New brushes are invalidated, brushes already in the BrushRenderer are not invalidated. Brushes that are
+             * not in the given list are removed.
+             *
+             * Takes time linear in the number of given brushes plus the number of slots, but only the added and
+             * invalidated brushes are validated afterwards.
              */
             void setBrushes(const Model::BrushList& brushes);
+            /**
+             * Brushes that are not in the BrushRenderer are ignored. Takes time linear in the number of given brushes;
+             * the slots of the removed brushes are reused by brushes that are added later.
+             */
+            void removeBrushes(const Model::BrushList& brushes);
             void clear();
 
             /**
@@ -201,8 +252,8 @@ namespace TrenchBroom {
              *
              * Until a brush is invalidated, we don't re-evaluate the Filter, and don't check the Brush object for modification.
              *
-             * Additionally, calling `invalidate()` guarantees the m_brushInfo, m_transparentFaces, and m_opaqueFaces
-             * maps will be empty, so the BrushRenderer will not have any lingering Texture* pointers.
+             * Additionally, calling `invalidate()` guarantees that no brush is in the VBO and that the m_transparentFaces
+             * and m_opaqueFaces maps will be empty, so the BrushRenderer will not have any lingering Texture* pointers.
              */
             void invalidate();
             void invalidateBrushes(const Model::BrushList& brushes);
@@ -232,17 +283,27 @@ namespace TrenchBroom {
              * Only exposed for benchmarking.
              */
             void validate();
+
+            /**
+             * Returns the number of slots, including the free ones. Only exposed for testing.
+             */
+            size_t slotCount() const;
         private:
-            void validateBrush(const Model::Brush* brush);
-            void addBrush(const Model::Brush* brush);
-            void removeBrush(const Model::Brush* brush);
+            void validateBrush(BrushSlot& slot);
+            /**
+             * Adds the given brush and returns the index of its slot. If the brush is already present, its validity
+             * is unchanged.
+             */
+            size_t addBrush(const Model::Brush* brush);
+            void removeBrush(size_t index);
+            void invalidateSlot(size_t index);
 
             /**
-             * If the given brush is not currently in the VBO, it's silently ignored.
+             * If the brush in the given slot is not currently in the VBO, it's silently ignored.
              * Otherwise, it's removed from the VBO (having its indices zeroed out, causing it to no longer draw).
-             * The brush's "valid" state is not touched inside here, but the m_brushInfo is updated.
+             * The brush's "valid" state is not touched inside here, but the slot's BrushInfo is cleared.
              */
-            void removeBrushFromVbo(const Model::Brush* brush);
+            void removeBrushFromVbo(BrushSlot& slot);
         private:
             BrushRenderer(const BrushRenderer& other);
             BrushRenderer& operator=(const BrushRenderer& other);
@@ -20,6 +20,7 @@
 #ifndef BrushRendererArray_h
 #define BrushRendererArray_h
 
+#include "Renderer/BrushRendererBrushCache.h"
 #include "Renderer/VertexSpec.h"
 #include "Renderer/Vbo.h"
 #include "Renderer/AllocationTracker.h"
@@ -294,7 +295,7 @@ namespace TrenchBroom {
          */
         class BrushVertexArray {
         private:
-            using Vertex = Renderer::VertexSpecs::P3NT2::Vertex;
+            using Vertex = BrushRendererBrushCache::Vertex;
 
             VertexHolder<Vertex> m_vertexHolder;
             AllocationTracker m_allocationTracker;
@@ -19,10 +19,15 @@
 
 #include "BrushRendererBrushCache.h"
 
+#include "MemoryUsage.h"
 #include "Model/Brush.h"
 #include "Model/BrushFace.h"
 #include "Model/BrushGeometry.h"
 
+#include <vecmath/scalar.h>
+
+#include <cmath>
+
 namespace TrenchBroom {
     namespace Renderer {
         BrushRendererBrushCache::CachedFace::CachedFace(Model::BrushFace* i_face,
@@ -44,6 +49,13 @@ namespace TrenchBroom {
         BrushRendererBrushCache::BrushRendererBrushCache()
                 : m_rendererCacheValid(false) {}
 
+        BrushRendererBrushCache::PackedNormal BrushRendererBrushCache::packNormal(const vm::vec3f& normal) {
+            const auto pack = [](const float f) {
+                return static_cast<GLbyte>(std::round(vm::clamp(f, -1.0f, 1.0f) * 127.0f));
+            };
+            return PackedNormal(pack(normal.x()), pack(normal.y()), pack(normal.z()), 0);
+        }
+
         void BrushRendererBrushCache::invalidateVertexCache() {
             m_rendererCacheValid = false;
             m_cachedVertices.clear();
@@ -66,6 +78,7 @@ namespace TrenchBroom {
 
             for (Model::BrushFace* face : brush->faces()) {
                 const auto indexOfFirstVertexRelativeToBrush = m_cachedVertices.size();
+                const auto normal = packNormal(vm::vec3f(face->boundary().normal));
 
                 const auto* first = face->geometry()->boundary().front();
                 const auto* current = first;
@@ -80,7 +93,7 @@ namespace TrenchBroom {
                     vertex->setPayload(static_cast<GLuint>(currentIndex));
 
                     const auto& position = vertex->position();
-                    m_cachedVertices.emplace_back(vm::vec3f(position), vm::vec3f(face->boundary().normal), face->textureCoords(position));
+                    m_cachedVertices.emplace_back(vm::vec3f(position), normal, face->textureCoords(position));
 
                     // The boundary is in CCW order, but the renderer expects CW order:
                     current = current->previous();
@@ -128,5 +141,9 @@ namespace TrenchBroom {
             assert(m_rendererCacheValid);
             return m_cachedEdges;
         }
+
+        size_t BrushRendererBrushCache::memoryUsage() const {
+            return heapMemoryUsage(m_cachedVertices) + heapMemoryUsage(m_cachedEdges) + heapMemoryUsage(m_cachedFacesSortedByTexture);
+        }
     }
 }
@@ -22,6 +22,8 @@
 
 #include "Renderer/VertexSpec.h"
 
+#include <vecmath/forward.h>
+
 #include <vector>
 
 namespace TrenchBroom {
@@ -37,8 +39,19 @@ namespace TrenchBroom {
     namespace Renderer {
         class BrushRendererBrushCache {
         public:
-            using VertexSpec = Renderer::VertexSpecs::P3NT2;
+            /**
+             * The normals are packed into bytes because they are constant per face, and they only need to be precise
+             * enough for shading. Positions and texture coordinates stay floats since large faces can span many
+             * texture repetitions.
+             *
+             * This shrinks a vertex from 32 to 24 bytes. The format is not configurable: every OpenGL version we
+             * support accepts byte normals, and the shading is indistinguishable, so there is no case in which the
+             * unpacked format would be preferable. The remaining 20 bytes are the float positions and texture
+             * coordinates, which is why the saving is 25%.
+             */
+            using VertexSpec = Renderer::VertexSpecs::P3NbT2;
             using Vertex = VertexSpec::Vertex;
+            using PackedNormal = VertexSpec::A2::ElementType;
 
             struct CachedFace {
                 const Assets::Texture* texture;
@@ -71,6 +84,11 @@ namespace TrenchBroom {
         public:
             BrushRendererBrushCache();
 
+            /**
+             * Packs the given unit vector into signed normalized bytes.
+             */
+            static PackedNormal packNormal(const vm::vec3f& normal);
+
             /**
              * Only exposed to be called by BrushFace
              */
@@ -91,6 +109,11 @@ namespace TrenchBroom {
             const std::vector<Vertex>& cachedVertices() const;
             const std::vector<CachedFace>& cachedFacesSortedByTexture() const;
             const std::vector<CachedEdge>& cachedEdges() const;
+
+            /**
+             * Returns the number of bytes allocated by the cached vertices, edges and faces.
+             */
+            size_t memoryUsage() const;
         };
     }
 }
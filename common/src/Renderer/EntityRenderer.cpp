@@ -72,6 +72,7 @@ namespace TrenchBroom {
         m_editorContext(editorContext),
         m_modelRenderer(m_entityModelManager, m_editorContext),
         m_boundsValid(false),
+        m_modelLoadGeneration(m_entityModelManager.loadGeneration()),
         m_showOverlays(true),
         m_showOccludedOverlays(false),
         m_tint(false),
@@ -157,6 +158,7 @@ namespace TrenchBroom {
 
         void EntityRenderer::render(RenderContext& renderContext, RenderBatch& renderBatch) {
             if (!m_entities.empty()) {
+                updateLoadedModels();
                 renderBounds(renderContext, renderBatch);
                 renderModels(renderContext, renderBatch);
                 renderClassnames(renderContext, renderBatch);
@@ -164,6 +166,18 @@ namespace TrenchBroom {
             }
         }
         
+        void EntityRenderer::updateLoadedModels() {
+            m_entityModelManager.collectLoadedModels();
+
+            // entities whose models were still loading are rendered as solid bounds and have no model renderer yet
+            const auto loadGeneration = m_entityModelManager.loadGeneration();
+            if (loadGeneration != m_modelLoadGeneration) {
+                m_modelLoadGeneration = loadGeneration;
+                reloadModels();
+                invalidateBounds();
+            }
+        }
+
         void EntityRenderer::renderBounds(RenderContext& renderContext, RenderBatch& renderBatch) {
             if (!m_boundsValid)
                 validateBounds();
@@ -62,6 +62,7 @@ namespace TrenchBroom {
             TriangleRenderer m_solidBoundsRenderer;
             EntityModelRenderer m_modelRenderer;
             bool m_boundsValid;
+            size_t m_modelLoadGeneration;
             
             bool m_showOverlays;
             Color m_overlayTextColor;
@@ -105,6 +106,7 @@ namespace TrenchBroom {
         public: // rendering
             void render(RenderContext& renderContext, RenderBatch& renderBatch);
         private:
+            void updateLoadedModels();
             void renderBounds(RenderContext& renderContext, RenderBatch& renderBatch);
             void renderPointEntityWireframeBounds(RenderBatch& renderBatch);
             void renderBrushEntityWireframeBounds(RenderBatch& renderBatch);
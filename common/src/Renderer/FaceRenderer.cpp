@@ -46,7 +46,8 @@ namespace TrenchBroom {
             void before(const Assets::Texture* texture) override {
                 if (texture != nullptr) {
                     texture->activate();
-                    shader.set("ApplyTexture", applyTexture);
+                    // textures are uploaded in batches, use the average color until the texture is uploaded
+                    shader.set("ApplyTexture", applyTexture && texture->isPrepared());
                     shader.set("Color", texture->averageColor());
                 } else {
                     shader.set("ApplyTexture", false);
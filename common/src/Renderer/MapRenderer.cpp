@@ -23,7 +23,9 @@
 #include "Macros.h"
 #include "PreferenceManager.h"
 #include "Preferences.h"
+#include "Profiler.h"
 #include "Assets/EntityDefinitionManager.h"
+#include "Model/AssortNodesVisitor.h"
 #include "Model/Brush.h"
 #include "Model/CollectMatchingNodesVisitor.h"
 #include "Model/EditorContext.h"
@@ -172,6 +174,7 @@ namespace TrenchBroom {
         }
         
         void MapRenderer::render(RenderContext& renderContext, RenderBatch& renderBatch) {
+            TB_PROFILE_SCOPE("MapRenderer::render");
             commitPendingChanges();
             setupGL(renderBatch);
             renderDefaultOpaque(renderContext, renderBatch);
@@ -187,6 +190,7 @@ namespace TrenchBroom {
         }
         
         void MapRenderer::commitPendingChanges() {
+            TB_PROFILE_SCOPE("MapRenderer::commitPendingChanges");
             View::MapDocumentSPtr document = lock(m_document);
             document->commitPendingAssets();
         }
@@ -437,6 +441,27 @@ namespace TrenchBroom {
             }
             invalidateEntityLinkRenderer();
         }
+
+        void MapRenderer::updateGroupsAndEntitiesInRenderers(const Renderer renderers) {
+            View::MapDocumentSPtr document = lock(m_document);
+            Model::World* world = document->world();
+
+            CollectRenderableNodes collect(renderers);
+            world->acceptAndRecurse(collect);
+
+            if ((renderers & Renderer_Default) != 0) {
+                m_defaultRenderer->setGroupsAndEntities(collect.defaultNodes().groups(),
+                                                        collect.defaultNodes().entities());
+            }
+            if ((renderers & Renderer_Selection) != 0) {
+                m_selectionRenderer->setGroupsAndEntities(collect.selectedNodes().groups(),
+                                                          collect.selectedNodes().entities());
+            }
+            if ((renderers& Renderer_Locked) != 0) {
+                m_lockedRenderer->setGroupsAndEntities(collect.lockedNodes().groups(),
+                                                       collect.lockedNodes().entities());
+            }
+        }
         
         void MapRenderer::invalidateRenderers(Renderer renderers) {
             if ((renderers & Renderer_Default) != 0)
@@ -459,6 +484,18 @@ namespace TrenchBroom {
             }
         }
 
+        void MapRenderer::removeBrushesFromRenderers(Renderer renderers, const Model::BrushList& brushes) {
+            if ((renderers & Renderer_Default) != 0) {
+                m_defaultRenderer->removeBrushes(brushes);
+            }
+            if ((renderers & Renderer_Selection) != 0) {
+                m_selectionRenderer->removeBrushes(brushes);
+            }
+            if ((renderers& Renderer_Locked) != 0) {
+                m_lockedRenderer->removeBrushes(brushes);
+            }
+        }
+
         void MapRenderer::invalidateEntityLinkRenderer() {
             m_entityLinkRenderer->invalidate();
         }
@@ -530,11 +567,32 @@ namespace TrenchBroom {
         }
         
         void MapRenderer::nodesWereAdded(const Model::NodeList& nodes) {
-            updateRenderers(Renderer_Default);
+            // only the added subtrees are visited, so adding brushes takes time linear in the number of added brushes
+            CollectRenderableNodes collect(Renderer_Default);
+            Model::Node::acceptAndRecurse(std::begin(nodes), std::end(nodes), collect);
+
+            const auto& added = collect.defaultNodes();
+            if (!added.groups().empty() || !added.entities().empty()) {
+                updateGroupsAndEntitiesInRenderers(Renderer_Default);
+            } else {
+                // the bounds of the groups and entities containing the added brushes have changed
+                m_defaultRenderer->invalidateGroupsAndEntities();
+            }
+            m_defaultRenderer->addBrushes(added.brushes());
+            invalidateEntityLinkRenderer();
         }
         
         void MapRenderer::nodesWereRemoved(const Model::NodeList& nodes) {
-            updateRenderers(Renderer_Default);
+            Model::CollectObjectsVisitor collect;
+            Model::Node::acceptAndRecurse(std::begin(nodes), std::end(nodes), collect);
+
+            if (!collect.groups().empty() || !collect.entities().empty()) {
+                updateGroupsAndEntitiesInRenderers(Renderer_Default);
+            } else {
+                m_defaultRenderer->invalidateGroupsAndEntities();
+            }
+            removeBrushesFromRenderers(Renderer_All, collect.brushes());
+            invalidateEntityLinkRenderer();
         }
         
         void MapRenderer::nodesDidChange(const Model::NodeList& nodes) {
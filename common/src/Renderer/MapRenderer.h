@@ -109,8 +109,14 @@ namespace TrenchBroom {
              * If brushes are modified, you need to call invalidateRenderers() or invalidateObjectsInRenderers()
              */
             void updateRenderers(Renderer renderers);
+            /**
+             * Like updateRenderers(), but leaves the brushes alone. Used when nodes are added or removed, where the
+             * brushes are added to or removed from the renderers directly.
+             */
+            void updateGroupsAndEntitiesInRenderers(Renderer renderers);
             void invalidateRenderers(Renderer renderers);
             void invalidateBrushesInRenderers(Renderer renderers, const Model::BrushList& brushes);
+            void removeBrushesFromRenderers(Renderer renderers, const Model::BrushList& brushes);
             void invalidateEntityLinkRenderer();
             void reloadEntityModels();
         private: // notification
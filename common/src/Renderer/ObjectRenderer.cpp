@@ -31,12 +31,30 @@ namespace TrenchBroom {
             m_brushRenderer.setBrushes(brushes);
         }
 
+        void ObjectRenderer::setGroupsAndEntities(const Model::GroupList& groups, const Model::EntityList& entities) {
+            m_groupRenderer.setGroups(groups);
+            m_entityRenderer.setEntities(entities);
+        }
+
+        void ObjectRenderer::addBrushes(const Model::BrushList& brushes) {
+            m_brushRenderer.addBrushes(brushes);
+        }
+
+        void ObjectRenderer::removeBrushes(const Model::BrushList& brushes) {
+            m_brushRenderer.removeBrushes(brushes);
+        }
+
         void ObjectRenderer::invalidate() {
             m_groupRenderer.invalidate();
             m_entityRenderer.invalidate();
             m_brushRenderer.invalidate();
         }
 
+        void ObjectRenderer::invalidateGroupsAndEntities() {
+            m_groupRenderer.invalidate();
+            m_entityRenderer.invalidate();
+        }
+
         void ObjectRenderer::invalidateBrushes(const Model::BrushList& brushes) {
             m_brushRenderer.invalidateBrushes(brushes);
         }
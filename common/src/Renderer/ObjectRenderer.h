@@ -48,7 +48,11 @@ namespace TrenchBroom {
             m_brushRenderer(brushFilter) {}
         public: // object management
             void setObjects(const Model::GroupList& groups, const Model::EntityList& entities, const Model::BrushList& brushes);
+            void setGroupsAndEntities(const Model::GroupList& groups, const Model::EntityList& entities);
+            void addBrushes(const Model::BrushList& brushes);
+            void removeBrushes(const Model::BrushList& brushes);
             void invalidate();
+            void invalidateGroupsAndEntities();
             void invalidateBrushes(const Model::BrushList& brushes);
             void clear();
             void reloadModels();
@@ -175,6 +175,7 @@ namespace TrenchBroom {
             using P3N    = VertexSpec2<AttributeSpecs::P3, AttributeSpecs::N>;
             using P3NC4  = VertexSpec3<AttributeSpecs::P3, AttributeSpecs::N, AttributeSpecs::C4>;
             using P3NT2  = VertexSpec3<AttributeSpecs::P3, AttributeSpecs::N, AttributeSpecs::T02>;
+            using P3NbT2 = VertexSpec3<AttributeSpecs::P3, AttributeSpecs::Nb, AttributeSpecs::T02>;
         }
     }
 }
@@ -23,7 +23,62 @@
 #include <cstdarg>
 #include <cstdio>
 
+#if defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+// floating point support for std::to_chars is missing from older standard libraries
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define TB_HAS_FLOAT_TO_CHARS 1
+#endif
+
 namespace StringUtils {
+    void appendFtos(String& str, const double value, const int precision) {
+        // large values need more room than this, they are formatted by ftos instead
+        char buffer[64];
+#ifdef TB_HAS_FLOAT_TO_CHARS
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, precision);
+        if (result.ec != std::errc()) {
+            str += ftos(value, precision);
+            return;
+        }
+        const char* end = result.ptr;
+#else
+        const int length = std::snprintf(buffer, sizeof(buffer), "%.*f", precision, value);
+        if (length < 0 || static_cast<size_t>(length) >= sizeof(buffer)) {
+            str += ftos(value, precision);
+            return;
+        }
+        const char* end = buffer + length;
+#endif
+
+        // remove trailing zeros and the decimal point if nothing remains after it, like ftos does
+        const char* last = end - 1;
+        while (last > buffer && *last == '0') {
+            --last;
+        }
+        if (*last == '.') {
+            --last;
+        }
+        str.append(buffer, static_cast<size_t>(last - buffer + 1));
+    }
+
+    void appendGeneral(String& str, const double value, const int precision) {
+        // the general notation switches to scientific notation for large values, so this is always enough
+        char buffer[64];
+#ifdef TB_HAS_FLOAT_TO_CHARS
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, precision);
+        assert(result.ec == std::errc());
+        str.append(buffer, static_cast<size_t>(result.ptr - buffer));
+#else
+        const int length = std::snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+        assert(length >= 0 && static_cast<size_t>(length) < sizeof(buffer));
+        str.append(buffer, static_cast<size_t>(length));
+#endif
+    }
+
     String formatString(const char* format, ...) {
         va_list arguments;
         va_start(arguments, format);
@@ -145,6 +145,27 @@ namespace StringUtils {
         return str.erase(end + 1);
     }
     
+    /**
+     * Appends the given value to the given string. The result is the same as that of ftos, but no stream is
+     * used, so this is much faster and can safely be called from multiple threads at once.
+     *
+     * @param str the string to append to
+     * @param value the value to append
+     * @param precision the number of decimals
+     */
+    void appendFtos(String& str, double value, int precision);
+
+    /**
+     * Appends the given value to the given string using the shortest representation with the given number
+     * of significant digits. The result is the same as that of printf's "%.<precision>g" format and of an
+     * output stream with the given precision and default floating point notation in the "C" locale.
+     *
+     * @param str the string to append to
+     * @param value the value to append
+     * @param precision the number of significant digits
+     */
+    void appendGeneral(String& str, double value, int precision);
+
     String formatString(const char* format, ...);
     String formatStringV(const char* format, va_list arguments);
     String trim(const String& str, const String& chars = " \n\t\r");
@@ -295,6 +295,9 @@ namespace TrenchBroom {
 #ifndef NDEBUG
             Menu* debugMenu = m_menuBar->addMenu("Debug");
             debugMenu->addUnmodifiableActionItem(CommandIds::Menu::DebugPrintVertices, "Print Vertices");
+            debugMenu->addUnmodifiableActionItem(CommandIds::Menu::DebugPrintMemoryUsage, "Print Memory Usage");
+            debugMenu->addUnmodifiableActionItem(CommandIds::Menu::DebugPrintFrameProfile, "Print Frame Profile");
+            debugMenu->addUnmodifiableActionItem(CommandIds::Menu::DebugSaveProfileTrace, "Save Profile Trace...");
             debugMenu->addUnmodifiableActionItem(CommandIds::Menu::DebugCreateBrush, "Create Brush...");
             debugMenu->addUnmodifiableActionItem(CommandIds::Menu::DebugCreateCube, "Create Cube...");
             debugMenu->addUnmodifiableActionItem(CommandIds::Menu::DebugClipWithFace, "Clip Brush...");
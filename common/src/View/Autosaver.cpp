@@ -22,9 +22,12 @@
 #include "StringUtils.h"
 #include "TemporarilySetAny.h"
 #include "IO/DiskFileSystem.h"
+#include "IO/IOUtils.h"
 #include "View/MapDocument.h"
 
 #include <cassert>
+#include <chrono>
+#include <cstdio>
 
 namespace TrenchBroom {
     namespace View {
@@ -42,10 +45,16 @@ namespace TrenchBroom {
         
         Autosaver::~Autosaver() {
             unbindObservers();
+            finishPendingBackup(nullptr, true);
             triggerAutosave(nullptr);
+            finishPendingBackup(nullptr, true);
         }
         
         void Autosaver::triggerAutosave(Logger* logger) {
+            // don't start another backup while the previous one is still being written
+            if (!finishPendingBackup(logger, false))
+                return;
+
             const time_t currentTime = time(nullptr);
             
             MapDocumentSPtr document = lock(m_document);
@@ -89,16 +98,41 @@ namespace TrenchBroom {
 
                 m_lastSaveTime = time(nullptr);
                 m_lastModificationCount = document->modificationCount();
-                document->saveDocumentTo(backupFilePath);
-                
-                if (m_logger != nullptr)
-                    m_logger->info("Created autosave backup at %s", backupFilePath.asString().c_str());
-                
+
+                // Take a snapshot of the map, which is consistent because the document cannot change while we're
+                // here. Only writing the snapshot to disk, which can be slow for large maps, happens in the background.
+                String buffer;
+                document->saveDocumentTo(buffer);
+
+                m_pendingBackupPath = backupFilePath;
+                m_pendingBackup = std::async(std::launch::async, [backupFilePath, buffer = std::move(buffer)]() {
+                    IO::OpenFile open(backupFilePath, true);
+                    if (std::fwrite(buffer.data(), 1, buffer.size(), open.file) != buffer.size())
+                        throw FileSystemException("Cannot write file: " + backupFilePath.asString());
+                });
             } catch (const FileSystemException&) {
                 if (m_logger != nullptr)
                     m_logger->error("Aborting autosave");
             }
         }
+
+        bool Autosaver::finishPendingBackup(Logger* logger, const bool wait) {
+            if (!m_pendingBackup.valid())
+                return true;
+
+            if (!wait && m_pendingBackup.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                return false;
+
+            try {
+                m_pendingBackup.get();
+                if (logger != nullptr)
+                    logger->info("Created autosave backup at %s", m_pendingBackupPath.asString().c_str());
+            } catch (const FileSystemException& e) {
+                if (logger != nullptr)
+                    logger->error("Aborting autosave: %s", e.what());
+            }
+            return true;
+        }
         
         IO::WritableDiskFileSystem Autosaver::createBackupFileSystem(const IO::Path& mapPath) const {
             const IO::Path basePath = mapPath.deleteLastComponent();
@@ -24,6 +24,7 @@
 #include "View/ViewTypes.h"
 
 #include <ctime>
+#include <future>
 
 namespace TrenchBroom {
     class Logger;
@@ -47,6 +48,10 @@ namespace TrenchBroom {
             time_t m_lastSaveTime;
             time_t m_lastModificationTime;
             size_t m_lastModificationCount;
+
+            // The map is serialized on the calling thread, but the backup file is written in the background.
+            std::future<void> m_pendingBackup;
+            IO::Path m_pendingBackupPath;
         public:
             Autosaver(View::MapDocumentWPtr document, time_t saveInterval = 10 * 60, time_t idleInterval = 3, size_t maxBackups = 50);
             ~Autosaver();
@@ -54,6 +59,11 @@ namespace TrenchBroom {
             void triggerAutosave(Logger* logger);
         private:
             void autosave(View::MapDocumentSPtr document);
+            /**
+             * Reports the result of the backup that is being written in the background, if any, once it has been
+             * written. Returns false if the backup is still being written.
+             */
+            bool finishPendingBackup(Logger* logger, bool wait);
             IO::WritableDiskFileSystem createBackupFileSystem(const IO::Path& mapPath) const;
             IO::Path::List collectBackups(const IO::WritableDiskFileSystem& fs, const IO::Path& mapBasename) const;
             bool isBackup(const IO::Path& backupPath, const IO::Path& mapBasename) const;
@@ -108,6 +108,8 @@ namespace TrenchBroom {
                 const int FileReloadTextureCollections       = Lowest + 130;
                 const int FileReloadEntityDefinitions        = Lowest + 131;
 
+                const int DebugPrintFrameProfile             = Lowest + 138;
+                const int DebugSaveProfileTrace              = Lowest + 139;
                 const int DebugPrintVertices                 = Lowest + 140;
                 const int DebugCreateBrush                   = Lowest + 141;
                 const int DebugCopyJSShortcuts               = Lowest + 142;
@@ -117,6 +119,7 @@ namespace TrenchBroom {
                 const int DebugCrashReportDialog             = Lowest + 146;
                 const int DebugSetWindowSize                 = Lowest + 147;
                 const int DebugThrowExceptionDuringCommand   = Lowest + 148;
+                const int DebugPrintMemoryUsage              = Lowest + 149;
 
                 const int RunCompile                         = Lowest + 150;
                 const int RunLaunch                          = Lowest + 151;
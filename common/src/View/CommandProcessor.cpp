@@ -20,12 +20,14 @@
 #include "CommandProcessor.h"
 
 #include "Exceptions.h"
+#include "Profiler.h"
 #include "TemporarilySetAny.h"
 #include "View/MapDocumentCommandFacade.h"
 
 #include <wx/time.h>
 
 #include <algorithm>
+#include <iterator>
 
 namespace TrenchBroom {
     namespace View {
@@ -97,6 +99,21 @@ namespace TrenchBroom {
         bool CommandGroup::doCollateWith(UndoableCommand::Ptr command) {
             return false;
         }
+
+        size_t CommandGroup::doGetMemoryUsage() const {
+            size_t result = 0;
+            for (const auto& command : m_commands) {
+                result += command->memoryUsage();
+            }
+            return result;
+        }
+
+        void CommandGroup::doCompact() {
+            // only the last command has left the document in its current state
+            if (!m_commands.empty()) {
+                m_commands.back()->compact();
+            }
+        }
         
         const wxLongLong CommandProcessor::CollationInterval(1000);
         
@@ -113,7 +130,10 @@ namespace TrenchBroom {
         m_document(document),
         m_clearRepeatableCommandStack(false),
         m_lastCommandTimestamp(0),
-        m_groupLevel(0) {
+        m_groupLevel(0),
+        m_lastCommandStackMemoryUsage(0),
+        m_memoryBudget(0),
+        m_reportedDiscardedCommands(false) {
             ensure(m_document != nullptr, "document is null");
         }
         
@@ -141,6 +161,22 @@ namespace TrenchBroom {
             }
         }
         
+        size_t CommandProcessor::memoryUsage() const {
+            size_t result = lastCommandStackMemoryUsage();
+            for (const auto& command : m_nextCommandStack) {
+                result += command->memoryUsage();
+            }
+            for (const auto& command : m_groupedCommands) {
+                result += command->memoryUsage();
+            }
+            return result;
+        }
+
+        void CommandProcessor::setMemoryBudget(const size_t memoryBudget) {
+            m_memoryBudget = memoryBudget;
+            enforceMemoryBudget();
+        }
+
         void CommandProcessor::beginGroup(const String& name) {
             if (m_groupLevel == 0) {
                 m_groupName = name;
@@ -172,6 +208,7 @@ namespace TrenchBroom {
             } else {
                 m_lastCommandStack.clear();
                 m_nextCommandStack.clear();
+                m_lastCommandStackMemoryUsage = 0;
                 return true;
             }
         }
@@ -250,10 +287,16 @@ namespace TrenchBroom {
             clearRepeatableCommands();
             m_lastCommandStack.clear();
             m_nextCommandStack.clear();
+            m_lastCommandStackMemoryUsage = 0;
             m_lastCommandTimestamp = 0;
+            m_reportedDiscardedCommands = false;
         }
         
         CommandProcessor::SubmitAndStoreResult CommandProcessor::submitAndStoreCommand(UndoableCommand::Ptr command, const bool collate) {
+            if (canCompactLastCommand(command, collate)) {
+                compactLastCommand();
+            }
+
             SubmitAndStoreResult result;
             result.submitted = doCommand(command);
             if (!result.submitted) {
@@ -268,6 +311,7 @@ namespace TrenchBroom {
         }
         
         bool CommandProcessor::doCommand(Command::Ptr command) {
+            TB_PROFILE_SCOPE("CommandProcessor::doCommand");
             Notifier1<Command::Ptr>::NotifyBeforeSuccessFail notifier(commandDoNotifier, commandDoneNotifier, commandDoFailedNotifier, command);
             if (command->performDo(m_document)) {
                 notifier.setDidSucceed(true);
@@ -279,6 +323,7 @@ namespace TrenchBroom {
         }
         
         bool CommandProcessor::undoCommand(UndoableCommand::Ptr command) {
+            TB_PROFILE_SCOPE("CommandProcessor::undoCommand");
             Notifier1<UndoableCommand::Ptr>::NotifyBeforeSuccessFail notifier(commandUndoNotifier, commandUndoneNotifier, commandUndoFailedNotifier, command);
             if (command->performUndo(m_document)) {
                 notifier.setDidSucceed(true);
@@ -329,6 +374,9 @@ namespace TrenchBroom {
                 }
                 auto group(createCommandGroup(m_groupName, m_groupedCommands));
                 m_groupedCommands.clear();
+
+                // a group is never collated with other commands, so it can be compacted right away
+                group->compact();
                 pushLastCommand(group, false);
                 pushRepeatableCommand(group);
             }
@@ -352,10 +400,16 @@ namespace TrenchBroom {
             if (collatable(collate, timestamp)) {
                 auto lastCommand = m_lastCommandStack.back();
                 if (lastCommand->collateWith(command)) {
+                    enforceMemoryBudget();
                     return false;
                 }
             }
+
+            if (!m_lastCommandStack.empty()) {
+                m_lastCommandStackMemoryUsage += m_lastCommandStack.back()->memoryUsage();
+            }
             m_lastCommandStack.push_back(command);
+            enforceMemoryBudget();
             return true;
         }
         
@@ -387,6 +441,9 @@ namespace TrenchBroom {
             } else {
                 auto lastCommand = m_lastCommandStack.back();
                 m_lastCommandStack.pop_back();
+                if (!m_lastCommandStack.empty()) {
+                    m_lastCommandStackMemoryUsage -= m_lastCommandStack.back()->memoryUsage();
+                }
                 return lastCommand;
             }
         }
@@ -407,5 +464,59 @@ namespace TrenchBroom {
                 m_repeatableCommandStack.pop_back();
             }
         }
+
+        bool CommandProcessor::canCompactLastCommand(UndoableCommand::Ptr command, const bool collate) const {
+            if (m_lastCommandStack.empty()) {
+                return false;
+            } else if (m_groupLevel > 0) {
+                // once the group has changed the document, it is no longer in the state the last command left it in
+                return m_groupedCommands.empty();
+            } else {
+                // the last command must not be compacted if the given command may still be collated with it
+                const auto& lastCommand = m_lastCommandStack.back();
+                return lastCommand->type() != command->type() || !collatable(collate, ::wxGetLocalTimeMillis());
+            }
+        }
+
+        void CommandProcessor::compactLastCommand() {
+            assert(!m_lastCommandStack.empty());
+            m_lastCommandStack.back()->compact();
+        }
+
+        size_t CommandProcessor::lastCommandStackMemoryUsage() const {
+            if (m_lastCommandStack.empty()) {
+                return 0;
+            } else {
+                return m_lastCommandStackMemoryUsage + m_lastCommandStack.back()->memoryUsage();
+            }
+        }
+
+        void CommandProcessor::enforceMemoryBudget() {
+            if (m_memoryBudget == 0 || m_lastCommandStack.size() <= 1) {
+                return;
+            }
+
+            auto usage = lastCommandStackMemoryUsage();
+            auto it = std::begin(m_lastCommandStack);
+            const auto lastCommand = std::prev(std::end(m_lastCommandStack));
+            while (usage > m_memoryBudget && it != lastCommand) {
+                const auto commandUsage = (*it)->memoryUsage();
+                usage -= commandUsage;
+                m_lastCommandStackMemoryUsage -= commandUsage;
+                ++it;
+            }
+
+            const auto discardedCount = static_cast<size_t>(std::distance(std::begin(m_lastCommandStack), it));
+            m_lastCommandStack.erase(std::begin(m_lastCommandStack), it);
+
+            // only report this once, otherwise every command would log a warning once the budget is reached
+            if (discardedCount > 0 && !m_reportedDiscardedCommands) {
+                m_document->warn("The undo history exceeds the undo memory limit of %u MiB, %u of the oldest undo steps have been discarded. "
+                                 "Older undo steps will be discarded as you keep editing. The limit can be raised in the preferences.",
+                                 static_cast<unsigned int>(m_memoryBudget / 1024u / 1024u),
+                                 static_cast<unsigned int>(discardedCount));
+                m_reportedDiscardedCommands = true;
+            }
+        }
     }
 }
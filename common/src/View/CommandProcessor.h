@@ -62,6 +62,9 @@ namespace TrenchBroom {
             UndoableCommand::Ptr doRepeat(MapDocumentCommandFacade* document) const override;
 
             bool doCollateWith(UndoableCommand::Ptr command) override;
+
+            size_t doGetMemoryUsage() const override;
+            void doCompact() override;
         };
         
         class CommandProcessor {
@@ -81,6 +84,15 @@ namespace TrenchBroom {
             CommandStack m_groupedCommands;
             size_t m_groupLevel;
 
+            /**
+             * The memory used by the commands on the undo stack except for the most recent one, which can still
+             * change when other commands are collated with it or when it is compacted.
+             */
+            size_t m_lastCommandStackMemoryUsage;
+            size_t m_memoryBudget;
+            // whether the user has been told that the undo history is being truncated, reset by clear()
+            bool m_reportedDiscardedCommands;
+
             struct SubmitAndStoreResult;
         public:
             CommandProcessor(MapDocumentCommandFacade* document);
@@ -97,6 +109,19 @@ namespace TrenchBroom {
 
             const String& lastCommandName() const;
             const String& nextCommandName() const;
+
+            /**
+             * Returns the number of bytes held by the commands on the undo and redo stacks.
+             */
+            size_t memoryUsage() const;
+
+            /**
+             * Sets the number of bytes that the undo stack may use. If the undo stack exceeds the budget, the oldest
+             * commands are discarded and can no longer be undone, but the most recent command is always kept. The first
+             * time this happens after the undo stack was cleared, a warning is logged. A budget of 0 means that the
+             * undo stack is not limited.
+             */
+            void setMemoryBudget(size_t memoryBudget);
             
             void beginGroup(const String& name = "");
             void endGroup();
@@ -132,6 +157,11 @@ namespace TrenchBroom {
             
             UndoableCommand::Ptr popLastCommand();
             UndoableCommand::Ptr popNextCommand();
+
+            bool canCompactLastCommand(UndoableCommand::Ptr command, bool collate) const;
+            void compactLastCommand();
+            size_t lastCommandStackMemoryUsage() const;
+            void enforceMemoryBudget();
             void popLastRepeatableCommand(UndoableCommand::Ptr command);
         };
     }
@@ -173,6 +173,9 @@ namespace TrenchBroom {
             MapDocumentSPtr document = lock(m_document);
             Model::World* world = document->world();
             if (world != nullptr) {
+                // regenerate the outdated issues in parallel so that the visitor only collects them
+                world->validateIssues();
+
                 const Model::IssueGeneratorList& issueGenerators = world->registeredIssueGenerators();
                 Model::CollectMatchingIssuesVisitor<IssueVisible> visitor(issueGenerators, IssueVisible(m_hiddenGenerators, m_showHiddenIssues));
                 world->acceptAndRecurse(visitor);
@@ -19,9 +19,11 @@
 
 #include "View/MapDocument.h"
 
+#include "MemoryUsage.h"
 #include "PreferenceManager.h"
 #include "Preferences.h"
 #include "Polyhedron.h"
+#include "Profiler.h"
 #include "Assets/EntityDefinitionManager.h"
 #include "Assets/EntityModelManager.h"
 #include "Assets/Texture.h"
@@ -38,6 +40,7 @@
 #include "Model/ChangeBrushFaceAttributesRequest.h"
 #include "Model/CollectAttributableNodesVisitor.h"
 #include "Model/CollectContainedNodesVisitor.h"
+#include "Model/CollectMemoryUsageVisitor.h"
 #include "Model/CollectMatchingBrushFacesVisitor.h"
 #include "Model/CollectNodesVisitor.h"
 #include "Model/CollectNodesByVisibilityVisitor.h"
@@ -114,6 +117,7 @@
 
 #include <vecmath/util.h>
 
+#include <algorithm>
 #include <cassert>
 #include <numeric>
 
@@ -141,6 +145,7 @@ namespace TrenchBroom {
         m_lastSelectionBounds(0.0, 32.0),
         m_selectionBoundsValid(true),
         m_viewEffectsService(nullptr) {
+            m_textureManager->setResidencyBudget(textureMemoryBudget());
             bindObservers();
         }
         
@@ -254,6 +259,7 @@ namespace TrenchBroom {
         }
         
         void MapDocument::loadDocument(const Model::MapFormat mapFormat, const vm::bbox3& worldBounds, Model::GameSPtr game, const IO::Path& path) {
+            TB_PROFILE_SCOPE("MapDocument::loadDocument");
             info("Loading document from " + path.asString());
             
             clearDocument();
@@ -274,10 +280,18 @@ namespace TrenchBroom {
         }
         
         void MapDocument::saveDocumentTo(const IO::Path& path) {
+            TB_PROFILE_SCOPE("MapDocument::saveDocumentTo");
             ensure(m_game.get() != nullptr, "game is null");
             ensure(m_world != nullptr, "world is null");
             m_game->writeMap(m_world, path);
         }
+
+        void MapDocument::saveDocumentTo(String& buffer) {
+            TB_PROFILE_SCOPE("MapDocument::saveDocumentTo");
+            ensure(m_game.get() != nullptr, "game is null");
+            ensure(m_world != nullptr, "world is null");
+            m_game->writeMap(m_world, buffer);
+        }
         
         void MapDocument::exportDocumentAs(const Model::ExportFormat format, const IO::Path& path) {
             m_game->exportMap(m_world, format, path);
@@ -1054,22 +1068,23 @@ namespace TrenchBroom {
                 return false;
             }
 
-            Polyhedron3 polyhedron;
+            std::vector<vm::vec3> points;
             
             if (hasSelectedBrushFaces()) {
                 for (const Model::BrushFace* face : selectedBrushFaces()) {
                     for (const Model::BrushVertex* vertex : face->vertices()) {
-                        polyhedron.addPoint(vertex->position());
+                        points.push_back(vertex->position());
                     }
                 }
             } else if (selectedNodes().hasOnlyBrushes()) {
                 for (const Model::Brush* brush : selectedNodes().brushes()) {
                     for (const Model::BrushVertex* vertex : brush->vertices()) {
-                        polyhedron.addPoint(vertex->position());
+                        points.push_back(vertex->position());
                     }
                 }
             }
             
+            const Polyhedron3 polyhedron(points);
             if (!polyhedron.polyhedron() || !polyhedron.closed()) {
                 return false;
             }
@@ -1117,11 +1132,11 @@ namespace TrenchBroom {
                 toRemove.push_back(subtrahend);
             }
 
-            for (auto* minuend : minuends) {
-                const Model::BrushList result = minuend->subtract(*m_world, m_worldBounds, currentTextureName(), subtrahends);
-
-                if (!result.empty()) {
-                    VectorUtils::append(toAdd[minuend->parent()], result);
+            const auto results = Model::Brush::subtractAll(*m_world, m_worldBounds, currentTextureName(), minuends, subtrahends);
+            for (size_t i = 0; i < minuends.size(); ++i) {
+                auto* minuend = minuends[i];
+                if (!results[i].empty()) {
+                    VectorUtils::append(toAdd[minuend->parent()], results[i]);
                 }
                 toRemove.push_back(minuend);
             }
@@ -1292,7 +1307,7 @@ namespace TrenchBroom {
             
             // try to find the texture if it is null, maybe it just wasn't set?
             if (attributes.texture() == nullptr) {
-                Assets::Texture* texture = m_textureManager->texture(attributes.textureName());
+                Assets::Texture* texture = m_textureManager->texture(attributes.internedTextureName());
                 request.setTexture(texture);
             }
             
@@ -1385,6 +1400,21 @@ namespace TrenchBroom {
             }
         }
 
+        void MapDocument::printMemoryUsage() {
+            info("Memory usage:\n" + memoryUsage().asString());
+        }
+
+        MemoryUsage MapDocument::memoryUsage() const {
+            MemoryUsage usage;
+            if (m_world != nullptr) {
+                usage += Model::collectMemoryUsage(m_world);
+            }
+            usage.add(MemoryUsage::Category::Snapshots, doGetCommandMemoryUsage());
+            usage.add(MemoryUsage::Category::Textures, m_textureManager->memoryUsage());
+            usage.add(MemoryUsage::Category::EntityModels, m_entityModelManager->memoryUsage());
+            return usage;
+        }
+
         class ThrowExceptionCommand : public DocumentCommand {
         public:
             static const CommandType Type;
@@ -1447,6 +1477,14 @@ namespace TrenchBroom {
         void MapDocument::clearRepeatableCommands() {
             doClearRepeatableCommands();
         }
+
+        size_t MapDocument::commandMemoryUsage() const {
+            return doGetCommandMemoryUsage();
+        }
+
+        size_t MapDocument::commandMemoryBudget() const {
+            return static_cast<size_t>(std::max(pref(Preferences::UndoMemoryBudget), 0)) * 1024u * 1024u;
+        }
         
         void MapDocument::beginTransaction(const String& name) {
             doBeginTransaction(name);
@@ -1478,6 +1516,7 @@ namespace TrenchBroom {
         }
         
         void MapDocument::pick(const vm::ray3& pickRay, Model::PickResult& pickResult) const {
+            TB_PROFILE_SCOPE("MapDocument::pick");
             if (m_world != nullptr)
                 m_world->pick(pickRay, pickResult);
         }
@@ -1500,6 +1539,7 @@ namespace TrenchBroom {
         }
         
         void MapDocument::loadWorld(const Model::MapFormat mapFormat, const vm::bbox3& worldBounds, Model::GameSPtr game, const IO::Path& path) {
+            TB_PROFILE_SCOPE("MapDocument::loadWorld");
             m_worldBounds = worldBounds;
             m_game = game;
             m_world = m_game->loadMap(mapFormat, m_worldBounds, path, this);
@@ -1553,12 +1593,25 @@ namespace TrenchBroom {
             setTextures();
         }
 
+        void MapDocument::collectLoadedTextureCollections() {
+            if (m_textureManager->hasLoadedCollections()) {
+                const Model::NodeList nodes(1, m_world);
+                Notifier1<const Model::NodeList&>::NotifyBeforeAndAfter notifyNodes(nodesWillChangeNotifier, nodesDidChangeNotifier, nodes);
+                Notifier0::NotifyBeforeAndAfter notifyTextureCollections(textureCollectionsWillChangeNotifier, textureCollectionsDidChangeNotifier);
+
+                if (m_textureManager->collectLoadedCollections()) {
+                    setTextures();
+                }
+            }
+        }
+
         void MapDocument::reloadEntityDefinitions() {
             auto oldSpec = entityDefinitionFile();
             setEntityDefinitionFile(oldSpec);
         }
 
         void MapDocument::loadAssets() {
+            TB_PROFILE_SCOPE("MapDocument::loadAssets");
             loadEntityDefinitions();
             setEntityDefinitions();
             loadEntityModels();
@@ -1604,6 +1657,7 @@ namespace TrenchBroom {
 
         void MapDocument::reloadTextures() {
             unloadTextures();
+            m_entityModelManager->cancelLoads();
             m_game->reloadShaders();
             loadTextures();
         }
@@ -1752,6 +1806,8 @@ namespace TrenchBroom {
         
         void MapDocument::updateGameSearchPaths() {
             const IO::Path::List additionalSearchPaths = IO::Path::asPaths(mods());
+            m_entityModelManager->cancelLoads();
+            m_textureManager->cancelLoads();
             m_game->setAdditionalSearchPaths(additionalSearchPaths, this);
         }
         
@@ -1853,9 +1909,11 @@ namespace TrenchBroom {
             if (isGamePathPreference(path)) {
                 const Model::GameFactory& gameFactory = Model::GameFactory::instance();
                 const IO::Path newGamePath = gameFactory.gamePath(m_game->gameName());
-                m_game->setGamePath(newGamePath, this);
-                
+
+                // the background model and texture loads read from the file system that is about to be replaced
                 clearEntityModels();
+                m_textureManager->cancelLoads();
+                m_game->setGamePath(newGamePath, this);
                 
                 unsetTextures();
                 loadTextures();
@@ -1866,9 +1924,17 @@ namespace TrenchBroom {
                        path == Preferences::TextureMagFilter.path()) {
                 m_entityModelManager->setTextureMode(pref(Preferences::TextureMinFilter), pref(Preferences::TextureMagFilter));
                 m_textureManager->setTextureMode(pref(Preferences::TextureMinFilter), pref(Preferences::TextureMagFilter));
+            } else if (path == Preferences::TextureMemoryBudget.path()) {
+                m_textureManager->setResidencyBudget(textureMemoryBudget());
+            } else if (path == Preferences::UndoMemoryBudget.path()) {
+                doSetCommandMemoryBudget(commandMemoryBudget());
             }
         }
 
+        size_t MapDocument::textureMemoryBudget() const {
+            return static_cast<size_t>(std::max(pref(Preferences::TextureMemoryBudget), 0)) * 1024u * 1024u;
+        }
+
         void MapDocument::commandDone(Command::Ptr command) {
             debug("Command '%s' executed", command->name().c_str());
         }
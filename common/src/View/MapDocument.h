@@ -43,6 +43,8 @@
 
 class Color;
 namespace TrenchBroom {
+    class MemoryUsage;
+
     namespace Assets {
         class EntityDefinitionManager;
         class EntityModelManager;
@@ -187,6 +189,8 @@ namespace TrenchBroom {
             void saveDocument();
             void saveDocumentAs(const IO::Path& path);
             void saveDocumentTo(const IO::Path& path);
+            // Appends the document to the given buffer in the same form in which saveDocumentTo writes it.
+            void saveDocumentTo(String& buffer);
             void exportDocumentAs(Model::ExportFormat format, const IO::Path& path);
         private:
             void doSaveDocument(const IO::Path& path);
@@ -351,7 +355,13 @@ namespace TrenchBroom {
             virtual void performRebuildBrushGeometry(const Model::BrushList& brushes) = 0;
         public: // debug commands
             void printVertices();
+            void printMemoryUsage();
             bool throwExceptionDuringCommand();
+
+            /**
+             * Returns the memory used by the world, the undo and redo stacks, the textures and the entity models.
+             */
+            MemoryUsage memoryUsage() const;
         public: // command processing
             bool canUndoLastCommand() const;
             bool canRedoNextCommand() const;
@@ -361,6 +371,13 @@ namespace TrenchBroom {
             void redoNextCommand();
             bool repeatLastCommands();
             void clearRepeatableCommands();
+
+            /**
+             * Returns the number of bytes held by the commands on the undo and redo stacks.
+             */
+            size_t commandMemoryUsage() const;
+        protected:
+            size_t commandMemoryBudget() const;
         public: // transactions
             void beginTransaction(const String& name = "");
             void rollbackTransaction();
@@ -378,6 +395,8 @@ namespace TrenchBroom {
             virtual void doRedoNextCommand() = 0;
             virtual bool doRepeatLastCommands() = 0;
             virtual void doClearRepeatableCommands() = 0;
+            virtual size_t doGetCommandMemoryUsage() const = 0;
+            virtual void doSetCommandMemoryBudget(size_t memoryBudget) = 0;
             
             virtual void doBeginTransaction(const String& name) = 0;
             virtual void doEndTransaction() = 0;
@@ -406,6 +425,11 @@ namespace TrenchBroom {
             IO::Path::List availableTextureCollections() const;
             void setEnabledTextureCollections(const IO::Path::List& paths);
             void reloadTextureCollections();
+            /**
+             * Texture collections are loaded in the background. This hands the collections that have finished loading
+             * to the texture manager and updates the textures of the faces that use them. Must be called periodically.
+             */
+            void collectLoadedTextureCollections();
 
             void reloadEntityDefinitions();
         private:
@@ -465,6 +489,7 @@ namespace TrenchBroom {
             void bindObservers();
             void unbindObservers();
             void preferenceDidChange(const IO::Path& path);
+            size_t textureMemoryBudget() const;
             void commandDone(Command::Ptr command);
             void commandUndone(UndoableCommand::Ptr command);
         };
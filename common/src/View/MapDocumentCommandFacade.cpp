@@ -50,6 +50,7 @@ namespace TrenchBroom {
 
         MapDocumentCommandFacade::MapDocumentCommandFacade() :
         m_commandProcessor(this) {
+            m_commandProcessor.setMemoryBudget(commandMemoryBudget());
             bindObservers();
         }
 
@@ -461,9 +462,14 @@ namespace TrenchBroom {
           Notifier1<const Model::NodeList &>::NotifyBeforeAndAfter notifyNodes(
               nodesWillChangeNotifier, nodesDidChangeNotifier, nodes);
 
-          Model::TransformObjectVisitor visitor(transform, lockTextures,
-                                                m_worldBounds);
-          Model::Node::accept(std::begin(nodes), std::end(nodes), visitor);
+          {
+              // update the node tree once for all transformed nodes
+              Model::DeferNodeTreeUpdates deferNodeTreeUpdates(*m_world);
+              Model::TransformObjectVisitor visitor(transform, lockTextures,
+                                                    m_worldBounds);
+              Model::Node::accept(std::begin(nodes), std::end(nodes), visitor);
+              deferNodeTreeUpdates.apply();
+          }
 
           invalidateSelectionBounds();
           return true;
@@ -968,6 +974,14 @@ namespace TrenchBroom {
             m_commandProcessor.clearRepeatableCommands();
         }
 
+        size_t MapDocumentCommandFacade::doGetCommandMemoryUsage() const {
+            return m_commandProcessor.memoryUsage();
+        }
+
+        void MapDocumentCommandFacade::doSetCommandMemoryBudget(const size_t memoryBudget) {
+            m_commandProcessor.setMemoryBudget(memoryBudget);
+        }
+
         void MapDocumentCommandFacade::doBeginTransaction(const String& name) {
             debug("Starting transaction '" + name + "'");
             m_commandProcessor.beginGroup(name);
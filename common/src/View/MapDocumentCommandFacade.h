@@ -131,6 +131,8 @@ namespace TrenchBroom {
             void doRedoNextCommand() override;
             bool doRepeatLastCommands() override;
             void doClearRepeatableCommands() override;
+            size_t doGetCommandMemoryUsage() const override;
+            void doSetCommandMemoryBudget(size_t memoryBudget) override;
             
             void doBeginTransaction(const String& name) override;
             void doEndTransaction() override;
@@ -20,8 +20,11 @@
 #include "MapFrame.h"
 
 #include "TrenchBroomApp.h"
+#include "MemoryUsage.h"
 #include "Preferences.h"
 #include "PreferenceManager.h"
+#include "Profiler.h"
+#include "Assets/TextureManager.h"
 #include "IO/DiskFileSystem.h"
 #include "IO/ResourceUtils.h"
 #include "Model/AttributableNode.h"
@@ -79,6 +82,7 @@
 #include <wx/statusbr.h>
 
 #include <cassert>
+#include <fstream>
 #include <iterator>
 
 namespace TrenchBroom {
@@ -485,7 +489,10 @@ namespace TrenchBroom {
         }
         
         void MapFrame::createStatusBar() {
-            m_statusBar = CreateStatusBar();
+            // the second field shows the memory used by the undo and redo stacks
+            const int widths[2] = { -1, 150 };
+            m_statusBar = CreateStatusBar(2);
+            m_statusBar->SetStatusWidths(2, widths);
         }
         
         static Model::AttributableNode* commonEntityForBrushList(const Model::BrushList& list) {
@@ -609,7 +616,12 @@ namespace TrenchBroom {
         }
         
         void MapFrame::updateStatusBar() {
-            m_statusBar->SetStatusText(describeSelection(m_document.get()));
+            m_statusBar->SetStatusText(describeSelection(m_document.get()), 0);
+            updateUndoMemoryStatus();
+        }
+
+        void MapFrame::updateUndoMemoryStatus() {
+            m_statusBar->SetStatusText("Undo: " + formatBytes(m_document->commandMemoryUsage()), 1);
         }
         
         void MapFrame::bindObservers() {
@@ -625,6 +637,8 @@ namespace TrenchBroom {
             m_document->currentLayerDidChangeNotifier.addObserver(this, &MapFrame::currentLayerDidChange);
             m_document->groupWasOpenedNotifier.addObserver(this, &MapFrame::groupWasOpened);
             m_document->groupWasClosedNotifier.addObserver(this, &MapFrame::groupWasClosed);
+            m_document->commandDoneNotifier.addObserver(this, &MapFrame::commandDone);
+            m_document->commandUndoneNotifier.addObserver(this, &MapFrame::commandUndone);
             
             Grid& grid = m_document->grid();
             grid.gridDidChangeNotifier.addObserver(this, &MapFrame::gridDidChange);
@@ -643,6 +657,8 @@ namespace TrenchBroom {
             m_document->currentLayerDidChangeNotifier.removeObserver(this, &MapFrame::currentLayerDidChange);
             m_document->groupWasOpenedNotifier.removeObserver(this, &MapFrame::groupWasOpened);
             m_document->groupWasClosedNotifier.removeObserver(this, &MapFrame::groupWasClosed);
+            m_document->commandDoneNotifier.removeObserver(this, &MapFrame::commandDone);
+            m_document->commandUndoneNotifier.removeObserver(this, &MapFrame::commandUndone);
             
             Grid& grid = m_document->grid();
             grid.gridDidChangeNotifier.removeObserver(this, &MapFrame::gridDidChange);
@@ -655,6 +671,7 @@ namespace TrenchBroom {
         void MapFrame::documentDidChange(View::MapDocument* document) {
             updateTitle();
             updateRecentDocumentsMenu();
+            updateUndoMemoryStatus();
         }
 
         void MapFrame::documentModificationStateDidChange() {
@@ -690,6 +707,14 @@ namespace TrenchBroom {
             updateStatusBar();
         }
 
+        void MapFrame::commandDone(Command::Ptr command) {
+            updateUndoMemoryStatus();
+        }
+
+        void MapFrame::commandUndone(UndoableCommand::Ptr command) {
+            updateUndoMemoryStatus();
+        }
+
         void MapFrame::bindEvents() {
             Bind(wxEVT_MENU, &MapFrame::OnFileSave, this, wxID_SAVE);
             Bind(wxEVT_MENU, &MapFrame::OnFileSaveAs, this, wxID_SAVEAS);
@@ -775,6 +800,9 @@ namespace TrenchBroom {
             Bind(wxEVT_MENU, &MapFrame::OnRunLaunch, this, CommandIds::Menu::RunLaunch);
             
             Bind(wxEVT_MENU, &MapFrame::OnDebugPrintVertices, this, CommandIds::Menu::DebugPrintVertices);
+            Bind(wxEVT_MENU, &MapFrame::OnDebugPrintMemoryUsage, this, CommandIds::Menu::DebugPrintMemoryUsage);
+            Bind(wxEVT_MENU, &MapFrame::OnDebugPrintFrameProfile, this, CommandIds::Menu::DebugPrintFrameProfile);
+            Bind(wxEVT_MENU, &MapFrame::OnDebugSaveProfileTrace, this, CommandIds::Menu::DebugSaveProfileTrace);
             Bind(wxEVT_MENU, &MapFrame::OnDebugCreateBrush, this, CommandIds::Menu::DebugCreateBrush);
             Bind(wxEVT_MENU, &MapFrame::OnDebugCreateCube, this, CommandIds::Menu::DebugCreateCube);
             Bind(wxEVT_MENU, &MapFrame::OnDebugClipBrush, this, CommandIds::Menu::DebugClipWithFace);
@@ -802,6 +830,7 @@ namespace TrenchBroom {
 
             Bind(wxEVT_CLOSE_WINDOW, &MapFrame::OnClose, this);
             Bind(wxEVT_TIMER, &MapFrame::OnAutosaveTimer, this);
+            Bind(wxEVT_IDLE, &MapFrame::OnIdle, this);
 			Bind(wxEVT_CHILD_FOCUS, &MapFrame::OnChildFocus, this);
 
 #if defined(_WIN32)
@@ -1450,6 +1479,36 @@ namespace TrenchBroom {
             m_document->printVertices();
         }
 
+        void MapFrame::OnDebugPrintMemoryUsage(wxCommandEvent& event) {
+            if (IsBeingDeleted()) return;
+
+            m_document->printMemoryUsage();
+        }
+
+        void MapFrame::OnDebugPrintFrameProfile(wxCommandEvent& event) {
+            if (IsBeingDeleted()) return;
+
+            logger()->info("Frame profile:\n" + Profiler::formatLastFrameStats());
+        }
+
+        void MapFrame::OnDebugSaveProfileTrace(wxCommandEvent& event) {
+            if (IsBeingDeleted()) return;
+
+            wxFileDialog saveDialog(this, "Save profile trace", "", "trace.json", "Chrome trace files (*.json)|*.json", wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+            if (saveDialog.ShowModal() == wxID_CANCEL)
+                return;
+
+            const IO::Path path(saveDialog.GetPath().ToStdString());
+            std::ofstream stream(path.asString().c_str());
+            if (!stream.good()) {
+                logger()->error("Could not open " + path.asString() + " for writing");
+                return;
+            }
+
+            Profiler::writeChromeTrace(stream);
+            logger()->info("Saved profile trace to " + path.asString());
+        }
+
         void MapFrame::OnDebugCreateBrush(wxCommandEvent& event) {
             if (IsBeingDeleted()) return;
             
@@ -1843,6 +1902,7 @@ namespace TrenchBroom {
                     event.Enable(canLaunch());
                     break;
                 case CommandIds::Menu::DebugPrintVertices:
+                case CommandIds::Menu::DebugPrintMemoryUsage:
                 case CommandIds::Menu::DebugCreateBrush:
                 case CommandIds::Menu::DebugCreateCube:
                 case CommandIds::Menu::DebugCopyJSShortcuts:
@@ -1854,6 +1914,10 @@ namespace TrenchBroom {
                 case CommandIds::Menu::DebugClipWithFace:
                     event.Enable(m_document->selectedNodes().hasOnlyBrushes());
                     break;
+                case CommandIds::Menu::DebugPrintFrameProfile:
+                case CommandIds::Menu::DebugSaveProfileTrace:
+                    event.Enable(Profiler::enabled());
+                    break;
                 case CommandIds::Actions::FlipObjectsHorizontally:
                 case CommandIds::Actions::FlipObjectsVertically:
                     event.Enable(m_mapView->canFlipObjects());
@@ -2076,6 +2140,15 @@ namespace TrenchBroom {
 
             m_autosaver->triggerAutosave(logger());
         }
+
+        void MapFrame::OnIdle(wxIdleEvent& event) {
+            if (IsBeingDeleted()) return;
+
+            // All views that were refreshed are repainted before the next idle event, so this is where a frame ends.
+            // The views share the texture manager, and textures used by any of them in this frame must stay resident.
+            m_document->textureManager().nextFrame();
+            event.Skip();
+        }
         
         int MapFrame::indexForGridSize(const int gridSize) {
             return gridSize - Grid::MinSize;
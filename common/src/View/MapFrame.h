@@ -23,7 +23,9 @@
 #include "Model/MapFormat.h"
 #include "Model/ModelTypes.h"
 #include "View/Inspector.h"
+#include "View/Command.h"
 #include "View/Selection.h"
+#include "View/UndoableCommand.h"
 #include "View/ViewTypes.h"
 #include "SplitterWindow2.h"
 
@@ -118,6 +120,7 @@ namespace TrenchBroom {
         private: // status bar
             void createStatusBar();
             void updateStatusBar();
+            void updateUndoMemoryStatus();
         private: // gui creation
             void createGui();
         private: // notification handlers
@@ -133,6 +136,8 @@ namespace TrenchBroom {
             void currentLayerDidChange(const TrenchBroom::Model::Layer* layer);
             void groupWasOpened(Model::Group* group);
             void groupWasClosed(Model::Group* group);
+            void commandDone(Command::Ptr command);
+            void commandUndone(UndoableCommand::Ptr command);
         private: // menu event handlers
             void bindEvents();
 
@@ -235,6 +240,9 @@ namespace TrenchBroom {
             void OnRunLaunch(wxCommandEvent& event);
 
             void OnDebugPrintVertices(wxCommandEvent& event);
+            void OnDebugPrintMemoryUsage(wxCommandEvent& event);
+            void OnDebugPrintFrameProfile(wxCommandEvent& event);
+            void OnDebugSaveProfileTrace(wxCommandEvent& event);
             void OnDebugCreateBrush(wxCommandEvent& event);
             void OnDebugCreateCube(wxCommandEvent& event);
             void OnDebugClipBrush(wxCommandEvent& event);
@@ -291,6 +299,7 @@ namespace TrenchBroom {
         private: // other event handlers
             void OnClose(wxCloseEvent& event);
             void OnAutosaveTimer(wxTimerEvent& event);
+            void OnIdle(wxIdleEvent& event);
         private: // grid helpers
             static int indexForGridSize(const int gridSize);
             static int gridSizeForIndex(const int index);
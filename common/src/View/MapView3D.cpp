@@ -173,6 +173,7 @@ namespace TrenchBroom {
                 Refresh();
                 event.RequestMore();
             }
+            event.Skip();
         }
 
         void MapView3D::OnKeyDown(wxKeyEvent& event) {
@@ -24,6 +24,8 @@
 #include "PreferenceManager.h"
 #include "Preferences.h"
 #include "Assets/EntityDefinitionManager.h"
+#include "Assets/EntityModelManager.h"
+#include "Assets/TextureManager.h"
 #include "Model/Brush.h"
 #include "Model/BrushFace.h"
 #include "Model/BrushGeometry.h"
@@ -66,6 +68,7 @@
 #include <vecmath/polygon.h>
 #include <vecmath/util.h>
 
+#include <wx/app.h>
 #include <wx/frame.h>
 #include <wx/menu.h>
 
@@ -99,12 +102,17 @@ namespace TrenchBroom {
         m_animationManager(new AnimationManager()),
         m_renderer(renderer),
         m_compass(nullptr),
-        m_portalFileRenderer(nullptr) {
+        m_portalFileRenderer(nullptr),
+        m_entityModelLoadGeneration(0) {
             setToolBox(toolBox);
             toolBox.addWindow(this);
             bindEvents();
             bindObservers();
             updateAcceleratorTable(HasFocus());
+
+            // wxWakeUpIdle can be called from the worker threads that load the entity models
+            lock(m_document)->entityModelManager().setModelLoadedCallback([]() { wxWakeUpIdle(); });
+            lock(m_document)->textureManager().setCollectionLoadedCallback([]() { wxWakeUpIdle(); });
         }
 
         void MapViewBase::setCompass(Renderer::Compass* compass) {
@@ -261,6 +269,7 @@ namespace TrenchBroom {
         void MapViewBase::bindEvents() {
             Bind(wxEVT_SET_FOCUS, &MapViewBase::OnSetFocus, this);
             Bind(wxEVT_KILL_FOCUS, &MapViewBase::OnKillFocus, this);
+            Bind(wxEVT_IDLE, &MapViewBase::OnIdle, this);
 
             Bind(wxEVT_MENU, &MapViewBase::OnToggleClipSide,               this, CommandIds::Actions::ToggleClipSide);
             Bind(wxEVT_MENU, &MapViewBase::OnPerformClip,                  this, CommandIds::Actions::PerformClip);
@@ -756,6 +765,28 @@ namespace TrenchBroom {
             event.Skip();
         }
 
+        void MapViewBase::OnIdle(wxIdleEvent& event) {
+            if (IsBeingDeleted()) return;
+
+            // entity models are loaded in the background, redraw once some of them have been loaded
+            auto document = lock(m_document);
+            auto& entityModelManager = document->entityModelManager();
+            entityModelManager.collectLoadedModels();
+            if (entityModelManager.loadGeneration() != m_entityModelLoadGeneration) {
+                m_entityModelLoadGeneration = entityModelManager.loadGeneration();
+                Refresh();
+            }
+
+            // texture collections are loaded in the background as well, the document notifies the views once they are loaded
+            document->collectLoadedTextureCollections();
+
+            // textures are uploaded in batches while rendering, keep redrawing until all of them are uploaded
+            if (document->textureManager().hasPendingChanges()) {
+                Refresh();
+            }
+            event.Skip();
+        }
+
         void MapViewBase::updateAcceleratorTable() {
             updateAcceleratorTable(HasFocus());
         }
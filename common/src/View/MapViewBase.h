@@ -80,6 +80,7 @@ namespace TrenchBroom {
             Renderer::MapRenderer& m_renderer;
             Renderer::Compass* m_compass;
             std::unique_ptr<Renderer::PrimitiveRenderer> m_portalFileRenderer;
+            size_t m_entityModelLoadGeneration;
         protected:
             MapViewBase(wxWindow* parent, Logger* logger, MapDocumentWPtr document, MapViewToolBox& toolBox, Renderer::MapRenderer& renderer, GLContextManager& contextManager);
             
@@ -205,6 +206,7 @@ namespace TrenchBroom {
             void OnSetFocus(wxFocusEvent& event);
             void OnKillFocus(wxFocusEvent& event);
             void OnActivateFrame(wxActivateEvent& event);
+            void OnIdle(wxIdleEvent& event);
         protected: // accelerator table management
             void updateAcceleratorTable();
         private:
@@ -21,6 +21,7 @@
 #include "Exceptions.h"
 #include "PreferenceManager.h"
 #include "Preferences.h"
+#include "Profiler.h"
 #include "Renderer/Transformation.h"
 #include "Renderer/VertexArray.h"
 #include "Renderer/VertexSpec.h"
@@ -70,6 +71,7 @@ namespace TrenchBroom {
                 wxPaintDC paintDC(this);
                 render();
                 SwapBuffers();
+                TB_PROFILE_FRAME();
             }
         }
         
@@ -145,6 +147,7 @@ namespace TrenchBroom {
         }
         
         void RenderView::render() {
+            TB_PROFILE_SCOPE("RenderView::render");
             clearBackground();
             doRender();
             renderFocusIndicator();
@@ -48,6 +48,16 @@ namespace TrenchBroom {
             return restoreSnapshot(document);
         }
 
+        size_t SnapshotCommand::doGetMemoryUsage() const {
+            return m_snapshot != nullptr ? m_snapshot->memoryUsage() : 0u;
+        }
+
+        void SnapshotCommand::doCompact() {
+            if (m_snapshot != nullptr) {
+                m_snapshot->compact();
+            }
+        }
+
         void SnapshotCommand::takeSnapshot(MapDocumentCommandFacade *document) {
             assert(m_snapshot == nullptr);
             m_snapshot = doTakeSnapshot(document);
@@ -37,6 +37,9 @@ namespace TrenchBroom {
         public:
             bool performDo(MapDocumentCommandFacade* document) override;
             bool doPerformUndo(MapDocumentCommandFacade* document) override;
+        private:
+            size_t doGetMemoryUsage() const override;
+            void doCompact() override;
         private:
             void takeSnapshot(MapDocumentCommandFacade* document);
             bool restoreSnapshot(MapDocumentCommandFacade* document);
@@ -257,6 +257,11 @@ namespace TrenchBroom {
             renderBounds(layout, y, height);
             renderTextures(layout, y, height);
             renderNames(layout, y, height);
+
+            if (m_textureManager.hasPendingChanges()) {
+                // textures are uploaded once they become visible, the view is rendered again to show them
+                Refresh();
+            }
         }
 
         bool TextureBrowserView::doShouldRenderFocusIndicator() const {
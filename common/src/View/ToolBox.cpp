@@ -19,6 +19,7 @@
 
 #include "CollectionUtils.h"
 #include "ToolBox.h"
+#include "Profiler.h"
 #include "TemporarilySetAny.h"
 #include "View/InputState.h"
 #include "View/Tool.h"
@@ -106,6 +107,7 @@ namespace TrenchBroom {
         }
 
         void ToolBox::pick(ToolChain* chain, const InputState& inputState, Model::PickResult& pickResult) {
+            TB_PROFILE_SCOPE("ToolBox::pick");
             chain->pick(inputState, pickResult);
         }
 
@@ -58,10 +58,24 @@ namespace TrenchBroom {
             return doCollateWith(command);
         }
 
+        size_t UndoableCommand::memoryUsage() const {
+            return doGetMemoryUsage();
+        }
+
+        void UndoableCommand::compact() {
+            doCompact();
+        }
+
         bool UndoableCommand::doIsRepeatDelimiter() const {
             return false;
         }
         
+        size_t UndoableCommand::doGetMemoryUsage() const {
+            return 0;
+        }
+
+        void UndoableCommand::doCompact() {}
+
         UndoableCommand::Ptr UndoableCommand::doRepeat(MapDocumentCommandFacade* document) const {
             throw CommandProcessorException("Command is not repeatable");
         }
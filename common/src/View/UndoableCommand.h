@@ -41,6 +41,19 @@ namespace TrenchBroom {
             UndoableCommand::Ptr repeat(MapDocumentCommandFacade* document) const;
             
             virtual bool collateWith(UndoableCommand::Ptr command);
+
+            /**
+             * Returns the number of bytes this command holds on to in order to undo or redo itself, e.g. the
+             * snapshots it has taken.
+             */
+            size_t memoryUsage() const;
+
+            /**
+             * Reduces the memory this command holds on to in order to undo itself. The command processor calls this
+             * once the command can no longer be collated with other commands, and only while the document is still in
+             * the state that this command left it in.
+             */
+            void compact();
         private:
             virtual bool doPerformUndo(MapDocumentCommandFacade* document) = 0;
             
@@ -49,6 +62,9 @@ namespace TrenchBroom {
             virtual UndoableCommand::Ptr doRepeat(MapDocumentCommandFacade* document) const;
             
             virtual bool doCollateWith(UndoableCommand::Ptr command) = 0;
+
+            virtual size_t doGetMemoryUsage() const;
+            virtual void doCompact();
         public: // this method is just a service for DocumentCommand and should never be called from anywhere else
             virtual size_t documentModificationCount() const;
         private:
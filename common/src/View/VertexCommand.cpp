@@ -163,6 +163,16 @@ namespace TrenchBroom {
             return false;
         }
 
+        size_t VertexCommand::doGetMemoryUsage() const {
+            return m_snapshot != nullptr ? m_snapshot->memoryUsage() : 0u;
+        }
+
+        void VertexCommand::doCompact() {
+            if (m_snapshot != nullptr) {
+                m_snapshot->compact();
+            }
+        }
+
         void VertexCommand::takeSnapshot() {
             assert(m_snapshot == nullptr);
             m_snapshot = new Model::Snapshot(std::begin(m_brushes), std::end(m_brushes));
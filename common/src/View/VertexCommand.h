@@ -72,6 +72,8 @@ namespace TrenchBroom {
             bool doPerformUndo(MapDocumentCommandFacade* document) override;
             void restoreAndTakeNewSnapshot(MapDocumentCommandFacade* document);
             bool doIsRepeatable(MapDocumentCommandFacade* document) const override;
+            size_t doGetMemoryUsage() const override;
+            void doCompact() override;
         private:
             void takeSnapshot();
             void deleteSnapshot();
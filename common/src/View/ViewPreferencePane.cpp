@@ -40,6 +40,9 @@
 #include <wx/layout.h>
 #include <wx/valnum.h>
 
+#include <algorithm>
+#include <iterator>
+
 namespace TrenchBroom {
     namespace View {
         struct TextureMode {
@@ -62,6 +65,10 @@ namespace TrenchBroom {
             TextureMode(GL_LINEAR_MIPMAP_NEAREST,   GL_LINEAR,  "Linear (mipmapped)"),
             TextureMode(GL_LINEAR_MIPMAP_LINEAR,    GL_LINEAR,  "Linear (mipmapped, interpolated")
         };
+
+        // in MiB, 0 means no limit
+        static const size_t NumUndoMemoryBudgets = 6;
+        static const int UndoMemoryBudgets[] = { 0, 128, 256, 512, 1024, 2048 };
         
         static const size_t NumFrameLayouts = 4;
         
@@ -204,6 +211,19 @@ namespace TrenchBroom {
             prefs.set(Preferences::RendererFontSize, wxAtoi(str));
         }
 
+        void ViewPreferencePane::OnUndoMemoryBudgetChanged(wxCommandEvent& event) {
+            if (IsBeingDeleted()) return;
+
+            const auto selection = m_undoMemoryBudgetChoice->GetSelection();
+            if (selection >= 0) {
+                const auto index = static_cast<size_t>(selection);
+                assert(index < NumUndoMemoryBudgets);
+
+                auto& prefs = PreferenceManager::instance();
+                prefs.set(Preferences::UndoMemoryBudget, UndoMemoryBudgets[index]);
+            }
+        }
+
         void ViewPreferencePane::createGui() {
             auto* viewPreferences = createViewPreferences();
             
@@ -289,6 +309,16 @@ namespace TrenchBroom {
 
 
             
+            auto* undoPrefsHeader = new wxStaticText(viewBox, wxID_ANY, "Undo");
+            undoPrefsHeader->SetFont(undoPrefsHeader->GetFont().Bold());
+
+            auto* undoMemoryBudgetLabel = new wxStaticText(viewBox, wxID_ANY, "Memory Limit (truncates undo history)");
+            wxString undoMemoryBudgets[NumUndoMemoryBudgets] = { "Unlimited", "128 MiB", "256 MiB", "512 MiB", "1 GiB", "2 GiB" };
+            m_undoMemoryBudgetChoice = new wxChoice(viewBox, wxID_ANY, wxDefaultPosition, wxDefaultSize, NumUndoMemoryBudgets, undoMemoryBudgets);
+            m_undoMemoryBudgetChoice->SetToolTip("Limits the memory used by the undo history. When the limit is exceeded, the oldest undo steps are discarded and can no longer be undone. The most recent step is always kept.");
+
+
+            
             const auto HMargin           = LayoutConstants::WideHMargin;
             const auto LMargin           = LayoutConstants::WideVMargin;
             const auto HeaderFlags       = wxLEFT;
@@ -382,6 +412,16 @@ namespace TrenchBroom {
             sizer->Add(fontPrefsRendererFontSizeLabel,      wxGBPosition( r, 0), wxDefaultSpan, LabelFlags,  HMargin);
             sizer->Add(m_fontPrefsRendererFontSizeCombo,    wxGBPosition( r, 1), wxDefaultSpan, ChoiceFlags, HMargin);
             ++r;
+
+            sizer->Add(new BorderLine(viewBox),             wxGBPosition( r, 0), wxGBSpan(1,2), LineFlags, LMargin);
+            ++r;
+
+            sizer->Add(undoPrefsHeader,                     wxGBPosition( r, 0), wxGBSpan(1,2), HeaderFlags, HMargin);
+            ++r;
+
+            sizer->Add(undoMemoryBudgetLabel,               wxGBPosition( r, 0), wxDefaultSpan, LabelFlags,  HMargin);
+            sizer->Add(m_undoMemoryBudgetChoice,            wxGBPosition( r, 1), wxDefaultSpan, ChoiceFlags, HMargin);
+            ++r;
  
             sizer->Add(0, LayoutConstants::ChoiceSizeDelta, wxGBPosition( r, 0), wxGBSpan(1,2));
             
@@ -409,6 +449,8 @@ namespace TrenchBroom {
 
             m_fontPrefsRendererFontSizeCombo->Bind(wxEVT_COMBOBOX, &ViewPreferencePane::OnFontPrefsRendererFontSizeChanged, this);
             m_fontPrefsRendererFontSizeCombo->Bind(wxEVT_TEXT, &ViewPreferencePane::OnFontPrefsRendererFontSizeChanged, this);
+
+            m_undoMemoryBudgetChoice->Bind(wxEVT_CHOICE, &ViewPreferencePane::OnUndoMemoryBudgetChanged, this);
         }
 
         bool ViewPreferencePane::doCanResetToDefaults() {
@@ -428,6 +470,7 @@ namespace TrenchBroom {
             prefs.resetToDefault(Preferences::EdgeColor);
             prefs.resetToDefault(Preferences::TextureBrowserIconSize);
             prefs.resetToDefault(Preferences::RendererFontSize);
+            prefs.resetToDefault(Preferences::UndoMemoryBudget);
         }
 
         void ViewPreferencePane::doUpdateControls() {
@@ -465,6 +508,13 @@ namespace TrenchBroom {
             }
 
             m_fontPrefsRendererFontSizeCombo->SetValue(wxString::Format(wxT("%i"), pref(Preferences::RendererFontSize)));
+
+            const auto undoMemoryBudget = std::find(std::begin(UndoMemoryBudgets), std::end(UndoMemoryBudgets), pref(Preferences::UndoMemoryBudget));
+            if (undoMemoryBudget != std::end(UndoMemoryBudgets)) {
+                m_undoMemoryBudgetChoice->SetSelection(static_cast<int>(std::distance(std::begin(UndoMemoryBudgets), undoMemoryBudget)));
+            } else {
+                m_undoMemoryBudgetChoice->SetSelection(wxNOT_FOUND);
+            }
         }
 
         bool ViewPreferencePane::doValidate() {
@@ -45,6 +45,7 @@ namespace TrenchBroom {
             wxColourPickerCtrl* m_edgeColorPicker;
             wxChoice* m_textureBrowserIconSizeChoice;
             wxComboBox* m_fontPrefsRendererFontSizeCombo;
+            wxChoice* m_undoMemoryBudgetChoice;
         public:
             ViewPreferencePane(wxWindow* parent);
 
@@ -59,6 +60,7 @@ namespace TrenchBroom {
             void OnEdgeColorChanged(wxColourPickerEvent& event);
             void OnTextureBrowserIconSizeChanged(wxCommandEvent& event);
             void OnFontPrefsRendererFontSizeChanged(wxCommandEvent& event);
+            void OnUndoMemoryBudgetChanged(wxCommandEvent& event);
        private:
             void createGui();
             wxWindow* createViewPreferences();
@@ -31,6 +31,9 @@
 #include "Model/NodeVisitor.h"
 #include "Model/World.h"
 
+#include <chrono>
+#include <cstdio>
+
 namespace TrenchBroom {
     namespace Model {
         using AABB = AABBTree<double, 3, Node*>;
@@ -98,6 +101,71 @@ namespace TrenchBroom {
 
             delete world;
         }
+
+        class CollectTreeEntries : public NodeVisitor {
+        private:
+            AABB::EntryList m_entries;
+        public:
+            const AABB::EntryList& entries() const {
+                return m_entries;
+            }
+        private:
+            void doVisit(World* world) override {}
+            void doVisit(Layer* layer) override {}
+            void doVisit(Group* group) override {}
+            void doVisit(Entity* entity) override {
+                m_entries.emplace_back(entity->bounds(), entity);
+            }
+            void doVisit(Brush* brush) override {
+                m_entries.emplace_back(brush->bounds(), brush);
+            }
+        };
+
+        template <typename L>
+        static double timeMillis(L&& lambda) {
+            const auto start = std::chrono::high_resolution_clock::now();
+            lambda();
+            const auto end = std::chrono::high_resolution_clock::now();
+            return std::chrono::duration<double, std::milli>(end - start).count();
+        }
+
+        TEST(AABBTreeStressTest, bulkBuildQualityTest) {
+            const auto mapPath = IO::Disk::getCurrentWorkingDir() + IO::Path("data/IO/Map/rtz_q1.map");
+            const auto file = IO::Disk::openFile(mapPath);
+
+            IO::TestParserStatus status;
+            IO::WorldReader reader(file->begin(), file->end(), nullptr);
+
+            const vm::bbox3 worldBounds(8192);
+            auto* world = reader.read(Model::MapFormat::Standard, worldBounds, status);
+
+            CollectTreeEntries collect;
+            world->acceptAndRecurse(collect);
+            const auto& entries = collect.entries();
+
+            AABB incremental;
+            const auto incrementalTime = timeMillis([&]() {
+                for (const auto& entry : entries) {
+                    incremental.insert(entry.first, entry.second);
+                }
+            });
+
+            AABB bulk;
+            const auto bulkTime = timeMillis([&]() { bulk.clearAndBuild(entries); });
+
+            std::printf("Building tree with %zu entries\n", entries.size());
+            std::printf("  incremental: %fms, height %zu, SAH cost %f\n", incrementalTime, incremental.height(), incremental.sahCost());
+            std::printf("  bulk:        %fms, height %zu, SAH cost %f\n", bulkTime, bulk.height(), bulk.sahCost());
+
+            ASSERT_EQ(incremental.bounds(), bulk.bounds());
+            for (const auto& entry : entries) {
+                ASSERT_TRUE(bulk.contains(entry.first, entry.second));
+            }
+            ASSERT_LE(bulk.height(), incremental.height());
+            ASSERT_LT(bulk.sahCost(), incremental.sahCost());
+
+            delete world;
+        }
     }
 }
 
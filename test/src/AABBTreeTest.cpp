@@ -22,6 +22,11 @@
 #include <vecmath/vec.h>
 #include <vecmath/ray.h>
 #include "AABBTree.h"
+#include "Exceptions.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <limits>
 
 using AABB = AABBTree<double, 3, size_t>;
 using BOX = AABB::Box;
@@ -30,6 +35,7 @@ using VEC = vm::vec<AABB::FloatType, AABB::Components>;
 
 void assertTree(const std::string& exp, const AABB& actual);
 void assertIntersectors(const AABB& tree, const RAY& ray, std::initializer_list<AABB::DataType> items);
+AABB::EntryList makeGrid(size_t size);
 
 TEST(AABBTreeTest, createEmptyTree) {
     AABB tree;
@@ -468,6 +474,390 @@ TEST(AABBTreeTest, findIntersectorsFromInsideRootBBox) {
     assertIntersectors(tree, RAY(VEC(0.0,  0.0,  0.0), VEC::pos_x), { 2u });
 }
 
+TEST(AABBTreeTest, findIntersectorsOfBox) {
+    AABB tree;
+    tree.clearAndBuild(makeGrid(4));
+
+    std::set<AABB::DataType> actual;
+    tree.findIntersectors(BOX(VEC(-1.0, -1.0, -1.0), VEC(-0.5, -0.5, -0.5)), std::inserter(actual, std::end(actual)));
+    ASSERT_TRUE(actual.empty());
+
+    // touching boxes are included
+    tree.findIntersectors(BOX(VEC(0.5, 0.5, 0.5), VEC(0.75, 0.75, 0.75)), std::inserter(actual, std::end(actual)));
+    ASSERT_EQ(std::set<AABB::DataType>({ 0u }), actual);
+
+    actual.clear();
+    tree.findIntersectors(BOX(VEC(0.75, 0.25, 0.25), VEC(1.25, 0.25, 0.25)), std::inserter(actual, std::end(actual)));
+    ASSERT_EQ(std::set<AABB::DataType>({ 16u }), actual);
+
+    std::set<AABB::DataType> expected;
+    for (const auto& entry : makeGrid(4)) {
+        if (entry.first.intersects(BOX(VEC(0.6, 0.6, 0.6), VEC(2.2, 3.0, 1.0)))) {
+            expected.insert(entry.second);
+        }
+    }
+
+    actual.clear();
+    tree.findIntersectors(BOX(VEC(0.6, 0.6, 0.6), VEC(2.2, 3.0, 1.0)), std::inserter(actual, std::end(actual)));
+    ASSERT_EQ(expected, actual);
+}
+
+TEST(AABBTreeTest, clearAndBuildEmpty) {
+    AABB tree;
+    tree.insert(BOX(VEC(0.0, 0.0, 0.0), VEC(2.0, 1.0, 1.0)), 1u);
+    tree.clearAndBuild(AABB::EntryList());
+
+    ASSERT_TRUE(tree.empty());
+    ASSERT_EQ(0.0, tree.sahCost());
+}
+
+TEST(AABBTreeTest, clearAndBuildSingleEntry) {
+    const BOX bounds(VEC(0.0, 0.0, 0.0), VEC(2.0, 1.0, 1.0));
+
+    AABB tree;
+    tree.clearAndBuild({ { bounds, 1u } });
+
+    assertTree(R"(
+L [ ( 0 0 0 ) ( 2 1 1 ) ]: 1
+)" , tree);
+}
+
+TEST(AABBTreeTest, clearAndBuildThreeEntries) {
+    const BOX bounds1(VEC(0.0, 0.0, 0.0), VEC(2.0, 1.0, 1.0));
+    const BOX bounds2(VEC(-1.0, -1.0, -1.0), VEC(1.0, 1.0, 1.0));
+    const BOX bounds3(VEC(-2.0, -2.0, -1.0), VEC(0.0, 0.0, 1.0));
+
+    AABB tree;
+    tree.clearAndBuild({ { bounds1, 1u }, { bounds2, 2u }, { bounds3, 3u } });
+
+    ASSERT_FALSE(tree.empty());
+    ASSERT_EQ(3u, tree.height());
+    ASSERT_EQ(merge(merge(bounds1, bounds2), bounds3), tree.bounds());
+    ASSERT_TRUE(tree.contains(bounds1, 1u));
+    ASSERT_TRUE(tree.contains(bounds2, 2u));
+    ASSERT_TRUE(tree.contains(bounds3, 3u));
+
+    assertIntersectors(tree, RAY(VEC(-3.0, -1.5,  0.0), VEC::pos_x), { 3u });
+    assertIntersectors(tree, RAY(VEC(-3.0,  0.5,  0.5), VEC::pos_x), { 1u, 2u });
+}
+
+TEST(AABBTreeTest, clearAndBuildCoincidentEntries) {
+    const BOX bounds(VEC(-1.0, -1.0, -1.0), VEC(1.0, 1.0, 1.0));
+
+    AABB::EntryList entries;
+    for (size_t i = 0; i < 64; ++i) {
+        entries.emplace_back(bounds, i);
+    }
+
+    AABB tree;
+    tree.clearAndBuild(entries);
+
+    ASSERT_EQ(7u, tree.height());
+    for (const auto& entry : entries) {
+        ASSERT_TRUE(tree.contains(entry.first, entry.second));
+    }
+}
+
+TEST(AABBTreeTest, clearAndBuildInvalidBounds) {
+    const auto nan = std::numeric_limits<double>::quiet_NaN();
+
+    AABB tree;
+    ASSERT_THROW(tree.clearAndBuild({ { BOX(VEC(0.0, 0.0, 0.0), VEC(nan, 1.0, 1.0)), 1u } }), NodeTreeException);
+    ASSERT_TRUE(tree.empty());
+}
+
+TEST(AABBTreeTest, clearAndBuildMatchesIncrementalTree) {
+    const auto entries = makeGrid(8);
+
+    AABB incremental;
+    for (const auto& entry : entries) {
+        incremental.insert(entry.first, entry.second);
+    }
+
+    AABB bulk;
+    bulk.clearAndBuild(entries);
+
+    ASSERT_EQ(incremental.bounds(), bulk.bounds());
+    for (const auto& entry : entries) {
+        ASSERT_TRUE(bulk.contains(entry.first, entry.second));
+    }
+
+    // a balanced tree over 512 leafs has height 10
+    ASSERT_EQ(10u, bulk.height());
+    ASSERT_LE(bulk.sahCost(), incremental.sahCost());
+
+    const RAY rays[] = {
+        RAY(VEC(-1.0,  0.5,  0.5), VEC::pos_x),
+        RAY(VEC(-1.0, -1.0, -1.0), normalize(VEC(1.0, 1.0, 1.0))),
+        RAY(VEC( 3.2,  4.7, 20.0), VEC::neg_z),
+        RAY(VEC( 3.2,  4.7, 20.0), VEC::pos_z),
+    };
+
+    for (const auto& ray : rays) {
+        std::set<AABB::DataType> expected;
+        incremental.findIntersectors(ray, std::inserter(expected, std::end(expected)));
+
+        std::set<AABB::DataType> actual;
+        bulk.findIntersectors(ray, std::inserter(actual, std::end(actual)));
+
+        ASSERT_EQ(expected, actual);
+    }
+}
+
+TEST(AABBTreeTest, clearAndBuildInParallel) {
+    // large enough to build subtrees on separate threads
+    const auto entries = makeGrid(16);
+
+    AABB sequential;
+    sequential.clearAndBuild(entries, 1);
+
+    AABB parallel;
+    parallel.clearAndBuild(entries, 4);
+
+    std::stringstream expected;
+    sequential.print(expected);
+
+    std::stringstream actual;
+    parallel.print(actual);
+
+    ASSERT_EQ(expected.str(), actual.str());
+}
+
+TEST(AABBTreeTest, clearAndBuildUsesSharedWorkerThreads) {
+    const auto entries = makeGrid(16);
+    const auto workerCount = std::max(TrenchBroom::workerThreadCount(), TrenchBroom::defaultThreadCount() - 1u);
+
+    // the subtrees are built on parallelFor's workers, which are not grown beyond the hardware threads
+    AABB parallel;
+    parallel.clearAndBuild(entries, 256);
+    ASSERT_LE(TrenchBroom::workerThreadCount(), workerCount);
+
+    AABB sequential;
+    sequential.clearAndBuild(entries, 1);
+
+    std::stringstream expected;
+    sequential.print(expected);
+
+    std::stringstream actual;
+    parallel.print(actual);
+
+    ASSERT_EQ(expected.str(), actual.str());
+}
+
+TEST(AABBTreeTest, snapshotOfEmptyTree) {
+    AABB tree;
+    const AABB::Snapshot snapshot(tree);
+
+    ASSERT_TRUE(snapshot.empty());
+
+    std::vector<AABB::DataType> actual;
+    snapshot.findIntersectors(RAY(VEC::zero, VEC::pos_x), std::back_inserter(actual));
+    snapshot.findContainers(VEC::zero, std::back_inserter(actual));
+    ASSERT_TRUE(actual.empty());
+}
+
+TEST(AABBTreeTest, snapshotUsesExactLeafBounds) {
+    // 0.1 and 0.3 are not representable as floats
+    AABB tree;
+    tree.insert(BOX(VEC(0.1, 0.1, 0.1), VEC(0.3, 0.3, 0.3)), 1u);
+    tree.insert(BOX(VEC(0.3, 0.1, 0.1), VEC(0.5, 0.3, 0.3)), 2u);
+
+    const AABB::Snapshot snapshot(tree);
+
+    std::set<AABB::DataType> actual;
+    snapshot.findContainers(VEC(0.1, 0.1, 0.1), std::inserter(actual, std::end(actual)));
+    ASSERT_EQ(std::set<AABB::DataType>({ 1u }), actual);
+
+    actual.clear();
+    snapshot.findContainers(VEC(0.3, 0.3, 0.3), std::inserter(actual, std::end(actual)));
+    ASSERT_EQ(std::set<AABB::DataType>({ 1u, 2u }), actual);
+
+    actual.clear();
+    snapshot.findContainers(VEC(0.5, 0.2, 0.2), std::inserter(actual, std::end(actual)));
+    ASSERT_EQ(std::set<AABB::DataType>({ 2u }), actual);
+
+    actual.clear();
+    snapshot.findIntersectors(RAY(VEC(0.0, 0.3, 0.3), VEC::pos_x), std::inserter(actual, std::end(actual)));
+    ASSERT_EQ(std::set<AABB::DataType>({ 1u, 2u }), actual);
+
+    actual.clear();
+    snapshot.findIntersectors(RAY(VEC(0.0, 0.30000001, 0.3), VEC::pos_x), std::inserter(actual, std::end(actual)));
+    ASSERT_TRUE(actual.empty());
+}
+
+TEST(AABBTreeTest, snapshotMatchesTree) {
+    AABB tree;
+    for (const auto& entry : makeGrid(8)) {
+        tree.insert(entry.first, entry.second);
+    }
+
+    const AABB::Snapshot snapshot(tree);
+    ASSERT_FALSE(snapshot.empty());
+
+    const RAY rays[] = {
+        RAY(VEC(-1.0,  0.5,  0.5), VEC::pos_x),
+        RAY(VEC(-1.0,  0.7,  0.7), VEC::pos_x),
+        RAY(VEC(-1.0, -1.0, -1.0), normalize(VEC(1.0, 1.0, 1.0))),
+        RAY(VEC( 3.2,  4.7, 20.0), VEC::neg_z),
+        RAY(VEC( 3.2,  4.7, 20.0), VEC::pos_z),
+        RAY(VEC( 3.2,  4.2,  2.2), normalize(VEC(-1.0, 0.3, 2.0))),
+    };
+
+    for (const auto& ray : rays) {
+        std::set<AABB::DataType> expected;
+        tree.findIntersectors(ray, std::inserter(expected, std::end(expected)));
+
+        std::set<AABB::DataType> actual;
+        snapshot.findIntersectors(ray, std::inserter(actual, std::end(actual)));
+
+        ASSERT_EQ(expected, actual);
+    }
+
+    const VEC points[] = {
+        VEC(0.0, 0.0, 0.0),
+        VEC(0.5, 0.5, 0.5),
+        VEC(0.75, 0.5, 0.5),
+        VEC(3.25, 4.5, 7.0),
+        VEC(9.0, 9.0, 9.0),
+    };
+
+    for (const auto& point : points) {
+        std::set<AABB::DataType> expected;
+        tree.findContainers(point, std::inserter(expected, std::end(expected)));
+
+        std::set<AABB::DataType> actual;
+        snapshot.findContainers(point, std::inserter(actual, std::end(actual)));
+
+        ASSERT_EQ(expected, actual);
+    }
+}
+
+TEST(AABBTreeTest, snapshotOfDeepTree) {
+    // nested boxes degenerate the tree into a list that is too deep for the local traversal stack
+    AABB tree;
+    for (size_t i = 1; i <= 512; ++i) {
+        const auto size = static_cast<double>(i);
+        tree.insert(BOX(VEC(-size, -size, -size), VEC(size, size, size)), i);
+    }
+
+    const AABB::Snapshot snapshot(tree);
+
+    const VEC points[] = {
+        VEC(0.0, 0.0, 0.0),
+        VEC(100.5, 0.0, 0.0),
+        VEC(511.5, 511.5, 511.5),
+        VEC(600.0, 0.0, 0.0),
+    };
+
+    for (const auto& point : points) {
+        std::set<AABB::DataType> expected;
+        tree.findContainers(point, std::inserter(expected, std::end(expected)));
+
+        std::set<AABB::DataType> actual;
+        snapshot.findContainers(point, std::inserter(actual, std::end(actual)));
+
+        ASSERT_EQ(expected, actual);
+    }
+}
+
+TEST(AABBTreeTest, updateBatch) {
+    auto entries = makeGrid(8);
+
+    AABB tree;
+    tree.clearAndBuild(entries);
+
+    // move a corner of the grid far away, so that the refitted subtrees must be rebuilt
+    AABB::UpdateList updates;
+    for (auto& entry : entries) {
+        if (entry.first.min.x() < 2.0 && entry.first.min.y() < 2.0) {
+            const auto newBounds = entry.first.translate(VEC(20.0, 0.0, 0.0));
+            updates.push_back(AABB::Update{ entry.first, newBounds, entry.second });
+            entry.first = newBounds;
+        }
+    }
+    ASSERT_EQ(32u, updates.size());
+
+    tree.update(updates);
+
+    AABB expected;
+    expected.clearAndBuild(entries);
+
+    ASSERT_EQ(expected.bounds(), tree.bounds());
+    for (const auto& update : updates) {
+        ASSERT_FALSE(tree.contains(update.oldBounds, update.data));
+    }
+    for (const auto& entry : entries) {
+        ASSERT_TRUE(tree.contains(entry.first, entry.second));
+    }
+    ASSERT_LE(tree.sahCost(), 1.5 * expected.sahCost());
+
+    const RAY rays[] = {
+        RAY(VEC(-1.0,  0.5,  0.5), VEC::pos_x),
+        RAY(VEC(-1.0, -1.0, -1.0), normalize(VEC(1.0, 1.0, 1.0))),
+        RAY(VEC(21.2,  1.2, 20.0), VEC::neg_z),
+        RAY(VEC( 3.2,  4.7, 20.0), VEC::neg_z),
+    };
+
+    for (const auto& ray : rays) {
+        std::set<AABB::DataType> expectedIntersectors;
+        expected.findIntersectors(ray, std::inserter(expectedIntersectors, std::end(expectedIntersectors)));
+
+        std::set<AABB::DataType> actualIntersectors;
+        tree.findIntersectors(ray, std::inserter(actualIntersectors, std::end(actualIntersectors)));
+
+        ASSERT_EQ(expectedIntersectors, actualIntersectors);
+    }
+}
+
+TEST(AABBTreeTest, updateBatchKeepsStructureOfTranslatedTree) {
+    const auto entries = makeGrid(4);
+
+    AABB tree;
+    tree.clearAndBuild(entries);
+
+    AABB::UpdateList updates;
+    AABB::EntryList translated;
+    for (const auto& entry : entries) {
+        const auto newBounds = entry.first.translate(VEC(100.0, 0.0, 0.0));
+        updates.push_back(AABB::Update{ entry.first, newBounds, entry.second });
+        translated.emplace_back(newBounds, entry.second);
+    }
+
+    tree.update(updates);
+
+    AABB expected;
+    expected.clearAndBuild(translated);
+
+    std::stringstream expectedStr;
+    expected.print(expectedStr);
+
+    std::stringstream actualStr;
+    tree.print(actualStr);
+
+    ASSERT_EQ(expectedStr.str(), actualStr.str());
+}
+
+TEST(AABBTreeTest, updateBatchWithMissingLeaf) {
+    const auto entries = makeGrid(4);
+
+    AABB tree;
+    tree.clearAndBuild(entries);
+
+    AABB::UpdateList updates;
+    for (const auto& entry : entries) {
+        updates.push_back(AABB::Update{ entry.first, entry.first.translate(VEC(0.0, 0.0, 10.0)), entry.second });
+    }
+    updates.push_back(AABB::Update{ BOX(VEC(-2.0, -2.0, -2.0), VEC(-1.0, -1.0, -1.0)), BOX(VEC::zero, VEC::one), 1000u });
+
+    ASSERT_THROW(tree.update(updates), NodeTreeException);
+
+    // the preceding updates were applied and the tree is consistent
+    ASSERT_EQ(BOX(VEC(0.0, 0.0, 10.0), VEC(3.5, 3.5, 13.5)), tree.bounds());
+    for (const auto& entry : entries) {
+        ASSERT_TRUE(tree.contains(entry.first.translate(VEC(0.0, 0.0, 10.0)), entry.second));
+    }
+}
+
 void assertTree(const std::string& exp, const AABB& actual) {
     std::stringstream str;
     actual.print(str);
@@ -482,3 +872,16 @@ void assertIntersectors(const AABB& tree, const RAY& ray, std::initializer_list<
 
     ASSERT_EQ(expected, actual);
 }
+
+AABB::EntryList makeGrid(const size_t size) {
+    AABB::EntryList result;
+    for (size_t x = 0; x < size; ++x) {
+        for (size_t y = 0; y < size; ++y) {
+            for (size_t z = 0; z < size; ++z) {
+                const auto min = VEC(static_cast<double>(x), static_cast<double>(y), static_cast<double>(z));
+                result.emplace_back(BOX(min, min + VEC(0.5, 0.5, 0.5)), result.size());
+            }
+        }
+    }
+    return result;
+}
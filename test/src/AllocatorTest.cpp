@@ -0,0 +1,97 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Allocator.h"
+#include "ParallelFor.h"
+
+#include <thread>
+#include <vector>
+
+namespace TrenchBroom {
+    class AllocatorTestObject : public Allocator<AllocatorTestObject> {
+    public:
+        size_t value;
+
+        explicit AllocatorTestObject(const size_t i_value) :
+        value(i_value) {}
+    };
+
+    TEST(AllocatorTest, allocateOnSeveralThreads) {
+        std::vector<AllocatorTestObject*> objects(10000);
+        parallelFor(objects.size(), [&](const size_t i) {
+            objects[i] = new AllocatorTestObject(i);
+        }, 4);
+
+        for (size_t i = 0; i < objects.size(); ++i) {
+            ASSERT_EQ(i, objects[i]->value);
+        }
+
+        parallelFor(objects.size(), [&](const size_t i) {
+            delete objects[i];
+        }, 4);
+    }
+
+    TEST(AllocatorTest, deleteOnOtherThread) {
+        std::vector<AllocatorTestObject*> objects;
+        std::thread allocate([&]() {
+            for (size_t i = 0; i < 1000; ++i) {
+                objects.push_back(new AllocatorTestObject(i));
+            }
+        });
+        allocate.join();
+
+        // the slots end up in the cache of this thread, and are reused from there
+        for (auto* object : objects) {
+            delete object;
+        }
+
+        auto* object = new AllocatorTestObject(1);
+        ASSERT_EQ(1u, object->value);
+        delete object;
+    }
+
+    TEST(AllocatorTest, allocateFromArenaWithSeveralPages) {
+        const size_t blockSize = AllocatorTestObject::arenaBlockSize();
+        const size_t count = 3 * AllocatorPage::Size / blockSize;
+
+        AllocatorArena* arena = AllocatorArena::create(count * blockSize, blockSize);
+        ASSERT_NE(nullptr, arena);
+
+        std::vector<AllocatorTestObject*> objects;
+        for (size_t i = 0; i < count; ++i) {
+            objects.push_back(new (*arena) AllocatorTestObject(i));
+            // every object must come from the arena, none from the pool
+            ASSERT_EQ(arena, AllocatorPage::of(objects.back())->arena);
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            ASSERT_EQ(i, objects[i]->value);
+        }
+
+        // the last object frees the arena
+        std::thread release([&]() {
+            for (auto* object : objects) {
+                delete object;
+            }
+        });
+        release.join();
+    }
+}
@@ -0,0 +1,202 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Exceptions.h"
+#include "Assets/EntityModel.h"
+#include "Assets/EntityModelManager.h"
+#include "IO/EntityModelLoader.h"
+#include "IO/Path.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace TrenchBroom {
+    namespace Assets {
+        class TestEntityModelLoader : public IO::EntityModelLoader {
+        public:
+            mutable std::atomic<size_t> loadCount;
+
+            TestEntityModelLoader() :
+            loadCount(0) {}
+        private:
+            EntityModel* doLoadEntityModel(const IO::Path& path) const override {
+                ++loadCount;
+                if (path.extension() != "mdl") {
+                    throw GameException("Unsupported model format '" + path.asString() + "'");
+                }
+                return new EntityModel(path.asString());
+            }
+        };
+
+        class SlowEntityModelLoader : public IO::EntityModelLoader {
+        public:
+            mutable std::atomic<size_t> activeLoads;
+            mutable std::atomic<size_t> loadCount;
+
+            SlowEntityModelLoader() :
+            activeLoads(0),
+            loadCount(0) {}
+        private:
+            EntityModel* doLoadEntityModel(const IO::Path& path) const override {
+                ++activeLoads;
+                ++loadCount;
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                --activeLoads;
+                return new EntityModel(path.asString());
+            }
+        };
+
+        static void waitForModels(EntityModelManager& manager) {
+            const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (manager.loading() && std::chrono::steady_clock::now() < timeout) {
+                manager.collectLoadedModels();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            ASSERT_FALSE(manager.loading());
+        }
+
+        TEST(EntityModelManagerTest, requestModelLoadsInBackground) {
+            TestEntityModelLoader loader;
+            EntityModelManager manager(nullptr, 0, 0);
+            manager.setLoader(&loader);
+
+            const IO::Path path("progs/player.mdl");
+            const auto loadGeneration = manager.loadGeneration();
+
+            ASSERT_EQ(nullptr, manager.requestModel(path));
+            ASSERT_EQ(nullptr, manager.requestModel(path));
+            ASSERT_TRUE(manager.loading());
+
+            waitForModels(manager);
+
+            auto* model = manager.requestModel(path);
+            ASSERT_NE(nullptr, model);
+            ASSERT_EQ(model, manager.model(path));
+            ASSERT_EQ(1u, loader.loadCount.load());
+            ASSERT_EQ(loadGeneration + 1u, manager.loadGeneration());
+        }
+
+        TEST(EntityModelManagerTest, requestManyModels) {
+            TestEntityModelLoader loader;
+            EntityModelManager manager(nullptr, 0, 0);
+            manager.setLoader(&loader);
+
+            for (size_t i = 0; i < 100; ++i) {
+                manager.requestModel(IO::Path("progs/model" + std::to_string(i) + ".mdl"));
+            }
+
+            waitForModels(manager);
+
+            for (size_t i = 0; i < 100; ++i) {
+                ASSERT_NE(nullptr, manager.requestModel(IO::Path("progs/model" + std::to_string(i) + ".mdl")));
+            }
+            ASSERT_EQ(100u, loader.loadCount.load());
+        }
+
+        TEST(EntityModelManagerTest, requestModelThatCannotBeLoaded) {
+            TestEntityModelLoader loader;
+            EntityModelManager manager(nullptr, 0, 0);
+            manager.setLoader(&loader);
+
+            const IO::Path path("progs/player.abc");
+            const auto loadGeneration = manager.loadGeneration();
+
+            ASSERT_EQ(nullptr, manager.requestModel(path));
+            waitForModels(manager);
+
+            ASSERT_EQ(nullptr, manager.requestModel(path));
+            ASSERT_FALSE(manager.loading());
+            ASSERT_EQ(1u, loader.loadCount.load());
+            ASSERT_EQ(loadGeneration, manager.loadGeneration());
+        }
+
+        TEST(EntityModelManagerTest, loadModelWhileLoadingInBackground) {
+            TestEntityModelLoader loader;
+            EntityModelManager manager(nullptr, 0, 0);
+            manager.setLoader(&loader);
+
+            const IO::Path path("progs/player.mdl");
+            ASSERT_EQ(nullptr, manager.requestModel(path));
+
+            auto* model = manager.model(path);
+            ASSERT_NE(nullptr, model);
+
+            waitForModels(manager);
+            ASSERT_EQ(model, manager.requestModel(path));
+        }
+
+        TEST(EntityModelManagerTest, clearCancelsLoads) {
+            TestEntityModelLoader loader;
+            EntityModelManager manager(nullptr, 0, 0);
+            manager.setLoader(&loader);
+
+            for (size_t i = 0; i < 100; ++i) {
+                manager.requestModel(IO::Path("progs/model" + std::to_string(i) + ".mdl"));
+            }
+
+            manager.clear();
+            ASSERT_FALSE(manager.loading());
+            ASSERT_FALSE(manager.collectLoadedModels());
+
+            // models are requested again after clearing the manager
+            ASSERT_EQ(nullptr, manager.requestModel(IO::Path("progs/model0.mdl")));
+            waitForModels(manager);
+            ASSERT_NE(nullptr, manager.requestModel(IO::Path("progs/model0.mdl")));
+        }
+
+        TEST(EntityModelManagerTest, cancelLoadsWaitsForLoadsInProgress) {
+            SlowEntityModelLoader loader;
+            EntityModelManager manager(nullptr, 0, 0);
+            manager.setLoader(&loader);
+
+            for (size_t i = 0; i < 100; ++i) {
+                manager.requestModel(IO::Path("progs/model" + std::to_string(i) + ".mdl"));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+            manager.cancelLoads();
+            ASSERT_EQ(0u, loader.activeLoads.load());
+            ASSERT_FALSE(manager.loading());
+
+            // no further loads are started after cancelling
+            const auto loadCount = loader.loadCount.load();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            ASSERT_EQ(loadCount, loader.loadCount.load());
+            ASSERT_LT(loadCount, 100u);
+        }
+
+        TEST(EntityModelManagerTest, modelLoadedCallback) {
+            TestEntityModelLoader loader;
+            EntityModelManager manager(nullptr, 0, 0);
+            manager.setLoader(&loader);
+
+            std::atomic<size_t> callbacks(0);
+            manager.setModelLoadedCallback([&]() { ++callbacks; });
+
+            manager.requestModel(IO::Path("progs/player.mdl"));
+            manager.requestModel(IO::Path("progs/player.abc"));
+            waitForModels(manager);
+
+            ASSERT_EQ(2u, callbacks.load());
+        }
+    }
+}
@@ -0,0 +1,153 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "ByteBuffer.h"
+#include "Color.h"
+#include "Assets/Palette.h"
+
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Assets {
+        // the straightforward implementation that the lookup table and histogram must match exactly
+        static bool referenceIndexedToRgba(const unsigned char* palette, const unsigned char* indexedImage, const size_t pixelCount, std::vector<unsigned char>& rgbaImage, const PaletteTransparency transparency, Color& averageColor) {
+            double avg[3];
+            avg[0] = avg[1] = avg[2] = 0.0;
+            bool hasTransparency = false;
+            for (size_t i = 0; i < pixelCount; ++i) {
+                const size_t index = static_cast<size_t>(indexedImage[i]);
+                for (size_t j = 0; j < 3; ++j) {
+                    const unsigned char c = palette[index * 3 + j];
+                    rgbaImage[i * 4 + j] = c;
+                    avg[j] += static_cast<double>(c);
+                }
+                switch (transparency) {
+                    case PaletteTransparency::Opaque:
+                        rgbaImage[i * 4 + 3] = 0xFF;
+                        break;
+                    case PaletteTransparency::Index255Transparent:
+                        rgbaImage[i * 4 + 3] = (index == 255) ? 0x00 : 0xFF;
+                        hasTransparency |= (index == 255);
+                        break;
+                }
+            }
+
+            for (size_t i = 0; i < 3; ++i) {
+                averageColor[i] = static_cast<float>(avg[i] / pixelCount / 0xFF);
+            }
+            averageColor[3] = 1.0f;
+
+            return hasTransparency;
+        }
+
+        static Palette makePalette(std::mt19937& random, std::vector<unsigned char>& data) {
+            std::uniform_int_distribution<int> byte(0, 255);
+            data.resize(3 * 256);
+            for (auto& c : data) {
+                c = static_cast<unsigned char>(byte(random));
+            }
+            return Palette::fromRaw(data.size(), data.data());
+        }
+
+        static void assertMatchesReference(const Palette& palette, const unsigned char* paletteData, const std::vector<unsigned char>& indices, const PaletteTransparency transparency) {
+            const auto pixelCount = indices.size();
+
+            std::vector<unsigned char> expectedImage(4 * pixelCount);
+            Color expectedColor;
+            const auto expectedTransparency = referenceIndexedToRgba(paletteData, indices.data(), pixelCount, expectedImage, transparency, expectedColor);
+
+            Buffer<unsigned char> actualImage(4 * pixelCount);
+            Color actualColor;
+            const auto actualTransparency = palette.indexedToRgba(indices.data(), pixelCount, actualImage, transparency, actualColor);
+
+            ASSERT_EQ(expectedTransparency, actualTransparency);
+            ASSERT_EQ(0, std::memcmp(expectedImage.data(), actualImage.ptr(), expectedImage.size()));
+            for (size_t i = 0; i < 4; ++i) {
+                // the average must be bit for bit identical, not just close
+                ASSERT_EQ(expectedColor[i], actualColor[i]);
+            }
+        }
+
+        TEST(PaletteTest, indexedToRgbaMatchesReference) {
+            std::mt19937 random(42);
+            std::vector<unsigned char> paletteData;
+            const auto palette = makePalette(random, paletteData);
+
+            std::uniform_int_distribution<int> byte(0, 255);
+            // sizes that are not multiples of the vector width, and the sizes of typical mip levels
+            for (const size_t pixelCount : { 1u, 3u, 7u, 8u, 9u, 31u, 33u, 100u, 16u * 16u, 64u * 64u, 256u * 256u + 5u }) {
+                std::vector<unsigned char> indices(pixelCount);
+                for (auto& index : indices) {
+                    index = static_cast<unsigned char>(byte(random));
+                }
+
+                assertMatchesReference(palette, paletteData.data(), indices, PaletteTransparency::Opaque);
+                assertMatchesReference(palette, paletteData.data(), indices, PaletteTransparency::Index255Transparent);
+            }
+        }
+
+        TEST(PaletteTest, indexedToRgbaTransparency) {
+            std::mt19937 random(7);
+            std::vector<unsigned char> paletteData;
+            const auto palette = makePalette(random, paletteData);
+
+            // large uniform areas, with and without the transparent index
+            std::vector<unsigned char> opaque(1000, 17);
+            assertMatchesReference(palette, paletteData.data(), opaque, PaletteTransparency::Index255Transparent);
+
+            std::vector<unsigned char> masked(1000, 17);
+            masked[997] = 255;
+            assertMatchesReference(palette, paletteData.data(), masked, PaletteTransparency::Index255Transparent);
+            assertMatchesReference(palette, paletteData.data(), masked, PaletteTransparency::Opaque);
+
+            Buffer<unsigned char> rgbaImage(4 * masked.size());
+            Color averageColor;
+            ASSERT_TRUE(palette.indexedToRgba(masked.data(), masked.size(), rgbaImage, PaletteTransparency::Index255Transparent, averageColor));
+            ASSERT_EQ(0x00, rgbaImage[4 * 997 + 3]);
+            ASSERT_EQ(0xFF, rgbaImage[4 * 996 + 3]);
+            ASSERT_FALSE(palette.indexedToRgba(masked.data(), masked.size(), rgbaImage, PaletteTransparency::Opaque, averageColor));
+            ASSERT_EQ(0xFF, rgbaImage[4 * 997 + 3]);
+        }
+
+        TEST(PaletteTest, indexedToRgbaSignedIndices) {
+            std::mt19937 random(3);
+            std::vector<unsigned char> paletteData;
+            const auto palette = makePalette(random, paletteData);
+
+            // texture readers pass the indices as chars
+            std::vector<unsigned char> indices = { 0, 1, 127, 128, 200, 255 };
+            std::vector<char> signedIndices(indices.size());
+            std::memcpy(signedIndices.data(), indices.data(), indices.size());
+
+            Buffer<unsigned char> expected(4 * indices.size());
+            Buffer<unsigned char> actual(4 * indices.size());
+            Color expectedColor, actualColor;
+            palette.indexedToRgba(indices.data(), indices.size(), expected, PaletteTransparency::Opaque, expectedColor);
+            palette.indexedToRgba(signedIndices.data(), indices.size(), actual, PaletteTransparency::Opaque, actualColor);
+
+            ASSERT_EQ(0, std::memcmp(expected.ptr(), actual.ptr(), expected.size()));
+            ASSERT_EQ(expectedColor, actualColor);
+        }
+    }
+}
@@ -0,0 +1,127 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Logger.h"
+#include "Assets/Texture.h"
+#include "Assets/TextureCollection.h"
+#include "Assets/TextureManager.h"
+#include "IO/DiskFileSystem.h"
+#include "IO/DiskIO.h"
+#include "IO/Path.h"
+#include "IO/TextureLoader.h"
+#include "Model/GameConfig.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+namespace TrenchBroom {
+    namespace Assets {
+        class TextureManagerTest : public ::testing::Test {
+        protected:
+            NullLogger logger;
+            const IO::Path root;
+            const IO::DiskFileSystem fileSystem;
+            const Model::GameConfig::TextureConfig textureConfig;
+            TextureManager manager;
+
+            TextureManagerTest() :
+            root(IO::Disk::getCurrentWorkingDir()),
+            fileSystem(root, true),
+            textureConfig(Model::GameConfig::TexturePackageConfig(Model::GameConfig::PackageFormatConfig("wad", "idmip")),
+                          Model::GameConfig::PackageFormatConfig("D", "idmip"),
+                          IO::Path("data/palette.lmp"),
+                          "wad"),
+            manager(&logger, 0, 0) {}
+
+            void request(const IO::Path::List& paths) {
+                manager.requestTextureCollections(paths, [this](Logger* loadLogger) {
+                    return std::make_unique<IO::TextureLoader>(fileSystem, IO::Path::List{ root }, textureConfig, loadLogger);
+                });
+            }
+
+            void waitForCollections() {
+                const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+                while (manager.loading() && std::chrono::steady_clock::now() < timeout) {
+                    manager.collectLoadedCollections();
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                ASSERT_FALSE(manager.loading());
+            }
+        };
+
+        TEST_F(TextureManagerTest, requestTextureCollectionsLoadsInBackground) {
+            const auto loadGeneration = manager.loadGeneration();
+            request({ IO::Path("data/IO/Wad/cr8_czg.wad") });
+
+            // a placeholder is added right away
+            ASSERT_EQ(1u, manager.collections().size());
+            ASSERT_FALSE(manager.collections().front()->loaded());
+            ASSERT_TRUE(manager.textures().empty());
+
+            waitForCollections();
+
+            ASSERT_EQ(1u, manager.collections().size());
+            ASSERT_TRUE(manager.collections().front()->loaded());
+            ASSERT_EQ(IO::Path("data/IO/Wad/cr8_czg.wad"), manager.collections().front()->path());
+            ASSERT_FALSE(manager.textures().empty());
+            ASSERT_NE(nullptr, manager.texture("cr8_czg_1"));
+            ASSERT_EQ(loadGeneration + 1u, manager.loadGeneration());
+
+            // loaded collections are kept when requested again
+            auto* collection = manager.collections().front();
+            request({ IO::Path("data/IO/Wad/cr8_czg.wad") });
+            ASSERT_FALSE(manager.loading());
+            ASSERT_EQ(collection, manager.collections().front());
+        }
+
+        TEST_F(TextureManagerTest, requestTextureCollectionThatCannotBeLoaded) {
+            const auto loadGeneration = manager.loadGeneration();
+            request({ IO::Path("data/IO/Wad/does_not_exist.wad") });
+            waitForCollections();
+
+            ASSERT_EQ(1u, manager.collections().size());
+            ASSERT_FALSE(manager.collections().front()->loaded());
+            ASSERT_TRUE(manager.textures().empty());
+            ASSERT_EQ(loadGeneration, manager.loadGeneration());
+        }
+
+        TEST_F(TextureManagerTest, clearCancelsLoads) {
+            request({ IO::Path("data/IO/Wad/cr8_czg.wad") });
+
+            manager.clear();
+            ASSERT_FALSE(manager.loading());
+            ASSERT_FALSE(manager.collectLoadedCollections());
+            ASSERT_TRUE(manager.collections().empty());
+        }
+
+        TEST_F(TextureManagerTest, collectionLoadedCallback) {
+            std::atomic<size_t> callbacks(0);
+            manager.setCollectionLoadedCallback([&]() { ++callbacks; });
+
+            request({ IO::Path("data/IO/Wad/cr8_czg.wad"), IO::Path("data/IO/Wad/does_not_exist.wad") });
+            waitForCollections();
+
+            ASSERT_EQ(2u, callbacks.load());
+        }
+    }
+}
@@ -0,0 +1,99 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Assets/TextureName.h"
+
+#include <thread>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Assets {
+        TEST(TextureNameTest, emptyName) {
+            const TextureName name;
+            ASSERT_TRUE(name.empty());
+            ASSERT_EQ(String(""), name.name());
+            ASSERT_EQ(0u, name.id());
+            ASSERT_EQ(name, TextureName(String("")));
+        }
+
+        TEST(TextureNameTest, internName) {
+            const TextureName name1(String("e1u1/floor1_3"));
+            const TextureName name2(std::string_view("e1u1/floor1_3"));
+            const TextureName name3(String("e1u1/floor1_4"));
+
+            ASSERT_FALSE(name1.empty());
+            ASSERT_EQ(String("e1u1/floor1_3"), name1.name());
+            ASSERT_EQ(name1, name2);
+            ASSERT_EQ(name1.id(), name2.id());
+            ASSERT_EQ(&name1.name(), &name2.name());
+            ASSERT_NE(name1, name3);
+            ASSERT_NE(name1.id(), name3.id());
+            ASSERT_LT(name3.id(), TextureName::count());
+        }
+
+        TEST(TextureNameTest, findDoesNotIntern) {
+            const size_t count = TextureName::count();
+
+            TextureName result;
+            ASSERT_FALSE(TextureName::find("e1u1/never_interned", result));
+            ASSERT_TRUE(result.empty());
+            ASSERT_EQ(count, TextureName::count());
+
+            const TextureName name(String("e1u1/interned"));
+            ASSERT_TRUE(TextureName::find("e1u1/interned", result));
+            ASSERT_EQ(name, result);
+        }
+
+        TEST(TextureNameTest, caseInsensitiveId) {
+            const TextureName upper(String("*WATER1"));
+            const TextureName mixed(String("*Water1"));
+            const TextureName lower(String("*water1"));
+
+            ASSERT_NE(upper, mixed);
+            ASSERT_NE(upper, lower);
+            ASSERT_EQ(lower.id(), lower.caseInsensitiveId());
+            ASSERT_EQ(lower.id(), upper.caseInsensitiveId());
+            ASSERT_EQ(lower.id(), mixed.caseInsensitiveId());
+        }
+
+        TEST(TextureNameTest, internFromMultipleThreads) {
+            static const size_t ThreadCount = 4;
+            static const size_t NameCount = 1000;
+
+            std::vector<std::vector<TextureName::Id>> ids(ThreadCount);
+            std::vector<std::thread> threads;
+            for (size_t i = 0; i < ThreadCount; ++i) {
+                threads.emplace_back([&ids, i]() {
+                    for (size_t j = 0; j < NameCount; ++j) {
+                        ids[i].push_back(TextureName("texture_" + std::to_string(j)).id());
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            for (size_t i = 1; i < ThreadCount; ++i) {
+                ASSERT_EQ(ids[0], ids[i]);
+            }
+        }
+    }
+}
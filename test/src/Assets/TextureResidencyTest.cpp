@@ -0,0 +1,232 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Assets/Texture.h"
+#include "Assets/TextureResidency.h"
+
+#include <memory>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Assets {
+        // the textures are never prepared, so no GL context is needed
+        class TextureResidencyTest : public ::testing::Test {
+        protected:
+            std::vector<std::unique_ptr<Texture>> m_textures;
+
+            Texture* texture(const size_t index) {
+                while (m_textures.size() <= index) {
+                    m_textures.push_back(std::make_unique<Texture>("texture" + std::to_string(m_textures.size()), 16, 16));
+                }
+                return m_textures[index].get();
+            }
+
+            void addTextures(TextureResidency& residency, const size_t count, const size_t size) {
+                for (size_t i = 0; i < count; ++i) {
+                    residency.add(texture(i), size);
+                }
+            }
+        };
+
+        TEST_F(TextureResidencyTest, uploadUsedTexturesOnly) {
+            TextureResidency residency(100);
+            addTextures(residency, 3, 10);
+            ASSERT_FALSE(residency.hasPendingUploads());
+
+            residency.use(texture(1));
+            residency.use(texture(1));
+            ASSERT_TRUE(residency.hasPendingUploads());
+
+            const auto changes = residency.update(100);
+            ASSERT_EQ(TextureList({ texture(1) }), changes.upload);
+            ASSERT_TRUE(changes.evict.empty());
+            ASSERT_FALSE(residency.hasPendingUploads());
+            ASSERT_TRUE(residency.resident(texture(1)));
+            ASSERT_FALSE(residency.resident(texture(0)));
+            ASSERT_EQ(10u, residency.residentBytes());
+
+            // using a resident texture does not upload it again
+            residency.use(texture(1));
+            ASSERT_FALSE(residency.hasPendingUploads());
+            ASSERT_TRUE(residency.update(100).upload.empty());
+        }
+
+        TEST_F(TextureResidencyTest, ignoreUnknownTextures) {
+            TextureResidency residency(100);
+            residency.use(texture(0));
+            ASSERT_FALSE(residency.hasPendingUploads());
+        }
+
+        TEST_F(TextureResidencyTest, uploadInBatches) {
+            TextureResidency residency(100);
+            addTextures(residency, 5, 10);
+            for (size_t i = 0; i < 5; ++i) {
+                residency.use(texture(i));
+            }
+
+            // the last texture of a batch may exceed the upload budget
+            ASSERT_EQ(TextureList({ texture(0), texture(1) }), residency.update(15).upload);
+            ASSERT_TRUE(residency.hasPendingUploads());
+            ASSERT_EQ(TextureList({ texture(2), texture(3) }), residency.update(15).upload);
+            ASSERT_EQ(TextureList({ texture(4) }), residency.update(15).upload);
+            ASSERT_FALSE(residency.hasPendingUploads());
+        }
+
+        TEST_F(TextureResidencyTest, evictLeastRecentlyUsed) {
+            TextureResidency residency(30);
+            addTextures(residency, 5, 10);
+
+            residency.use(texture(0));
+            residency.use(texture(1));
+            residency.use(texture(2));
+            residency.update(100);
+            ASSERT_EQ(30u, residency.residentBytes());
+
+            residency.nextFrame();
+            residency.use(texture(3));
+            auto changes = residency.update(100);
+            ASSERT_EQ(TextureList({ texture(3) }), changes.upload);
+            ASSERT_EQ(TextureList({ texture(0) }), changes.evict);
+            ASSERT_EQ(30u, residency.residentBytes());
+
+            // texture 1 is now the least recently used texture, unless it is used again
+            residency.nextFrame();
+            residency.use(texture(1));
+            residency.use(texture(4));
+            changes = residency.update(100);
+            ASSERT_EQ(TextureList({ texture(4) }), changes.upload);
+            ASSERT_EQ(TextureList({ texture(2) }), changes.evict);
+            ASSERT_TRUE(residency.resident(texture(1)));
+            ASSERT_FALSE(residency.resident(texture(2)));
+
+            // evicted textures are uploaded again when they are used
+            residency.nextFrame();
+            residency.use(texture(0));
+            changes = residency.update(100);
+            ASSERT_EQ(TextureList({ texture(0) }), changes.upload);
+            ASSERT_EQ(TextureList({ texture(3) }), changes.evict);
+        }
+
+        TEST_F(TextureResidencyTest, neverEvictTexturesUsedInCurrentFrame) {
+            TextureResidency residency(10);
+            addTextures(residency, 3, 10);
+
+            residency.use(texture(0));
+            residency.use(texture(1));
+            auto changes = residency.update(100);
+            ASSERT_EQ(2u, changes.upload.size());
+            ASSERT_TRUE(changes.evict.empty());
+            ASSERT_EQ(20u, residency.residentBytes());
+
+            // texture 0 was not used in this frame, so it is evicted
+            residency.nextFrame();
+            residency.use(texture(1));
+            changes = residency.update(100);
+            ASSERT_TRUE(changes.upload.empty());
+            ASSERT_EQ(TextureList({ texture(0) }), changes.evict);
+            ASSERT_EQ(10u, residency.residentBytes());
+        }
+
+        TEST_F(TextureResidencyTest, keepTexturesUsedByEveryViewInCurrentFrame) {
+            TextureResidency residency(10);
+            addTextures(residency, 2, 10);
+
+            // two views render different textures in the same frame
+            residency.use(texture(0));
+            residency.update(100);
+            residency.use(texture(1));
+            auto changes = residency.update(100);
+            ASSERT_EQ(TextureList({ texture(1) }), changes.upload);
+            ASSERT_TRUE(changes.evict.empty());
+            ASSERT_TRUE(residency.resident(texture(0)));
+
+            residency.nextFrame();
+            residency.use(texture(1));
+            changes = residency.update(100);
+            ASSERT_EQ(TextureList({ texture(0) }), changes.evict);
+        }
+
+        TEST_F(TextureResidencyTest, lowerBudget) {
+            TextureResidency residency(100);
+            addTextures(residency, 4, 10);
+            for (size_t i = 0; i < 4; ++i) {
+                residency.use(texture(i));
+            }
+            residency.update(100);
+            ASSERT_EQ(40u, residency.residentBytes());
+
+            residency.setBudget(20);
+            residency.nextFrame();
+            residency.use(texture(0));
+            const auto changes = residency.update(100);
+            ASSERT_EQ(TextureList({ texture(1), texture(2) }), changes.evict);
+            ASSERT_EQ(20u, residency.residentBytes());
+        }
+
+        TEST_F(TextureResidencyTest, removeTextures) {
+            TextureResidency residency(100);
+            addTextures(residency, 3, 10);
+            residency.use(texture(0));
+            residency.update(100);
+
+            residency.use(texture(1));
+            ASSERT_TRUE(residency.hasPendingUploads());
+
+            residency.remove(texture(0));
+            residency.remove(texture(1));
+            ASSERT_EQ(0u, residency.residentBytes());
+            ASSERT_FALSE(residency.resident(texture(0)));
+            ASSERT_FALSE(residency.hasPendingUploads());
+
+            const auto changes = residency.update(100);
+            ASSERT_TRUE(changes.upload.empty());
+            ASSERT_TRUE(changes.evict.empty());
+        }
+
+        TEST_F(TextureResidencyTest, addResidentTexture) {
+            TextureResidency residency(10);
+            residency.add(texture(0), 10, true);
+            residency.add(texture(1), 10);
+            ASSERT_TRUE(residency.resident(texture(0)));
+            ASSERT_EQ(10u, residency.residentBytes());
+
+            residency.use(texture(1));
+            const auto changes = residency.update(100);
+            ASSERT_EQ(TextureList({ texture(1) }), changes.upload);
+            ASSERT_EQ(TextureList({ texture(0) }), changes.evict);
+        }
+
+        TEST_F(TextureResidencyTest, videoMemoryUsage) {
+            // OpenGL generates the mipmaps of textures with a single buffer
+            const Texture generated("generated", 16, 16, Color(), TextureBuffer(3 * 16 * 16), GL_RGB, TextureType::Opaque);
+            ASSERT_EQ(4u * 16u * 16u * 4u / 3u, generated.videoMemoryUsage());
+
+            TextureBuffer::List buffers;
+            setMipBufferSize(buffers, 4, 16, 16, GL_RGBA);
+            const Texture mipmapped("mipmapped", 16, 16, Color(), buffers, GL_RGBA, TextureType::Opaque);
+            ASSERT_EQ(4u * (16u * 16u + 8u * 8u + 4u * 4u + 2u * 2u), mipmapped.videoMemoryUsage());
+
+            // only the first mip level of masked textures is uploaded
+            const Texture masked("masked", 16, 16, Color(), buffers, GL_RGBA, TextureType::Masked);
+            ASSERT_EQ(4u * 16u * 16u, masked.videoMemoryUsage());
+        }
+    }
+}
@@ -21,6 +21,9 @@
 
 #include "DoublyLinkedList.h"
 
+#include <iterator>
+#include <vector>
+
 class Element;
 
 class GetElementLink {
@@ -837,3 +840,65 @@ TEST(DoublyLinkedListTest, clearThreeElementList) {
     ASSERT_TRUE(d2);
     ASSERT_TRUE(d3);
 }
+
+TEST(DoublyLinkedListTest, iterateEmptyList) {
+    ElementList list;
+    ASSERT_EQ(list.end(), list.begin());
+    ASSERT_EQ(list.cend(), list.cbegin());
+}
+
+TEST(DoublyLinkedListTest, iterateThreeElementList) {
+    bool d1 = false;
+    bool d2 = false;
+    bool d3 = false;
+
+    Element* e1 = new Element(d1);
+    Element* e2 = new Element(d2);
+    Element* e3 = new Element(d3);
+
+    ElementList list;
+    list.append(e1, 1);
+    list.append(e2, 1);
+    list.append(e3, 1);
+
+    std::vector<Element*> elements;
+    for (Element* element : list) {
+        elements.push_back(element);
+    }
+    ASSERT_EQ((std::vector<Element*>{ e1, e2, e3 }), elements);
+
+    auto it = list.begin();
+    const auto copy = it++;
+    ASSERT_EQ(e1, *copy);
+    ASSERT_EQ(e2, *it);
+    ASSERT_TRUE(copy < it);
+    ASSERT_EQ(e3, *++it);
+    ASSERT_EQ(list.end(), ++it);
+
+    const ElementList& constList = list;
+    ASSERT_EQ(3, std::distance(constList.begin(), constList.end()));
+}
+
+TEST(DoublyLinkedListTest, eraseWithIterator) {
+    bool d1 = false;
+    bool d2 = false;
+    bool d3 = false;
+
+    Element* e1 = new Element(d1);
+    Element* e2 = new Element(d2);
+    Element* e3 = new Element(d3);
+
+    ElementList list;
+    list.append(e1, 1);
+    list.append(e2, 1);
+    list.append(e3, 1);
+
+    auto it = std::next(list.begin());
+    it = list.erase(it);
+    ASSERT_EQ(e3, *it);
+    ASSERT_EQ(2u, list.size());
+    ASSERT_FALSE(list.contains(e2));
+
+    delete e2;
+    ASSERT_TRUE(d2);
+}
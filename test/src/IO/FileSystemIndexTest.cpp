@@ -0,0 +1,194 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Exceptions.h"
+#include "IO/DiskFileSystem.h"
+#include "IO/DiskIO.h"
+#include "IO/FileSystemIndex.h"
+#include "IO/IdPakFileSystem.h"
+#include "IO/MappedFile.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace TrenchBroom {
+    namespace IO {
+        class FileSystemIndexTest : public ::testing::Test {
+        protected:
+            std::unique_ptr<FileSystem> m_fileSystem;
+            const FileSystem* m_pak1;
+            const FileSystem* m_pak3;
+            const FileSystem* m_shadowedPak1;
+            const FileSystem* m_disk;
+
+            void SetUp() override {
+                const auto pakDir = Disk::getCurrentWorkingDir() + Path("data/IO/Pak");
+                const auto pak1Path = pakDir + Path("pak1.pak");
+                const auto pak3Path = pakDir + Path("pak3.pak");
+
+                // the chain is pak1 -> pak3 -> pak1 -> disk
+                m_fileSystem = std::make_unique<DiskFileSystem>(pakDir);
+                m_disk = m_fileSystem.get();
+                m_fileSystem = std::make_unique<IdPakFileSystem>(std::move(m_fileSystem), pak1Path, Disk::openFile(pak1Path));
+                m_shadowedPak1 = m_fileSystem.get();
+                m_fileSystem = std::make_unique<IdPakFileSystem>(std::move(m_fileSystem), pak3Path, Disk::openFile(pak3Path));
+                m_pak3 = m_fileSystem.get();
+                m_fileSystem = std::make_unique<IdPakFileSystem>(std::move(m_fileSystem), pak1Path, Disk::openFile(pak1Path));
+                m_pak1 = m_fileSystem.get();
+            }
+        };
+
+        static bool contains(const Path::List& paths, const Path& path) {
+            return std::find(std::begin(paths), std::end(paths), path) != std::end(paths);
+        }
+
+        TEST_F(FileSystemIndexTest, emptyIndex) {
+            FileSystemIndex index;
+            ASSERT_TRUE(index.empty());
+            ASSERT_EQ(nullptr, index.find(Path("pics/tag1.pcx")));
+            ASSERT_FALSE(index.fileExists(Path("pics/tag1.pcx")));
+            ASSERT_TRUE(index.directoryContents(Path("")).empty());
+            ASSERT_THROW(index.openFile(Path("pics/tag1.pcx")), FileSystemException);
+        }
+
+        TEST_F(FileSystemIndexTest, findShadowedItems) {
+            FileSystemIndex index;
+            index.build(*m_fileSystem);
+            ASSERT_FALSE(index.empty());
+
+            const auto* wal = index.find(Path("textures/e1u1/box1_3.wal"));
+            ASSERT_NE(nullptr, wal);
+            ASSERT_EQ(m_pak1, wal->fileSystem);
+            ASSERT_FALSE(wal->directory);
+
+            const auto* palette = index.find(Path("gfx/palette.lmp"));
+            ASSERT_NE(nullptr, palette);
+            ASSERT_EQ(m_pak3, palette->fileSystem);
+
+            const auto* pak = index.find(Path("pak3.pak"));
+            ASSERT_NE(nullptr, pak);
+            ASSERT_EQ(m_disk, pak->fileSystem);
+
+            ASSERT_NE(m_shadowedPak1, wal->fileSystem);
+        }
+
+        TEST_F(FileSystemIndexTest, caseInsensitiveLookup) {
+            FileSystemIndex index;
+            index.build(*m_fileSystem);
+
+            ASSERT_TRUE(index.fileExists(Path("GFX/Palette.LMP")));
+            ASSERT_TRUE(index.directoryExists(Path("Textures/E1U2")));
+            ASSERT_TRUE(index.directoryExists(Path("")));
+
+            ASSERT_FALSE(index.fileExists(Path("textures/e1u2")));
+            ASSERT_FALSE(index.directoryExists(Path("pics/tag1.pcx")));
+            ASSERT_FALSE(index.fileExists(Path("pics/tag3.pcx")));
+
+            // the entry keeps the case of the file system that contains it
+            ASSERT_EQ(Path("gfx/palette.lmp"), index.find(Path("GFX/PALETTE.LMP"))->path);
+        }
+
+        TEST_F(FileSystemIndexTest, directoryContents) {
+            FileSystemIndex index;
+            index.build(*m_fileSystem);
+
+            const auto root = index.directoryContents(Path(""));
+            ASSERT_EQ(8u, root.size());
+            for (const auto& name : { "pics", "textures", "amnet.cfg", "bear.cfg", "gfx", "pak1.pak", "pak3.pak", "dkpak_test.pak" }) {
+                ASSERT_TRUE(contains(root, Path(name))) << name;
+            }
+
+            const auto textures = index.directoryContents(Path("TEXTURES"));
+            ASSERT_EQ(3u, textures.size());
+            ASSERT_TRUE(contains(textures, Path("e1u1")));
+            ASSERT_TRUE(contains(textures, Path("e1u2")));
+            ASSERT_TRUE(contains(textures, Path("e1u3")));
+
+            const auto e1u2 = index.directoryContents(Path("textures/e1u2"));
+            ASSERT_EQ(3u, e1u2.size());
+            ASSERT_TRUE(contains(e1u2, Path("angle1_1.wal")));
+            ASSERT_TRUE(contains(e1u2, Path("angle1_2.wal")));
+            ASSERT_TRUE(contains(e1u2, Path("basic1_7.wal")));
+
+            ASSERT_TRUE(index.directoryContents(Path("pics/tag1.pcx")).empty());
+        }
+
+        TEST_F(FileSystemIndexTest, directoryContentsWithSiblingsThatExtendTheName) {
+            // "gfx.wad" and "gfx0.cfg" sort between "gfx" and "gfx/palette.lmp" in byte order
+            const auto dir = Disk::getCurrentWorkingDir() + Path("data/IO/FileSystemIndex");
+            const DiskFileSystem fileSystem(dir);
+
+            FileSystemIndex index;
+            index.build(fileSystem);
+
+            const auto root = index.directoryContents(Path(""));
+            ASSERT_EQ(3u, root.size());
+            ASSERT_TRUE(contains(root, Path("gfx")));
+            ASSERT_TRUE(contains(root, Path("gfx.wad")));
+            ASSERT_TRUE(contains(root, Path("gfx0.cfg")));
+
+            const auto gfx = index.directoryContents(Path("gfx"));
+            ASSERT_EQ(2u, gfx.size());
+            ASSERT_TRUE(contains(gfx, Path("palette.lmp")));
+            ASSERT_TRUE(contains(gfx, Path("sub")));
+
+            ASSERT_TRUE(index.fileExists(Path("gfx/sub/colormap.lmp")));
+            ASSERT_TRUE(index.fileExists(Path("gfx.wad")));
+        }
+
+        TEST_F(FileSystemIndexTest, matchesFileSystemChain) {
+            FileSystemIndex index;
+            index.build(*m_fileSystem);
+
+            const auto items = m_fileSystem->findItemsRecursively(Path(""), [](const Path&, bool) { return true; });
+            ASSERT_EQ(items.size(), index.size());
+
+            for (const auto& item : items) {
+                ASSERT_EQ(m_fileSystem->fileExists(item), index.fileExists(item)) << item;
+                ASSERT_EQ(m_fileSystem->directoryExists(item), index.directoryExists(item)) << item;
+                ASSERT_TRUE(contains(index.directoryContents(item.deleteLastComponent()), item.lastComponent())) << item;
+            }
+        }
+
+        TEST_F(FileSystemIndexTest, openFile) {
+            FileSystemIndex index;
+            index.build(*m_fileSystem);
+
+            const auto expected = m_fileSystem->openFile(Path("gfx/palette.lmp"));
+            const auto actual = index.openFile(Path("GFX/PALETTE.LMP"));
+            ASSERT_NE(nullptr, actual);
+            ASSERT_EQ(expected->size(), actual->size());
+            ASSERT_TRUE(std::equal(expected->begin(), expected->end(), actual->begin()));
+
+            ASSERT_THROW(index.openFile(Path("gfx")), FileSystemException);
+            ASSERT_THROW(index.openFile(Path("gfx/colormap.lmp")), FileSystemException);
+        }
+
+        TEST_F(FileSystemIndexTest, clear) {
+            FileSystemIndex index;
+            index.build(*m_fileSystem);
+            index.clear();
+
+            ASSERT_TRUE(index.empty());
+            ASSERT_FALSE(index.fileExists(Path("gfx/palette.lmp")));
+        }
+    }
+}
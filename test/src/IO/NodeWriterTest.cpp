@@ -30,6 +30,8 @@
 #include "Model/MapFormat.h"
 #include "Model/World.h"
 
+#include <cstdio>
+
 namespace TrenchBroom {
     namespace IO {
         TEST(NodeWriterTest, writeEmptyMap) {
@@ -479,5 +481,64 @@ namespace TrenchBroom {
                          "\"message\" \"holy damn\\nhe said\"\n"
                          "}\n", result.c_str());
         }
+
+        TEST(NodeWriterTest, writeManyBrushes) {
+            const vm::bbox3 worldBounds(8192.0);
+
+            Model::World map(Model::MapFormat::Standard, nullptr, worldBounds);
+            map.addOrUpdateAttribute("classname", "worldspawn");
+
+            // more brushes than are serialized in one batch
+            const size_t brushCount = 1536;
+
+            Model::BrushBuilder builder(&map, worldBounds);
+            Model::BrushList brushes;
+            for (size_t i = 0; i < brushCount; ++i) {
+                Model::Brush* brush = builder.createCube(static_cast<FloatType>(i + 1) / 3.0, "none");
+                map.defaultLayer()->addChild(brush);
+                brushes.push_back(brush);
+            }
+
+            StringStream str;
+            NodeWriter streamWriter(&map, str);
+            streamWriter.writeMap();
+
+            String buffer;
+            NodeWriter bufferWriter(&map, buffer);
+            bufferWriter.writeMap();
+
+            // the file serializer must write exactly what it writes to a buffer
+            FILE* file = std::tmpfile();
+            ASSERT_NE(nullptr, file);
+            NodeWriter fileWriter(&map, file);
+            fileWriter.writeMap();
+
+            String fileContents(static_cast<size_t>(std::ftell(file)), '\0');
+            std::rewind(file);
+            ASSERT_EQ(fileContents.size(), std::fread(&fileContents[0], 1, fileContents.size(), file));
+            std::fclose(file);
+            ASSERT_EQ(buffer, fileContents);
+
+            const String streamResult = str.str();
+            size_t streamPos = 0;
+            size_t bufferPos = 0;
+            for (size_t i = 0; i < brushCount; ++i) {
+                const String comment = "// brush " + StringUtils::toString(i) + "\n{\n";
+                streamPos = streamResult.find(comment, streamPos);
+                bufferPos = buffer.find(comment, bufferPos);
+                ASSERT_NE(String::npos, streamPos);
+                ASSERT_NE(String::npos, bufferPos);
+
+                // the entity takes 3 lines, every brush 9 lines, and the file position starts at the opening brace
+                const size_t lineNumber = 3 + 9 * i + 2;
+                ASSERT_EQ(lineNumber, brushes[i]->lineNumber());
+                ASSERT_TRUE(brushes[i]->containsLine(lineNumber + 7));
+                ASSERT_FALSE(brushes[i]->containsLine(lineNumber + 8));
+            }
+
+            const String lastFace = "( 256 256 256 ) ( 256 256 257 ) ( 256 257 256 ) none 0 0 0 1 1\n";
+            ASSERT_NE(String::npos, buffer.find(lastFace));
+            ASSERT_NE(String::npos, streamResult.find(lastFace));
+        }
     }
 }
@@ -0,0 +1,132 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "IO/StandardMapParser.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        static bool readFace(const String& str, QuakeMapFace& face, const bool valve) {
+            QuakeMapFaceTokenizer tokenizer(str.data(), str.data() + str.size());
+            return tokenizer.readFace(face, valve);
+        }
+
+        static bool readNumber(const String& str, double& value) {
+            // the scale is the last number of a face
+            QuakeMapFace face;
+            if (!readFace("( 0 0 0 ) ( 0 0 0 ) ( 0 0 0 ) tex 0 0 0 0 " + str, face, false)) {
+                return false;
+            }
+            value = face.yScale;
+            return true;
+        }
+
+        TEST(QuakeMapFaceTokenizerTest, readQuakeFace) {
+            const String str("( -32 -32.5 -1e0 ) ( 32 32 +32 ) ( .5 -.25 1. ) some_texture 1 -2 90 0.5 0.25\n}");
+            QuakeMapFaceTokenizer tokenizer(str.data(), str.data() + str.size());
+            QuakeMapFace face;
+
+            // exponents are not supported
+            ASSERT_FALSE(tokenizer.readFace(face, false));
+
+            const String str2("( -32 -32.5 -1 ) ( 32 32 +32 ) ( .5 -.25 1. ) some_texture 1 -2 90 0.5 0.25\n}");
+            QuakeMapFaceTokenizer tokenizer2(str2.data(), str2.data() + str2.size());
+            ASSERT_TRUE(tokenizer2.readFace(face, false));
+            ASSERT_EQ(vm::vec3(-32.0, -32.5, -1.0), face.p1);
+            ASSERT_EQ(vm::vec3(32.0, 32.0, 32.0), face.p2);
+            ASSERT_EQ(vm::vec3(0.5, -0.25, 1.0), face.p3);
+            ASSERT_EQ("some_texture", face.textureName);
+            ASSERT_EQ(1.0, face.xOffset);
+            ASSERT_EQ(-2.0, face.yOffset);
+            ASSERT_EQ(90.0, face.rotation);
+            ASSERT_EQ(0.5, face.xScale);
+            ASSERT_EQ(0.25, face.yScale);
+            ASSERT_EQ('\n', *tokenizer2.curPos());
+        }
+
+        TEST(QuakeMapFaceTokenizerTest, readValveFace) {
+            QuakeMapFace face;
+            ASSERT_TRUE(readFace("(-32 -32 -32) (-32 -31 -32) (-32 -32 -31) *water1 [ 0 1 0 -4 ] [ 0 0 -1 8 ] 0 1 1", face, true));
+            ASSERT_EQ(vm::vec3(-32.0, -32.0, -32.0), face.p1);
+            ASSERT_EQ("*water1", face.textureName);
+            ASSERT_EQ((vm::vec<FloatType,4>(0.0, 1.0, 0.0, -4.0)), face.texX);
+            ASSERT_EQ((vm::vec<FloatType,4>(0.0, 0.0, -1.0, 8.0)), face.texY);
+            ASSERT_EQ(-4.0, face.xOffset);
+            ASSERT_EQ(8.0, face.yOffset);
+            ASSERT_EQ(0.0, face.rotation);
+            ASSERT_EQ(1.0, face.xScale);
+            ASSERT_EQ(1.0, face.yScale);
+
+            // a Valve face is not a valid Quake face and vice versa
+            ASSERT_FALSE(readFace("( 0 0 0 ) ( 0 0 0 ) ( 0 0 0 ) tex [ 0 1 0 -4 ] [ 0 0 -1 8 ] 0 1 1", face, false));
+            ASSERT_FALSE(readFace("( 0 0 0 ) ( 0 0 0 ) ( 0 0 0 ) tex 0 0 0 1 1", face, true));
+        }
+
+        TEST(QuakeMapFaceTokenizerTest, rejectUnusualFaces) {
+            QuakeMapFace face;
+            ASSERT_FALSE(readFace("", face, false));
+            ASSERT_FALSE(readFace("( 0 0 0 ) ( 0 0 0 ) ( 0 0 0 ) \"tex\" 0 0 0 1 1", face, false));
+            ASSERT_FALSE(readFace("// comment\n( 0 0 0 ) ( 0 0 0 ) ( 0 0 0 ) tex 0 0 0 1 1", face, false));
+            ASSERT_FALSE(readFace("( 0 0 0 ) ( 0 0 0 ) ( 0 0 ) tex 0 0 0 1 1", face, false));
+            ASSERT_FALSE(readFace("( 0 0 0 ) ( 0 0 0 ) ( 0 0 0 ) tex 0 0 0 1", face, false));
+            ASSERT_FALSE(readFace("( 0 0 0 ) ( 0 0 0 ) ( 0 0 0 ) tex 0 0 0 1 1}", face, false));
+
+            double value;
+            ASSERT_FALSE(readNumber("-", value));
+            ASSERT_FALSE(readNumber(".", value));
+            ASSERT_FALSE(readNumber("1.2.3", value));
+            ASSERT_FALSE(readNumber("--1", value));
+            ASSERT_FALSE(readNumber("1E5", value));
+            ASSERT_FALSE(readNumber("0x10", value));
+        }
+
+        TEST(QuakeMapFaceTokenizerTest, readNumbersLikeAtof) {
+            std::vector<String> strs = {
+                "0", "-0", "+0", "1", "-1", "+1", ".5", "-.5", "1.", "0.1", "0.3", "-0.000001",
+                "3.14159265358979323846264338327950288", "123456789012345678901234567890",
+                "9007199254740993", "0.000000000000000000000000000001", "8192", "-65536.125",
+                "00000000000000000000000000000001.5"
+            };
+
+            std::mt19937 rng(42);
+            std::uniform_real_distribution<double> coords(-65536.0, 65536.0);
+            for (size_t i = 0; i < 1000; ++i) {
+                char buffer[64];
+                std::snprintf(buffer, sizeof(buffer), "%.*f", static_cast<int>(i % 20), coords(rng));
+                strs.push_back(buffer);
+            }
+
+            for (const auto& str : strs) {
+                double value;
+                ASSERT_TRUE(readNumber(str, value)) << str;
+
+                const double expected = std::atof(str.c_str());
+                ASSERT_EQ(expected, value) << str;
+                ASSERT_EQ(std::signbit(expected), std::signbit(value)) << str;
+            }
+        }
+    }
+}
@@ -0,0 +1,74 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Logger.h"
+#include "Assets/Palette.h"
+#include "Assets/Texture.h"
+#include "Assets/TextureCollection.h"
+#include "IO/DiskFileSystem.h"
+#include "IO/DiskIO.h"
+#include "IO/FileMatcher.h"
+#include "IO/Path.h"
+#include "IO/TextureCollectionLoader.h"
+#include "IO/WalTextureReader.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace TrenchBroom {
+    namespace IO {
+        TEST(TextureCollectionLoaderTest, loadDirectoryInOrder) {
+            NullLogger logger;
+            DiskFileSystem fs(IO::Disk::getCurrentWorkingDir());
+            const Assets::Palette palette = Assets::Palette::loadFile(fs, Path("data/colormap.pcx"));
+
+            TextureReader::PathSuffixNameStrategy nameStrategy(2, true);
+            WalTextureReader textureReader(nameStrategy, palette);
+
+            DirectoryTextureCollectionLoader loader(&logger, fs);
+            const auto collection = loader.loadTextureCollection(Path("data/IO/Wal/rtz"), StringList { "wal" }, textureReader);
+            ASSERT_TRUE(collection->loaded());
+
+            // the textures must be in the same order and have the same contents as if they were read one by one
+            const auto paths = fs.findItems(Path("data/IO/Wal/rtz"), FileExtensionMatcher("wal"));
+            ASSERT_EQ(7u, paths.size());
+            ASSERT_EQ(paths.size(), collection->textureCount());
+
+            for (size_t i = 0; i < paths.size(); ++i) {
+                const auto expected = std::unique_ptr<Assets::Texture>(textureReader.readTexture(fs.openFile(paths[i])));
+                const auto* actual = collection->textureByIndex(i);
+
+                ASSERT_EQ(expected->name(), actual->name());
+                ASSERT_EQ(expected->width(), actual->width());
+                ASSERT_EQ(expected->height(), actual->height());
+                ASSERT_EQ(expected->averageColor(), actual->averageColor());
+
+                const auto& expectedBuffers = expected->buffersIfUnprepared();
+                const auto& actualBuffers = actual->buffersIfUnprepared();
+                ASSERT_EQ(expectedBuffers.size(), actualBuffers.size());
+                for (size_t j = 0; j < expectedBuffers.size(); ++j) {
+                    ASSERT_EQ(expectedBuffers[j].size(), actualBuffers[j].size());
+                    ASSERT_TRUE(std::equal(expectedBuffers[j].ptr(), expectedBuffers[j].ptr() + expectedBuffers[j].size(), actualBuffers[j].ptr()));
+                }
+            }
+        }
+    }
+}
@@ -557,6 +557,78 @@ namespace TrenchBroom {
             delete world;
         }
 
+        TEST(WorldReaderTest, parseBrushesInFileOrder) {
+            const String data(R"(
+{
+"classname" "worldspawn"
+{
+( -0 -0 -16 ) ( -0 -0  -0 ) ( 64 -0 -16 ) tex1 0 0 0 1 1
+( -0 -0 -16 ) ( -0 64 -16 ) ( -0 -0  -0 ) tex1 0 0 0 1 1
+( -0 -0 -16 ) ( 64 -0 -16 ) ( -0 64 -16 ) tex1 0 0 0 1 1
+( 64 64  -0 ) ( -0 64  -0 ) ( 64 64 -16 ) tex1 0 0 0 1 1
+( 64 64  -0 ) ( 64 64 -16 ) ( 64 -0  -0 ) tex1 0 0 0 1 1
+( 64 64  -0 ) ( 64 -0  -0 ) ( -0 64  -0 ) tex1 0 0 0 1 1
+}
+{
+( -0 -0 -16 ) ( -0 -0  -0 ) ( 64 -0 -16 ) tex2 0 0 0 1 1
+( -0 -0 -16 ) ( -0 64 -16 ) ( -0 -0  -0 ) tex2 0 0 0 1 1
+( -0 -0 -16 ) ( 64 -0 -16 ) ( -0 64 -16 ) tex2 0 0 0 1 1
+}
+{
+( -0 -0 -16 ) ( -0 -0  -0 ) ( 64 -0 -16 ) tex3 0 0 0 1 1
+( -0 -0 -16 ) ( -0 64 -16 ) ( -0 -0  -0 ) tex3 0 0 0 1 1
+( -0 -0 -16 ) ( 64 -0 -16 ) ( -0 64 -16 ) tex3 0 0 0 1 1
+( 64 64  -0 ) ( -0 64  -0 ) ( 64 64 -16 ) tex3 0 0 0 1 1
+( 64 64  -0 ) ( 64 64 -16 ) ( 64 -0  -0 ) tex3 0 0 0 1 1
+( 64 64  -0 ) ( 64 -0  -0 ) ( -0 64  -0 ) tex3 0 0 0 1 1
+}
+}
+{
+"classname" "func_detail"
+{
+( -0 -0 -16 ) ( -0 -0  -0 ) ( 64 -0 -16 ) tex4 0 0 0 1 1
+( -0 -0 -16 ) ( -0 64 -16 ) ( -0 -0  -0 ) tex4 0 0 0 1 1
+( -0 -0 -16 ) ( 64 -0 -16 ) ( -0 64 -16 ) tex4 0 0 0 1 1
+( 64 64  -0 ) ( -0 64  -0 ) ( 64 64 -16 ) tex4 0 0 0 1 1
+( 64 64  -0 ) ( 64 64 -16 ) ( 64 -0  -0 ) tex4 0 0 0 1 1
+( 64 64  -0 ) ( 64 -0  -0 ) ( -0 64  -0 ) tex4 0 0 0 1 1
+}
+})");
+            vm::bbox3 worldBounds(8192);
+
+            IO::TestParserStatus status;
+            WorldReader reader(data, nullptr);
+
+            Model::World* world = reader.read(Model::MapFormat::Standard, worldBounds, status);
+
+            // the incomplete brush is skipped with an error, all other nodes are added in file order
+            ASSERT_EQ(1u, status.countStatus(Logger::LogLevel_Error));
+
+            ASSERT_EQ(1u, world->childCount());
+            Model::Node* defaultLayer = world->children().front();
+            ASSERT_EQ(3u, defaultLayer->childCount());
+
+            const Model::NodeList& children = defaultLayer->children();
+            Model::Brush* brush1 = dynamic_cast<Model::Brush*>(children[0]);
+            Model::Brush* brush3 = dynamic_cast<Model::Brush*>(children[1]);
+            Model::Entity* entity = dynamic_cast<Model::Entity*>(children[2]);
+
+            ASSERT_TRUE(brush1 != nullptr);
+            ASSERT_TRUE(brush3 != nullptr);
+            ASSERT_TRUE(entity != nullptr);
+
+            ASSERT_STREQ("tex1", brush1->faces().front()->textureName().c_str());
+            ASSERT_STREQ("tex3", brush3->faces().front()->textureName().c_str());
+            ASSERT_EQ(4u, brush1->lineNumber());
+            ASSERT_EQ(17u, brush3->lineNumber());
+
+            ASSERT_EQ(1u, entity->childCount());
+            Model::Brush* brush4 = static_cast<Model::Brush*>(entity->children().front());
+            ASSERT_STREQ("tex4", brush4->faces().front()->textureName().c_str());
+
+            delete world;
+        }
+
         TEST(WorldReaderTest, parseBrushesWithLayer) {
             const String data(R"(
 {
@@ -0,0 +1,84 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "MemoryUsage.h"
+
+#include <vector>
+
+namespace TrenchBroom {
+    TEST(MemoryUsageTest, addAndTotal) {
+        MemoryUsage usage;
+        ASSERT_EQ(0u, usage.total());
+
+        usage.add(MemoryUsage::Category::BrushFaces, 10u);
+        usage.add(MemoryUsage::Category::BrushFaces, 5u);
+        usage.add(MemoryUsage::Category::Textures, 7u);
+
+        ASSERT_EQ(15u, usage.bytes(MemoryUsage::Category::BrushFaces));
+        ASSERT_EQ(7u, usage.bytes(MemoryUsage::Category::Textures));
+        ASSERT_EQ(0u, usage.bytes(MemoryUsage::Category::Nodes));
+        ASSERT_EQ(22u, usage.total());
+    }
+
+    TEST(MemoryUsageTest, accumulate) {
+        MemoryUsage first;
+        first.add(MemoryUsage::Category::Nodes, 1u);
+        first.add(MemoryUsage::Category::Snapshots, 2u);
+
+        MemoryUsage second;
+        second.add(MemoryUsage::Category::Nodes, 3u);
+        second.add(MemoryUsage::Category::EntityModels, 4u);
+
+        first += second;
+        ASSERT_EQ(4u, first.bytes(MemoryUsage::Category::Nodes));
+        ASSERT_EQ(2u, first.bytes(MemoryUsage::Category::Snapshots));
+        ASSERT_EQ(4u, first.bytes(MemoryUsage::Category::EntityModels));
+        ASSERT_EQ(10u, first.total());
+    }
+
+    TEST(MemoryUsageTest, asStringListsAllCategories) {
+        MemoryUsage usage;
+        usage.add(MemoryUsage::Category::PolyhedronElements, 3u * 1024u * 1024u);
+
+        const String str = usage.asString();
+        for (size_t i = 0; i < static_cast<size_t>(MemoryUsage::Category::Count); ++i) {
+            ASSERT_NE(String::npos, str.find(MemoryUsage::categoryName(static_cast<MemoryUsage::Category>(i))));
+        }
+        ASSERT_NE(String::npos, str.find("Total"));
+        ASSERT_NE(String::npos, str.find("3.00 MiB"));
+    }
+
+    TEST(MemoryUsageTest, stringHeapMemoryUsage) {
+        ASSERT_EQ(0u, heapMemoryUsage(String()));
+        ASSERT_EQ(0u, heapMemoryUsage(String("a")));
+
+        const String longString(1000, 'x');
+        ASSERT_LE(1001u, heapMemoryUsage(longString));
+    }
+
+    TEST(MemoryUsageTest, vectorHeapMemoryUsage) {
+        std::vector<double> vec;
+        ASSERT_EQ(0u, heapMemoryUsage(vec));
+
+        vec.reserve(16);
+        ASSERT_EQ(vec.capacity() * sizeof(double), heapMemoryUsage(vec));
+    }
+}
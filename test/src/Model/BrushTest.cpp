@@ -36,6 +36,8 @@
 #include "Model/World.h"
 
 #include <vecmath/vec.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
 #include <vecmath/polygon.h>
 
 #include <algorithm>
@@ -581,6 +583,62 @@ namespace TrenchBroom {
             ASSERT_TRUE(hits2.empty());
         }
 
+        TEST(BrushTest, pickMatchesFacePolygons) {
+            const vm::bbox3 worldBounds(4096.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+            BrushBuilder builder(&world, worldBounds);
+
+            const std::vector<vm::vec3> points {
+                vm::vec3(-32.0, -16.0, -8.0),
+                vm::vec3( 48.0, -24.0, -8.0),
+                vm::vec3( 16.0,  40.0, -8.0),
+                vm::vec3(-40.0,  24.0,  0.0),
+                vm::vec3(  0.0,   0.0, 56.0),
+                vm::vec3( 24.0,   8.0, 40.0),
+                vm::vec3(-16.0,  16.0, 32.0),
+            };
+            std::unique_ptr<Brush> brush(builder.createBrush(points, "texture"));
+
+            // aim rays from points around the brush at points inside its bounds
+            size_t hitCount = 0;
+            for (size_t i = 0; i < 32; ++i) {
+                for (size_t j = 0; j < 32; ++j) {
+                    const auto angle = static_cast<FloatType>(i) * vm::Cd::twoPi() / 32.0;
+                    const auto origin = vm::vec3(std::cos(angle) * 128.0, std::sin(angle) * 128.0, static_cast<FloatType>(j) * 4.0 - 32.0);
+                    const auto target = vm::vec3(static_cast<FloatType>(j) * 2.5 - 40.0, static_cast<FloatType>(i) * 2.0 - 30.0, 10.0);
+                    const auto ray = vm::ray3(origin, normalize(target - origin));
+
+                    BrushFace* expectedFace = nullptr;
+                    auto expectedDistance = vm::nan<FloatType>();
+                    for (auto* face : brush->faces()) {
+                        expectedDistance = face->intersectWithRay(ray);
+                        if (!vm::isnan(expectedDistance)) {
+                            expectedFace = face;
+                            break;
+                        }
+                    }
+
+                    PickResult hits;
+                    brush->pick(ray, hits);
+                    if (expectedFace == nullptr) {
+                        ASSERT_TRUE(hits.empty());
+                    } else {
+                        ASSERT_EQ(1u, hits.size());
+                        const auto& hit = hits.all().front();
+                        ASSERT_EQ(expectedFace, hit.target<BrushFace*>());
+                        ASSERT_NEAR(expectedDistance, hit.distance(), 0.0001);
+                        ++hitCount;
+                    }
+                }
+            }
+            ASSERT_LT(0u, hitCount);
+
+            // no hit from inside the brush
+            PickResult hits;
+            brush->pick(vm::ray3(vm::vec3(0.0, 0.0, 8.0), vm::vec3::pos_x), hits);
+            ASSERT_TRUE(hits.empty());
+        }
+
         TEST(BrushTest, partialSelectionAfterAdd) {
             const vm::bbox3 worldBounds(4096.0);
 
@@ -2853,6 +2911,127 @@ namespace TrenchBroom {
             VectorUtils::deleteAll(result);
         }
 
+        TEST(BrushTest, subtractAll) {
+            const vm::bbox3 worldBounds(4096.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+
+            const String minuendTexture("minuend");
+            const String subtrahendTexture("subtrahend");
+            const String defaultTexture("default");
+
+            BrushBuilder builder(&world, worldBounds);
+            const BrushList minuends {
+                builder.createCuboid(vm::bbox3(vm::vec3(-32.0, -16.0, -32.0), vm::vec3(32.0, 16.0, 32.0)), minuendTexture),
+                builder.createCuboid(vm::bbox3(vm::vec3(128.0, -16.0, -32.0), vm::vec3(192.0, 16.0, 32.0)), minuendTexture)
+            };
+            const BrushList subtrahends {
+                builder.createCuboid(vm::bbox3(vm::vec3(512.0, 512.0, 512.0), vm::vec3(576.0, 576.0, 576.0)), subtrahendTexture),
+                builder.createCuboid(vm::bbox3(vm::vec3(-16.0, -32.0, -64.0), vm::vec3(16.0, 32.0, 0.0)), subtrahendTexture)
+            };
+
+            for (const size_t threadCount : { 1u, 4u }) {
+                const std::vector<BrushList> results = Brush::subtractAll(world, worldBounds, defaultTexture, minuends, subtrahends, threadCount);
+                ASSERT_EQ(2u, results.size());
+
+                const BrushList expected = minuends[0]->subtract(world, worldBounds, defaultTexture, subtrahends);
+                ASSERT_EQ(expected.size(), results[0].size());
+                for (const Brush* brush : results[0]) {
+                    const auto it = std::find_if(std::begin(expected), std::end(expected), [&](const Brush* e) { return e->bounds() == brush->bounds(); });
+                    ASSERT_NE(std::end(expected), it);
+                    for (const BrushFace* face : brush->faces()) {
+                        const BrushFace* expectedFace = (*it)->findFace(face->boundary());
+                        ASSERT_NE(nullptr, expectedFace);
+                        ASSERT_EQ(expectedFace->textureName(), face->textureName());
+                    }
+                }
+
+                ASSERT_EQ(1u, results[1].size());
+                ASSERT_EQ(minuends[1]->bounds(), results[1].front()->bounds());
+                for (const BrushFace* face : results[1].front()->faces()) {
+                    ASSERT_EQ(minuendTexture, face->textureName());
+                }
+
+                VectorUtils::deleteAll(expected);
+                for (const BrushList& result : results) {
+                    VectorUtils::deleteAll(result);
+                }
+            }
+
+            VectorUtils::deleteAll(minuends);
+            VectorUtils::deleteAll(subtrahends);
+        }
+
+        TEST(BrushTest, subtractAllMergesFragments) {
+            const vm::bbox3 worldBounds(4096.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+
+            const String minuendTexture("minuend");
+            const String subtrahendTexture("subtrahend");
+
+            BrushBuilder builder(&world, worldBounds);
+            const BrushList minuends {
+                builder.createCuboid(vm::bbox3(vm::vec3(-32.0, -32.0, -32.0), vm::vec3(32.0, 32.0, 32.0)), minuendTexture)
+            };
+
+            // the first subtrahend splits the minuend into two fragments, and the second one removes the part of the
+            // first fragment that made their union non-convex
+            const BrushList subtrahends {
+                builder.createCuboid(vm::bbox3(vm::vec3(16.0, 16.0, -64.0), vm::vec3(64.0, 64.0, 64.0)), subtrahendTexture),
+                builder.createCuboid(vm::bbox3(vm::vec3(-64.0, 16.0, -64.0), vm::vec3(64.0, 64.0, 64.0)), subtrahendTexture)
+            };
+
+            const BrushList fragments = minuends[0]->subtract(world, worldBounds, "default", subtrahends);
+            ASSERT_EQ(2u, fragments.size());
+
+            const std::vector<BrushList> results = Brush::subtractAll(world, worldBounds, "default", minuends, subtrahends);
+            ASSERT_EQ(1u, results.size());
+            ASSERT_EQ(1u, results[0].size());
+
+            const Brush* brush = results[0].front();
+            ASSERT_EQ(vm::bbox3(vm::vec3(-32.0, -32.0, -32.0), vm::vec3(32.0, 16.0, 32.0)), brush->bounds());
+            ASSERT_EQ(6u, brush->faceCount());
+            ASSERT_EQ(subtrahendTexture, brush->findFace(vm::vec3::pos_y)->textureName());
+            ASSERT_EQ(minuendTexture, brush->findFace(vm::vec3::neg_y)->textureName());
+            ASSERT_EQ(minuendTexture, brush->findFace(vm::vec3::pos_x)->textureName());
+            ASSERT_EQ(minuendTexture, brush->findFace(vm::vec3::neg_x)->textureName());
+            ASSERT_EQ(minuendTexture, brush->findFace(vm::vec3::pos_z)->textureName());
+            ASSERT_EQ(minuendTexture, brush->findFace(vm::vec3::neg_z)->textureName());
+
+            VectorUtils::deleteAll(fragments);
+            VectorUtils::deleteAll(results[0]);
+            VectorUtils::deleteAll(minuends);
+            VectorUtils::deleteAll(subtrahends);
+        }
+
+        TEST(BrushTest, subtractAllMergesLargeFragments) {
+            const vm::bbox3 worldBounds(8192.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+
+            // the fragments span most of the world, so rounding errors of their volumes exceed any absolute epsilon
+            BrushBuilder builder(&world, worldBounds);
+            const BrushList minuends {
+                builder.createCuboid(vm::bbox3(vm::vec3(-3000.0, -3000.0, -3000.0), vm::vec3(3000.1, 3000.1, 3000.1)), "minuend")
+            };
+
+            const BrushList subtrahends {
+                builder.createCuboid(vm::bbox3(vm::vec3(1000.3, 1000.3, -4000.0), vm::vec3(4000.0, 4000.0, 4000.0)), "subtrahend"),
+                builder.createCuboid(vm::bbox3(vm::vec3(-4000.0, 1000.3, -4000.0), vm::vec3(4000.0, 4000.0, 4000.0)), "subtrahend")
+            };
+
+            const std::vector<BrushList> results = Brush::subtractAll(world, worldBounds, "default", minuends, subtrahends);
+            ASSERT_EQ(1u, results.size());
+            ASSERT_EQ(1u, results[0].size());
+
+            const Brush* brush = results[0].front();
+            ASSERT_EQ(6u, brush->faceCount());
+            ASSERT_TRUE(isEqual(vm::vec3(-3000.0, -3000.0, -3000.0), brush->bounds().min, vm::C::almostZero()));
+            ASSERT_TRUE(isEqual(vm::vec3(3000.1, 1000.3, 3000.1), brush->bounds().max, vm::C::almostZero()));
+
+            VectorUtils::deleteAll(results[0]);
+            VectorUtils::deleteAll(minuends);
+            VectorUtils::deleteAll(subtrahends);
+        }
+
         TEST(BrushTest, testAlmostDegenerateBrush) {
             // https://github.com/kduske/TrenchBroom/issues/1194
             const String data("{\n"
@@ -3373,6 +3552,142 @@ namespace TrenchBroom {
             delete cube;
         }
 
+        static void assertFacesMatchGeometry(const Brush* brush) {
+            for (const auto* face : brush->faces()) {
+                ASSERT_NE(nullptr, face->geometry());
+                ASSERT_EQ(face, face->geometry()->payload());
+            }
+        }
+
+        TEST(BrushTest, snapshotRestoresGeometry) {
+            const vm::bbox3 worldBounds(8192.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+            const BrushBuilder builder(&world, worldBounds);
+
+            Brush* cube = builder.createCube(64.0, "texture");
+            const auto originalVertices = cube->vertexPositions();
+            const auto originalBounds = cube->bounds();
+
+            BrushSnapshot* snapshot = dynamic_cast<BrushSnapshot*>(cube->takeSnapshot());
+            ASSERT_NE(nullptr, snapshot);
+
+            const std::vector<vm::vec3> vertices { vm::vec3(32.0, 32.0, 32.0) };
+            const vm::vec3 delta(16.0, 16.0, 16.0);
+            ASSERT_TRUE(cube->canMoveVertices(worldBounds, vertices, delta));
+            cube->moveVertices(worldBounds, vertices, delta);
+            ASSERT_FALSE(cube->hasVertex(vm::vec3(32.0, 32.0, 32.0)));
+
+            snapshot->restore(worldBounds);
+            delete snapshot;
+
+            ASSERT_EQ(originalBounds, cube->bounds());
+            ASSERT_EQ(6u, cube->faceCount());
+            ASSERT_TRUE(cube->hasVertices(originalVertices));
+            assertFacesMatchGeometry(cube);
+
+            for (const auto* face : cube->faces()) {
+                ASSERT_EQ("texture", face->textureName());
+                ASSERT_EQ(4u, face->vertexCount());
+            }
+
+            delete cube;
+        }
+
+        TEST(BrushTest, cloneCopiesGeometry) {
+            const vm::bbox3 worldBounds(8192.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+            const BrushBuilder builder(&world, worldBounds);
+
+            Brush* cube = builder.createCube(64.0, "texture");
+            const std::vector<vm::vec3> vertices { vm::vec3(32.0, 32.0, 32.0) };
+            cube->moveVertices(worldBounds, vertices, vm::vec3(16.0, 16.0, 16.0));
+
+            Brush* clone = cube->clone(worldBounds);
+            ASSERT_EQ(cube->bounds(), clone->bounds());
+            ASSERT_EQ(cube->faceCount(), clone->faceCount());
+            ASSERT_TRUE(clone->hasVertices(cube->vertexPositions()));
+            assertFacesMatchGeometry(clone);
+
+            for (size_t i = 0; i < cube->faceCount(); ++i) {
+                const auto* original = cube->faces()[i];
+                const auto* copy = clone->faces()[i];
+                ASSERT_NE(original->geometry(), copy->geometry());
+                ASSERT_EQ(original->boundary(), copy->boundary());
+                ASSERT_TRUE(copy->hasVertices(vm::polygon3(original->vertexPositions())));
+            }
+
+            delete clone;
+            delete cube;
+        }
+
+        TEST(BrushTest, compactedSnapshotRestoresTransformedBrush) {
+            const vm::bbox3 worldBounds(8192.0);
+            World world(MapFormat::Valve, nullptr, worldBounds);
+            const BrushBuilder builder(&world, worldBounds);
+
+            Brush* cube = builder.createCube(64.0, "texture");
+            cube->faces().front()->setXOffset(8.0f);
+            cube->faces().back()->setRotation(30.0f);
+
+            std::vector<BrushFace*> originalFaces;
+            for (const auto* face : cube->faces()) {
+                originalFaces.push_back(face->clone());
+            }
+            const auto originalVertices = cube->vertexPositions();
+
+            std::unique_ptr<NodeSnapshot> snapshot(cube->takeSnapshot());
+            const auto transform = vm::translationMatrix(vm::vec3(16.0, 8.0, 0.0)) * vm::rotationMatrix(vm::vec3::pos_z, vm::toRadians(45.0));
+            cube->transform(transform, true, worldBounds);
+
+            const auto fullUsage = snapshot->memoryUsage();
+            snapshot->compact();
+            ASSERT_LT(snapshot->memoryUsage(), fullUsage);
+
+            snapshot->restore(worldBounds);
+            ASSERT_EQ(originalFaces.size(), cube->faceCount());
+            ASSERT_TRUE(cube->hasVertices(originalVertices));
+            assertFacesMatchGeometry(cube);
+
+            for (size_t i = 0; i < cube->faceCount(); ++i) {
+                const auto* original = originalFaces[i];
+                const auto* restored = cube->faces()[i];
+                ASSERT_EQ(original->boundary(), restored->boundary());
+                ASSERT_EQ(original->textureName(), restored->textureName());
+                ASSERT_EQ(original->offset(), restored->offset());
+                ASSERT_EQ(original->rotation(), restored->rotation());
+                ASSERT_VEC_EQ(original->textureXAxis(), restored->textureXAxis());
+                ASSERT_VEC_EQ(original->textureYAxis(), restored->textureYAxis());
+            }
+
+            VectorUtils::clearAndDelete(originalFaces);
+            delete cube;
+        }
+
+        TEST(BrushTest, compactedSnapshotKeepsFacesIfFaceCountChanged) {
+            const vm::bbox3 worldBounds(8192.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+            const BrushBuilder builder(&world, worldBounds);
+
+            Brush* cube = builder.createCube(64.0, "texture");
+            const auto originalVertices = cube->vertexPositions();
+
+            std::unique_ptr<NodeSnapshot> snapshot(cube->takeSnapshot());
+            const std::vector<vm::vec3> vertices { vm::vec3(32.0, 32.0, 32.0) };
+            cube->moveVertices(worldBounds, vertices, vm::vec3(16.0, 16.0, 16.0));
+            ASSERT_NE(6u, cube->faceCount());
+
+            const auto fullUsage = snapshot->memoryUsage();
+            snapshot->compact();
+            ASSERT_EQ(fullUsage, snapshot->memoryUsage());
+
+            snapshot->restore(worldBounds);
+            ASSERT_EQ(6u, cube->faceCount());
+            ASSERT_TRUE(cube->hasVertices(originalVertices));
+            assertFacesMatchGeometry(cube);
+
+            delete cube;
+        }
+
         TEST(BrushTest, resizePastWorldBounds) {
             const vm::bbox3 worldBounds(8192.0);
             World world(MapFormat::Standard, nullptr, worldBounds);
@@ -0,0 +1,135 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "MemoryUsage.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushFaceAttributes.h"
+#include "Model/CollectMemoryUsageVisitor.h"
+#include "Model/Entity.h"
+#include "Model/Layer.h"
+#include "Model/MapFormat.h"
+#include "Model/Snapshot.h"
+#include "Model/World.h"
+
+#include <vecmath/bbox.h>
+
+namespace TrenchBroom {
+    namespace Model {
+        using Category = MemoryUsage::Category;
+
+        TEST(CollectMemoryUsageVisitorTest, emptyWorld) {
+            const vm::bbox3 worldBounds(8192.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+
+            const MemoryUsage usage = collectMemoryUsage(&world);
+            ASSERT_LE(sizeof(World) + sizeof(Layer), usage.bytes(Category::Nodes));
+            ASSERT_EQ(0u, usage.bytes(Category::BrushFaces));
+            ASSERT_EQ(0u, usage.bytes(Category::PolyhedronElements));
+            ASSERT_EQ(0u, usage.bytes(Category::Snapshots));
+        }
+
+        TEST(CollectMemoryUsageVisitorTest, brushesGrowFaceAndGeometryCategories) {
+            const vm::bbox3 worldBounds(8192.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+            BrushBuilder builder(&world, worldBounds);
+
+            world.defaultLayer()->addChild(builder.createCube(64.0, "tex"));
+            const MemoryUsage one = collectMemoryUsage(&world);
+
+            for (size_t i = 0; i < 9; ++i) {
+                world.defaultLayer()->addChild(builder.createCube(64.0, "tex"));
+            }
+            const MemoryUsage ten = collectMemoryUsage(&world);
+
+            for (const auto category : { Category::BrushFaces, Category::FaceAttributes, Category::TexCoordSystems, Category::PolyhedronElements }) {
+                ASSERT_LT(0u, one.bytes(category)) << MemoryUsage::categoryName(category);
+                ASSERT_LT(one.bytes(category), ten.bytes(category)) << MemoryUsage::categoryName(category);
+            }
+
+            // a cube has 6 faces with one attributes object each
+            ASSERT_EQ(10u * 6u * sizeof(BrushFaceAttributes), ten.bytes(Category::FaceAttributes));
+            // 8 vertices, 12 edges, 24 half edges and 6 faces per cube
+            ASSERT_LE(10u * (8u * sizeof(BrushVertex) + 12u * sizeof(BrushEdge) + 24u * sizeof(BrushHalfEdge) + 6u * sizeof(BrushFaceGeometry)), ten.bytes(Category::PolyhedronElements));
+        }
+
+        TEST(CollectMemoryUsageVisitorTest, rendererCache) {
+            const vm::bbox3 worldBounds(8192.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+            BrushBuilder builder(&world, worldBounds);
+
+            Brush* brush = builder.createCube(64.0, "tex");
+            world.defaultLayer()->addChild(brush);
+            ASSERT_EQ(0u, collectMemoryUsage(&world).bytes(Category::RendererCaches));
+
+            brush->brushRendererBrushCache().validateVertexCache(brush);
+            ASSERT_LT(0u, collectMemoryUsage(&world).bytes(Category::RendererCaches));
+        }
+
+        TEST(CollectMemoryUsageVisitorTest, entityAttributes) {
+            const vm::bbox3 worldBounds(8192.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+
+            Entity* entity = world.createEntity();
+            world.defaultLayer()->addChild(entity);
+            const size_t before = collectMemoryUsage(&world).bytes(Category::EntityAttributes);
+
+            entity->addOrUpdateAttribute("message", String(1000, 'x'));
+            const size_t after = collectMemoryUsage(&world).bytes(Category::EntityAttributes);
+            ASSERT_LE(before + 1000u, after);
+        }
+
+        TEST(CollectMemoryUsageVisitorTest, collectSubtree) {
+            const vm::bbox3 worldBounds(8192.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+            BrushBuilder builder(&world, worldBounds);
+
+            Brush* brush = builder.createCube(64.0, "tex");
+            world.defaultLayer()->addChild(brush);
+
+            const MemoryUsage brushUsage = collectMemoryUsage(brush);
+            const MemoryUsage worldUsage = collectMemoryUsage(&world);
+            ASSERT_EQ(brushUsage.bytes(Category::PolyhedronElements), worldUsage.bytes(Category::PolyhedronElements));
+            ASSERT_LT(brushUsage.bytes(Category::Nodes), worldUsage.bytes(Category::Nodes));
+        }
+
+        TEST(CollectMemoryUsageVisitorTest, snapshot) {
+            const vm::bbox3 worldBounds(8192.0);
+            World world(MapFormat::Standard, nullptr, worldBounds);
+            BrushBuilder builder(&world, worldBounds);
+
+            NodeList brushes;
+            for (size_t i = 0; i < 4; ++i) {
+                Brush* brush = builder.createCube(64.0, "tex");
+                world.defaultLayer()->addChild(brush);
+                brushes.push_back(brush);
+            }
+
+            const Snapshot one(std::begin(brushes), std::next(std::begin(brushes)));
+            const Snapshot four(std::begin(brushes), std::end(brushes));
+
+            // a brush snapshot contains copies of the brush faces
+            const size_t faceBytes = collectMemoryUsage(brushes.front()).bytes(Category::BrushFaces);
+            ASSERT_LT(faceBytes, one.memoryUsage());
+            ASSERT_LT(one.memoryUsage(), four.memoryUsage());
+        }
+    }
+}
@@ -33,7 +33,9 @@
 #include "Model/GameImpl.h"
 
 #include <algorithm>
+#include <chrono>
 #include <iterator>
+#include <thread>
 
 namespace TrenchBroom {
     namespace Model {
@@ -78,6 +80,14 @@ namespace TrenchBroom {
             auto textureManager = Assets::TextureManager(&logger, 0, 0);
             game.loadTextureCollections(&worldspawn, IO::Path(), textureManager, &logger);
 
+            // the collection is loaded in the background
+            const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (textureManager.loading() && std::chrono::steady_clock::now() < timeout) {
+                textureManager.collectLoadedCollections();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            ASSERT_FALSE(textureManager.loading());
+
             ASSERT_EQ(1u, textureManager.collections().size());
 
             /*
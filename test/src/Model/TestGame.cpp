@@ -63,6 +63,7 @@ namespace TrenchBroom {
         }
         
         void TestGame::doWriteMap(World* world, const IO::Path& path) const {}
+        void TestGame::doWriteMap(World* world, String& buffer) const {}
         void TestGame::doExportMap(World* world, Model::ExportFormat format, const IO::Path& path) const {}
         
         NodeList TestGame::doParseNodes(const String& str, World* world, const vm::bbox3& worldBounds, Logger* logger) const {
@@ -46,6 +46,7 @@ namespace TrenchBroom {
             World* doNewMap(MapFormat format, const vm::bbox3& worldBounds, Logger* logger) const override;
             World* doLoadMap(MapFormat format, const vm::bbox3& worldBounds, const IO::Path& path, Logger* logger) const override;
             void doWriteMap(World* world, const IO::Path& path) const override;
+            void doWriteMap(World* world, String& buffer) const override;
             void doExportMap(World* world, Model::ExportFormat format, const IO::Path& path) const override;
             
             NodeList doParseNodes(const String& str, World* world, const vm::bbox3& worldBounds, Logger* logger) const override;
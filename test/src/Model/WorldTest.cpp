@@ -0,0 +1,296 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Exceptions.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/CollectNodesVisitor.h"
+#include "Model/EmptyAttributeValueIssueGenerator.h"
+#include "Model/Entity.h"
+#include "Model/Issue.h"
+#include "Model/Layer.h"
+#include "Model/LinkTargetIssueGenerator.h"
+#include "Model/MissingClassnameIssueGenerator.h"
+#include "Model/NonIntegerVerticesIssueGenerator.h"
+#include "Model/World.h"
+#include "Model/WorldBoundsIssueGenerator.h"
+
+#include <vecmath/mat_ext.h>
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Model {
+        using IssueInfo = std::tuple<Node*, IssueType, String>;
+
+        static const vm::bbox3 worldBounds(4096.0);
+
+        static void addNodes(World& world, const size_t count) {
+            BrushBuilder builder(&world, worldBounds);
+            for (size_t i = 0; i < count; ++i) {
+                auto* entity = world.createEntity();
+                if (i % 3 != 0) {
+                    entity->addOrUpdateAttribute(AttributeNames::Classname, "func_door");
+                }
+                if (i % 5 == 0) {
+                    entity->addOrUpdateAttribute("message", "");
+                }
+                if (i % 7 == 0) {
+                    entity->addOrUpdateAttribute(AttributeNames::Target, "nowhere");
+                }
+                world.defaultLayer()->addChild(entity);
+
+                const auto offset = static_cast<FloatType>(i % 2 == 0 ? 16 : 16.5);
+                const auto min = vm::vec3(offset * static_cast<FloatType>(i % 100), 0.0, 0.0);
+                entity->addChild(builder.createCuboid(vm::bbox3(min, min + vm::vec3(16.0, 16.0, 16.0)), "texture"));
+            }
+        }
+
+        static void registerIssueGenerators(World& world) {
+            world.registerIssueGenerator(new MissingClassnameIssueGenerator());
+            world.registerIssueGenerator(new EmptyAttributeValueIssueGenerator());
+            world.registerIssueGenerator(new LinkTargetIssueGenerator());
+            world.registerIssueGenerator(new NonIntegerVerticesIssueGenerator());
+            world.registerIssueGenerator(new WorldBoundsIssueGenerator(vm::bbox3(1024.0)));
+        }
+
+        static NodeList collectNodes(World& world) {
+            CollectNodesVisitor visitor;
+            world.acceptAndRecurse(visitor);
+            return visitor.nodes();
+        }
+
+        static std::vector<IssueInfo> collectIssues(World& world) {
+            std::vector<IssueInfo> result;
+            for (auto* node : collectNodes(world)) {
+                for (const auto* issue : node->issues(world.registeredIssueGenerators())) {
+                    result.emplace_back(node, issue->type(), issue->description());
+                }
+            }
+            return result;
+        }
+
+        TEST(WorldTest, validateIssuesMatchesSequentialValidation) {
+            World world(MapFormat::Standard, nullptr, worldBounds);
+            addNodes(world, 500);
+            registerIssueGenerators(world);
+
+            world.validateIssues(4);
+            for (const auto* node : collectNodes(world)) {
+                ASSERT_EQ(0, node->invalidIssueTypes());
+            }
+            const auto parallelIssues = collectIssues(world);
+            ASSERT_FALSE(parallelIssues.empty());
+
+            for (auto* node : collectNodes(world)) {
+                node->invalidateIssues();
+            }
+            const auto sequentialIssues = collectIssues(world);
+            ASSERT_EQ(sequentialIssues, parallelIssues);
+        }
+
+        TEST(WorldTest, validateIssuesOfChangedNodesOnly) {
+            World world(MapFormat::Standard, nullptr, worldBounds);
+            addNodes(world, 10);
+            registerIssueGenerators(world);
+            world.validateIssues(4);
+
+            auto* changedEntity = static_cast<Entity*>(world.defaultLayer()->children()[1]);
+            auto* unchangedEntity = static_cast<Entity*>(world.defaultLayer()->children()[3]);
+            const auto unchangedIssues = unchangedEntity->issues(world.registeredIssueGenerators());
+            ASSERT_FALSE(unchangedIssues.empty());
+
+            changedEntity->addOrUpdateAttribute("message", "");
+            ASSERT_NE(0, changedEntity->invalidIssueTypes());
+            ASSERT_EQ(0, unchangedEntity->invalidIssueTypes());
+
+            world.validateIssues(4);
+            ASSERT_EQ(0, changedEntity->invalidIssueTypes());
+            ASSERT_EQ(1u, changedEntity->issues(world.registeredIssueGenerators()).size());
+            // the issues of the unchanged entity were not regenerated
+            ASSERT_EQ(unchangedIssues, unchangedEntity->issues(world.registeredIssueGenerators()));
+        }
+
+        TEST(WorldTest, registerIssueGeneratorKeepsExistingIssues) {
+            World world(MapFormat::Standard, nullptr, worldBounds);
+            addNodes(world, 10);
+            world.registerIssueGenerator(new MissingClassnameIssueGenerator());
+            world.validateIssues(4);
+
+            auto* entity = static_cast<Entity*>(world.defaultLayer()->children()[0]);
+            const auto oldIssues = entity->issues(world.registeredIssueGenerators());
+            ASSERT_EQ(1u, oldIssues.size());
+
+            auto* generator = new EmptyAttributeValueIssueGenerator();
+            world.registerIssueGenerator(generator);
+            ASSERT_EQ(generator->type(), entity->invalidIssueTypes());
+
+            world.validateIssues(4);
+            const auto& newIssues = entity->issues(world.registeredIssueGenerators());
+            ASSERT_EQ(2u, newIssues.size());
+            ASSERT_EQ(oldIssues[0], newIssues[0]);
+            ASSERT_EQ(generator->type(), newIssues[1]->type());
+        }
+
+        TEST(WorldTest, changingBrushInvalidatesOnlyAffectedIssuesOfAncestors) {
+            World world(MapFormat::Standard, nullptr, worldBounds);
+            addNodes(world, 10);
+            auto* missingClassnameGenerator = new MissingClassnameIssueGenerator();
+            auto* linkTargetGenerator = new LinkTargetIssueGenerator();
+            auto* worldBoundsGenerator = new WorldBoundsIssueGenerator(vm::bbox3(1024.0));
+            world.registerIssueGenerator(missingClassnameGenerator);
+            world.registerIssueGenerator(linkTargetGenerator);
+            world.registerIssueGenerator(worldBoundsGenerator);
+            world.validateIssues(4);
+
+            auto* entity = static_cast<Entity*>(world.defaultLayer()->children()[0]);
+            auto* brush = static_cast<Brush*>(entity->children().front());
+            const auto oldIssueCount = entity->issues(world.registeredIssueGenerators()).size();
+            ASSERT_EQ(2u, oldIssueCount);
+
+            brush->transform(vm::translationMatrix(vm::vec3(2048.0, 0.0, 0.0)), false, worldBounds);
+
+            // the brush itself changed, but its ancestors only need to check their bounds again
+            ASSERT_EQ(missingClassnameGenerator->type() | linkTargetGenerator->type() | worldBoundsGenerator->type(), brush->invalidIssueTypes());
+            ASSERT_EQ(worldBoundsGenerator->type(), entity->invalidIssueTypes());
+            ASSERT_EQ(worldBoundsGenerator->type(), world.defaultLayer()->invalidIssueTypes());
+
+            world.validateIssues(4);
+            const auto& newIssues = entity->issues(world.registeredIssueGenerators());
+            ASSERT_EQ(oldIssueCount + 1u, newIssues.size());
+            ASSERT_EQ(worldBoundsGenerator->type(), newIssues.back()->type());
+        }
+
+        TEST(WorldTest, deferNodeTreeUpdates) {
+            World world(MapFormat::Standard, nullptr, worldBounds);
+            addNodes(world, 100);
+
+            const auto entities = world.defaultLayer()->children();
+            const auto translation = vm::translationMatrix(vm::vec3(0.0, 1024.0, 0.0));
+
+            world.deferNodeTreeUpdates();
+            for (auto* entity : entities) {
+                for (auto* child : entity->children()) {
+                    static_cast<Brush*>(child)->transform(translation, false, worldBounds);
+                }
+            }
+
+            // removing a node while updates are deferred must find it in the tree
+            auto* removedEntity = entities[2];
+            world.defaultLayer()->removeChild(removedEntity);
+            delete removedEntity;
+
+            world.applyDeferredNodeTreeUpdates();
+
+            NodeList nodes;
+            world.findNodesContaining(vm::vec3(8.0, 8.0, 8.0), nodes);
+            ASSERT_TRUE(nodes.empty());
+
+            auto* brush = entities[0]->children().front();
+            world.findNodesContaining(vm::vec3(8.0, 1032.0, 8.0), nodes);
+            ASSERT_NE(std::end(nodes), std::find(std::begin(nodes), std::end(nodes), brush));
+
+            // without deferring, the tree is updated immediately
+            static_cast<Brush*>(brush)->transform(vm::translationMatrix(vm::vec3(0.0, -1024.0, 0.0)), false, worldBounds);
+
+            nodes.clear();
+            world.findNodesContaining(vm::vec3(8.0, 8.0, 8.0), nodes);
+            ASSERT_NE(std::end(nodes), std::find(std::begin(nodes), std::end(nodes), brush));
+        }
+
+        TEST(WorldTest, deferNodeTreeUpdatesAppliesUpdatesIfTransformFails) {
+            World world(MapFormat::Standard, nullptr, worldBounds);
+            addNodes(world, 100);
+
+            const auto entities = world.defaultLayer()->children();
+            const auto translation = vm::translationMatrix(vm::vec3(0.0, 1024.0, 0.0));
+
+            try {
+                DeferNodeTreeUpdates deferNodeTreeUpdates(world);
+                for (size_t i = 0; i < 50; ++i) {
+                    for (auto* child : entities[i]->children()) {
+                        static_cast<Brush*>(child)->transform(translation, false, worldBounds);
+                    }
+                }
+                throw GeometryException("transform failed");
+            } catch (const GeometryException&) {}
+
+            // the brushes that were transformed before the failure are found at their new position
+            auto* transformed = entities[0]->children().front();
+            NodeList nodes;
+            world.findNodesContaining(vm::vec3(8.0, 1032.0, 8.0), nodes);
+            ASSERT_NE(std::end(nodes), std::find(std::begin(nodes), std::end(nodes), transformed));
+
+            nodes.clear();
+            world.findNodesContaining(vm::vec3(8.0, 8.0, 8.0), nodes);
+            ASSERT_EQ(std::end(nodes), std::find(std::begin(nodes), std::end(nodes), transformed));
+
+            // the world no longer defers updates
+            auto* untransformed = entities[60]->children().front();
+            const auto point = untransformed->bounds().center();
+            static_cast<Brush*>(untransformed)->transform(translation, false, worldBounds);
+
+            nodes.clear();
+            world.findNodesContaining(point + vm::vec3(0.0, 1024.0, 0.0), nodes);
+            ASSERT_NE(std::end(nodes), std::find(std::begin(nodes), std::end(nodes), untransformed));
+        }
+
+        TEST(WorldTest, deferNodeTreeUpdatesRebuildsTreeIfUpdateFails) {
+            World world(MapFormat::Standard, nullptr, worldBounds);
+            addNodes(world, 10);
+
+            // brushes that are missing from the node tree cannot be updated
+            BrushBuilder builder(&world, worldBounds);
+            world.disableNodeTreeUpdates();
+            auto* brush1 = builder.createCube(16.0, "texture");
+            world.defaultLayer()->addChild(brush1);
+            world.enableNodeTreeUpdates();
+
+            const auto translation = vm::translationMatrix(vm::vec3(0.0, 1024.0, 0.0));
+            {
+                DeferNodeTreeUpdates deferNodeTreeUpdates(world);
+                brush1->transform(translation, false, worldBounds);
+                ASSERT_THROW(deferNodeTreeUpdates.apply(), NodeTreeException);
+            }
+
+            NodeList nodes;
+            world.findNodesContaining(brush1->bounds().center(), nodes);
+            ASSERT_NE(std::end(nodes), std::find(std::begin(nodes), std::end(nodes), brush1));
+
+            world.disableNodeTreeUpdates();
+            auto* brush2 = builder.createCube(16.0, "texture");
+            world.defaultLayer()->addChild(brush2);
+            world.enableNodeTreeUpdates();
+
+            // without calling apply, the failure is not reported, but the tree is rebuilt all the same
+            {
+                DeferNodeTreeUpdates deferNodeTreeUpdates(world);
+                brush2->transform(translation, false, worldBounds);
+            }
+
+            nodes.clear();
+            world.findNodesContaining(brush2->bounds().center(), nodes);
+            ASSERT_NE(std::end(nodes), std::find(std::begin(nodes), std::end(nodes), brush2));
+        }
+    }
+}
@@ -0,0 +1,92 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "ParallelFor.h"
+
+#include <atomic>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace TrenchBroom {
+    TEST(ParallelForTest, emptyRange) {
+        std::atomic<size_t> calls(0);
+        parallelFor(0, [&](const size_t) { ++calls; }, 4);
+        ASSERT_EQ(0u, calls.load());
+    }
+
+    TEST(ParallelForTest, visitEveryIndexOnce) {
+        for (const size_t threadCount : { 1u, 2u, 4u, 16u }) {
+            std::vector<std::atomic<size_t>> visits(1000);
+            parallelFor(visits.size(), [&](const size_t i) { ++visits[i]; }, threadCount);
+
+            for (const auto& count : visits) {
+                ASSERT_EQ(1u, count.load());
+            }
+        }
+    }
+
+    TEST(ParallelForTest, moreThreadsThanIndices) {
+        std::vector<std::atomic<size_t>> visits(3);
+        parallelFor(visits.size(), [&](const size_t i) { ++visits[i]; }, 8);
+
+        for (const auto& count : visits) {
+            ASSERT_EQ(1u, count.load());
+        }
+    }
+
+    TEST(ParallelForTest, runSeriallyBelowMinCountPerThread) {
+        std::set<std::thread::id> threads;
+        parallelFor(63, [&](const size_t) { threads.insert(std::this_thread::get_id()); }, 4, 32);
+        ASSERT_EQ(std::set<std::thread::id>({ std::this_thread::get_id() }), threads);
+    }
+
+    TEST(ParallelForTest, nestedCalls) {
+        std::vector<std::atomic<size_t>> visits(100 * 100);
+        parallelFor(100, [&](const size_t i) {
+            parallelFor(100, [&](const size_t j) { ++visits[i * 100 + j]; }, 4, 1);
+        }, 4, 1);
+
+        for (const auto& count : visits) {
+            ASSERT_EQ(1u, count.load());
+        }
+    }
+
+    TEST(ParallelForTest, reuseWorkerThreads) {
+        parallelFor(1000, [](const size_t) {}, 4);
+        const auto workerCount = workerThreadCount();
+        ASSERT_LE(3u, workerCount);
+
+        for (size_t i = 0; i < 10; ++i) {
+            parallelFor(1000, [](const size_t) {}, 4);
+        }
+        ASSERT_EQ(workerCount, workerThreadCount());
+    }
+
+    TEST(ParallelForTest, rethrowException) {
+        ASSERT_THROW(parallelFor(100, [](const size_t i) {
+            if (i == 42) {
+                throw std::runtime_error("42");
+            }
+        }, 4), std::runtime_error);
+    }
+}
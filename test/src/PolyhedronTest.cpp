@@ -28,7 +28,10 @@
 #include <vecmath/plane.h>
 #include <vecmath/scalar.h>
 
+#include <algorithm>
+#include <cmath>
 #include <iterator>
+#include <random>
 #include <tuple>
 
 typedef Polyhedron<double, DefaultPolyhedronPayload, DefaultPolyhedronPayload> Polyhedron3d;
@@ -114,6 +117,35 @@ TEST(PolyhedronTest, copy) {
     ASSERT_EQ(original, copy);
 }
 
+TEST(PolyhedronTest, modifyCopy) {
+    const Polyhedron3d original(vm::bbox3d(-8.0, 8.0));
+
+    for (const bool useArena : { true, false }) {
+        AllocatorArena::setEnabled(useArena);
+
+        Polyhedron3d copy(original);
+        ASSERT_EQ(original, copy);
+
+        // clipping deletes some of the copied elements and adds new ones
+        ASSERT_TRUE(copy.clip(vm::plane3d(vm::vec3d(4.0, 4.0, 4.0), normalize(vm::vec3d(1.0, 1.0, 1.0)))).success());
+        ASSERT_EQ(10u, copy.vertexCount());
+        ASSERT_EQ(7u, copy.faceCount());
+
+        copy.addPoint(vm::vec3d(0.0, 0.0, 16.0));
+        ASSERT_TRUE(copy.closed());
+        ASSERT_TRUE(hasVertex(copy, vm::vec3d(0.0, 0.0, 16.0)));
+
+        Polyhedron3d copyOfCopy(copy);
+        ASSERT_EQ(copy, copyOfCopy);
+
+        copy = Polyhedron3d();
+        ASSERT_TRUE(copyOfCopy.closed());
+        ASSERT_EQ(8u, original.vertexCount());
+    }
+
+    AllocatorArena::setEnabled(true);
+}
+
 TEST(PolyhedronTest, swap) {
     const vm::vec3d p1( 0.0, 0.0, 8.0);
     const vm::vec3d p2( 8.0, 0.0, 0.0);
@@ -502,6 +534,80 @@ TEST(PolyhedronTest, testSimpleConvexHullOfCube) {
     ASSERT_TRUE(hasQuadOf(p, p2, p6, p8, p4));
 }
 
+class CountingCallback : public Polyhedron3d::Callback {
+public:
+    size_t createdFaces = 0u;
+    size_t deletedFaces = 0u;
+    size_t addedVertices = 0u;
+public:
+    void faceWasCreated(PFace*) override {
+        ++createdFaces;
+    }
+
+    void faceWillBeDeleted(PFace*) override {
+        ++deletedFaces;
+    }
+
+    void vertexWasAdded(PVertex*) override {
+        ++addedVertices;
+    }
+};
+
+TEST(PolyhedronTest, addManyPoints) {
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> coordinate(-64.0, 64.0);
+
+    std::vector<vm::vec3d> points;
+    for (size_t i = 0; i < 300; ++i) {
+        points.emplace_back(coordinate(random), coordinate(random), coordinate(random));
+    }
+
+    Polyhedron3d incremental;
+    for (const auto& point : points) {
+        incremental.addPoint(point);
+    }
+
+    CountingCallback callback;
+    Polyhedron3d polyhedron;
+    polyhedron.addPoints(points, callback);
+
+    ASSERT_TRUE(polyhedron.polyhedron());
+    ASSERT_TRUE(polyhedron.closed());
+    ASSERT_EQ(incremental.vertexCount(), polyhedron.vertexCount());
+    ASSERT_EQ(incremental.edgeCount(), polyhedron.edgeCount());
+    ASSERT_EQ(incremental.faceCount(), polyhedron.faceCount());
+    ASSERT_TRUE(polyhedron.hasVertices(incremental.vertexPositions()));
+    ASSERT_EQ(incremental.bounds(), polyhedron.bounds());
+
+    for (const auto& point : points) {
+        ASSERT_TRUE(polyhedron.contains(point));
+    }
+
+    ASSERT_EQ(polyhedron.faceCount(), callback.createdFaces - callback.deletedFaces);
+    ASSERT_LE(polyhedron.vertexCount(), callback.addedVertices);
+}
+
+TEST(PolyhedronTest, mergePreservesUntouchedFaces) {
+    Polyhedron3d polyhedron(vm::bbox3d(32.0));
+    const Polyhedron3d other(vm::bbox3d(vm::vec3d(-32.0, -32.0, -32.0), vm::vec3d(32.0, 32.0, 64.0)));
+
+    const auto findBottom = [](const Polyhedron3d& p) -> const PFace* {
+        for (const auto* face : p.faces()) {
+            if (face->normal() == vm::vec3d::neg_z) {
+                return face;
+            }
+        }
+        return nullptr;
+    };
+
+    const auto* bottom = findBottom(polyhedron);
+    ASSERT_NE(nullptr, bottom);
+
+    polyhedron.merge(other);
+    ASSERT_EQ(other, polyhedron);
+    ASSERT_EQ(bottom, findBottom(polyhedron));
+}
+
 TEST(PolyhedronTest, initEmpty) {
     Polyhedron3d p;
     ASSERT_TRUE(p.empty());
@@ -1780,6 +1886,119 @@ bool findAndRemove(Polyhedron3d::SubtractResult& result, const std::vector<vm::v
     return false;
 }
 
+TEST(PolyhedronTest, volume) {
+    ASSERT_DOUBLE_EQ(0.0, Polyhedron3d().volume());
+    ASSERT_DOUBLE_EQ(0.0, Polyhedron3d({ vm::vec3d(0.0, 0.0, 0.0), vm::vec3d(1.0, 0.0, 0.0), vm::vec3d(0.0, 1.0, 0.0) }).volume());
+
+    ASSERT_DOUBLE_EQ(64.0 * 64.0 * 64.0, Polyhedron3d(vm::bbox3d(32.0)).volume());
+    ASSERT_DOUBLE_EQ(2.0 * 3.0 * 4.0, Polyhedron3d(vm::bbox3d(vm::vec3d(1000.0, 2000.0, 3000.0), vm::vec3d(1002.0, 2003.0, 3004.0))).volume());
+
+    const Polyhedron3d tetrahedron(vm::vec3d(0.0, 0.0, 0.0), vm::vec3d(6.0, 0.0, 0.0), vm::vec3d(0.0, 6.0, 0.0), vm::vec3d(0.0, 0.0, 6.0));
+    ASSERT_DOUBLE_EQ(36.0, tetrahedron.volume());
+}
+
+static std::vector<vm::plane3d> facePlanes(const Polyhedron3d& polyhedron) {
+    std::vector<vm::plane3d> result;
+    for (const auto* face : polyhedron.faces()) {
+        result.emplace_back(face->origin(), face->normal());
+    }
+    return result;
+}
+
+TEST(PolyhedronTest, setPlanesOfCuboid) {
+    const vm::bbox3d bounds(vm::vec3d(-16.0, -32.0, 0.0), vm::vec3d(16.0, 64.0, 8.0));
+    const Polyhedron3d expected(bounds);
+
+    auto planes = facePlanes(expected);
+    std::reverse(std::begin(planes), std::end(planes));
+
+    Polyhedron3d polyhedron;
+    std::vector<PFace*> faces;
+    ASSERT_TRUE(polyhedron.setPlanes(planes, faces));
+    ASSERT_EQ(expected, polyhedron);
+    ASSERT_EQ(bounds, polyhedron.bounds());
+
+    // the faces are created in the order of the planes
+    ASSERT_EQ(planes.size(), faces.size());
+    auto* face = polyhedron.faces().front();
+    for (size_t i = 0; i < planes.size(); ++i) {
+        ASSERT_EQ(face, faces[i]);
+        ASSERT_EQ(planes[i].normal, face->normal());
+        face = face->next();
+    }
+}
+
+TEST(PolyhedronTest, setPlanesOfPrism) {
+    std::vector<vm::vec3d> points;
+    for (size_t i = 0; i < 12; ++i) {
+        const auto angle = vm::Cd::twoPi() * static_cast<double>(i) / 12.0;
+        const auto x = std::round(64.0 * std::cos(angle));
+        const auto y = std::round(64.0 * std::sin(angle));
+        points.emplace_back(x, y, -32.0);
+        points.emplace_back(x, y, +32.0);
+    }
+    const Polyhedron3d expected(points);
+    const auto planes = facePlanes(expected);
+
+    Polyhedron3d polyhedron;
+    std::vector<PFace*> faces;
+    ASSERT_TRUE(polyhedron.setPlanes(planes, faces));
+
+    ASSERT_EQ(expected.vertexCount(), polyhedron.vertexCount());
+    ASSERT_EQ(expected.edgeCount(), polyhedron.edgeCount());
+    ASSERT_EQ(expected.faceCount(), polyhedron.faceCount());
+    ASSERT_TRUE(polyhedron.hasVertices(expected.vertexPositions(), 0.0001));
+
+    for (size_t i = 0; i < planes.size(); ++i) {
+        ASSERT_NE(nullptr, faces[i]);
+        ASSERT_TRUE(vm::isEqual(planes[i].normal, faces[i]->normal(), 0.0001));
+    }
+}
+
+TEST(PolyhedronTest, setPlanesSkipsRedundantPlanes) {
+    const Polyhedron3d cube(vm::bbox3d(32.0));
+
+    auto planes = facePlanes(cube);
+    // coincides with the first plane
+    planes.push_back(planes.front());
+    // touches the cube at an edge
+    planes.emplace_back(vm::vec3d(32.0, 32.0, 0.0), vm::normalize(vm::vec3d(1.0, 1.0, 0.0)));
+    // touches the cube at a vertex
+    planes.emplace_back(vm::vec3d(32.0, 32.0, 32.0), vm::normalize(vm::vec3d(1.0, 1.0, 1.0)));
+    // doesn't touch the cube at all
+    planes.emplace_back(vm::vec3d(0.0, 0.0, 64.0), vm::vec3d::pos_z);
+
+    Polyhedron3d polyhedron;
+    std::vector<PFace*> faces;
+    ASSERT_TRUE(polyhedron.setPlanes(planes, faces));
+    ASSERT_EQ(cube, polyhedron);
+
+    ASSERT_EQ(planes.size(), faces.size());
+    for (size_t i = 0; i < 6; ++i) {
+        ASSERT_NE(nullptr, faces[i]);
+    }
+    for (size_t i = 6; i < planes.size(); ++i) {
+        ASSERT_EQ(nullptr, faces[i]);
+    }
+}
+
+TEST(PolyhedronTest, setPlanesFailsIfNotClosed) {
+    const Polyhedron3d cube(vm::bbox3d(32.0));
+    auto planes = facePlanes(cube);
+    planes.pop_back();
+
+    Polyhedron3d polyhedron(cube);
+    std::vector<PFace*> faces;
+    ASSERT_FALSE(polyhedron.setPlanes(planes, faces));
+    ASSERT_EQ(cube, polyhedron);
+
+    // the planes do not bound anything
+    planes = facePlanes(cube);
+    planes.emplace_back(vm::vec3d(0.0, 0.0, -64.0), vm::vec3d::pos_z);
+    ASSERT_FALSE(polyhedron.setPlanes(planes, faces));
+    ASSERT_EQ(cube, polyhedron);
+}
+
 TEST(PolyhedronTest, subtractInnerCuboidFromCuboid) {
     const Polyhedron3d minuend(vm::bbox3d(32.0));
     const Polyhedron3d subtrahend(vm::bbox3d(16.0));
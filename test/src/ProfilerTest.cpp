@@ -0,0 +1,110 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "ParallelFor.h"
+#include "Profiler.h"
+
+#include <sstream>
+#include <string>
+
+namespace TrenchBroom {
+    namespace Profiler {
+        TEST(ProfilerTest, lastFrameStats) {
+            clear();
+
+            const auto start = Clock::now();
+            recordZone("outside", start - std::chrono::milliseconds(1), start);
+            endFrame();
+
+            const auto frameStart = Clock::now();
+            recordZone("render", frameStart, frameStart + std::chrono::milliseconds(2));
+            recordZone("render", frameStart, frameStart + std::chrono::milliseconds(4));
+            recordZone("pick", frameStart, frameStart + std::chrono::milliseconds(1));
+
+            // zones that end after the frame ends are not counted
+            while (Clock::now() < frameStart + std::chrono::milliseconds(4)) {}
+            endFrame();
+
+            const auto stats = lastFrameStats();
+            ASSERT_EQ(2u, stats.size());
+
+            ASSERT_EQ("render", stats[0].name);
+            ASSERT_EQ(2u, stats[0].count);
+            ASSERT_NEAR(6.0, stats[0].totalMs, 0.001);
+            ASSERT_NEAR(4.0, stats[0].maxMs, 0.001);
+
+            ASSERT_EQ("pick", stats[1].name);
+            ASSERT_EQ(1u, stats[1].count);
+
+            clear();
+        }
+
+        TEST(ProfilerTest, scopedZone) {
+            clear();
+            endFrame();
+            {
+                const ScopedZone zone("scoped");
+            }
+            endFrame();
+
+            const auto stats = lastFrameStats();
+            ASSERT_EQ(1u, stats.size());
+            ASSERT_EQ("scoped", stats[0].name);
+
+            clear();
+        }
+
+        TEST(ProfilerTest, recordOnMultipleThreads) {
+            clear();
+            endFrame();
+            parallelFor(1000, [](const size_t) {
+                const ScopedZone zone("work");
+            }, 4);
+            endFrame();
+
+            const auto stats = lastFrameStats();
+            ASSERT_EQ(1u, stats.size());
+            ASSERT_EQ(1000u, stats[0].count);
+
+            clear();
+        }
+
+        TEST(ProfilerTest, writeChromeTrace) {
+            clear();
+
+            const auto start = Clock::now();
+            recordZone("MapRenderer::render", start, start + std::chrono::microseconds(1500));
+            recordZone("quote\"d", start, start);
+
+            std::stringstream str;
+            writeChromeTrace(str);
+            const auto json = str.str();
+
+            ASSERT_EQ(0u, json.find("{\"traceEvents\":["));
+            ASSERT_NE(std::string::npos, json.find("{\"name\":\"MapRenderer::render\",\"ph\":\"X\",\"pid\":1,\"tid\":"));
+            ASSERT_NE(std::string::npos, json.find(",\"dur\":1500.000}"));
+            ASSERT_NE(std::string::npos, json.find("\"name\":\"quote\\\"d\""));
+
+            clear();
+        }
+    }
+}
@@ -0,0 +1,81 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushFace.h"
+#include "Model/MapFormat.h"
+#include "Model/World.h"
+#include "Renderer/BrushRendererBrushCache.h"
+
+#include <vecmath/vec.h>
+
+#include <algorithm>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        TEST(BrushRendererBrushCacheTest, packedVertexSize) {
+            ASSERT_EQ(24u, sizeof(BrushRendererBrushCache::Vertex));
+            ASSERT_EQ(24u, BrushRendererBrushCache::VertexSpec::Size);
+            ASSERT_LT(sizeof(BrushRendererBrushCache::Vertex), sizeof(VertexSpecs::P3NT2::Vertex));
+        }
+
+        TEST(BrushRendererBrushCacheTest, packNormal) {
+            using PackedNormal = BrushRendererBrushCache::PackedNormal;
+
+            ASSERT_EQ(PackedNormal(127, 0, 0, 0), BrushRendererBrushCache::packNormal(vm::vec3f::pos_x));
+            ASSERT_EQ(PackedNormal(0, -127, 0, 0), BrushRendererBrushCache::packNormal(vm::vec3f::neg_y));
+            ASSERT_EQ(PackedNormal(0, 0, 127, 0), BrushRendererBrushCache::packNormal(vm::vec3f::pos_z));
+            ASSERT_EQ(PackedNormal(90, -90, 0, 0), BrushRendererBrushCache::packNormal(normalize(vm::vec3f(1.0f, -1.0f, 0.0f))));
+        }
+
+        TEST(BrushRendererBrushCacheTest, validateVertexCache) {
+            const vm::bbox3 worldBounds(4096.0);
+            Model::World world(Model::MapFormat::Standard, nullptr, worldBounds);
+            Model::BrushBuilder builder(&world, worldBounds);
+
+            Model::Brush* brush = builder.createCube(64.0, "texture");
+            auto& cache = brush->brushRendererBrushCache();
+            cache.validateVertexCache(brush);
+
+            const auto& vertices = cache.cachedVertices();
+            ASSERT_EQ(24u, vertices.size());
+            ASSERT_EQ(6u, cache.cachedFacesSortedByTexture().size());
+            ASSERT_EQ(12u, cache.cachedEdges().size());
+
+            for (const auto& cachedFace : cache.cachedFacesSortedByTexture()) {
+                const auto* face = cachedFace.face;
+                const auto expectedNormal = BrushRendererBrushCache::packNormal(vm::vec3f(face->boundary().normal));
+                const auto positions = face->vertexPositions();
+
+                for (size_t i = 0; i < cachedFace.vertexCount; ++i) {
+                    const auto& vertex = vertices[cachedFace.indexOfFirstVertexRelativeToBrush + i];
+                    ASSERT_EQ(expectedNormal, vertex.v2);
+                    ASSERT_NE(std::end(positions), std::find(std::begin(positions), std::end(positions), vm::vec3(vertex.v1)));
+                    ASSERT_EQ(face->textureCoords(vm::vec3(vertex.v1)), vertex.v3);
+                }
+            }
+
+            delete brush;
+        }
+    }
+}
@@ -0,0 +1,167 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "CollectionUtils.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/MapFormat.h"
+#include "Model/World.h"
+#include "Renderer/BrushRenderer.h"
+
+#include <vecmath/bbox.h>
+#include <vecmath/vec.h>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        static const vm::bbox3 worldBounds(4096.0);
+
+        static Model::BrushList makeBrushes(Model::World& world, const size_t count) {
+            Model::BrushBuilder builder(&world, worldBounds);
+
+            Model::BrushList result;
+            for (size_t i = 0; i < count; ++i) {
+                const auto min = vm::vec3(static_cast<FloatType>(i) * 32.0, 0.0, 0.0);
+                result.push_back(builder.createCuboid(vm::bbox3(min, min + vm::vec3(16.0, 16.0, 16.0)), "texture"));
+            }
+            return result;
+        }
+
+        TEST(BrushRendererTest, setBrushesReusesSlots) {
+            Model::World world(Model::MapFormat::Standard, nullptr, worldBounds);
+            auto brushes = makeBrushes(world, 5);
+
+            BrushRenderer renderer(false);
+            renderer.setBrushes({ brushes[0], brushes[1], brushes[2] });
+            ASSERT_FALSE(renderer.valid());
+            renderer.validate();
+            ASSERT_EQ(3u, renderer.slotCount());
+
+            renderer.setBrushes({ brushes[0] });
+            ASSERT_TRUE(renderer.valid());
+            ASSERT_EQ(3u, renderer.slotCount());
+
+            // the new brushes take the slots of the removed ones
+            renderer.setBrushes({ brushes[0], brushes[3], brushes[4] });
+            ASSERT_FALSE(renderer.valid());
+            ASSERT_EQ(3u, renderer.slotCount());
+            renderer.validate();
+            ASSERT_TRUE(renderer.valid());
+
+            // adding a brush again does not invalidate it
+            renderer.addBrushes({ brushes[3] });
+            ASSERT_TRUE(renderer.valid());
+            ASSERT_EQ(3u, renderer.slotCount());
+
+            renderer.addBrushes({ brushes[1] });
+            ASSERT_FALSE(renderer.valid());
+            ASSERT_EQ(4u, renderer.slotCount());
+            renderer.validate();
+
+            VectorUtils::clearAndDelete(brushes);
+        }
+
+        TEST(BrushRendererTest, removeBrushesReusesSlots) {
+            Model::World world(Model::MapFormat::Standard, nullptr, worldBounds);
+            auto brushes = makeBrushes(world, 4);
+
+            BrushRenderer renderer(false);
+            renderer.addBrushes({ brushes[0], brushes[1], brushes[2] });
+            renderer.validate();
+
+            // unknown brushes are ignored
+            renderer.removeBrushes({ brushes[1], brushes[3] });
+            ASSERT_TRUE(renderer.valid());
+            ASSERT_EQ(3u, renderer.slotCount());
+
+            // the new brush takes the slot of the removed one
+            renderer.addBrushes({ brushes[3] });
+            ASSERT_FALSE(renderer.valid());
+            ASSERT_EQ(3u, renderer.slotCount());
+            renderer.validate();
+            ASSERT_TRUE(renderer.valid());
+
+            VectorUtils::clearAndDelete(brushes);
+        }
+
+        TEST(BrushRendererTest, removingInvalidBrushMakesItsHandleStale) {
+            Model::World world(Model::MapFormat::Standard, nullptr, worldBounds);
+            auto brushes = makeBrushes(world, 3);
+
+            BrushRenderer renderer(false);
+            renderer.setBrushes({ brushes[0], brushes[1] });
+            renderer.validate();
+
+            renderer.invalidateBrushes({ brushes[0] });
+            ASSERT_FALSE(renderer.valid());
+
+            // the removed brush no longer needs to be validated
+            renderer.setBrushes({ brushes[1] });
+            ASSERT_TRUE(renderer.valid());
+
+            // the new brush reuses the slot, the stale handle to the slot must be skipped when validating
+            renderer.setBrushes({ brushes[1], brushes[2] });
+            ASSERT_EQ(2u, renderer.slotCount());
+            ASSERT_FALSE(renderer.valid());
+            renderer.validate();
+            ASSERT_TRUE(renderer.valid());
+
+            renderer.invalidateBrushes({ brushes[2] });
+            ASSERT_FALSE(renderer.valid());
+            renderer.validate();
+            ASSERT_TRUE(renderer.valid());
+
+            VectorUtils::clearAndDelete(brushes);
+        }
+
+        TEST(BrushRendererTest, invalidateBrushesIgnoresUnknownBrushes) {
+            Model::World world(Model::MapFormat::Standard, nullptr, worldBounds);
+            auto brushes = makeBrushes(world, 2);
+
+            BrushRenderer renderer(false);
+            renderer.setBrushes({ brushes[0] });
+            renderer.validate();
+
+            renderer.invalidateBrushes({ brushes[1] });
+            ASSERT_TRUE(renderer.valid());
+            ASSERT_EQ(1u, renderer.slotCount());
+
+            VectorUtils::clearAndDelete(brushes);
+        }
+
+        TEST(BrushRendererTest, clearResetsSlots) {
+            Model::World world(Model::MapFormat::Standard, nullptr, worldBounds);
+            auto brushes = makeBrushes(world, 2);
+
+            BrushRenderer renderer(false);
+            renderer.setBrushes(brushes);
+            renderer.clear();
+            ASSERT_TRUE(renderer.valid());
+            ASSERT_EQ(0u, renderer.slotCount());
+
+            renderer.setBrushes(brushes);
+            ASSERT_FALSE(renderer.valid());
+            renderer.validate();
+            ASSERT_TRUE(renderer.valid());
+
+            VectorUtils::clearAndDelete(brushes);
+        }
+    }
+}
@@ -21,6 +21,12 @@
 
 #include "StringUtils.h"
 
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
 namespace StringUtils {
     TEST(StringUtilsTest, trim) {
         String result;
@@ -293,4 +299,50 @@ namespace StringUtils {
         ASSERT_EQ(String("asdf\\"), StringUtils::unescape("asdf\\\\", ""));
         ASSERT_EQ(String("asdf\\\\"), StringUtils::unescape("asdf\\\\\\\\", ""));
     }
+
+    std::vector<double> testValues();
+    std::vector<double> testValues() {
+        std::vector<double> values = {
+            0.0, -0.0, 1.0, -1.0, 0.5, 0.1, 1.0 / 3.0, 123456789.0, 1e-7, 1e-20, 1e20, 8192.0, -8192.0,
+            0.999999999, 1e15 + 0.3, std::numeric_limits<double>::min(), std::numeric_limits<double>::epsilon()
+        };
+
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<double> coords(-65536.0, 65536.0);
+        std::uniform_real_distribution<double> small(-1.0, 1.0);
+        for (size_t i = 0; i < 1000; ++i) {
+            values.push_back(coords(rng));
+            values.push_back(small(rng));
+            values.push_back(std::round(coords(rng)));
+        }
+        return values;
+    }
+
+    TEST(StringUtilsTest, appendFtos) {
+        for (const int precision : { 1, 6, 17 }) {
+            for (const double value : testValues()) {
+                String str = "x";
+                appendFtos(str, value, precision);
+                ASSERT_EQ("x" + ftos(value, precision), str) << "value " << value << ", precision " << precision;
+            }
+        }
+
+        // too large for the internal buffer
+        String str;
+        appendFtos(str, 1e100, 17);
+        ASSERT_EQ(ftos(1e100, 17), str);
+    }
+
+    TEST(StringUtilsTest, appendGeneral) {
+        for (const int precision : { 1, 6, 17 }) {
+            for (const double value : testValues()) {
+                char expected[64];
+                std::snprintf(expected, sizeof(expected), "%.*g", precision, value);
+
+                String str = "x";
+                appendGeneral(str, value, precision);
+                ASSERT_EQ("x" + String(expected), str) << "value " << value << ", precision " << precision;
+            }
+        }
+    }
 }
@@ -58,5 +58,24 @@ namespace TrenchBroom {
             for (Model::BrushFace* face : brush->faces())
                 ASSERT_EQ(texture, face->texture());
         }
+
+        TEST_F(SnapshotTest, undoCompactedTransformation) {
+            Model::Brush* brush = createBrush("texture");
+            document->addNode(brush, document->currentParent());
+            document->select(brush);
+
+            const vm::bbox3 originalBounds = brush->bounds();
+            const std::vector<vm::vec3> originalVertices = brush->vertexPositions();
+
+            document->rotateObjects(brush->bounds().center(), vm::vec3::pos_z, vm::toRadians(30.0));
+            ASSERT_NE(originalBounds, brush->bounds());
+
+            // submitting a command of another type compacts the snapshot of the rotation
+            document->deselectAll();
+            document->undoLastCommand();
+
+            document->undoLastCommand();
+            ASSERT_TRUE(brush->hasVertices(originalVertices, 0.001));
+        }
     }
 }
@@ -0,0 +1,166 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <vecmath/forward.h>
+#include <vecmath/vec.h>
+#include <vecmath/vec_ext.h>
+#include <vecmath/ray.h>
+#include <vecmath/scalar.h>
+#include <vecmath/intersection_batch.h>
+
+#include <random>
+#include <vector>
+
+namespace vm {
+    bbox4f makeBoxes(const std::vector<vec3f>& mins, const std::vector<vec3f>& maxs);
+
+    struct convex_planes {
+        std::vector<double> nx, ny, nz, d;
+
+        void add(const vec3d& normal, const double distance) {
+            nx.push_back(normal.x());
+            ny.push_back(normal.y());
+            nz.push_back(normal.z());
+            d.push_back(distance);
+        }
+
+        std::pair<size_t, double> intersect(const ray3d& r) const {
+            return intersectConvex(r, nx.data(), ny.data(), nz.data(), d.data(), nx.size());
+        }
+    };
+
+    convex_planes cube();
+
+    TEST(IntersectionBatchTest, intersectBoxes) {
+        const auto boxes = makeBoxes(
+            { vec3f(-1.0f, -1.0f, -1.0f), vec3f(4.0f, -1.0f, -1.0f), vec3f(-1.0f, 4.0f, -1.0f), vec3f(-8.0f, -1.0f, -1.0f) },
+            { vec3f(+1.0f, +1.0f, +1.0f), vec3f(6.0f, +1.0f, +1.0f), vec3f(+1.0f, 6.0f, +1.0f), vec3f(-6.0f, +1.0f, +1.0f) });
+
+        ASSERT_EQ(0x3u, intersectMask(box_query_ray(ray3f(vec3f(-2.0f, 0.0f, 0.0f), vec3f::pos_x)), boxes));
+        ASSERT_EQ(0x3u, intersectMask(box_query_ray(ray3f(vec3f(0.0f, 0.0f, 0.0f), vec3f::pos_x)), boxes));
+        ASSERT_EQ(0x9u, intersectMask(box_query_ray(ray3f(vec3f(0.0f, 0.0f, 0.0f), vec3f::neg_x)), boxes));
+        ASSERT_EQ(0x5u, intersectMask(box_query_ray(ray3f(vec3f(0.0f, -2.0f, 0.0f), vec3f::pos_y)), boxes));
+        ASSERT_EQ(0x0u, intersectMask(box_query_ray(ray3f(vec3f(0.0f, 0.0f, 2.0f), vec3f::pos_z)), boxes));
+        ASSERT_EQ(0x2u, intersectMask(box_query_ray(ray3f(vec3f(5.0f, 0.0f, 2.0f), vec3f::neg_z)), boxes));
+
+        // the ray origin is on a box boundary, and the ray is parallel to the boundary
+        ASSERT_EQ(0x3u, intersectMask(box_query_ray(ray3f(vec3f(-2.0f, 1.0f, 0.0f), vec3f::pos_x)), boxes));
+        ASSERT_EQ(0x0u, intersectMask(box_query_ray(ray3f(vec3f(-2.0f, 1.5f, 0.0f), vec3f::pos_x)), boxes));
+    }
+
+    TEST(IntersectionBatchTest, containsPoint) {
+        const auto boxes = makeBoxes(
+            { vec3f(-1.0f, -1.0f, -1.0f), vec3f(0.0f, 0.0f, 0.0f), vec3f(2.0f, 2.0f, 2.0f), vec3f(-8.0f, -8.0f, -8.0f) },
+            { vec3f(+1.0f, +1.0f, +1.0f), vec3f(2.0f, 2.0f, 2.0f), vec3f(3.0f, 3.0f, 3.0f), vec3f(-6.0f, -6.0f, -6.0f) });
+
+        ASSERT_EQ(0x3u, containsMask(vec3f(0.5f, 0.5f, 0.5f), boxes));
+        ASSERT_EQ(0x6u, containsMask(vec3f(2.0f, 2.0f, 2.0f), boxes));
+        ASSERT_EQ(0x0u, containsMask(vec3f(4.0f, 0.0f, 0.0f), boxes));
+    }
+
+    TEST(IntersectionBatchTest, simdMatchesScalar) {
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> position(-16.0f, 16.0f);
+        std::uniform_real_distribution<float> size(0.0f, 8.0f);
+        std::uniform_int_distribution<int> axis(-1, 2);
+
+        for (size_t i = 0; i < 1000; ++i) {
+            std::vector<vec3f> mins, maxs;
+            for (size_t j = 0; j < 4; ++j) {
+                const auto min = vec3f(position(random), position(random), position(random));
+                mins.push_back(min);
+                maxs.push_back(min + vec3f(size(random), size(random), size(random)));
+            }
+            const auto boxes = makeBoxes(mins, maxs);
+
+            // use axis aligned rays starting on a box boundary every now and then
+            auto origin = vec3f(position(random), position(random), position(random));
+            auto direction = normalize(vec3f(position(random), position(random), position(random)));
+            const auto a = axis(random);
+            if (a >= 0) {
+                direction = vec3f::zero;
+                direction[static_cast<size_t>(a)] = 1.0f;
+                origin[(static_cast<size_t>(a) + 1) % 3] = mins[i % 4][(static_cast<size_t>(a) + 1) % 3];
+            }
+
+            const box_query_ray query(ray3f(origin, direction));
+            ASSERT_EQ(intersectMaskScalar(query, boxes), intersectMask(query, boxes));
+            ASSERT_EQ(containsMaskScalar(origin, boxes), containsMask(origin, boxes));
+        }
+    }
+
+    TEST(IntersectionBatchTest, intersectConvex) {
+        const auto planes = cube();
+
+        const auto hit1 = planes.intersect(ray3d(vec3d(-4.0, 0.0, 0.0), vec3d::pos_x));
+        ASSERT_EQ(0u, hit1.first);
+        ASSERT_DOUBLE_EQ(3.0, hit1.second);
+
+        const auto hit2 = planes.intersect(ray3d(vec3d(0.5, 0.5, 4.0), vec3d::neg_z));
+        ASSERT_EQ(4u, hit2.first);
+        ASSERT_DOUBLE_EQ(3.0, hit2.second);
+
+        // through the edge between the left and the front face
+        const auto hit3 = planes.intersect(ray3d(vec3d(-2.0, -2.0, 0.0), normalize(vec3d(1.0, 1.0, 0.0))));
+        ASSERT_EQ(0u, hit3.first);
+        ASSERT_DOUBLE_EQ(length(vec3d(1.0, 1.0, 0.0)), hit3.second);
+
+        // away from the cube
+        const auto miss1 = planes.intersect(ray3d(vec3d(-4.0, 0.0, 0.0), vec3d::neg_x));
+        ASSERT_EQ(6u, miss1.first);
+        ASSERT_TRUE(isnan(miss1.second));
+
+        // parallel to the cube outside of it
+        const auto miss2 = planes.intersect(ray3d(vec3d(-4.0, 2.0, 0.0), vec3d::pos_x));
+        ASSERT_EQ(6u, miss2.first);
+
+        // from inside the cube
+        const auto miss3 = planes.intersect(ray3d(vec3d(0.0, 0.0, 0.0), vec3d::pos_x));
+        ASSERT_EQ(6u, miss3.first);
+
+        // past a corner
+        const auto miss4 = planes.intersect(ray3d(vec3d(-4.0, -1.5, 0.0), normalize(vec3d(1.0, -0.1, 0.0))));
+        ASSERT_EQ(6u, miss4.first);
+    }
+
+    bbox4f makeBoxes(const std::vector<vec3f>& mins, const std::vector<vec3f>& maxs) {
+        bbox4f result;
+        for (size_t i = 0; i < 4; ++i) {
+            for (size_t a = 0; a < 3; ++a) {
+                result.min[a][i] = mins[i][a];
+                result.max[a][i] = maxs[i][a];
+            }
+        }
+        return result;
+    }
+
+    convex_planes cube() {
+        convex_planes result;
+        result.add(vec3d::neg_x, 1.0);
+        result.add(vec3d::neg_y, 1.0);
+        result.add(vec3d::pos_x, 1.0);
+        result.add(vec3d::pos_y, 1.0);
+        result.add(vec3d::pos_z, 1.0);
+        result.add(vec3d::neg_z, 1.0);
+        return result;
+    }
+}